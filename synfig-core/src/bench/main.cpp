@@ -0,0 +1,816 @@
+/* === S Y N F I G ========================================================= */
+/*!	\file bench/main.cpp
+**	\brief Benchmark and regression harness for the rendering engine
+**
+**	$Id$
+**
+**	\legal
+**	Copyright (c) 2019 Synfig Contributors
+**
+**	This package is free software; you can redistribute it and/or
+**	modify it under the terms of the GNU General Public License as
+**	published by the Free Software Foundation; either version 2 of
+**	the License, or (at your option) any later version.
+**
+**	This package is distributed in the hope that it will be useful,
+**	but WITHOUT ANY WARRANTY; without even the implied warranty of
+**	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+**	General Public License for more details.
+**	\endlegal
+**
+** === N O T E S ===========================================================
+**
+**	synfig-bench renders every scene of the corpus with every requested
+**	renderer, resolution and thread count and writes a JSON report.
+**
+**	Each configuration is measured in a separate worker process (the same
+**	binary started with --worker), so thread count set by environment
+**	variable SYNFIG_RENDERING_THREADS and peak memory usage are isolated.
+**	The worker prints one line prefixed by "synfig-bench-result: "
+**	with JSON object of results, all other output is ignored.
+**
+**	Reference images are stored as PAM files (RGBA, 8 bit per channel)
+**	named <scene>-<renderer>-<width>x<height>.pam
+**
+**	Worker counts heap allocations by own operator new: "allocations"
+**	is the count for the whole frame, "set_time_allocations" is the count
+**	for the evaluation of parameters of all layers (one call of set_time).
+**
+** ========================================================================= */
+
+/* === H E A D E R S ======================================================= */
+
+#ifdef USING_PCH
+#	include "pch.h"
+#else
+#ifdef HAVE_CONFIG_H
+#	include <config.h>
+#endif
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#include <algorithm>
+#include <atomic>
+#include <fstream>
+#include <iostream>
+#include <new>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#ifndef _WIN32
+#include <sys/resource.h>
+#endif
+
+#include <glibmm.h>
+#include <giomm.h>
+
+#include <ETL/stringf>
+
+#include <synfig/general.h>
+#include <synfig/localization.h>
+
+#include <synfig/bone.h>
+#include <synfig/canvas.h>
+#include <synfig/canvasfilenaming.h>
+#include <synfig/context.h>
+#include <synfig/layer.h>
+#include <synfig/loadcanvas.h>
+#include <synfig/main.h>
+#include <synfig/matrix.h>
+#include <synfig/renddesc.h>
+#include <synfig/surface.h>
+#include <synfig/target_tile.h>
+#include <synfig/threadpool.h>
+#include <synfig/value.h>
+#include <synfig/rendering/renderer.h>
+#include <synfig/rendering/renderqueue.h>
+#include <synfig/valuenodes/valuenode_add.h>
+#include <synfig/valuenodes/valuenode_animated.h>
+#include <synfig/valuenodes/valuenode_composite.h>
+#include <synfig/valuenodes/valuenode_const.h>
+#include <synfig/valuenodes/valuenode_cos.h>
+#include <synfig/valuenodes/valuenode_scale.h>
+
+#endif
+
+using namespace synfig;
+
+/* === M A C R O S ========================================================= */
+
+#define RESULT_PREFIX "synfig-bench-result: "
+#define BUILTIN_PREFIX "builtin:"
+#define DEFAULT_RENDERERS "software,software-draft,software-preview,software-low4,safe"
+#define DEFAULT_SIZES "480x270,1280x720,1920x1080"
+#define DEFAULT_THREADS "1,max"
+#define DEFAULT_QUALITY 3
+
+/* === G L O B A L S ======================================================= */
+
+namespace {
+
+//! Pixel difference to reference which is considered as changed pixel (in 8-bit units)
+const int changed_pixel_threshold = 2;
+
+//! Count of calls of operator new, see the end of file
+std::atomic<long long> allocations_count(0);
+
+struct Options
+{
+	std::vector<String> scenes;
+	std::vector<String> renderers;
+	std::vector<String> sizes;
+	std::vector<String> threads;
+	int repeat;
+	String references;
+	bool write_references;
+	String output;
+
+	Options(): repeat(3), write_references(false) { }
+};
+
+struct WorkerOptions
+{
+	String scene;
+	String renderer;
+	int width;
+	int height;
+	int repeat;
+	String references;
+	bool write_references;
+
+	WorkerOptions(): width(), height(), repeat(1), write_references(false) { }
+};
+
+/* === P R O C E D U R E S ================================================= */
+
+std::vector<String>
+split(const String &str, char separator = ',')
+{
+	std::vector<String> list;
+	std::stringstream stream(str);
+	String item;
+	while(std::getline(stream, item, separator))
+		if (!item.empty())
+			list.push_back(item);
+	return list;
+}
+
+bool
+parse_size(const String &str, int &width, int &height)
+{
+	return sscanf(str.c_str(), "%dx%d", &width, &height) == 2
+		&& width > 0 && height > 0;
+}
+
+String
+json_string(const String &str)
+{
+	String result = "\"";
+	for(String::const_iterator i = str.begin(); i != str.end(); ++i) {
+		switch(*i) {
+		case '"':  result += "\\\""; break;
+		case '\\': result += "\\\\"; break;
+		case '\n': result += "\\n";  break;
+		case '\r': result += "\\r";  break;
+		case '\t': result += "\\t";  break;
+		default:
+			if ((unsigned char)*i < 0x20)
+				result += etl::strprintf("\\u%04x", (int)(unsigned char)*i);
+			else
+				result += *i;
+		}
+	}
+	return result + "\"";
+}
+
+String
+scene_name(const String &scene)
+{
+	if (scene.compare(0, strlen(BUILTIN_PREFIX), BUILTIN_PREFIX) == 0)
+		return scene.substr(strlen(BUILTIN_PREFIX));
+	return etl::filename_sans_extension(etl::basename(scene));
+}
+
+//! returns peak resident set size of current process in bytes, or -1 if unknown
+long long
+get_peak_memory()
+{
+#ifdef _WIN32
+	return -1;
+#else
+	rusage usage;
+	if (getrusage(RUSAGE_SELF, &usage))
+		return -1;
+#ifdef __APPLE__
+	return (long long)usage.ru_maxrss;
+#else
+	return (long long)usage.ru_maxrss*1024;
+#endif
+#endif
+}
+
+/* === R E F E R E N C E S ================================================= */
+
+void
+to_rgba8(const Surface &surface, std::vector<unsigned char> &pixels)
+{
+	pixels.resize(4*surface.get_w()*surface.get_h());
+	unsigned char *p = pixels.empty() ? NULL : &pixels.front();
+	for(int y = 0; y < surface.get_h(); ++y) {
+		const Color *c = surface[y];
+		for(int x = 0; x < surface.get_w(); ++x, ++c, p += 4) {
+			p[0] = (unsigned char)std::round(255.f*clamp(c->get_r(), 0.f, 1.f));
+			p[1] = (unsigned char)std::round(255.f*clamp(c->get_g(), 0.f, 1.f));
+			p[2] = (unsigned char)std::round(255.f*clamp(c->get_b(), 0.f, 1.f));
+			p[3] = (unsigned char)std::round(255.f*clamp(c->get_a(), 0.f, 1.f));
+		}
+	}
+}
+
+bool
+write_pam(const String &filename, int width, int height, const std::vector<unsigned char> &pixels)
+{
+	std::ofstream f(filename.c_str(), std::ios::binary);
+	if (!f) return false;
+	f << "P7\n"
+	  << "WIDTH " << width << "\n"
+	  << "HEIGHT " << height << "\n"
+	  << "DEPTH 4\n"
+	  << "MAXVAL 255\n"
+	  << "TUPLTYPE RGB_ALPHA\n"
+	  << "ENDHDR\n";
+	f.write((const char*)&pixels.front(), pixels.size());
+	return (bool)f;
+}
+
+bool
+read_pam(const String &filename, int &width, int &height, std::vector<unsigned char> &pixels)
+{
+	std::ifstream f(filename.c_str(), std::ios::binary);
+	if (!f) return false;
+
+	String line;
+	if (!std::getline(f, line) || line != "P7")
+		return false;
+
+	int depth = 0, maxval = 0;
+	width = height = 0;
+	while(std::getline(f, line) && line != "ENDHDR") {
+		std::stringstream stream(line);
+		String key;
+		stream >> key;
+		if (key == "WIDTH")  stream >> width;  else
+		if (key == "HEIGHT") stream >> height; else
+		if (key == "DEPTH")  stream >> depth;  else
+		if (key == "MAXVAL") stream >> maxval;
+	}
+	if (line != "ENDHDR" || width <= 0 || height <= 0 || depth != 4 || maxval != 255)
+		return false;
+
+	pixels.resize(4*width*height);
+	f.read((char*)&pixels.front(), pixels.size());
+	return f.gcount() == (std::streamsize)pixels.size();
+}
+
+/* === S C E N E S ========================================================= */
+
+Layer::Handle
+create_layer(const Canvas::Handle &canvas, const String &name)
+{
+	Layer::Handle layer = Layer::create(name);
+	if (!layer)
+		throw std::runtime_error(etl::strprintf("layer '%s' is not available", name.c_str()));
+	layer->set_canvas(canvas);
+	canvas->push_back(layer);
+	return layer;
+}
+
+Matrix
+bone_matrix(const Point &origin, Real angle)
+	{ return Matrix().set_translate(origin)*Matrix().set_rotate(Angle::rad(angle)); }
+
+Bone
+create_bone(const Point &origin, Real angle, Real length, Real width)
+{
+	Bone bone;
+	bone.set_origin(origin);
+	bone.set_angle(Angle::rad(angle));
+	bone.set_length(length);
+	bone.set_width(width);
+	bone.set_tipwidth(width);
+	bone.set_animated_matrix(bone_matrix(origin, angle));
+	return bone;
+}
+
+//! Skeleton deformation of shapes by a fan of bones.
+//! Static bones can not be stored in the file, so this scene is built here.
+Canvas::Handle
+create_skeleton_scene()
+{
+	Canvas::Handle canvas = Canvas::create();
+
+	RendDesc &desc = canvas->rend_desc();
+	desc.set_wh(480, 270);
+	desc.set_tl_br(Point(-8.0, 4.5), Point(8.0, -4.5));
+	desc.set_time_start(Time(0));
+	desc.set_time_end(Time(0));
+
+	typedef std::pair<Bone, Bone> BonePair;
+	std::vector<ValueBase> bones;
+	const int bones_count = 12;
+	for(int i = 0; i < bones_count; ++i) {
+		Real angle = 2.0*PI*i/bones_count;
+		Bone base = create_bone(Point(), angle, 3.5, 1.0);
+		Bone animated = base;
+		animated.set_animated_matrix(bone_matrix(Point(), angle + 0.3*sin(3.0*angle)));
+		bones.push_back(ValueBase(BonePair(base, animated)));
+	}
+
+	Layer::Handle skeleton = create_layer(canvas, "skeleton_deformation");
+	skeleton->set_param("bones", ValueBase(bones));
+	skeleton->set_param("point1", ValueBase(Point(-6.0, 4.5)));
+	skeleton->set_param("point2", ValueBase(Point(6.0, -4.5)));
+	skeleton->set_param("x_subdivisions", ValueBase(64));
+	skeleton->set_param("y_subdivisions", ValueBase(64));
+
+	for(int i = 0; i < 24; ++i) {
+		Real angle = 2.0*PI*i/24;
+		Layer::Handle circle = create_layer(canvas, "circle");
+		circle->set_param("color", ValueBase(Color(0.5 + 0.5*cos(angle), 0.5 + 0.5*sin(angle), 0.5, 1.0)));
+		circle->set_param("radius", ValueBase(Real(0.6)));
+		circle->set_param("origin", ValueBase(Point(3.0*cos(angle), 3.0*sin(angle))));
+	}
+
+	Layer::Handle rectangle = create_layer(canvas, "rectangle");
+	rectangle->set_param("color", ValueBase(Color(0.2, 0.3, 0.8, 1.0)));
+	rectangle->set_param("point1", ValueBase(Point(-4.0, 0.5)));
+	rectangle->set_param("point2", ValueBase(Point(4.0, -0.5)));
+
+	return canvas;
+}
+
+//! Layers with parameters converted into graphs of value nodes,
+//! which are linked to a few shared animated nodes, like in rigged characters.
+Canvas::Handle
+create_valuenodes_scene()
+{
+	Canvas::Handle canvas = Canvas::create();
+
+	RendDesc &desc = canvas->rend_desc();
+	desc.set_wh(480, 270);
+	desc.set_tl_br(Point(-8.0, 4.5), Point(8.0, -4.5));
+	desc.set_time_start(Time(0.5));
+	desc.set_time_end(Time(0.5));
+
+	ValueNode_Animated::Handle angle = ValueNode_Animated::create(type_angle);
+	angle->new_waypoint(Time(0), ValueBase(Angle::deg(0)));
+	angle->new_waypoint(Time(2), ValueBase(Angle::deg(360)));
+
+	ValueNode_Animated::Handle center = ValueNode_Animated::create(type_vector);
+	center->new_waypoint(Time(0), ValueBase(Vector(-2.0, 0.0)));
+	center->new_waypoint(Time(2), ValueBase(Vector(2.0, 0.0)));
+
+	for(int i = 0; i < 400; ++i) {
+		// origin = center + radius*(cos(angle + phase), sin(angle + phase))
+		ValueNode_Add::Handle phase = ValueNode_Add::create(ValueBase(Angle::deg(0)));
+		phase->set_link("lhs", angle);
+		phase->set_link("rhs", ValueNode_Const::create(Angle::deg(i*7.0)));
+
+		ValueNode_Add::Handle phase_sin = ValueNode_Add::create(ValueBase(Angle::deg(0)));
+		phase_sin->set_link("lhs", phase);
+		phase_sin->set_link("rhs", ValueNode_Const::create(Angle::deg(-90.0)));
+
+		Real radius = 1.0 + 3.0*i/400;
+		ValueNode_Cos::Handle x = ValueNode_Cos::create(ValueBase(radius));
+		x->set_link("angle", phase);
+		ValueNode_Cos::Handle y = ValueNode_Cos::create(ValueBase(radius));
+		y->set_link("angle", phase_sin);
+
+		ValueNode_Composite::Handle offset = ValueNode_Composite::create(ValueBase(Vector()));
+		offset->set_link(0, x);
+		offset->set_link(1, y);
+
+		ValueNode_Add::Handle origin = ValueNode_Add::create(ValueBase(Vector()));
+		origin->set_link("lhs", center);
+		origin->set_link("rhs", offset);
+
+		// size = 0.15*(1.25 + cos(angle + phase)/4)
+		ValueNode_Cos::Handle pulse = ValueNode_Cos::create(ValueBase(Real(0.25)));
+		pulse->set_link("angle", phase);
+		ValueNode_Add::Handle scalar = ValueNode_Add::create(ValueBase(Real(1.0)));
+		scalar->set_link("rhs", pulse);
+		ValueNode_Scale::Handle size = ValueNode_Scale::create(ValueBase(Real(0.15)));
+		size->set_link("scalar", scalar);
+
+		Layer::Handle circle = create_layer(canvas, "circle");
+		circle->set_param("color", ValueBase(Color(0.5 + 0.5*cos(i*0.1), 0.5 + 0.5*sin(i*0.1), 0.5, 1.0)));
+		circle->connect_dynamic_param("origin", ValueNode::LooseHandle(origin));
+		circle->connect_dynamic_param("radius", ValueNode::LooseHandle(size));
+	}
+
+	return canvas;
+}
+
+Canvas::Handle
+load_scene(const String &scene)
+{
+	if (scene == BUILTIN_PREFIX "skeleton")
+		return create_skeleton_scene();
+	if (scene == BUILTIN_PREFIX "valuenodes")
+		return create_valuenodes_scene();
+
+	FileSystem::Handle file_system = CanvasFileNaming::make_filesystem(scene);
+	if (!file_system)
+		throw std::runtime_error(etl::strprintf("unable to open container '%s'", scene.c_str()));
+	FileSystem::Identifier identifier = file_system->get_identifier(CanvasFileNaming::project_file(scene));
+
+	String errors, warnings;
+	Canvas::Handle canvas = open_canvas_as(identifier, scene, errors, warnings);
+	if (!canvas)
+		throw std::runtime_error(etl::strprintf("unable to load '%s': %s", scene.c_str(), errors.c_str()));
+	return canvas;
+}
+
+void
+add_scenes(std::vector<String> &scenes, const String &path)
+{
+	if (!Glib::file_test(path, Glib::FILE_TEST_IS_DIR)) {
+		scenes.push_back(path);
+		return;
+	}
+
+	std::vector<String> files;
+	Glib::Dir dir(path);
+	for(Glib::DirIterator i = dir.begin(); i != dir.end(); ++i) {
+		String extension = etl::filename_extension(*i);
+		if (extension == ".sif" || extension == ".sifz" || extension == ".sfg")
+			files.push_back(Glib::build_filename(path, *i));
+	}
+	std::sort(files.begin(), files.end());
+	scenes.insert(scenes.end(), files.begin(), files.end());
+}
+
+/* === W O R K E R ========================================================= */
+
+int
+run_worker(const WorkerOptions &options)
+{
+	Canvas::Handle canvas = load_scene(options.scene);
+
+	RendDesc desc = canvas->rend_desc();
+	desc.set_wh(options.width, options.height);
+	desc.set_time(desc.get_time_start());
+
+	rendering::RenderQueue *queue = rendering::Renderer::get_queue();
+	if (queue) queue->set_task_statistics_enabled(true);
+
+	// evaluation of parameters without rendering
+	const int set_time_repeat = 10;
+	canvas->get_independent_context().set_time(desc.get_time_start());
+	long long set_time_allocations = allocations_count;
+	for(int i = 0; i < set_time_repeat; ++i)
+		canvas->get_independent_context().set_time(desc.get_time_start());
+	set_time_allocations = (allocations_count - set_time_allocations)/set_time_repeat;
+
+	Surface surface;
+	std::vector<long long> times;
+	long long allocations = 0;
+	for(int i = 0; i <= std::max(1, options.repeat); ++i) {
+		// first run is a warm-up and is not timed,
+		// statistics are collected for the last run only
+		if (queue) queue->reset_statistics();
+		allocations = allocations_count;
+
+		surface = Surface();
+		Target_Tile::Handle target = surface_target(&surface, options.renderer);
+		target->set_canvas(canvas);
+		target->set_rend_desc(&desc);
+		target->set_quality(DEFAULT_QUALITY);
+
+		long long begin = g_get_monotonic_time();
+		if (!target->render())
+			throw std::runtime_error("rendering failed");
+		if (i > 0)
+			times.push_back(g_get_monotonic_time() - begin);
+		allocations = allocations_count - allocations;
+	}
+	std::sort(times.begin(), times.end());
+
+	std::vector<unsigned char> pixels;
+	to_rgba8(surface, pixels);
+
+	String reference_status = "none";
+	int max_diff = 0;
+	double mean_diff = 0.0;
+	long long changed_pixels = 0;
+	if (!options.references.empty()) {
+		String filename = Glib::build_filename(
+			options.references,
+			etl::strprintf( "%s-%s-%dx%d.pam",
+							scene_name(options.scene).c_str(),
+							options.renderer.c_str(),
+							surface.get_w(), surface.get_h() ));
+		std::vector<unsigned char> reference;
+		int width = 0, height = 0;
+		if (options.write_references) {
+			reference_status = write_pam(filename, surface.get_w(), surface.get_h(), pixels)
+				             ? "written" : "write-failed";
+		} else
+		if (!read_pam(filename, width, height, reference)) {
+			reference_status = "missing";
+		} else
+		if (width != surface.get_w() || height != surface.get_h()) {
+			reference_status = "size-mismatch";
+		} else {
+			reference_status = "compared";
+			long long sum = 0;
+			for(size_t i = 0; i < pixels.size(); i += 4) {
+				int pixel_diff = 0;
+				for(int j = 0; j < 4; ++j)
+					pixel_diff = std::max(pixel_diff, std::abs((int)pixels[i + j] - (int)reference[i + j]));
+				max_diff = std::max(max_diff, pixel_diff);
+				sum += pixel_diff;
+				if (pixel_diff >= changed_pixel_threshold) ++changed_pixels;
+			}
+			mean_diff = pixels.empty() ? 0.0 : (double)sum/(double)(pixels.size()/4);
+		}
+	}
+
+	std::stringstream json;
+	json << "{"
+	     << "\"scene\": " << json_string(scene_name(options.scene)) << ", "
+	     << "\"renderer\": " << json_string(options.renderer) << ", "
+	     << "\"width\": " << surface.get_w() << ", "
+	     << "\"height\": " << surface.get_h() << ", "
+	     << "\"threads\": " << (queue ? queue->get_threads_count() : ThreadPool::instance.get_max_threads()) << ", "
+	     << "\"runs\": " << times.size() << ", "
+	     << "\"time_min\": " << etl::strprintf("%.6f", (double)times.front()*1e-6) << ", "
+	     << "\"time_median\": " << etl::strprintf("%.6f", (double)times[times.size()/2]*1e-6) << ", "
+	     << "\"peak_memory\": " << get_peak_memory() << ", "
+	     << "\"allocations\": " << allocations << ", "
+	     << "\"set_time_allocations\": " << set_time_allocations << ", "
+	     << "\"tasks\": {";
+	if (queue) {
+		rendering::RenderQueue::TaskStatisticsMap tasks = queue->get_task_statistics();
+		for(rendering::RenderQueue::TaskStatisticsMap::const_iterator i = tasks.begin(); i != tasks.end(); ++i)
+			json << (i == tasks.begin() ? "" : ", ")
+			     << json_string(i->first) << ": {"
+			     << "\"count\": " << i->second.count << ", "
+			     << "\"time\": " << etl::strprintf("%.6f", (double)i->second.time*1e-6) << "}";
+	}
+	json << "}, "
+	     << "\"reference\": " << json_string(reference_status) << ", "
+	     << "\"max_diff\": " << max_diff << ", "
+	     << "\"mean_diff\": " << etl::strprintf("%.4f", mean_diff) << ", "
+	     << "\"changed_pixels\": " << changed_pixels
+	     << "}";
+
+	std::cout << std::endl << RESULT_PREFIX << json.str() << std::endl;
+	return 0;
+}
+
+/* === M A S T E R ========================================================= */
+
+String
+run_configuration(
+	const String &binary,
+	const Options &options,
+	const String &scene,
+	const String &renderer,
+	const String &size,
+	const String &threads )
+{
+	std::vector<String> argv;
+	argv.push_back(binary);
+	argv.push_back("--worker");
+	argv.push_back("--scene");    argv.push_back(scene);
+	argv.push_back("--renderer"); argv.push_back(renderer);
+	argv.push_back("--size");     argv.push_back(size);
+	argv.push_back("--repeat");   argv.push_back(etl::strprintf("%d", options.repeat));
+	if (!options.references.empty()) {
+		argv.push_back("--references");
+		argv.push_back(options.references);
+		if (options.write_references)
+			argv.push_back("--write-references");
+	}
+
+	String threads_count = threads == "max"
+		                 ? etl::strprintf("%d", (int)g_get_num_processors())
+		                 : threads;
+	Glib::setenv("SYNFIG_RENDERING_THREADS", threads_count, true);
+
+	String error;
+	std::string standard_output, standard_error;
+	int exit_status = 0;
+	try {
+		Glib::spawn_sync( String(), argv, Glib::SPAWN_DEFAULT, Glib::SlotSpawnChildSetup(),
+		                  &standard_output, &standard_error, &exit_status );
+	} catch(const Glib::Error &e) {
+		error = e.what();
+	}
+
+	if (error.empty()) {
+		std::stringstream stream(standard_output);
+		String line;
+		while(std::getline(stream, line))
+			if (line.compare(0, strlen(RESULT_PREFIX), RESULT_PREFIX) == 0)
+				return line.substr(strlen(RESULT_PREFIX));
+
+		std::vector<String> lines = split(standard_error, '\n');
+		error = lines.empty() ? etl::strprintf("worker failed with status %d", exit_status) : lines.back();
+	}
+
+	return String("{")
+		 + "\"scene\": " + json_string(scene_name(scene)) + ", "
+		 + "\"renderer\": " + json_string(renderer) + ", "
+		 + "\"size\": " + json_string(size) + ", "
+		 + "\"threads\": " + threads_count + ", "
+		 + "\"error\": " + json_string(error)
+		 + "}";
+}
+
+int
+run_master(const String &binary, const Options &options)
+{
+	std::vector<String> results;
+	for(std::vector<String>::const_iterator scene = options.scenes.begin(); scene != options.scenes.end(); ++scene)
+	for(std::vector<String>::const_iterator renderer = options.renderers.begin(); renderer != options.renderers.end(); ++renderer)
+	for(std::vector<String>::const_iterator size = options.sizes.begin(); size != options.sizes.end(); ++size)
+	for(std::vector<String>::const_iterator threads = options.threads.begin(); threads != options.threads.end(); ++threads) {
+		std::cerr << scene_name(*scene) << " " << *renderer << " " << *size << " threads " << *threads << std::endl;
+		results.push_back(run_configuration(binary, options, *scene, *renderer, *size, *threads));
+	}
+
+	std::stringstream report;
+	report << "{" << std::endl
+	       << "\t\"version\": " << json_string(SYNFIG_VERSION) << "," << std::endl
+	       << "\t\"processors\": " << g_get_num_processors() << "," << std::endl
+	       << "\t\"repeat\": " << options.repeat << "," << std::endl
+	       << "\t\"results\": [" << std::endl;
+	for(std::vector<String>::const_iterator i = results.begin(); i != results.end(); ++i)
+		report << "\t\t" << *i << (i + 1 == results.end() ? "" : ",") << std::endl;
+	report << "\t]" << std::endl
+	       << "}" << std::endl;
+
+	if (options.output.empty() || options.output == "-") {
+		std::cout << report.str();
+	} else {
+		std::ofstream f(options.output.c_str());
+		f << report.str();
+		if (!f) {
+			std::cerr << "unable to write report to " << options.output << std::endl;
+			return 1;
+		}
+	}
+	return 0;
+}
+
+void
+print_usage(const char *name)
+{
+	std::cerr
+		<< "Usage: " << name << " [options] [scene or directory ...]" << std::endl
+		<< std::endl
+		<< "Renders every scene with every renderer, size and thread count and writes a JSON report." << std::endl
+		<< "Without scenes the directory from SYNFIG_BENCH_CORPUS is used, built-in scene" << std::endl
+		<< "'" BUILTIN_PREFIX "skeleton' and '" BUILTIN_PREFIX "valuenodes' are always appended." << std::endl
+		<< std::endl
+		<< "  --renderers LIST      renderers separated by comma or 'all' (" DEFAULT_RENDERERS ")" << std::endl
+		<< "  --sizes LIST          frame sizes WxH separated by comma (" DEFAULT_SIZES ")" << std::endl
+		<< "  --threads LIST        thread counts or 'max' separated by comma (" DEFAULT_THREADS ")" << std::endl
+		<< "  --repeat N            timed renderings per configuration (3)" << std::endl
+		<< "                        one more untimed rendering warms up caches" << std::endl
+		<< "  --references DIR      compare results with reference images from DIR" << std::endl
+		<< "  --write-references    write reference images into DIR instead of comparing" << std::endl
+		<< "  --output FILE         write report to FILE instead of standard output" << std::endl;
+}
+
+} // end of anonimous namespace
+
+/* === A L L O C A T I O N S =============================================== */
+
+void*
+operator new(std::size_t size)
+{
+	++allocations_count;
+	if (void *p = std::malloc(size ? size : 1))
+		return p;
+	throw std::bad_alloc();
+}
+
+void*
+operator new[](std::size_t size)
+	{ return operator new(size); }
+
+void
+operator delete(void *p) noexcept
+	{ std::free(p); }
+
+void
+operator delete[](void *p) noexcept
+	{ std::free(p); }
+
+/* === E N T R Y P O I N T ================================================= */
+
+int main(int argc, char* argv[])
+{
+	setlocale(LC_ALL, "");
+	Glib::init();
+	Gio::init();
+
+	String binary = synfig::get_binary_path(argv[0]);
+
+	bool worker = false;
+	Options options;
+	WorkerOptions worker_options;
+	String renderers = DEFAULT_RENDERERS;
+	String sizes = DEFAULT_SIZES;
+	String threads = DEFAULT_THREADS;
+
+	for(int i = 1; i < argc; ++i) {
+		String arg = argv[i];
+		bool has_value = i + 1 < argc;
+		if (arg == "--help" || arg == "-h")
+			{ print_usage(argv[0]); return 0; }
+		else if (arg == "--worker")
+			worker = true;
+		else if (arg == "--write-references")
+			options.write_references = worker_options.write_references = true;
+		else if (arg == "--renderers" && has_value)
+			renderers = argv[++i];
+		else if (arg == "--sizes" && has_value)
+			sizes = argv[++i];
+		else if (arg == "--threads" && has_value)
+			threads = argv[++i];
+		else if (arg == "--repeat" && has_value)
+			options.repeat = worker_options.repeat = std::max(1, atoi(argv[++i]));
+		else if (arg == "--references" && has_value)
+			options.references = worker_options.references = argv[++i];
+		else if (arg == "--output" && has_value)
+			options.output = argv[++i];
+		else if (arg == "--scene" && has_value)
+			worker_options.scene = argv[++i];
+		else if (arg == "--renderer" && has_value)
+			worker_options.renderer = argv[++i];
+		else if (arg == "--size" && has_value) {
+			if (!parse_size(argv[++i], worker_options.width, worker_options.height))
+				{ std::cerr << "invalid size: " << argv[i] << std::endl; return 1; }
+		} else
+		if (arg.compare(0, 2, "--") == 0)
+			{ std::cerr << "unknown option: " << arg << std::endl; print_usage(argv[0]); return 1; }
+		else
+			add_scenes(options.scenes, arg);
+	}
+
+	try {
+		if (worker) {
+			synfig::synfig_quiet_mode = true;
+			Main synfig_main(Gio::File::create_for_path(binary + "/..")->get_path());
+			return run_worker(worker_options);
+		}
+
+		if (options.scenes.empty())
+			if (const char *corpus = getenv("SYNFIG_BENCH_CORPUS"))
+				add_scenes(options.scenes, corpus);
+		options.scenes.push_back(BUILTIN_PREFIX "skeleton");
+		options.scenes.push_back(BUILTIN_PREFIX "valuenodes");
+
+		options.sizes = split(sizes);
+		for(std::vector<String>::const_iterator i = options.sizes.begin(); i != options.sizes.end(); ++i) {
+			int width, height;
+			if (!parse_size(*i, width, height))
+				{ std::cerr << "invalid size: " << *i << std::endl; return 1; }
+		}
+		options.threads = split(threads);
+
+		if (renderers == "all") {
+			Main synfig_main(Gio::File::create_for_path(binary + "/..")->get_path());
+			typedef std::map<String, rendering::Renderer::Handle> RendererMap;
+			const RendererMap &map = rendering::Renderer::get_renderers();
+			for(RendererMap::const_iterator i = map.begin(); i != map.end(); ++i)
+				options.renderers.push_back(i->first);
+		} else {
+			options.renderers = split(renderers);
+		}
+
+		if (!options.write_references && !options.references.empty()
+		 && !Glib::file_test(options.references, Glib::FILE_TEST_IS_DIR))
+			{ std::cerr << "references directory not found: " << options.references << std::endl; return 1; }
+		if (options.write_references && options.references.empty())
+			{ std::cerr << "--write-references requires --references" << std::endl; return 1; }
+
+		return run_master(binary, options);
+	} catch(const std::exception &e) {
+		std::cerr << "error: " << e.what() << std::endl;
+	} catch(const Glib::Exception &e) {
+		std::cerr << "error: " << e.what() << std::endl;
+	} catch(...) {
+		std::cerr << "error: unknown exception" << std::endl;
+	}
+	return 1;
+}
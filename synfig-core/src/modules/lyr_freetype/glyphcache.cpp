@@ -0,0 +1,269 @@
+/* === S Y N F I G ========================================================= */
+/*!	\file glyphcache.cpp
+**	\brief Implementation of the cache of glyphs of the "Text" layer
+**
+**	$Id$
+**
+**	\legal
+**	Copyright (c) 2019 Synfig Contributors
+**
+**	This package is free software; you can redistribute it and/or
+**	modify it under the terms of the GNU General Public License as
+**	published by the Free Software Foundation; either version 2 of
+**	the License, or (at your option) any later version.
+**
+**	This package is distributed in the hope that it will be useful,
+**	but WITHOUT ANY WARRANTY; without even the implied warranty of
+**	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+**	General Public License for more details.
+**	\endlegal
+**
+** === N O T E S ===========================================================
+**
+** ========================================================================= */
+
+/* === H E A D E R S ======================================================= */
+
+#ifdef USING_PCH
+#	include "pch.h"
+#else
+#ifdef HAVE_CONFIG_H
+#	include <config.h>
+#endif
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+
+#include <synfig/general.h>
+
+#include "glyphcache.h"
+
+#include FT_OUTLINE_H
+
+#endif
+
+using namespace synfig;
+
+/* === M A C R O S ========================================================= */
+
+/* === G L O B A L S ======================================================= */
+
+/* === P R O C E D U R E S ================================================= */
+
+namespace {
+	Vector to_vector(const FT_Vector *v)
+		{ return Vector((Real)v->x, (Real)v->y); }
+
+	int decompose_move_to(const FT_Vector *to, void *user)
+		{ ((rendering::Contour*)user)->move_to(to_vector(to)); return 0; }
+	int decompose_line_to(const FT_Vector *to, void *user)
+		{ ((rendering::Contour*)user)->line_to(to_vector(to)); return 0; }
+	int decompose_conic_to(const FT_Vector *control, const FT_Vector *to, void *user)
+		{ ((rendering::Contour*)user)->conic_to(to_vector(to), to_vector(control)); return 0; }
+	int decompose_cubic_to(const FT_Vector *control1, const FT_Vector *control2, const FT_Vector *to, void *user)
+		{ ((rendering::Contour*)user)->cubic_to(to_vector(to), to_vector(control1), to_vector(control2)); return 0; }
+
+	void decompose(const FT_Outline &outline, rendering::Contour::ChunkList &out_chunks)
+	{
+		FT_Outline_Funcs funcs;
+		funcs.move_to = &decompose_move_to;
+		funcs.line_to = &decompose_line_to;
+		funcs.conic_to = &decompose_conic_to;
+		funcs.cubic_to = &decompose_cubic_to;
+		funcs.shift = 0;
+		funcs.delta = 0;
+
+		rendering::Contour contour;
+		if (FT_Outline_Decompose(const_cast<FT_Outline*>(&outline), &funcs, &contour))
+			return;
+		contour.close();
+		out_chunks = contour.get_chunks();
+	}
+
+	size_t get_default_cache_size() {
+		if (const char *s = getenv("SYNFIG_TEXT_GLYPH_CACHE_SIZE"))
+			return std::max(0, atoi(s))*(size_t)1024*(size_t)1024;
+		return 32*(size_t)1024*(size_t)1024;
+	}
+}
+
+/* === M E T H O D S ======================================================= */
+
+GlyphCache::Glyph::Glyph():
+	outline(),
+	mask_left(),
+	mask_top(),
+	mask_width(),
+	mask_height()
+{
+	advance.x = advance.y = 0;
+	bbox.xMin = bbox.yMin = bbox.xMax = bbox.yMax = 0;
+}
+
+GlyphCache::Glyph::~Glyph()
+	{ if (outline) FT_Done_Glyph(outline); }
+
+size_t
+GlyphCache::Glyph::get_memory_size() const
+{
+	size_t s = sizeof(*this) + mask.size() + chunks.size()*sizeof(chunks.front());
+	if (outline && outline->format == FT_GLYPH_FORMAT_OUTLINE) {
+		const FT_Outline &o = ((FT_OutlineGlyph)outline)->outline;
+		s += sizeof(FT_OutlineGlyphRec)
+		   + o.n_points*(sizeof(*o.points) + sizeof(*o.tags))
+		   + o.n_contours*sizeof(*o.contours);
+	}
+	return s;
+}
+
+GlyphCache::GlyphCache(size_t max_size):
+	max_size(max_size),
+	size()
+{ }
+
+GlyphCache::~GlyphCache()
+	{ clear(); }
+
+GlyphCache&
+GlyphCache::instance()
+{
+	static GlyphCache cache(get_default_cache_size());
+	return cache;
+}
+
+void
+GlyphCache::remove_entry(EntryList::iterator i)
+{
+	// mutex must be already locked
+	size -= i->size;
+	entries_map.erase(i->key);
+	entries.erase(i);
+}
+
+void
+GlyphCache::shrink(size_t max_size)
+{
+	// mutex must be already locked
+	while(size > max_size && !entries.empty()) {
+		remove_entry(--entries.end());
+		++statistics.evictions;
+	}
+}
+
+size_t
+GlyphCache::get_size() const
+	{ Glib::Threads::Mutex::Lock lock(mutex); return size; }
+
+size_t
+GlyphCache::get_max_size() const
+	{ Glib::Threads::Mutex::Lock lock(mutex); return max_size; }
+
+void
+GlyphCache::set_max_size(size_t max_size)
+{
+	Glib::Threads::Mutex::Lock lock(mutex);
+	this->max_size = max_size;
+	shrink(max_size);
+}
+
+GlyphCache::Glyph::Handle
+GlyphCache::load(FT_Face face, const Key &key)
+{
+	if (FT_Load_Glyph(face, key.glyph_index, key.load_flags))
+		return Glyph::Handle();
+
+	Glyph::Handle glyph(new Glyph());
+	if (FT_Get_Glyph(face->glyph, &glyph->outline))
+		{ glyph->outline = 0; return Glyph::Handle(); }
+	glyph->advance = face->glyph->advance;
+	FT_Glyph_Get_CBox(glyph->outline, ft_glyph_bbox_subpixels, &glyph->bbox);
+
+	if (glyph->outline->format == FT_GLYPH_FORMAT_OUTLINE)
+		decompose(((FT_OutlineGlyph)glyph->outline)->outline, glyph->chunks);
+
+	// unscaled outline is measured in font units, not in pixels
+	if (key.load_flags & FT_LOAD_NO_SCALE)
+		return glyph;
+
+	// render the mask, outline stays untouched
+	FT_Glyph image = glyph->outline;
+	if (!FT_Glyph_To_Bitmap(&image, ft_render_mode_normal, 0, 0)) {
+		const FT_BitmapGlyph bit = (FT_BitmapGlyph)image;
+		glyph->mask_left = bit->left;
+		glyph->mask_top = bit->top;
+		glyph->mask_width = (int)bit->bitmap.width;
+		glyph->mask_height = (int)bit->bitmap.rows;
+		glyph->mask.resize(glyph->mask_width*glyph->mask_height);
+		for(int v = 0; v < glyph->mask_height; ++v)
+			if (glyph->mask_width) memcpy(
+				&glyph->mask[v*glyph->mask_width],
+				bit->bitmap.buffer + v*bit->bitmap.pitch,
+				glyph->mask_width );
+		if (image != glyph->outline)
+			FT_Done_Glyph(image);
+	}
+
+	return glyph;
+}
+
+GlyphCache::Glyph::Handle
+GlyphCache::get(FT_Face face, const Key &key)
+{
+	{
+		Glib::Threads::Mutex::Lock lock(mutex);
+		EntryMap::iterator i = entries_map.find(key);
+		if (i != entries_map.end()) {
+			entries.splice(entries.begin(), entries, i->second);
+			++statistics.hits;
+			return i->second->glyph;
+		}
+		++statistics.misses;
+	}
+
+	// load outside of lock, FreeType may take a while
+	Glyph::Handle glyph = load(face, key);
+	if (!glyph)
+		return glyph;
+	size_t glyph_size = glyph->get_memory_size();
+
+	Glib::Threads::Mutex::Lock lock(mutex);
+	EntryMap::iterator i = entries_map.find(key);
+	if (i != entries_map.end()) {
+		// loaded by other thread at the same time
+		entries.splice(entries.begin(), entries, i->second);
+		return i->second->glyph;
+	}
+	if (glyph_size > max_size)
+		return glyph;
+
+	shrink(max_size - glyph_size);
+	entries.push_front(Entry(key, glyph, glyph_size));
+	entries_map[key] = entries.begin();
+	size += glyph_size;
+	return glyph;
+}
+
+void
+GlyphCache::clear()
+{
+	Glib::Threads::Mutex::Lock lock(mutex);
+	entries_map.clear();
+	entries.clear();
+	size = 0;
+}
+
+GlyphCache::Statistics
+GlyphCache::get_statistics() const
+	{ Glib::Threads::Mutex::Lock lock(mutex); return statistics; }
+
+void
+GlyphCache::log_statistics() const
+{
+	Statistics s = get_statistics();
+	info( "glyph cache: hits %lld, misses %lld, evictions %lld, size %.1fMb",
+		  s.hits, s.misses, s.evictions,
+		  (double)get_size()/(1024.0*1024.0) );
+}
+
+/* === E N T R Y P O I N T ================================================= */
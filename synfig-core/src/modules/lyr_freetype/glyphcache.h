@@ -0,0 +1,178 @@
+/* === S Y N F I G ========================================================= */
+/*!	\file glyphcache.h
+**	\brief Header file for the cache of glyphs of the "Text" layer
+**
+**	$Id$
+**
+**	\legal
+**	Copyright (c) 2019 Synfig Contributors
+**
+**	This package is free software; you can redistribute it and/or
+**	modify it under the terms of the GNU General Public License as
+**	published by the Free Software Foundation; either version 2 of
+**	the License, or (at your option) any later version.
+**
+**	This package is distributed in the hope that it will be useful,
+**	but WITHOUT ANY WARRANTY; without even the implied warranty of
+**	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+**	General Public License for more details.
+**	\endlegal
+**
+** === N O T E S ===========================================================
+**
+** ========================================================================= */
+
+/* === S T A R T =========================================================== */
+
+#ifndef __SYNFIG_GLYPHCACHE_H
+#define __SYNFIG_GLYPHCACHE_H
+
+/* === H E A D E R S ======================================================= */
+
+#include <list>
+#include <map>
+#include <vector>
+
+#include <glibmm/threads.h>
+
+#include <ft2build.h>
+#include FT_FREETYPE_H
+#include FT_GLYPH_H
+
+#include <ETL/handle>
+
+#include <synfig/string.h>
+#include <synfig/rendering/primitive/contour.h>
+
+/* === M A C R O S ========================================================= */
+
+/* === T Y P E D E F S ===================================================== */
+
+/* === C L A S S E S & S T R U C T S ======================================= */
+
+//! Process-wide LRU storage of loaded glyphs shared by all text layers.
+//! Glyph is identified by font file, face index, size, load flags and glyph index,
+//! and keeps the outline, the advance, the outline decomposed to contour chunks
+//! and the coverage mask. Glyphs loaded with FT_LOAD_NO_SCALE have no mask.
+//! Glyphs are not changed after creation, all methods are thread-safe.
+class GlyphCache
+{
+public:
+	struct Key
+	{
+		synfig::String font_file;
+		long face_index;
+		//! horizontal and vertical size in 1/64th of pixel per EM, not used for FT_LOAD_NO_SCALE
+		long size_x;
+		long size_y;
+		int load_flags;
+		unsigned int glyph_index;
+
+		Key(): face_index(), size_x(), size_y(), load_flags(), glyph_index() { }
+
+		bool operator< (const Key &other) const
+		{
+			if (glyph_index != other.glyph_index) return glyph_index < other.glyph_index;
+			if (size_x != other.size_x) return size_x < other.size_x;
+			if (size_y != other.size_y) return size_y < other.size_y;
+			if (load_flags != other.load_flags) return load_flags < other.load_flags;
+			if (face_index != other.face_index) return face_index < other.face_index;
+			return font_file < other.font_file;
+		}
+	};
+
+	class Glyph: public etl::shared_object
+	{
+	public:
+		typedef etl::handle<Glyph> Handle;
+
+		//! outline of glyph in 1/64th of pixel (or in font units for FT_LOAD_NO_SCALE),
+		//! owned by this object
+		FT_Glyph outline;
+		FT_Vector advance;
+		//! control box of the outline in 1/64th of pixel
+		FT_BBox bbox;
+
+		//! closed contours of the outline, in the same units as the outline
+		synfig::rendering::Contour::ChunkList chunks;
+
+		//! coverage mask, rows are stored from top to bottom without padding
+		int mask_left;
+		int mask_top;
+		int mask_width;
+		int mask_height;
+		std::vector<unsigned char> mask;
+
+		Glyph();
+		~Glyph();
+
+		//! returns approximate count of bytes used by glyph
+		size_t get_memory_size() const;
+
+	private:
+		Glyph(const Glyph&);
+		Glyph& operator= (const Glyph&);
+	};
+
+	struct Statistics
+	{
+		long long hits;
+		long long misses;
+		long long evictions;
+		Statistics(): hits(), misses(), evictions() { }
+	};
+
+private:
+	struct Entry
+	{
+		Key key;
+		Glyph::Handle glyph;
+		size_t size;
+		Entry(): size() { }
+		Entry(const Key &key, const Glyph::Handle &glyph, size_t size):
+			key(key), glyph(glyph), size(size) { }
+	};
+
+	typedef std::list<Entry> EntryList;
+	typedef std::map<Key, EntryList::iterator> EntryMap;
+
+	mutable Glib::Threads::Mutex mutex;
+
+	size_t max_size;
+	size_t size;
+
+	//! stored glyphs, most recently used first
+	EntryList entries;
+	EntryMap entries_map;
+
+	Statistics statistics;
+
+	void remove_entry(EntryList::iterator i);
+	void shrink(size_t max_size);
+
+	static Glyph::Handle load(FT_Face face, const Key &key);
+
+public:
+	explicit GlyphCache(size_t max_size);
+	~GlyphCache();
+
+	//! the cache shared by all layers
+	static GlyphCache& instance();
+
+	size_t get_size() const;
+	size_t get_max_size() const;
+	void set_max_size(size_t max_size);
+
+	//! returns stored glyph or loads it from the face,
+	//! face should be already sized according to the key,
+	//! caller should prevent simultaneous access to the face from other threads
+	Glyph::Handle get(FT_Face face, const Key &key);
+	void clear();
+
+	Statistics get_statistics() const;
+	void log_statistics() const;
+};
+
+/* === E N D =============================================================== */
+
+#endif
@@ -49,6 +49,9 @@
 #include <synfig/canvasfilenaming.h>
 #include <synfig/cairo_renddesc.h>
 
+#include <synfig/rendering/common/task/taskcontour.h>
+#include <synfig/rendering/common/task/tasklayer.h>
+
 #endif
 
 using namespace std;
@@ -59,6 +62,8 @@ using namespace synfig;
 
 #define MAX_GLYPHS		2000
 
+#define CHAR_RESOLUTION		(64)
+
 #define PANGO_STYLE_NORMAL (0)
 #define PANGO_STYLE_OBLIQUE (1)
 #define PANGO_STYLE_ITALIC (2)
@@ -75,6 +80,9 @@ SYNFIG_LAYER_SET_CATEGORY(Layer_Freetype,N_("Other"));
 SYNFIG_LAYER_SET_VERSION(Layer_Freetype,"0.2");
 SYNFIG_LAYER_SET_CVS_ID(Layer_Freetype,"$Id$");
 
+//! guards faces of all layers, FreeType faces are not thread-safe
+static synfig::RecMutex freetype_mutex;
+
 /* === P R O C E D U R E S ================================================= */
 
 /*Glyph::~Glyph()
@@ -85,12 +93,7 @@ SYNFIG_LAYER_SET_CVS_ID(Layer_Freetype,"$Id$");
 void
 TextLine::clear_and_free()
 {
-	std::vector<Glyph>::iterator iter;
-	for(iter=glyph_table.begin();iter!=glyph_table.end();++iter)
-	{
-		if(iter->glyph)FT_Done_Glyph(iter->glyph);
-		iter->glyph=0;
-	}
+	// glyphs are owned by the glyph cache
 	glyph_table.clear();
 }
 
@@ -135,7 +138,10 @@ Layer_Freetype::Layer_Freetype()
 Layer_Freetype::~Layer_Freetype()
 {
 	if(face)
+	{
+		synfig::RecMutex::Lock lock(freetype_mutex);
 		FT_Done_Face(face);
+	}
 }
 
 void
@@ -357,6 +363,15 @@ void fss2path(char *path, FSSpec *fss)
 }
 #endif
 
+//! opens the face and remembers its file, the file identifies the face in the glyph cache
+static FT_Error
+open_face(const char *filename, FT_Long face_index, FT_Face *face, String &face_file)
+{
+	FT_Error error = FT_New_Face(ft_library, filename, face_index, face);
+	if (!error) face_file = filename;
+	return error;
+}
+
 bool
 Layer_Freetype::new_face(const String &newfont)
 {
@@ -368,19 +383,24 @@ Layer_Freetype::new_face(const String &newfont)
 	if(face && font==newfont)
 		return true;
 
+	// faces of layer snapshots may be opened concurrently,
+	// but FT_New_Face() and FT_Done_Face() are not thread-safe
+	synfig::RecMutex::Lock lock(freetype_mutex);
+
 	if(face)
 	{
 		FT_Done_Face(face);
 		face=0;
+		face_file.clear();
 	}
 
-	error=FT_New_Face(ft_library,newfont.c_str(),face_index,&face);
-	if(error)error=FT_New_Face(ft_library,(newfont+".ttf").c_str(),face_index,&face);
+	error=open_face(newfont.c_str(),face_index,&face,face_file);
+	if(error)error=open_face((newfont+".ttf").c_str(),face_index,&face,face_file);
 
 	if(get_canvas())
 	{
-		if(error)error=FT_New_Face(ft_library,(get_canvas()->get_file_path()+ETL_DIRECTORY_SEPARATOR+newfont).c_str(),face_index,&face);
-		if(error)error=FT_New_Face(ft_library,(get_canvas()->get_file_path()+ETL_DIRECTORY_SEPARATOR+newfont+".ttf").c_str(),face_index,&face);
+		if(error)error=open_face((get_canvas()->get_file_path()+ETL_DIRECTORY_SEPARATOR+newfont).c_str(),face_index,&face,face_file);
+		if(error)error=open_face((get_canvas()->get_file_path()+ETL_DIRECTORY_SEPARATOR+newfont+".ttf").c_str(),face_index,&face,face_file);
 	}
 
 #ifdef USE_MAC_FT_FUNCS
@@ -394,7 +414,7 @@ Layer_Freetype::new_face(const String &newfont)
 			fss2path(filename,&fs_spec);
 			//FSSpecToNativePathName(fs_spec,filename,sizeof(filename)-1, 0);
 
-			error=FT_New_Face(ft_library, filename, face_index,&face);
+			error=open_face(filename,face_index,&face,face_file);
 			//error=FT_New_Face_From_FSSpec(ft_library, &fs_spec, face_index,&face);
 			synfig::info(__FILE__":%d: \"%s\" (%s) -- ft_error=%d",__LINE__,newfont.c_str(),filename,error);
 		}
@@ -429,7 +449,7 @@ Layer_Freetype::new_face(const String &newfont)
 			if(fs && fs->nfont){
 				FcChar8* file;
 				if( FcPatternGetString (fs->fonts[0], FC_FILE, 0, &file) == FcResultMatch )
-					error=FT_New_Face(ft_library,(const char*)file,face_index,&face);
+					error=open_face((const char*)file,face_index,&face,face_file);
 				FcFontSetDestroy(fs);
 			} else
 				synfig::warning("Layer_Freetype: fontconfig: %s",_("empty font set"));
@@ -438,31 +458,31 @@ Layer_Freetype::new_face(const String &newfont)
 #endif
 
 #ifdef _WIN32
-	if(error)error=FT_New_Face(ft_library,("C:\\WINDOWS\\FONTS\\"+newfont).c_str(),face_index,&face);
-	if(error)error=FT_New_Face(ft_library,("C:\\WINDOWS\\FONTS\\"+newfont+".ttf").c_str(),face_index,&face);
+	if(error)error=open_face(("C:\\WINDOWS\\FONTS\\"+newfont).c_str(),face_index,&face,face_file);
+	if(error)error=open_face(("C:\\WINDOWS\\FONTS\\"+newfont+".ttf").c_str(),face_index,&face,face_file);
 #else
 
 #ifdef __APPLE__
-	if(error)error=FT_New_Face(ft_library,("~/Library/Fonts/"+newfont).c_str(),face_index,&face);
-	if(error)error=FT_New_Face(ft_library,("~/Library/Fonts/"+newfont+".ttf").c_str(),face_index,&face);
-	if(error)error=FT_New_Face(ft_library,("~/Library/Fonts/"+newfont+".dfont").c_str(),face_index,&face);
+	if(error)error=open_face(("~/Library/Fonts/"+newfont).c_str(),face_index,&face,face_file);
+	if(error)error=open_face(("~/Library/Fonts/"+newfont+".ttf").c_str(),face_index,&face,face_file);
+	if(error)error=open_face(("~/Library/Fonts/"+newfont+".dfont").c_str(),face_index,&face,face_file);
 
-	if(error)error=FT_New_Face(ft_library,("/Library/Fonts/"+newfont).c_str(),face_index,&face);
-	if(error)error=FT_New_Face(ft_library,("/Library/Fonts/"+newfont+".ttf").c_str(),face_index,&face);
-	if(error)error=FT_New_Face(ft_library,("/Library/Fonts/"+newfont+".dfont").c_str(),face_index,&face);
+	if(error)error=open_face(("/Library/Fonts/"+newfont).c_str(),face_index,&face,face_file);
+	if(error)error=open_face(("/Library/Fonts/"+newfont+".ttf").c_str(),face_index,&face,face_file);
+	if(error)error=open_face(("/Library/Fonts/"+newfont+".dfont").c_str(),face_index,&face,face_file);
 #endif
 
-	if(error)error=FT_New_Face(ft_library,("/usr/X11R6/lib/X11/fonts/type1/"+newfont).c_str(),face_index,&face);
-	if(error)error=FT_New_Face(ft_library,("/usr/X11R6/lib/X11/fonts/type1/"+newfont+".ttf").c_str(),face_index,&face);
+	if(error)error=open_face(("/usr/X11R6/lib/X11/fonts/type1/"+newfont).c_str(),face_index,&face,face_file);
+	if(error)error=open_face(("/usr/X11R6/lib/X11/fonts/type1/"+newfont+".ttf").c_str(),face_index,&face,face_file);
 
-	if(error)error=FT_New_Face(ft_library,("/usr/share/fonts/truetype/"+newfont).c_str(),face_index,&face);
-	if(error)error=FT_New_Face(ft_library,("/usr/share/fonts/truetype/"+newfont+".ttf").c_str(),face_index,&face);
+	if(error)error=open_face(("/usr/share/fonts/truetype/"+newfont).c_str(),face_index,&face,face_file);
+	if(error)error=open_face(("/usr/share/fonts/truetype/"+newfont+".ttf").c_str(),face_index,&face,face_file);
 
-	if(error)error=FT_New_Face(ft_library,("/usr/X11R6/lib/X11/fonts/TTF/"+newfont).c_str(),face_index,&face);
-	if(error)error=FT_New_Face(ft_library,("/usr/X11R6/lib/X11/fonts/TTF/"+newfont+".ttf").c_str(),face_index,&face);
+	if(error)error=open_face(("/usr/X11R6/lib/X11/fonts/TTF/"+newfont).c_str(),face_index,&face,face_file);
+	if(error)error=open_face(("/usr/X11R6/lib/X11/fonts/TTF/"+newfont+".ttf").c_str(),face_index,&face,face_file);
 
-	if(error)error=FT_New_Face(ft_library,("/usr/X11R6/lib/X11/fonts/truetype/"+newfont).c_str(),face_index,&face);
-	if(error)error=FT_New_Face(ft_library,("/usr/X11R6/lib/X11/fonts/truetype/"+newfont+".ttf").c_str(),face_index,&face);
+	if(error)error=open_face(("/usr/X11R6/lib/X11/fonts/truetype/"+newfont).c_str(),face_index,&face,face_file);
+	if(error)error=open_face(("/usr/X11R6/lib/X11/fonts/truetype/"+newfont+".ttf").c_str(),face_index,&face,face_file);
 
 #endif
 	if(error)
@@ -702,101 +722,15 @@ Layer_Freetype::get_color(Context context, const synfig::Point &pos)const
 		return Color::blend(color,context.get_color(pos),get_amount(),get_blend_method());
 }
 
-bool
-Layer_Freetype::accelerated_render(Context context,Surface *surface,int quality, const RendDesc &renddesc, ProgressCallback *cb)const
+void
+Layer_Freetype::layout_text(const String &text, GlyphCache::Key &key, FT_UInt kerning_mode, Real compress, std::list<TextLine> &lines)const
 {
-	RENDER_TRANSFORMED_IF_NEED(__FILE__, __LINE__)
-
 	bool use_kerning=param_use_kerning.get(bool());
-	bool grid_fit=param_grid_fit.get(bool());
-	bool invert=param_invert.get(bool());
-	Color color=param_color.get(Color());
-	synfig::Point origin=param_origin.get(Point());
-	synfig::Vector orient=param_orient.get(Vector());
-
-	static synfig::RecMutex freetype_mutex;
-
-	if(needs_sync_)
-		const_cast<Layer_Freetype*>(this)->sync();
-
-	int error;
-	Vector size(Layer_Freetype::param_size.get(synfig::Vector())*2);
-
-	if(!context.accelerated_render(surface,quality,renddesc,cb))
-		return false;
-
-	if(is_disabled() || param_text.get(synfig::String()).empty())
-		return true;
-
-	// If there is no font loaded, just bail
-	if(!face)
-	{
-		if(cb)cb->warning(string("Layer_Freetype:")+_("No face loaded, no text will be rendered."));
-		return true;
-	}
-
-	String text(Layer_Freetype::param_text.get(synfig::String()));
-	if(text=="@_FILENAME_@" && get_canvas() && !get_canvas()->get_file_name().empty())
-	{
-		text=basename(get_canvas()->get_file_name());
-	}
-
-	// Width and Height of a pixel
-	Vector::value_type pw=renddesc.get_w()/(renddesc.get_br()[0]-renddesc.get_tl()[0]);
-	Vector::value_type ph=renddesc.get_h()/(renddesc.get_br()[1]-renddesc.get_tl()[1]);
-
-    // Calculate character width and height
-	int w=abs(round_to_int(size[0]*pw));
-	int h=abs(round_to_int(size[1]*ph));
-
-    //int bx=(int)((origin[0]-renddesc.get_tl()[0])*pw*64+0.5);
-    //int by=(int)((origin[1]-renddesc.get_tl()[1])*ph*64+0.5);
-    int bx=0;
-    int by=0;
-
-    // If the font is the size of a pixel, don't bother rendering any text
-	if(w<=1 || h<=1)
-	{
-		if(cb)cb->warning(string("Layer_Freetype:")+_("Text too small, no text will be rendered."));
-		return true;
-	}
-
-	synfig::RecMutex::Lock lock(freetype_mutex);
-
-#define CHAR_RESOLUTION		(64)
-	error = FT_Set_Char_Size(
-		face,						// handle to face object
-		(int)CHAR_RESOLUTION,	// char_width in 1/64th of points
-		(int)CHAR_RESOLUTION,	// char_height in 1/64th of points
-		round_to_int(abs(size[0]*pw*CHAR_RESOLUTION)),						// horizontal device resolution
-		round_to_int(abs(size[1]*ph*CHAR_RESOLUTION)) );						// vertical device resolution
-
-	// Here is where we can compensate for the
-	// error in freetype's rendering engine.
-	const Real xerror(abs(size[0]*pw)/(Real)face->size->metrics.x_ppem/1.13f/0.996);
-	const Real yerror(abs(size[1]*ph)/(Real)face->size->metrics.y_ppem/1.13f/0.996);
-	//synfig::info("xerror=%f, yerror=%f",xerror,yerror);
-	const Real compress(Layer_Freetype::param_compress.get(Real())*xerror);
-	const Real vcompress(Layer_Freetype::param_vcompress.get(Real())*yerror);
-
-	if(error)
-	{
-		if(cb)cb->warning(string("Layer_Freetype:")+_("Unable to set face size.")+strprintf(" (err=%d)",error));
-	}
 
-	FT_GlyphSlot  slot = face->glyph;  // a small shortcut
+	int bx=0;
+	int by=0;
 	FT_UInt       glyph_index(0);
 	FT_UInt       previous(0);
-	int u,v;
-
-	std::list<TextLine> lines;
-
-	/*
- --	** -- CREATE GLYPHS -------------------------------------------------------
-	*/
-
-	mbstate_t ps;
-	memset(&ps, 0, sizeof(ps));
 
 	lines.push_front(TextLine());
 	string::const_iterator iter;
@@ -829,10 +763,11 @@ Layer_Freetype::accelerated_render(Context context,Surface *surface,int quality,
 				bytes--;
 				code = c << (5*bytes - 1);
 				while (bytes > 0) {
+					if (iter + 1 == text.end()) { bad_char = true; break; }
 					iter++;
 					bytes--;
 					c = (unsigned char)*iter;
-					if (iter >= text.end() || (c & 0xc0) != 0x80) { bad_char = true; break; }
+					if ((c & 0xc0) != 0x80) { bad_char = true; break; }
 					code |= (c & 0x3f) << (6 * bytes);
 				}
 			}
@@ -852,10 +787,7 @@ Layer_Freetype::accelerated_render(Context context,Surface *surface,int quality,
 		{
 			FT_Vector  delta;
 
-			if(grid_fit)
-				FT_Get_Kerning( face, previous, glyph_index, ft_kerning_default, &delta );
-			else
-				FT_Get_Kerning( face, previous, glyph_index, ft_kerning_unfitted, &delta );
+			FT_Get_Kerning( face, previous, glyph_index, kerning_mode, &delta );
 
 			if(compress<1.0f)
 			{
@@ -875,36 +807,129 @@ Layer_Freetype::accelerated_render(Context context,Surface *surface,int quality,
         curr_glyph.pos.x = bx;
         curr_glyph.pos.y = by;
 
-        // load glyph image into the slot. DO NOT RENDER IT !!
-        if(grid_fit)
-			error = FT_Load_Glyph( face, glyph_index, FT_LOAD_DEFAULT);
-		else
-			error = FT_Load_Glyph( face, glyph_index, FT_LOAD_DEFAULT|FT_LOAD_NO_HINTING );
-        if (error) continue;  // ignore errors, jump to next glyph
-
-        // extract glyph image and store it in our table
-        error = FT_Get_Glyph( face->glyph, &curr_glyph.glyph );
-        if (error) continue;  // ignore errors, jump to next glyph
+        // take the glyph from cache, or load it and render its mask
+		key.glyph_index = glyph_index;
+		curr_glyph.glyph = GlyphCache::instance().get(face, key);
+        if (!curr_glyph.glyph) continue;  // ignore errors, jump to next glyph
+		const FT_Vector &advance = curr_glyph.glyph->advance;
 
         // record current glyph index
         previous = glyph_index;
 
 		// Update the line width
-		lines.front().width=bx+slot->advance.x;
+		lines.front().width=bx+advance.x;
 
 		// increment pen position
 		if(multiplier>1)
-			bx += round_to_int(slot->advance.x*multiplier*compress)-bx%round_to_int(slot->advance.x*multiplier*compress);
+			bx += round_to_int(advance.x*multiplier*compress)-bx%round_to_int(advance.x*multiplier*compress);
 		else
-			bx += round_to_int(slot->advance.x*compress*multiplier);
+			bx += round_to_int(advance.x*compress*multiplier);
 
-		//bx += round_to_int(slot->advance.x*compress*multiplier);
-		//by += round_to_int(slot->advance.y*compress);
-		by += slot->advance.y*multiplier;
+		//bx += round_to_int(advance.x*compress*multiplier);
+		//by += round_to_int(advance.y*compress);
+		by += advance.y*multiplier;
 
 		lines.front().glyph_table.push_back(curr_glyph);
 
 	}
+}
+
+bool
+Layer_Freetype::accelerated_render(Context context,Surface *surface,int quality, const RendDesc &renddesc, ProgressCallback *cb)const
+{
+	RENDER_TRANSFORMED_IF_NEED(__FILE__, __LINE__)
+
+	bool grid_fit=param_grid_fit.get(bool());
+	bool invert=param_invert.get(bool());
+	Color color=param_color.get(Color());
+	synfig::Point origin=param_origin.get(Point());
+	synfig::Vector orient=param_orient.get(Vector());
+
+	if(needs_sync_)
+		const_cast<Layer_Freetype*>(this)->sync();
+
+	int error;
+	Vector size(Layer_Freetype::param_size.get(synfig::Vector())*2);
+
+	if(!context.accelerated_render(surface,quality,renddesc,cb))
+		return false;
+
+	if(is_disabled() || param_text.get(synfig::String()).empty())
+		return true;
+
+	// If there is no font loaded, just bail
+	if(!face)
+	{
+		if(cb)cb->warning(string("Layer_Freetype:")+_("No face loaded, no text will be rendered."));
+		return true;
+	}
+
+	String text(Layer_Freetype::param_text.get(synfig::String()));
+	if(text=="@_FILENAME_@" && get_canvas() && !get_canvas()->get_file_name().empty())
+	{
+		text=basename(get_canvas()->get_file_name());
+	}
+
+	// Width and Height of a pixel
+	Vector::value_type pw=renddesc.get_w()/(renddesc.get_br()[0]-renddesc.get_tl()[0]);
+	Vector::value_type ph=renddesc.get_h()/(renddesc.get_br()[1]-renddesc.get_tl()[1]);
+
+    // Calculate character width and height
+	int w=abs(round_to_int(size[0]*pw));
+	int h=abs(round_to_int(size[1]*ph));
+
+    //int bx=(int)((origin[0]-renddesc.get_tl()[0])*pw*64+0.5);
+    //int by=(int)((origin[1]-renddesc.get_tl()[1])*ph*64+0.5);
+    int bx=0;
+    int by=0;
+
+    // If the font is the size of a pixel, don't bother rendering any text
+	if(w<=1 || h<=1)
+	{
+		if(cb)cb->warning(string("Layer_Freetype:")+_("Text too small, no text will be rendered."));
+		return true;
+	}
+
+	// face is used only while glyphs are collected,
+	// glyphs itself are shared via the glyph cache
+	freetype_mutex.lock();
+
+	GlyphCache::Key glyph_key;
+	glyph_key.font_file = face_file;
+	glyph_key.face_index = face->face_index;
+	glyph_key.size_x = round_to_int(abs(size[0]*pw*CHAR_RESOLUTION));
+	glyph_key.size_y = round_to_int(abs(size[1]*ph*CHAR_RESOLUTION));
+	glyph_key.load_flags = grid_fit ? FT_LOAD_DEFAULT : FT_LOAD_DEFAULT|FT_LOAD_NO_HINTING;
+
+	error = FT_Set_Char_Size(
+		face,						// handle to face object
+		(int)CHAR_RESOLUTION,	// char_width in 1/64th of points
+		(int)CHAR_RESOLUTION,	// char_height in 1/64th of points
+		glyph_key.size_x,						// horizontal device resolution
+		glyph_key.size_y );						// vertical device resolution
+
+	// Here is where we can compensate for the
+	// error in freetype's rendering engine.
+	const Real xerror(abs(size[0]*pw)/(Real)face->size->metrics.x_ppem/1.13f/0.996);
+	const Real yerror(abs(size[1]*ph)/(Real)face->size->metrics.y_ppem/1.13f/0.996);
+	//synfig::info("xerror=%f, yerror=%f",xerror,yerror);
+	const Real compress(Layer_Freetype::param_compress.get(Real())*xerror);
+	const Real vcompress(Layer_Freetype::param_vcompress.get(Real())*yerror);
+
+	if(error)
+	{
+		if(cb)cb->warning(string("Layer_Freetype:")+_("Unable to set face size.")+strprintf(" (err=%d)",error));
+	}
+
+	int u,v;
+
+	std::list<TextLine> lines;
+
+	/*
+ --	** -- CREATE GLYPHS -------------------------------------------------------
+	*/
+
+	layout_text(text, glyph_key, grid_fit ? ft_kerning_default : ft_kerning_unfitted, compress, lines);
 
 	//Real	string_height;
 	//string_height=(((lines.size()-1)*face->size->metrics.height+lines.back().actual_height()));
@@ -916,6 +941,8 @@ Layer_Freetype::accelerated_render(Context context,Surface *surface,int quality,
 	Real line_height = vcompress*((Real)face->height*(((Real)face->size->metrics.y_scale/METRICS_SCALE_ONE)));
 	Real text_height = (lines.size() - 1)*line_height + lines.back().actual_height();
 
+	freetype_mutex.unlock();
+
 	// This module sees to expect pixel height to be negative, as it
 	// usually is.  But rendering to .bmp format causes ph to be
 	// positive, which was causing text to be rendered upside down.
@@ -971,46 +998,122 @@ Layer_Freetype::accelerated_render(Context context,Surface *surface,int quality,
 			std::vector<Glyph>::iterator iter2;
 			for(iter2=iter->glyph_table.begin();iter2!=iter->glyph_table.end();++iter2)
 			{
-				FT_Glyph  image(iter2->glyph);
+				const GlyphCache::Glyph &glyph = *iter2->glyph;
 				FT_Vector pen;
-				FT_BitmapGlyph  bit;
 
 				pen.x = bx + iter2->pos.x;
 				pen.y = by + iter2->pos.y;
 
 				//synfig::info("GLYPH: line %d, pen.x=%d, pen,y=%d",curr_line,(pen.x+32)>>6,(pen.y+32)>>6);
 
-				error = FT_Glyph_To_Bitmap( &image, ft_render_mode_normal,0/*&pen*/, 1 );
-				if(error) { FT_Done_Glyph( image ); continue; }
+				// blit the cached mask, rows are clipped once instead of every pixel
+				const int x0 = ((pen.x+32)>>6) + glyph.mask_left;
+				const int u0 = std::max(0, -x0);
+				const int u1 = std::min(glyph.mask_width, surface->get_w() - x0);
+				if (u0 >= u1) continue;
 
-				bit = (FT_BitmapGlyph)image;
+				for(v=0;v<glyph.mask_height;v++)
+				{
+					int y=((pen.y+32)>>6) + (glyph.mask_top - v) * sign_y;
+					if (y < 0 || y >= surface->get_h()) continue;
 
-				for(v=0;v<(int)bit->bitmap.rows;v++)
-					for(u=0;u<(int)bit->bitmap.width;u++)
+					const unsigned char *m = &glyph.mask[v*glyph.mask_width];
+					Color *dst = &(*surface)[y][x0];
+					const Color *src = &(*src_surface)[y][x0];
+					for(u=u0;u<u1;u++)
 					{
-						int x=u+((pen.x+32)>>6)+ bit->left;
-						int y=((pen.y+32)>>6) + (bit->top - v) * sign_y;
-						if(	y>=0 &&
-							x>=0 &&
-							y<surface->get_h() &&
-							x<surface->get_w())
-						{
-							Real myamount=(Real)bit->bitmap.buffer[v*bit->bitmap.pitch+u]/255.0f;
-							if(invert)
-								myamount=1.0f-myamount;
-							(*surface)[y][x]=Color::blend(color,(*src_surface)[y][x],myamount*get_amount(),get_blend_method());
-						}
+						// zero amount leaves the pixel unchanged
+						if(!invert && !m[u]) continue;
+						Real myamount=(Real)m[u]/255.0f;
+						if(invert)
+							myamount=1.0f-myamount;
+						dst[u]=Color::blend(color,src[u],myamount*get_amount(),get_blend_method());
 					}
-
-				FT_Done_Glyph( image );
+				}
 			}
-			//iter->clear_and_free();
+			iter->clear_and_free();
 		}
 	}
 
 	return true;
 }
 
+rendering::Task::Handle
+Layer_Freetype::build_composite_task_vfunc(ContextParams /* context_params */)const
+{
+	// hinted glyphs and bitmap fonts depends on the pixel grid,
+	// so such text is still rendered by accelerated_render
+	if (param_grid_fit.get(bool()) || (face && !FT_IS_SCALABLE(face)))
+		return new rendering::TaskLayer();
+
+	if(needs_sync_)
+		const_cast<Layer_Freetype*>(this)->sync();
+
+	String text(param_text.get(synfig::String()));
+	if(text=="@_FILENAME_@" && get_canvas() && !get_canvas()->get_file_name().empty())
+		text=basename(get_canvas()->get_file_name());
+
+	if(!face || text.empty())
+		return rendering::Task::Handle();
+
+	Vector size(param_size.get(synfig::Vector())*2);
+	Vector orient(param_orient.get(synfig::Vector()));
+
+	// glyphs are loaded once per face in font units and scaled here,
+	// EM is the same as in accelerated_render, including its error compensation
+	std::list<TextLine> lines;
+	Vector scale;
+	Real line_height, text_height;
+	{
+		synfig::RecMutex::Lock lock(freetype_mutex);
+
+		GlyphCache::Key glyph_key;
+		glyph_key.font_file = face_file;
+		glyph_key.face_index = face->face_index;
+		glyph_key.load_flags = FT_LOAD_DEFAULT|FT_LOAD_NO_SCALE;
+
+		const Real error(72.0/CHAR_RESOLUTION/1.13f/0.996);
+		const Real compress(param_compress.get(Real())*error);
+		const Real vcompress(param_vcompress.get(Real())*error);
+		layout_text(text, glyph_key, ft_kerning_unscaled, compress, lines);
+
+		scale = Vector(std::fabs(size[0]), std::fabs(size[1]))*((Real)CHAR_RESOLUTION/72.0/(Real)face->units_per_EM);
+		line_height = vcompress*(Real)face->height;
+		text_height = (lines.size() - 1)*line_height + lines.back().actual_height();
+	}
+
+	rendering::Contour::Handle contour(new rendering::Contour());
+	contour->color = param_color.get(Color());
+	contour->invert = param_invert.get(bool());
+	contour->antialias = true;
+	contour->winding_style = rendering::Contour::WINDING_NON_ZERO;
+
+	int curr_line = 0;
+	for(std::list<TextLine>::const_iterator i = lines.begin(); i != lines.end(); ++i, ++curr_line)
+	{
+		Vector line_origin(
+			-orient[0]*i->width,
+			curr_line*line_height - text_height*(1.0 - orient[1]) );
+		for(std::vector<Glyph>::const_iterator j = i->glyph_table.begin(); j != i->glyph_table.end(); ++j)
+		{
+			Vector offset = line_origin + Vector((Real)j->pos.x, (Real)j->pos.y);
+			const rendering::Contour::ChunkList &chunks = j->glyph->chunks;
+			contour->reserve(chunks.size());
+			for(rendering::Contour::ChunkList::const_iterator k = chunks.begin(); k != chunks.end(); ++k)
+				contour->add_chunk(rendering::Contour::Chunk(
+					k->type,
+					(k->p1  + offset).multiply_coords(scale),
+					(k->pp0 + offset).multiply_coords(scale),
+					(k->pp1 + offset).multiply_coords(scale) ));
+		}
+	}
+
+	rendering::TaskContour::Handle task(new rendering::TaskContour());
+	task->transformation->matrix.set_translate( param_origin.get(Vector()) );
+	task->contour = contour;
+	return task;
+}
+
 ////
 bool
 Layer_Freetype::accelerated_cairorender(Context context, cairo_t *cr, int quality, const RendDesc &renddesc, ProgressCallback *cb)const
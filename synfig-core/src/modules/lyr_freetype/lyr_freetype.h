@@ -43,6 +43,7 @@
 #include <ft2build.h>
 #include FT_FREETYPE_H
 #include FT_GLYPH_H
+#include <list>
 #include <vector>
 
 #include <synfig/string.h>
@@ -55,6 +56,8 @@
 #include <synfig/valuenode.h>
 #include <synfig/canvas.h>
 
+#include "glyphcache.h"
+
 
 #include <ETL/misc>
 
@@ -76,7 +79,7 @@ using namespace etl;
 
 struct Glyph
 {
-	FT_Glyph glyph;
+	GlyphCache::Glyph::Handle glyph;
 	FT_Vector pos;
 	//int width;
 };
@@ -94,15 +97,8 @@ struct TextLine
 
 		std::vector<Glyph>::const_iterator iter;
 		for(iter=glyph_table.begin();iter!=glyph_table.end();++iter)
-		{
-			FT_BBox   glyph_bbox;
-
-			//FT_Glyph_Get_CBox( glyphs[n], ft_glyph_bbox_pixels, &glyph_bbox );
-			FT_Glyph_Get_CBox( iter->glyph, ft_glyph_bbox_subpixels, &glyph_bbox );
-
-			if(glyph_bbox.yMax>height)
-				height=glyph_bbox.yMax;
-		}
+			if(iter->glyph->bbox.yMax>height)
+				height=iter->glyph->bbox.yMax;
 		return height;
 	}
 };
@@ -142,6 +138,8 @@ private:
 	ValueBase param_invert;
 
 	FT_Face face;
+	//! file of the loaded face, identifies the face in the glyph cache
+	synfig::String face_file;
 
 	bool old_version;
 	bool needs_sync_;
@@ -152,6 +150,13 @@ private:
 
 	mutable synfig::Mutex mutex;
 
+	//! loads glyphs of text and places them into lines (last line first),
+	//! positions are in units of glyphs defined by key, face should be locked and sized
+	void layout_text(const synfig::String &text, GlyphCache::Key &key, FT_UInt kerning_mode, synfig::Real compress, std::list<TextLine> &lines)const;
+
+protected:
+	virtual rendering::Task::Handle build_composite_task_vfunc(ContextParams context_params)const;
+
 public:
 	Layer_Freetype();
 	virtual ~Layer_Freetype();
@@ -37,9 +37,11 @@
 #include <synfig/localization.h>
 #include <synfig/general.h>
 
+#include <cstdlib>
 #include <string.h>
 #include <synfig/module.h>
 #include "lyr_freetype.h"
+#include "glyphcache.h"
 #include <iostream>
 #include <ETL/stringf>
 
@@ -71,6 +73,9 @@ bool freetype_constructor(synfig::ProgressCallback *cb)
 void freetype_destructor()
 {
 	std::cerr<<"freetype_destructor()"<<std::endl;
+	if (getenv("SYNFIG_TEXT_GLYPH_CACHE_STATISTICS"))
+		GlyphCache::instance().log_statistics();
+	GlyphCache::instance().clear();
 }
 
 /* === E N T R Y P O I N T ================================================= */
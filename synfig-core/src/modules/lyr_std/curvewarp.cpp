@@ -44,6 +44,7 @@
 #include <synfig/valuenode.h>
 #include <ETL/calculus>
 #include <synfig/cairo_renddesc.h>
+#include <synfig/rendering/common/task/taskdistort.h>
 
 #endif
 
@@ -191,15 +192,49 @@ CurveWarp::CurveWarp():
 	SET_STATIC_DEFAULTS();
 }
 
-inline Point
+class CurveWarp::Distortion: public rendering::TaskDistort::Distortion
+{
+public:
+	const Params params;
+
+	explicit Distortion(const Params &params): params(params) { }
+
+	virtual Point map(const Point &point) const
+		{ return transform(params, point); }
+};
+
+void
+CurveWarp::fill_params(Params &params)const
+{
+	params.bline=param_bline.get_list_of(BLinePoint());
+	params.start_point=param_start_point.get(Point());
+	params.end_point=param_end_point.get(Point());
+	params.origin=param_origin.get(Point());
+	params.fast=param_fast.get(bool());
+	params.perp_width=param_perp_width.get(Real());
+	params.perp=perp_;
+	params.curve_length=curve_length_;
+}
+
+Point
 CurveWarp::transform(const Point &point_, Real *dist, Real *along, int quality)const
 {
-	std::vector<BLinePoint> bline(param_bline.get_list_of(BLinePoint()));
-	Point start_point=param_start_point.get(Point());
-	Point end_point=param_end_point.get(Point());
-	Point origin=param_origin.get(Point());
-	bool fast=param_fast.get(bool());
-	Real perp_width=param_perp_width.get(Real());
+	Params params;
+	fill_params(params);
+	return transform(params, point_, dist, along, quality);
+}
+
+Point
+CurveWarp::transform(const Params &params, const Point &point_, Real *dist, Real *along, int quality)
+{
+	const std::vector<BLinePoint> &bline=params.bline;
+	const Point &start_point=params.start_point;
+	const Point &end_point=params.end_point;
+	const Point &origin=params.origin;
+	bool fast=params.fast;
+	Real perp_width=params.perp_width;
+	const Vector &perp_=params.perp;
+	Real curve_length_=params.curve_length;
 
 	Vector tangent;
 	Vector diff;
@@ -454,6 +489,18 @@ CurveWarp::get_sub_renddesc_vfunc(const RendDesc &renddesc) const
 	return desc;
 }
 
+rendering::Task::Handle
+CurveWarp::build_rendering_task_vfunc(Context context) const
+{
+	Params params;
+	fill_params(params);
+
+	rendering::TaskDistort::Handle task(new rendering::TaskDistort());
+	task->distortion = new Distortion(params);
+	task->sub_task() = context.build_rendering_task();
+	return task;
+}
+
 bool
 CurveWarp::accelerated_render(Context context,Surface *surface,int quality, const RendDesc &renddesc, ProgressCallback *cb)const
 {
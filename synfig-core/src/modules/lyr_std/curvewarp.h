@@ -70,7 +70,24 @@ private:
 	Vector perp_;
 	Real curve_length_;
 
+	//! Values of params, used to transform points without access to the layer
+	struct Params {
+		std::vector<BLinePoint> bline;
+		Point start_point;
+		Point end_point;
+		Point origin;
+		bool fast;
+		Real perp_width;
+		Vector perp;
+		Real curve_length;
+		Params(): fast(), perp_width(), curve_length() { }
+	};
+
+	class Distortion;
+
 	void sync();
+	void fill_params(Params &params)const;
+	static Point transform(const Params &params, const Point &point_, Real *dist=NULL, Real *along=0, int quality=10);
 
 public:
 	CurveWarp();
@@ -87,6 +104,7 @@ public:
 
 protected:
 	virtual RendDesc get_sub_renddesc_vfunc(const RendDesc &renddesc) const;
+	virtual rendering::Task::Handle build_rendering_task_vfunc(Context context) const;
 };
 
 }; // END of namespace lyr_std
@@ -101,6 +101,13 @@ Import::set_param(const String & param, const ValueBase &value)
 
 	IMPORT_VALUE_PLUS_BEGIN(param_filename)
 	{
+		// snapshot uses importer of the source layer, see fill_snapshot_vfunc()
+		if(get_snapshot_source())
+		{
+			param_filename.set(value.get(String()));
+			return true;
+		}
+
 		if(!get_canvas() || !get_canvas()->get_file_system())
 		{
 			importer.reset();
@@ -212,6 +219,24 @@ Import::get_param_vocab()const
 	return ret;
 }
 
+void
+Import::fill_snapshot_vfunc(Layer &layer)const
+{
+	Layer_Bitmap::fill_snapshot_vfunc(layer);
+	if (Import *import = dynamic_cast<Import*>(&layer))
+	{
+		import->independent_filename = independent_filename;
+		import->importer = importer;
+		import->cimporter = cimporter;
+	}
+}
+
+bool
+Import::is_time_dependent_vfunc()const
+{
+	return importer && importer->is_animated();
+}
+
 void
 Import::set_time_vfunc(IndependentContext context, Time time)const
 {
@@ -77,6 +77,10 @@ public:
 
 	virtual void set_time_vfunc(IndependentContext context, Time time)const;
 	virtual void load_resources_vfunc(IndependentContext context, Time time)const;
+
+protected:
+	virtual void fill_snapshot_vfunc(Layer &layer)const;
+	virtual bool is_time_dependent_vfunc()const;
 };
 
 }; // END of namespace lyr_std
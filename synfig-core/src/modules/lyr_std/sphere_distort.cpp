@@ -48,6 +48,7 @@
 #include <synfig/cairo_renddesc.h>
 
 #include <synfig/curve_helper.h>
+#include <synfig/rendering/common/task/taskdistort.h>
 
 #endif
 
@@ -304,6 +305,56 @@ inline Point sphtrans(const Point &p, const Point &center, const Real &radius,
 	return sphtrans(p, center, radius, percent, type, tmp);
 }
 
+class Layer_SphereDistort::Distortion: public rendering::TaskDistort::Distortion
+{
+public:
+	const Point center;
+	const Real radius;
+	const Real percent;
+	const int type;
+	const bool clip;
+
+	explicit Distortion(const Layer_SphereDistort &layer):
+		center(layer.param_center.get(Vector())),
+		radius(layer.param_radius.get(double())),
+		percent(layer.param_amount.get(double())),
+		type(layer.param_type.get(int())),
+		clip(layer.param_clip.get(bool()))
+	{ }
+
+	virtual Point map(const Point &point) const
+		{ return sphtrans(point, center, radius, percent, type); }
+
+	// points outside of sphere are transparent when clipped, see Layer_SphereDistort::get_color()
+	virtual bool map_visible(const Point &point, Point &result) const
+	{
+		bool clipped;
+		result = sphtrans(point, center, radius, percent, type, clipped);
+		return !(clip && clipped);
+	}
+
+	// points inside of sphere stays inside, other points are not moved
+	virtual Rect map_bounds(const Rect &sub_bounds) const
+	{
+		Real r = fabs(radius);
+		Rect sphere;
+		switch(type) {
+		case TYPE_DISTH:
+			sphere = Rect(center[0] - r, sub_bounds.miny, center[0] + r, sub_bounds.maxy);
+			break;
+		case TYPE_DISTV:
+			sphere = Rect(sub_bounds.minx, center[1] - r, sub_bounds.maxx, center[1] + r);
+			break;
+		default:
+			sphere = Rect(center - Vector(r, r), center + Vector(r, r));
+			break;
+		}
+		if (clip)
+			return sphere;
+		return sub_bounds && sphere ? sub_bounds | sphere : sub_bounds;
+	}
+};
+
 Layer::Handle
 Layer_SphereDistort::hit_check(Context context, const Point &pos)const
 {
@@ -350,6 +401,15 @@ Layer_SphereDistort::get_sub_renddesc_vfunc(const RendDesc &renddesc) const
 	return desc;
 }
 
+rendering::Task::Handle
+Layer_SphereDistort::build_rendering_task_vfunc(Context context) const
+{
+	rendering::TaskDistort::Handle task(new rendering::TaskDistort());
+	task->distortion = new Distortion(*this);
+	task->sub_task() = context.build_rendering_task();
+	return task;
+}
+
 #if 1
 bool
 Layer_SphereDistort::accelerated_render(Context context,Surface *surface,int quality, const RendDesc &renddesc, ProgressCallback *cb)const
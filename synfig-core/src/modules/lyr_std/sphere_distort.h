@@ -67,6 +67,8 @@ private:
 
 	Rect bounds;
 
+	class Distortion;
+
 	void sync();
 
 public:
@@ -90,6 +92,7 @@ public:
 
 protected:
 	virtual RendDesc get_sub_renddesc_vfunc(const RendDesc &renddesc) const;
+	virtual rendering::Task::Handle build_rendering_task_vfunc(Context context) const;
 }; // END of class Layer_SphereDistort
 
 }; // END of namespace lyr_std
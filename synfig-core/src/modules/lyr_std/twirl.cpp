@@ -42,6 +42,7 @@
 #include <synfig/value.h>
 #include <synfig/valuenode.h>
 #include <synfig/transform.h>
+#include <synfig/rendering/common/task/taskdistort.h>
 #include "twirl.h"
 
 #endif
@@ -67,6 +68,39 @@ SYNFIG_LAYER_SET_CVS_ID(Twirl,"$Id$");
 
 /* === M E T H O D S ======================================================= */
 
+class Twirl::Distortion: public rendering::TaskDistort::Distortion
+{
+public:
+	const Params params;
+
+	explicit Distortion(const Params &params): params(params) { }
+
+	virtual Point map(const Point &point) const
+		{ return distort(params, point); }
+
+	// without distort_outside only points inside the circle are moved
+	Rect add_circle(const Rect &rect) const
+	{
+		Real r = fabs(params.radius);
+		Rect circle(params.center - Vector(r, r), params.center + Vector(r, r));
+		return rect && circle ? rect | circle : rect;
+	}
+
+	virtual Rect map_bounds(const Rect &sub_bounds) const
+	{
+		return params.distort_outside
+		     ? rendering::TaskDistort::Distortion::map_bounds(sub_bounds)
+		     : add_circle(sub_bounds);
+	}
+
+	virtual Rect map_rect(const Rect &rect, const Vector &pixel_size) const
+	{
+		return params.distort_outside
+		     ? rendering::TaskDistort::Distortion::map_rect(rect, pixel_size)
+		     : add_circle(rect);
+	}
+};
+
 /* === E N T R Y P O I N T ================================================= */
 
 Twirl::Twirl():
@@ -144,15 +178,33 @@ Twirl::get_param_vocab()const
 	return ret;
 }
 
+void
+Twirl::fill_params(Params &params)const
+{
+	params.center=param_center.get(Point());
+	params.radius=param_radius.get(Real());
+	params.rotations=param_rotations.get(Angle());
+	params.distort_inside=param_distort_inside.get(bool());
+	params.distort_outside=param_distort_outside.get(bool());
+}
+
 Point
 Twirl::distort(const Point &pos,bool reverse)const
 {
-	Point center=param_center.get(Point());
-	Real radius=param_radius.get(Real());
-	Angle rotations=param_rotations.get(Angle());
-	bool distort_inside=param_distort_inside.get(bool());
-	bool distort_outside=param_distort_outside.get(bool());
-	
+	Params params;
+	fill_params(params);
+	return distort(params, pos, reverse);
+}
+
+Point
+Twirl::distort(const Params &params, const Point &pos, bool reverse)
+{
+	const Point &center=params.center;
+	Real radius=params.radius;
+	const Angle &rotations=params.rotations;
+	bool distort_inside=params.distort_inside;
+	bool distort_outside=params.distort_outside;
+
 	Point centered(pos-center);
 	Real mag(centered.mag());
 
@@ -287,5 +339,16 @@ Twirl::get_sub_renddesc_vfunc(const RendDesc &renddesc) const
 }
 
 rendering::Task::Handle
-Twirl::build_rendering_task_vfunc(Context context) const
-	{ return Layer::build_rendering_task_vfunc(context); }
+Twirl::build_composite_fork_task_vfunc(ContextParams /* context_params */, rendering::Task::Handle sub_task) const
+{
+	Params params;
+	fill_params(params);
+
+	rendering::TaskDistort::Handle task(new rendering::TaskDistort());
+	task->distortion = new Distortion(params);
+	// sub_task is also the sub_task_a of the blend task created by Layer_CompositeFork,
+	// coordinates of tasks are assigned in place, and distortion requests another rect
+	// (and resolution) of the context than the blend, so the tree should not be shared
+	task->sub_task() = sub_task ? sub_task->clone_recursive() : rendering::Task::Handle();
+	return task;
+}
@@ -68,6 +68,20 @@ private:
 	//! Parameter: (bool)
 	ValueBase param_distort_outside;
 
+	//! Values of params, used to distort points without access to the layer
+	struct Params {
+		Point center;
+		Real radius;
+		Angle rotations;
+		bool distort_inside;
+		bool distort_outside;
+		Params(): radius(), distort_inside(), distort_outside() { }
+	};
+
+	class Distortion;
+
+	void fill_params(Params &params)const;
+	static Point distort(const Params &params, const Point &pos, bool reverse=false);
 	Point distort(const Point &pos, bool reverse=false)const;
 public:
 
@@ -90,7 +104,7 @@ public:
 
 protected:
 	virtual RendDesc get_sub_renddesc_vfunc(const RendDesc &renddesc) const;
-	virtual rendering::Task::Handle build_rendering_task_vfunc(Context context) const;
+	virtual rendering::Task::Handle build_composite_fork_task_vfunc(ContextParams context_params, rendering::Task::Handle sub_task) const;
 }; // END of class Twirl
 
 }; // END of namespace lyr_std
@@ -48,6 +48,7 @@
 #include <synfig/valuenode.h>
 #include <synfig/transform.h>
 #include <synfig/cairo_renddesc.h>
+#include <synfig/rendering/common/task/taskdistort.h>
 #include <ETL/misc>
 
 #endif
@@ -73,6 +74,84 @@ SYNFIG_LAYER_SET_CVS_ID(Warp,"$Id$");
 
 /* === M E T H O D S ======================================================= */
 
+class Warp::Distortion: public rendering::TaskDistort::Distortion
+{
+public:
+	Real matrix[3][3];
+	Real inv_matrix[3][3];
+	bool clip;
+	Rect clip_rect;
+	Real horizon;
+
+	explicit Distortion(const Warp &layer):
+		clip(layer.param_clip.get(bool())),
+		clip_rect(layer.param_src_tl.get(Point()), layer.param_src_br.get(Point())),
+		horizon(layer.param_horizon.get(Real()))
+	{
+		memcpy(matrix, layer.matrix, sizeof(matrix));
+		memcpy(inv_matrix, layer.inv_matrix, sizeof(inv_matrix));
+	}
+
+	// the same as Warp::transform_forward()
+	Point forward(const Point &p) const
+	{
+		Real z = inv_matrix[2][0]*p[0] + inv_matrix[2][1]*p[1] + inv_matrix[2][2];
+		return Point(
+			(inv_matrix[0][0]*p[0] + inv_matrix[0][1]*p[1] + inv_matrix[0][2])/z,
+			(inv_matrix[1][0]*p[0] + inv_matrix[1][1]*p[1] + inv_matrix[1][2])/z );
+	}
+
+	Real backward_z(const Point &p) const
+		{ return matrix[2][0]*p[0] + matrix[2][1]*p[1] + matrix[2][2]; }
+
+	Point backward(const Point &p) const
+	{
+		Real z = backward_z(p);
+		return Point(
+			(matrix[0][0]*p[0] + matrix[0][1]*p[1] + matrix[0][2])/z,
+			(matrix[1][0]*p[0] + matrix[1][1]*p[1] + matrix[1][2])/z );
+	}
+
+	virtual Point map(const Point &point) const
+		{ return forward(point); }
+
+	// points beyond the horizon and outside of source rect (when clipped) are transparent,
+	// see Warp::get_color()
+	virtual bool map_visible(const Point &point, Point &result) const
+	{
+		result = forward(point);
+		if (clip && !Rect(clip_rect).is_inside(result))
+			return false;
+		Real z = backward_z(result);
+		return z > 0 && z < horizon;
+	}
+
+	virtual Rect map_bounds(const Rect &sub_bounds) const
+	{
+		Rect under = sub_bounds;
+		if (clip)
+			under &= clip_rect;
+		if (!under.is_valid())
+			return Rect::zero();
+		if (under.is_nan_or_inf())
+			return Rect::infinite();
+
+		// z is linear, so when it is positive at all corners the image of rect is bounded
+		// by images of corners, otherwise the rect crosses the line of horizon
+		const Point corners[] = {
+			under.get_min(), under.get_max(),
+			Point(under.minx, under.maxy), Point(under.maxx, under.miny) };
+		Rect bounds = Rect::zero();
+		for(int i = 0; i < 4; ++i) {
+			if (!(backward_z(corners[i]) > 0))
+				return Rect::infinite();
+			Point p = backward(corners[i]);
+			if (i == 0) bounds = Rect(p); else bounds.expand(p);
+		}
+		return bounds;
+	}
+};
+
 /* === E N T R Y P O I N T ================================================= */
 
 Warp::Warp():
@@ -654,6 +733,15 @@ Warp::get_sub_renddesc_vfunc(const RendDesc &renddesc) const
 	return desc;
 }
 
+rendering::Task::Handle
+Warp::build_rendering_task_vfunc(Context context) const
+{
+	rendering::TaskDistort::Handle task(new rendering::TaskDistort());
+	task->distortion = new Distortion(*this);
+	task->sub_task() = context.build_rendering_task();
+	return task;
+}
+
 bool
 Warp::accelerated_render(Context context,Surface *surface,int quality, const RendDesc &renddesc, ProgressCallback *cb)const
 {
@@ -72,6 +72,8 @@ private:
 	Real matrix[3][3];
 	Real inv_matrix[3][3];
 
+	class Distortion;
+
 	Point transform_forward(const Point& p)const;
 	Point transform_backward(const Point& p)const;
 
@@ -99,6 +101,7 @@ public:
 
 protected:
 	virtual RendDesc get_sub_renddesc_vfunc(const RendDesc &renddesc) const;
+	virtual rendering::Task::Handle build_rendering_task_vfunc(Context context) const;
 };
 
 }; // END of namespace lyr_std
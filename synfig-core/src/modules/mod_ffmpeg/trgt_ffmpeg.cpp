@@ -71,6 +71,12 @@ using namespace etl;
  #define WIN32_PIPE_TO_PROCESSES
 #endif
 
+#ifdef WORDS_BIGENDIAN
+ #define FFMPEG_RAW_PIXEL_FORMAT "gbrp16be"
+#else
+ #define FFMPEG_RAW_PIXEL_FORMAT "gbrp16le"
+#endif
+
 /* === G L O B A L S ======================================================= */
 
 SYNFIG_TARGET_INIT(ffmpeg_trgt);
@@ -79,6 +85,18 @@ SYNFIG_TARGET_SET_EXT(ffmpeg_trgt,"mpg");
 SYNFIG_TARGET_SET_VERSION(ffmpeg_trgt,"0.1");
 SYNFIG_TARGET_SET_CVS_ID(ffmpeg_trgt,"$Id$");
 
+/* === P R O C E D U R E S ================================================= */
+
+namespace {
+	inline unsigned short
+	channel_to_uint16(ColorReal c)
+	{
+		return c > ColorReal(0.0)
+		     ? (c < ColorReal(1.0) ? (unsigned short)(c*ColorReal(65535.0) + ColorReal(0.5)) : 65535)
+		     : 0;
+	}
+}
+
 /* === M E T H O D S ======================================================= */
 
 ffmpeg_trgt::ffmpeg_trgt(const char *Filename, const synfig::TargetParam &params):
@@ -87,9 +105,15 @@ ffmpeg_trgt::ffmpeg_trgt(const char *Filename, const synfig::TargetParam &params
 	multi_image(false),
 	file(NULL),
 	filename(Filename),
-	buffer(NULL),
 	color_buffer(NULL),
-	bitrate()
+	bitrate(),
+	current_buffer(0),
+	scanline(-1),
+	writer_thread(NULL),
+	queued_buffer(-1),
+	writing_buffer(-1),
+	writer_stop(false),
+	writer_failed(false)
 {
 	set_alpha_mode(TARGET_ALPHA_MODE_FILL);
 
@@ -107,6 +131,7 @@ ffmpeg_trgt::ffmpeg_trgt(const char *Filename, const synfig::TargetParam &params
 
 ffmpeg_trgt::~ffmpeg_trgt()
 {
+	stop_writer();
 	if(file)
 	{
 		etl::yield();
@@ -120,10 +145,64 @@ ffmpeg_trgt::~ffmpeg_trgt()
 #endif
 	}
 	file=NULL;
-	delete [] buffer;
 	delete [] color_buffer;
 }
 
+void
+ffmpeg_trgt::stop_writer()
+{
+	if (!writer_thread)
+		return;
+	{
+		Glib::Threads::Mutex::Lock lock(mutex);
+		writer_stop = true;
+		cond.broadcast();
+	}
+	writer_thread->join();
+	writer_thread = NULL;
+}
+
+bool
+ffmpeg_trgt::write_frame(const std::vector<unsigned short> &frame_buffer)
+{
+	// planes are placed one after another, so whole frame goes by the single write
+	size_t size = frame_buffer.size()*sizeof(frame_buffer.front());
+	if (!size)
+		return true;
+	if (fwrite(&frame_buffer.front(), 1, size, file) != size)
+		return false;
+	return fflush(file) == 0;
+}
+
+void
+ffmpeg_trgt::writer()
+{
+	Glib::Threads::Mutex::Lock lock(mutex);
+	while(true) {
+		while(queued_buffer < 0 && !writer_stop)
+			cond.wait(mutex);
+		// queued frame is written even when stop requested
+		if (queued_buffer < 0)
+			break;
+
+		writing_buffer = queued_buffer;
+		queued_buffer = -1;
+		cond.broadcast();
+
+		bool skip = writer_failed;
+		lock.release();
+		bool success = skip || write_frame(frame_buffers[writing_buffer]);
+		lock.acquire();
+
+		if (!success) {
+			synfig::error(_("Unable to write frame into pipe to ffmpeg"));
+			writer_failed = true;
+		}
+		writing_buffer = -1;
+		cond.broadcast();
+	}
+}
+
 bool
 ffmpeg_trgt::set_rend_desc(RendDesc *given_desc)
 {
@@ -227,9 +306,11 @@ ffmpeg_trgt::init(ProgressCallback *cb=NULL)
 	std::vector<String> vargs;
 	vargs.push_back(ffmpeg_binary_path);
 	vargs.push_back("-f");
-	vargs.push_back("image2pipe");
-	vargs.push_back("-vcodec");
-	vargs.push_back("ppm");
+	vargs.push_back("rawvideo");
+	vargs.push_back("-pix_fmt");
+	vargs.push_back(FFMPEG_RAW_PIXEL_FORMAT);
+	vargs.push_back("-s");
+	vargs.push_back(strprintf("%dx%d", desc.get_w(), desc.get_h()));
 	vargs.push_back("-r");
 	vargs.push_back(strprintf("%f", desc.get_frame_rate()));
 	vargs.push_back("-i");
@@ -341,14 +422,22 @@ ffmpeg_trgt::init(ProgressCallback *cb=NULL)
 		return false;
 	}
 
+	writer_thread = Glib::Threads::Thread::create(sigc::mem_fun(*this, &ffmpeg_trgt::writer));
+
 	return true;
 }
 
 void
 ffmpeg_trgt::end_frame()
 {
-	//fprintf(file, " ");
-	fflush(file);
+	// pass the frame to the writer thread and continue with the other buffer
+	Glib::Threads::Mutex::Lock lock(mutex);
+	while(queued_buffer >= 0 && !writer_failed)
+		cond.wait(mutex);
+	queued_buffer = current_buffer;
+	cond.broadcast();
+	current_buffer = 1 - current_buffer;
+	scanline = -1;
 	imagecount++;
 }
 
@@ -357,15 +446,19 @@ ffmpeg_trgt::start_frame(synfig::ProgressCallback */*callback*/)
 {
 	int w=desc.get_w(),h=desc.get_h();
 
-	if(!file)
+	if(!file || !writer_thread)
 		return false;
 
-	fprintf(file, "P6\n");
-	fprintf(file, "%d %d\n", w, h);
-	fprintf(file, "%d\n", 255);
+	{
+		// wait while the writer thread sends previous content of the buffer
+		Glib::Threads::Mutex::Lock lock(mutex);
+		while(writing_buffer == current_buffer && !writer_failed)
+			cond.wait(mutex);
+		if (writer_failed)
+			return false;
+	}
 
-	delete [] buffer;
-	buffer=new unsigned char[3*w];
+	frame_buffers[current_buffer].resize(3*(size_t)w*(size_t)h);
 	delete [] color_buffer;
 	color_buffer=new Color[w];
 
@@ -373,8 +466,9 @@ ffmpeg_trgt::start_frame(synfig::ProgressCallback */*callback*/)
 }
 
 Color *
-ffmpeg_trgt::start_scanline(int /*scanline*/)
+ffmpeg_trgt::start_scanline(int scanline)
 {
+	this->scanline = scanline;
 	return color_buffer;
 }
 
@@ -384,10 +478,19 @@ ffmpeg_trgt::end_scanline()
 	if(!file)
 		return false;
 
-	color_to_pixelformat(buffer, color_buffer, PF_RGB, 0, desc.get_w());
-
-	if(!fwrite(buffer,1,desc.get_w()*3,file))
+	const size_t w = desc.get_w(), h = desc.get_h();
+	if (scanline < 0 || scanline >= (int)h)
 		return false;
 
+	std::vector<unsigned short> &frame_buffer = frame_buffers[current_buffer];
+	unsigned short *g = &frame_buffer[scanline*w];
+	unsigned short *b = g + w*h;
+	unsigned short *r = b + w*h;
+	for(const Color *c = color_buffer, *end = c + w; c != end; ++c, ++g, ++b, ++r) {
+		*g = channel_to_uint16(c->get_g());
+		*b = channel_to_uint16(c->get_b());
+		*r = channel_to_uint16(c->get_r());
+	}
+
 	return true;
 }
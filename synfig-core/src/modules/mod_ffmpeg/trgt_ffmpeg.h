@@ -35,6 +35,8 @@
 #include <synfig/targetparam.h>
 #include <sys/types.h>
 #include <cstdio>
+#include <vector>
+#include <glibmm/threads.h>
 
 /* === M A C R O S ========================================================= */
 
@@ -53,10 +55,31 @@ private:
 	bool multi_image;
 	FILE *file;
 	synfig::String filename;
-	unsigned char *buffer;
 	synfig::Color *color_buffer;
 	std::string video_codec;
 	int bitrate;
+
+	//! Frames are sent to ffmpeg as raw planar 16-bit RGB (G, B and R planes).
+	//! There are two frame buffers: while the writer thread sends one of them
+	//! into the pipe, the next frame is converted into the other one.
+	std::vector<unsigned short> frame_buffers[2];
+	int current_buffer;
+	int scanline;
+
+	Glib::Threads::Mutex mutex;
+	Glib::Threads::Cond cond;
+	Glib::Threads::Thread *writer_thread;
+	//! index of buffer which is waiting for the writer thread, or -1
+	int queued_buffer;
+	//! index of buffer which is being written now, or -1
+	int writing_buffer;
+	bool writer_stop;
+	bool writer_failed;
+
+	void writer();
+	bool write_frame(const std::vector<unsigned short> &frame_buffer);
+	void stop_writer();
+
 public:
 	ffmpeg_trgt(const char *filename,
 				const synfig::TargetParam& params);
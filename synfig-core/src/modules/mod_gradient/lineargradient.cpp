@@ -46,6 +46,8 @@
 #include <synfig/value.h>
 #include <synfig/valuenode.h>
 
+#include <synfig/rendering/common/task/taskpixelfunction.h>
+
 #endif
 
 /* === M A C R O S ========================================================= */
@@ -63,6 +65,18 @@ SYNFIG_LAYER_SET_CVS_ID(LinearGradient,"$Id$");
 
 /* === M E T H O D S ======================================================= */
 
+class LinearGradient::ColorFunction: public rendering::TaskPixelFunction::Function
+{
+public:
+	const Params params;
+
+	explicit ColorFunction(const Params &params): params(params) { }
+
+	virtual Color get_color(const Point &point, const Vector &pixel_size) const
+		{ return color_func(params, point, calc_supersample(params, pixel_size[0], pixel_size[1])); }
+};
+
+
 inline void
 LinearGradient::Params::calc_diff()
 {
@@ -96,7 +110,7 @@ LinearGradient::fill_params(Params &params)const
 }
 
 inline Color
-LinearGradient::color_func(const Params &params, const Point &point, synfig::Real supersample)const
+LinearGradient::color_func(const Params &params, const Point &point, synfig::Real supersample)
 {
 	Real dist(point*params.diff - params.p1*params.diff);
 	supersample *= 0.5;
@@ -104,7 +118,7 @@ LinearGradient::color_func(const Params &params, const Point &point, synfig::Rea
 }
 
 inline synfig::Real
-LinearGradient::calc_supersample(const Params &params, synfig::Real pw, synfig::Real /*ph*/)const
+LinearGradient::calc_supersample(const Params &params, synfig::Real pw, synfig::Real /*ph*/)
 {
 	// it's copy of code
 	// see also other calc_supersample overload
@@ -368,3 +382,14 @@ LinearGradient::compile_gradient(cairo_pattern_t* pattern, Gradient mygradient)c
 	}
 	return cpoints_all_opaque;
 }
+
+rendering::Task::Handle
+LinearGradient::build_composite_task_vfunc(ContextParams /* context_params */)const
+{
+	Params params;
+	fill_params(params);
+
+	rendering::TaskPixelFunction::Handle task(new rendering::TaskPixelFunction());
+	task->function = new ColorFunction(params);
+	return task;
+}
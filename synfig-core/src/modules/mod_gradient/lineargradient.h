@@ -69,9 +69,11 @@ private:
 		void calc_diff();
 	};
 
+	class ColorFunction;
+
 	void fill_params(Params &params)const;
-	synfig::Color color_func(const Params &params, const synfig::Point &x, synfig::Real supersample = 0.0)const;
-	synfig::Real calc_supersample(const Params &params, synfig::Real pw, synfig::Real ph)const;
+	static synfig::Color color_func(const Params &params, const synfig::Point &x, synfig::Real supersample = 0.0);
+	static synfig::Real calc_supersample(const Params &params, synfig::Real pw, synfig::Real ph);
 	bool compile_gradient(cairo_pattern_t* pattern, Gradient gradient)const;
 
 public:
@@ -86,6 +88,9 @@ public:
 	synfig::Layer::Handle hit_check(synfig::Context context, const synfig::Point &point)const;
 
 	virtual Vocab get_param_vocab()const;
+
+protected:
+	virtual rendering::Task::Handle build_composite_task_vfunc(ContextParams context_params)const;
 };
 
 /* === E N D =============================================================== */
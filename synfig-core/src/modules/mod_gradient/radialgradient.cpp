@@ -43,6 +43,8 @@
 #include <synfig/value.h>
 #include <synfig/valuenode.h>
 
+#include <synfig/rendering/common/task/taskpixelfunction.h>
+
 #include "radialgradient.h"
 
 #endif
@@ -66,6 +68,25 @@ SYNFIG_LAYER_SET_CVS_ID(RadialGradient,"$Id$");
 
 /* === M E T H O D S ======================================================= */
 
+class RadialGradient::ColorFunction: public rendering::TaskPixelFunction::Function
+{
+public:
+	const CompiledGradient gradient;
+	const Point center;
+	const Real radius;
+
+	ColorFunction(const CompiledGradient &gradient, const Point &center, Real radius):
+		gradient(gradient), center(center), radius(radius) { }
+
+	// see also RadialGradient::color_func() and RadialGradient::calc_supersample()
+	virtual Color get_color(const Point &point, const Vector &pixel_size) const
+	{
+		Real dist = (point - center).mag()/radius;
+		Real supersample = 0.5*1.2*pixel_size[0]/radius;
+		return gradient.average(dist - supersample, dist + supersample);
+	}
+};
+
 /* === E N T R Y P O I N T ================================================= */
 
 RadialGradient::RadialGradient():
@@ -342,3 +363,13 @@ RadialGradient::compile_gradient(cairo_pattern_t* pattern, Gradient mygradient)c
 	return cpoints_all_opaque;
 }
 
+rendering::Task::Handle
+RadialGradient::build_composite_task_vfunc(ContextParams /* context_params */)const
+{
+	rendering::TaskPixelFunction::Handle task(new rendering::TaskPixelFunction());
+	task->function = new ColorFunction(
+		compiled_gradient,
+		param_center.get(Point()),
+		param_radius.get(Real()) );
+	return task;
+}
@@ -62,6 +62,8 @@ private:
 
 	CompiledGradient compiled_gradient;
 
+	class ColorFunction;
+
 	void compile();
 	Color color_func(const Point &x, Real supersample=0)const;
 	Real calc_supersample(const Point &x, Real pw, Real ph)const;
@@ -82,6 +84,9 @@ public:
 	Layer::Handle hit_check(Context context, const Point &point)const;
 
 	virtual Vocab get_param_vocab()const;
+
+protected:
+	virtual rendering::Task::Handle build_composite_task_vfunc(ContextParams context_params)const;
 }; // END of class RadialGradient
 
 /* === E N D =============================================================== */
@@ -44,6 +44,7 @@
 #include <synfig/surface.h>
 #include <synfig/value.h>
 #include <synfig/valuenode.h>
+#include <synfig/rendering/common/task/taskdistort.h>
 #include <time.h>
 
 #endif
@@ -67,6 +68,24 @@ SYNFIG_LAYER_SET_CVS_ID(NoiseDistort,"$Id$");
 
 /* === M E T H O D S ======================================================= */
 
+class NoiseDistort::Distortion: public rendering::TaskDistort::Distortion
+{
+public:
+	const Params params;
+
+	explicit Distortion(const Params &params): params(params) { }
+
+	virtual Point map(const Point &point) const
+		{ return point_func(params, point); }
+
+	// points never moved farther than displacement, see also NoiseDistort::get_bounding_rect()
+	virtual Rect map_bounds(const Rect &sub_bounds) const
+		{ return Rect(sub_bounds).expand_x(fabs(params.displacement[0])).expand_y(fabs(params.displacement[1])); }
+	virtual Rect map_rect(const Rect &rect, const Vector & /* pixel_size */) const
+		{ return Rect(rect).expand_x(fabs(params.displacement[0])).expand_y(fabs(params.displacement[1])); }
+};
+
+
 NoiseDistort::NoiseDistort():
 	Layer_CompositeFork(1.0,Color::BLEND_STRAIGHT),
 	param_displacement(ValueBase(Vector(0.25,0.25))),
@@ -81,23 +100,43 @@ NoiseDistort::NoiseDistort():
 	SET_STATIC_DEFAULTS();
 }
 
+void
+NoiseDistort::fill_params(Params &params)const
+{
+	params.displacement=param_displacement.get(Vector());
+	params.size=param_size.get(Vector());
+	params.random.set_seed(param_random.get(int()));
+	params.smooth=param_smooth.get(int());
+	params.detail=param_detail.get(int());
+	params.speed=param_speed.get(Real());
+	params.time=params.speed*get_time_mark();
+	params.turbulent=param_turbulent.get(bool());
+}
+
 inline Point
 NoiseDistort::point_func(const Point &point)const
 {
-	Vector displacement=param_displacement.get(Vector());
-	Vector size=param_size.get(Vector());
-	RandomNoise random;
-	random.set_seed(param_random.get(int()));
-	int smooth_=param_smooth.get(int());
-	int detail=param_detail.get(int());
-	Real speed=param_speed.get(Real());
-	bool turbulent=param_turbulent.get(bool());
-	
+	Params params;
+	fill_params(params);
+	return point_func(params, point);
+}
+
+Point
+NoiseDistort::point_func(const Params &params, const Point &point)
+{
+	const Vector &displacement=params.displacement;
+	const Vector &size=params.size;
+	const RandomNoise &random=params.random;
+	int smooth_=params.smooth;
+	int detail=params.detail;
+	Real speed=params.speed;
+	bool turbulent=params.turbulent;
+
 	float x(point[0]/size[0]*(1<<detail));
 	float y(point[1]/size[1]*(1<<detail));
 	
 	int i;
-	Time time = speed*get_time_mark();
+	Time time = params.time;
 	int temp_smooth(smooth_);
 	int smooth((!speed && temp_smooth == (int)(RandomNoise::SMOOTH_SPLINE)) ? (int)(RandomNoise::SMOOTH_FAST_SPLINE) : temp_smooth);
 	
@@ -361,5 +400,23 @@ NoiseDistort::accelerated_render(Context context,Surface *surface,int quality, c
 */
 
 rendering::Task::Handle
-NoiseDistort::build_rendering_task_vfunc(Context context) const
-	{ return Layer::build_rendering_task_vfunc(context); }
+NoiseDistort::build_composite_fork_task_vfunc(ContextParams /* context_params */, rendering::Task::Handle sub_task) const
+{
+	Params params;
+	fill_params(params);
+
+	rendering::TaskDistort::Handle task(new rendering::TaskDistort());
+	task->distortion = new Distortion(params);
+	// sub_task is also the sub_task_a of the blend task created by Layer_CompositeFork,
+	// coordinates of tasks are assigned in place, and distortion requests another rect
+	// (and resolution) of the context than the blend, so the tree should not be shared
+	task->sub_task() = sub_task ? sub_task->clone_recursive() : rendering::Task::Handle();
+	return task;
+}
+
+bool
+NoiseDistort::is_time_dependent_vfunc() const
+{
+	// the noise is animated by time multiplied by speed
+	return param_speed.get(Real()) != 0.0;
+}
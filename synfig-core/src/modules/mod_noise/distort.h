@@ -64,6 +64,23 @@ private:
 
 	synfig::Color color_func(const synfig::Point &x, float supersample,synfig::Context context)const;
 	synfig::CairoColor cairocolor_func(const synfig::Point &x, float supersample,synfig::Context context)const;
+	//! Values of params, used to distort points without access to the layer
+	struct Params {
+		synfig::Vector displacement;
+		synfig::Vector size;
+		RandomNoise random;
+		int smooth;
+		int detail;
+		synfig::Real speed;
+		synfig::Time time;
+		bool turbulent;
+		Params(): smooth(), detail(), speed(), turbulent() { }
+	};
+
+	class Distortion;
+
+	void fill_params(Params &params)const;
+	static synfig::Point point_func(const Params &params, const synfig::Point &point);
 	synfig::Point point_func(const synfig::Point &point)const;
 
 	float calc_supersample(const synfig::Point &x, float pw,float ph)const;
@@ -84,7 +101,8 @@ public:
 
 protected:
 	virtual synfig::RendDesc get_sub_renddesc_vfunc(const synfig::RendDesc &renddesc) const;
-	virtual synfig::rendering::Task::Handle build_rendering_task_vfunc(synfig::Context context) const;
+	virtual synfig::rendering::Task::Handle build_composite_fork_task_vfunc(synfig::ContextParams context_params, synfig::rendering::Task::Handle sub_task) const;
+	virtual bool is_time_dependent_vfunc() const;
 }; // EOF of class NoiseDistort
 
 /* === E N D =============================================================== */
@@ -44,6 +44,7 @@
 #include <synfig/surface.h>
 #include <synfig/value.h>
 #include <synfig/valuenode.h>
+#include <synfig/rendering/common/task/taskpixelfunction.h>
 #include <time.h>
 
 #endif
@@ -67,6 +68,19 @@ SYNFIG_LAYER_SET_CVS_ID(Noise,"$Id$");
 
 /* === M E T H O D S ======================================================= */
 
+class Noise::ColorFunction: public rendering::TaskPixelFunction::Function
+{
+public:
+	const Params params;
+	const CompiledGradient gradient;
+
+	ColorFunction(const Params &params, const CompiledGradient &gradient):
+		params(params), gradient(gradient) { }
+
+	virtual Color get_color(const Point &point, const Vector &pixel_size) const
+		{ return color_func(params, gradient, point, 0.5*(pixel_size[0] + pixel_size[1])); }
+};
+
 Noise::Noise():
 	Layer_Composite(1.0,Color::BLEND_COMPOSITE),
 	param_gradient(ValueBase(Gradient(Color::black(), Color::white()))),
@@ -91,19 +105,39 @@ void
 Noise::compile()
 	{ compiled_gradient.set(param_gradient.get(Gradient()) ); }
 
+void
+Noise::fill_params(Params &params)const
+{
+	params.size=param_size.get(Vector());
+	params.random.set_seed(param_random.get(int()));
+	params.smooth=param_smooth.get(int());
+	params.detail=param_detail.get(int());
+	params.speed=param_speed.get(Real());
+	params.time=params.speed*get_time_mark();
+	params.turbulent=param_turbulent.get(bool());
+	params.do_alpha=param_do_alpha.get(bool());
+	params.super_sample=param_super_sample.get(bool());
+}
+
 inline Color
 Noise::color_func(const Point &point, float pixel_size,Context /*context*/)const
 {
-	Vector size=param_size.get(Vector());
-	RandomNoise random;
-	random.set_seed(param_random.get(int()));
-	int smooth_=param_smooth.get(int());
-	int detail=param_detail.get(int());
-	Real speed=param_speed.get(Real());
-	bool turbulent=param_turbulent.get(bool());
-	bool do_alpha=param_do_alpha.get(bool());
-	bool super_sample=param_super_sample.get(bool());
-	
+	Params params;
+	fill_params(params);
+	return color_func(params, compiled_gradient, point, pixel_size);
+}
+
+Color
+Noise::color_func(const Params &params, const CompiledGradient &compiled_gradient, const Point &point, float pixel_size)
+{
+	const Vector &size=params.size;
+	const RandomNoise &random=params.random;
+	int smooth_=params.smooth;
+	int detail=params.detail;
+	Real speed=params.speed;
+	bool turbulent=params.turbulent;
+	bool do_alpha=params.do_alpha;
+	bool super_sample=params.super_sample;
 
 	Color ret(0,0,0,0);
 
@@ -118,8 +152,7 @@ Noise::color_func(const Point &point, float pixel_size,Context /*context*/)const
 	}
 
 	int i;
-	Time time;
-	time=speed*get_time_mark();
+	Time time=params.time;
 	int smooth((!speed && smooth_ == (int)RandomNoise::SMOOTH_SPLINE) ? (int)RandomNoise::SMOOTH_FAST_SPLINE : smooth_);
 
 	float ftime(time);
@@ -381,3 +414,21 @@ Noise::accelerated_render(Context context,Surface *surface,int quality, const Re
 
 	return true;
 }
+
+rendering::Task::Handle
+Noise::build_composite_task_vfunc(ContextParams /*context_params*/)const
+{
+	Params params;
+	fill_params(params);
+
+	rendering::TaskPixelFunction::Handle task(new rendering::TaskPixelFunction());
+	task->function = new ColorFunction(params, compiled_gradient);
+	return task;
+}
+
+bool
+Noise::is_time_dependent_vfunc()const
+{
+	// the noise is animated by time multiplied by speed
+	return param_speed.get(Real()) != 0.0;
+}
@@ -69,7 +69,25 @@ private:
 
 	synfig::CompiledGradient compiled_gradient;
 
+	//! Values of params, used to calculate colors without access to the layer
+	struct Params {
+		synfig::Vector size;
+		RandomNoise random;
+		int smooth;
+		int detail;
+		synfig::Real speed;
+		synfig::Time time;
+		bool turbulent;
+		bool do_alpha;
+		bool super_sample;
+		Params(): smooth(), detail(), speed(), turbulent(), do_alpha(), super_sample() { }
+	};
+
+	class ColorFunction;
+
 	void compile();
+	void fill_params(Params &params)const;
+	static synfig::Color color_func(const Params &params, const synfig::CompiledGradient &gradient, const synfig::Point &x, float supersample);
 	synfig::Color color_func(const synfig::Point &x, float supersample,synfig::Context context)const;
 	float calc_supersample(const synfig::Point &x, float pw,float ph)const;
 
@@ -83,6 +101,10 @@ public:
 	virtual bool accelerated_render(synfig::Context context,synfig::Surface *surface,int quality, const synfig::RendDesc &renddesc, synfig::ProgressCallback *cb)const;
 	synfig::Layer::Handle hit_check(synfig::Context context, const synfig::Point &point)const;
 	virtual Vocab get_param_vocab()const;
+
+protected:
+	virtual synfig::rendering::Task::Handle build_composite_task_vfunc(synfig::ContextParams context_params)const;
+	virtual bool is_time_dependent_vfunc()const;
 };
 
 /* === E N D =============================================================== */
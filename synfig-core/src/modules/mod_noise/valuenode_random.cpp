@@ -125,6 +125,8 @@ ValueNode_Random::operator()(Time t)const
 	int		loop	= int((((*loop_ )(t).get(Real())) * speed) + 0.5);
 	speed *= t;
 
+	// local generator, node may be evaluated from several threads
+	RandomNoise random;
 	random.set_seed(seed);
 
 	Type &type(get_type());
@@ -63,6 +63,8 @@ public:
 	virtual String get_name()const;
 	virtual String get_local_name()const;
 
+	virtual bool is_time_dependent()const { return true; }
+
 	virtual ValueNode::LooseHandle get_link_vfunc(int i)const;
 
 	virtual ValueNode::Handle clone(etl::loose_handle<Canvas> canvas, const GUID& deriv_guid=GUID())const;
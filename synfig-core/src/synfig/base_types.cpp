@@ -183,6 +183,7 @@ public:
 	static TypeReal instance;
 };
 TypeReal TypeReal::instance;
+static_assert(sizeof(TypeReal::Inner) <= Operation::INLINE_SIZE, "Real should be stored inside of ValueBase");
 SYNFIG_IMPLEMENT_TYPE_ALIAS(Real, TypeReal)
 SYNFIG_IMPLEMENT_TYPE_ALIAS(float, TypeReal)
 
@@ -85,6 +85,24 @@ int _CanvasCounter::counter(0);
 
 /* === P R O C E D U R E S ================================================= */
 
+static void
+sort_layers(IndependentContext context, CanvasBase &out_queue)
+{
+	multimap<Real, Layer::Handle> layers;
+	int index = 0;
+	for(; *context; ++context, ++index)
+	{
+		// TODO: the 1.0001 constant should be somehow user defined
+		Real depth = (*context)->get_z_depth()*1.0001 + (Real)index;
+		layers.insert(pair<Real, Layer::Handle>(depth, *context));
+	}
+
+	out_queue.clear();
+	for(multimap<Real, Layer::Handle>::const_iterator i = layers.begin(); i != layers.end(); ++i)
+		out_queue.push_back(i->second);
+	out_queue.push_back(Layer::Handle());
+}
+
 /* === M E T H O D S ======================================================= */
 
 Canvas::Canvas(const String &id):
@@ -283,21 +301,7 @@ Canvas::get_context(const Context &parent_context)const
 Context
 Canvas::get_context_sorted(const ContextParams &params, CanvasBase &out_queue) const
 {
-	multimap<Real, Layer::Handle> layers;
-	int index = 0;
-	for(const_iterator i = begin(); i != end(); ++i, ++index)
-	{
-		assert(*i);
-		// TODO: the 1.0001 constant should be somehow user defined
-		Real depth = (*i)->get_z_depth()*1.0001 + (Real)index;
-		layers.insert(pair<Real, Layer::Handle>(depth, *i));
-	}
-
-	out_queue.clear();
-	for(multimap<Real, Layer::Handle>::const_iterator i = layers.begin(); i != layers.end(); ++i)
-		out_queue.push_back(i->second);
-	out_queue.push_back(Layer::Handle());
-
+	sort_layers(get_independent_context(), out_queue);
 	return Context(out_queue.begin(), params);
 }
 
@@ -306,8 +310,23 @@ Canvas::build_rendering_task(const ContextParams &context_params) const
 {
 	CanvasBase sub_queue;
 	Context context = get_context_sorted(context_params, sub_queue);
-	rendering::Task::Handle task = context.build_rendering_task();
-	
+	return apply_gamma(context.build_rendering_task());
+}
+
+rendering::Task::Handle
+Canvas::build_rendering_task(Time time, const ContextParams &context_params) const
+{
+	// z_depth may be animated, so layers are sorted after evaluation of snapshots
+	CanvasBase snapshot_queue;
+	CanvasBase sub_queue;
+	sort_layers(get_independent_context().snapshot(time, snapshot_queue), sub_queue);
+	Context context(sub_queue.begin(), context_params);
+	return apply_gamma(context.build_rendering_task());
+}
+
+rendering::Task::Handle
+Canvas::apply_gamma(rendering::Task::Handle task) const
+{
 	rendering::TaskPixelGamma::Handle task_gamma(new rendering::TaskPixelGamma());
 	task_gamma->gamma = get_root()->rend_desc().get_gamma().get_inverted();
 	task_gamma->sub_task() = task;
@@ -1520,6 +1539,15 @@ Canvas::get_times_vfunc(Node::time_set &set) const
 	}
 }
 
+bool
+Canvas::is_time_dependent()const
+{
+	for(const_iterator i = begin(); i != end(); ++i)
+		if ((*i)->active() && (*i)->is_time_dependent())
+			return true;
+	return false;
+}
+
 std::set<etl::handle<Layer> >
 Canvas::get_layers_in_group(const String&group)
 {
@@ -392,6 +392,9 @@ public:
 	//! Returns true if the Canvas is in line
 	bool is_inline()const { return is_inline_; }
 
+	//! Returns true if any of active layers of the Canvas depends on time
+	bool is_time_dependent()const;
+
 	//! Returns a handle to the RendDesc for this Canvas
 	RendDesc &rend_desc() { return desc_; }
 
@@ -600,6 +603,11 @@ public:
 
 	//! Creates sorted context and builds task for rendering based on it with applied gamma
 	rendering::Task::Handle build_rendering_task(const ContextParams &context_params) const;
+
+	//! Builds task for rendering of the Time \time like the function above,
+	//! but layers of the canvas are not changed, see IndependentContext::snapshot().
+	//! So tasks for several frames may be built concurrently (see Target_Scanline).
+	rendering::Task::Handle build_rendering_task(Time time, const ContextParams &context_params) const;
 	
 	int indexof(const const_iterator &iter) const;
 	iterator byindex(int index);
@@ -688,6 +696,8 @@ private:
 	//! Seems to be used to disconnect the stored signals connections of the layers.
 	//! \see connections_
 	void disconnect_connections(etl::loose_handle<Layer> layer);
+	//! Applies gamma of the root canvas to the rendering task
+	rendering::Task::Handle apply_gamma(rendering::Task::Handle task) const;
 
 protected:
 	//! Parent changed
@@ -324,6 +324,12 @@ public:
 	/* Other */
 	static Color blend(Color a, Color b, float amount, BlendMethod type=BLEND_COMPOSITE);
 
+	//! Blends \a count colors from \a src onto \a dest,
+	//! same as dest[i] = blend(src[i], dest[i], amount, type) but processes whole row at once
+	static void blend_row(Color *dest, const Color *src, int count, float amount, BlendMethod type=BLEND_COMPOSITE);
+	//! Blends single color \a src onto \a count colors of \a dest
+	static void blend_row(Color *dest, const Color &src, int count, float amount, BlendMethod type=BLEND_COMPOSITE);
+
 	static bool is_onto(BlendMethod x)
 		{ return BLEND_METHODS_ONTO & (1 << x); }
 
@@ -0,0 +1,239 @@
+/* === S Y N F I G ========================================================= */
+/*!	\file colorblendingrows.cpp
+**	\brief Blending of rows of colors
+**
+**	$Id$
+**
+**	\legal
+**	Copyright (c) 2019 Synfig Contributors
+**
+**	This package is free software; you can redistribute it and/or
+**	modify it under the terms of the GNU General Public License as
+**	published by the Free Software Foundation; either version 2 of
+**	the License, or (at your option) any later version.
+**
+**	This package is distributed in the hope that it will be useful,
+**	but WITHOUT ANY WARRANTY; without even the implied warranty of
+**	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+**	General Public License for more details.
+**	\endlegal
+*/
+/* ========================================================================= */
+
+/* === H E A D E R S ======================================================= */
+
+#ifdef USING_PCH
+#	include "pch.h"
+#else
+#ifdef HAVE_CONFIG_H
+#	include <config.h>
+#endif
+
+#include <cassert>
+#include <cmath>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+#include "color.h"
+#include "colorblendingfunctions.h"
+
+#endif
+
+using namespace synfig;
+
+/* === M A C R O S ========================================================= */
+
+#define COLOR_EPSILON	(0.000001f)
+
+/* === M E T H O D S ======================================================= */
+
+namespace {
+
+typedef void (*BlendRowFunc)(Color *dest, const Color *src, int src_step, int count, float amount);
+
+// Generic row blending, calls blending function directly for each pixel
+// without lookup in the table of blending functions
+template<blendfunc func>
+void blend_row_generic(Color *dest, const Color *src, int src_step, int count, float amount)
+{
+	for(Color *end = dest + count; dest < end; ++dest, src += src_step)
+	{
+		Color a(*src), b(*dest);
+		*dest = func(a, b, amount);
+	}
+}
+
+#ifdef __SSE2__
+
+// SSE2 versions of the most used blending methods,
+// all four channels of the pixel are processed in one register.
+// Operations are made in the same order as in colorblendingfunctions.h
+// so results are equal to the results of generic functions.
+
+static_assert(sizeof(Color) == 4*sizeof(float), "Color should contain four floats");
+
+inline __m128 load(const Color &c)
+	{ return _mm_loadu_ps(&c.get_r()); }
+inline void store(Color &c, __m128 v)
+	{ _mm_storeu_ps(reinterpret_cast<float*>(&c), v); }
+inline __m128 alpha(__m128 v)
+	{ return _mm_shuffle_ps(v, v, _MM_SHUFFLE(3, 3, 3, 3)); }
+inline __m128 with_alpha(__m128 v, __m128 a) {
+	const __m128 mask = _mm_castsi128_ps(_mm_set_epi32(-1, 0, 0, 0));
+	return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, v));
+}
+
+inline void composite(Color &dest, __m128 s, __m128 d, __m128 a_src, __m128 a_dest)
+{
+	const __m128 k = _mm_sub_ps(_mm_set1_ps(1.f), a_src);
+	const __m128 c = _mm_add_ps(_mm_mul_ps(s, a_src), _mm_mul_ps(_mm_mul_ps(d, a_dest), k));
+	const __m128 a_out = _mm_add_ps(a_src, _mm_mul_ps(a_dest, k));
+	const float a = _mm_cvtss_f32(a_out);
+	if (fabsf(a) > COLOR_EPSILON)
+		store(dest, with_alpha(_mm_mul_ps(c, _mm_set1_ps(1.f/a)), a_out));
+	else
+		dest = Color::alpha();
+}
+
+void blend_row_composite(Color *dest, const Color *src, int src_step, int count, float amount)
+{
+	const __m128 vamount = _mm_set1_ps(amount);
+	for(Color *end = dest + count; dest < end; ++dest, src += src_step) {
+		const __m128 s = load(*src), d = load(*dest);
+		composite(*dest, s, d, _mm_mul_ps(alpha(s), vamount), alpha(d));
+	}
+}
+
+void blend_row_onto(Color *dest, const Color *src, int src_step, int count, float amount)
+{
+	const __m128 vamount = _mm_set1_ps(amount);
+	const __m128 one = _mm_set1_ps(1.f);
+	for(Color *end = dest + count; dest < end; ++dest, src += src_step) {
+		const __m128 s = load(*src), d = load(*dest);
+		const float a = dest->get_a();
+		composite(*dest, s, d, _mm_mul_ps(alpha(s), vamount), one);
+		dest->set_a(a);
+	}
+}
+
+void blend_row_behind(Color *dest, const Color *src, int src_step, int count, float amount)
+{
+	const __m128 one = _mm_set1_ps(1.f);
+	for(Color *end = dest + count; dest < end; ++dest, src += src_step) {
+		Color a(*src);
+		if (a.get_a() == 0)
+			a.set_a(COLOR_EPSILON*amount);
+		else
+			a.set_a(a.get_a()*amount);
+		const __m128 s = load(*dest), d = load(a);
+		composite(*dest, s, d, _mm_mul_ps(alpha(s), one), alpha(d));
+	}
+}
+
+void blend_row_straight(Color *dest, const Color *src, int src_step, int count, float amount)
+{
+	const __m128 vamount = _mm_set1_ps(amount);
+	for(Color *end = dest + count; dest < end; ++dest, src += src_step) {
+		const __m128 s = load(*src), d = load(*dest);
+		const __m128 a_src = alpha(s), a_dest = alpha(d);
+		const __m128 a_out = _mm_add_ps(_mm_mul_ps(_mm_sub_ps(a_src, a_dest), vamount), a_dest);
+		const float a = _mm_cvtss_f32(a_out);
+		if (fabsf(a) > COLOR_EPSILON) {
+			const __m128 bg = _mm_mul_ps(d, a_dest);
+			const __m128 c = _mm_add_ps(_mm_mul_ps(_mm_sub_ps(_mm_mul_ps(s, a_src), bg), vamount), bg);
+			store(*dest, with_alpha(_mm_mul_ps(c, _mm_set1_ps(1.f/a)), a_out));
+		} else {
+			*dest = Color::alpha();
+		}
+	}
+}
+
+template<bool subtract>
+void blend_row_add(Color *dest, const Color *src, int src_step, int count, float amount)
+{
+	const __m128 vamount = _mm_set1_ps(amount);
+	for(Color *end = dest + count; dest < end; ++dest, src += src_step) {
+		const __m128 s = load(*src), d = load(*dest);
+		const __m128 a_src = _mm_mul_ps(alpha(s), vamount), a_dest = alpha(d);
+		const __m128 c = subtract
+		               ? _mm_sub_ps(_mm_mul_ps(d, a_dest), _mm_mul_ps(s, a_src))
+		               : _mm_add_ps(_mm_mul_ps(d, a_dest), _mm_mul_ps(s, a_src));
+		store(*dest, with_alpha(c, a_dest));
+	}
+}
+
+void blend_row_multiply(Color *dest, const Color *src, int src_step, int count, float amount)
+{
+	const __m128 one = _mm_set1_ps(1.f);
+	const bool invert = amount < 0;
+	if (invert) amount = -amount;
+	const __m128 vamount = _mm_set1_ps(amount);
+	for(Color *end = dest + count; dest < end; ++dest, src += src_step) {
+		__m128 s = load(*src);
+		const __m128 d = load(*dest);
+		if (invert) s = with_alpha(_mm_sub_ps(one, s), s);
+		const __m128 k = _mm_mul_ps(vamount, alpha(s));
+		const __m128 c = _mm_add_ps(_mm_mul_ps(_mm_sub_ps(_mm_mul_ps(d, s), d), k), d);
+		store(*dest, with_alpha(c, d));
+	}
+}
+
+#define BLEND_ROW_SSE2(name, func) func
+#else
+#define BLEND_ROW_SSE2(name, func) blend_row_generic<blendfunc_##name<Color> >
+#endif
+
+BlendRowFunc
+get_blend_row_func(Color::BlendMethod type)
+{
+	const static BlendRowFunc vtable[Color::BLEND_END] =
+	{
+		// WARNING: order should be the same as in Color::blend()
+		BLEND_ROW_SSE2(COMPOSITE, blend_row_composite),	// 0
+		BLEND_ROW_SSE2(STRAIGHT, blend_row_straight),
+		blend_row_generic<blendfunc_BRIGHTEN<Color> >,
+		blend_row_generic<blendfunc_DARKEN<Color> >,
+		BLEND_ROW_SSE2(ADD, blend_row_add<false>),
+		BLEND_ROW_SSE2(SUBTRACT, blend_row_add<true>),	// 5
+		BLEND_ROW_SSE2(MULTIPLY, blend_row_multiply),
+		blend_row_generic<blendfunc_DIVIDE<Color> >,
+		blend_row_generic<blendfunc_COLOR<Color> >,
+		blend_row_generic<blendfunc_HUE<Color> >,
+		blend_row_generic<blendfunc_SATURATION<Color> >,	// 10
+		blend_row_generic<blendfunc_LUMINANCE<Color> >,
+		BLEND_ROW_SSE2(BEHIND, blend_row_behind),
+		BLEND_ROW_SSE2(ONTO, blend_row_onto),
+		blend_row_generic<blendfunc_ALPHA_BRIGHTEN<Color> >,
+		blend_row_generic<blendfunc_ALPHA_DARKEN<Color> >,	// 15
+		blend_row_generic<blendfunc_SCREEN<Color> >,
+		blend_row_generic<blendfunc_HARD_LIGHT<Color> >,
+		blend_row_generic<blendfunc_DIFFERENCE<Color> >,
+		blend_row_generic<blendfunc_ALPHA_OVER<Color> >,
+		blend_row_generic<blendfunc_OVERLAY<Color> >,		// 20
+		blend_row_generic<blendfunc_STRAIGHT_ONTO<Color> >,
+		blend_row_generic<blendfunc_ADD_COMPOSITE<Color> >,
+	};
+
+	assert(type < Color::BLEND_END);
+	return vtable[type];
+}
+
+} // end of anonimous namespace
+
+
+void
+Color::blend_row(Color *dest, const Color *src, int count, float amount, Color::BlendMethod type)
+{
+	// see Color::blend()
+	if (count <= 0 || fabsf(amount) <= COLOR_EPSILON) return;
+	get_blend_row_func(type)(dest, src, 1, count, amount);
+}
+
+void
+Color::blend_row(Color *dest, const Color &src, int count, float amount, Color::BlendMethod type)
+{
+	if (count <= 0 || fabsf(amount) <= COLOR_EPSILON) return;
+	get_blend_row_func(type)(dest, &src, 0, count, amount);
+}
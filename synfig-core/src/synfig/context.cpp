@@ -111,6 +111,22 @@ IndependentContext::set_time(Time time, bool force)const
 	layer->set_time(context, time);
 }
 
+IndependentContext
+IndependentContext::snapshot(Time time, CanvasBase &out_queue)const
+{
+	out_queue.clear();
+	for(IndependentContext context(*this); *context; ++context)
+		if ((*context)->active())
+			if (Layer::Handle layer = (*context)->snapshot())
+				out_queue.push_back(layer);
+	out_queue.push_back(Layer::Handle());
+
+	IndependentContext context(out_queue.begin());
+	context.set_time(time, true);
+	context.load_resources(time, true);
+	return context;
+}
+
 void
 IndependentContext::load_resources(Time time, bool /*force*/)const
 {
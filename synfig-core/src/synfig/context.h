@@ -79,6 +79,13 @@ public:
 
 	//! Sets the context outline grow to \outline_grow. It is done recursively.
 	void set_outline_grow(Real outline_grow) const;
+
+	//! Fills \out_queue by snapshots of active layers of the context, sets them to the Time \time
+	//! and loads resources of snapshots (frames of animated imported images) for this time.
+	//! Layers of the context are not changed, so it may be called concurrently for different times.
+	//! Returned context is valid while \out_queue exists.
+	//! \see Layer::snapshot()
+	IndependentContext snapshot(Time time, CanvasBase &out_queue) const;
 };
 
 
@@ -150,6 +157,11 @@ public:
 	//! Get rendering parameters.
 	const ContextParams& get_params()const { return params; }
 
+	//! Makes snapshot of the context for the Time \time, rendering parameters are kept.
+	//! \see IndependentContext::snapshot()
+	Context snapshot(Time time, CanvasBase &out_queue) const
+		{ return Context(IndependentContext::snapshot(time, out_queue), params); }
+
 	//!	Returns the color of the context at the Point \pos.
 	//! It is the blended color of the context
 	Color get_color(const Point &pos)const;
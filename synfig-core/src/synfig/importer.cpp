@@ -63,6 +63,9 @@ using namespace synfig;
 Importer::Book* synfig::Importer::book_;
 
 static map<FileSystem::Identifier,Importer::LooseHandle> *__open_importers;
+//! guards __open_importers, importers may be opened and destroyed from several threads,
+//! recursive because destructor of importer is called from open() when its factory fails
+static RecMutex *__open_importers_mutex;
 
 /* === P R O C E D U R E S ================================================= */
 
@@ -73,6 +76,7 @@ Importer::subsys_init()
 {
 	book_=new Book();
 	__open_importers=new map<FileSystem::Identifier,Importer::LooseHandle>();
+	__open_importers_mutex=new RecMutex();
 	return true;
 }
 
@@ -81,6 +85,7 @@ Importer::subsys_stop()
 {
 	delete book_;
 	delete __open_importers;
+	delete __open_importers_mutex;
 	return true;
 }
 
@@ -101,6 +106,8 @@ Importer::open(const FileSystem::Identifier &identifier, bool force)
 		return 0;
 	}
 
+	Mutex::Lock lock(*__open_importers_mutex);
+
 	// If we already have an importer open under that filename,
 	// then use it instead.
 	if(__open_importers->count(identifier))
@@ -141,6 +148,7 @@ Importer::open(const FileSystem::Identifier &identifier, bool force)
 
 void Importer::forget(const FileSystem::Identifier &identifier)
 {
+	Mutex::Lock lock(*__open_importers_mutex);
 	__open_importers->erase(identifier);
 }
 
@@ -153,6 +161,7 @@ Importer::Importer(const FileSystem::Identifier &identifier):
 Importer::~Importer()
 {
 	// Remove ourselves from the open importer list
+	Mutex::Lock lock(*__open_importers_mutex);
 	map<FileSystem::Identifier,Importer::LooseHandle>::iterator iter;
 	for(iter=__open_importers->begin();iter!=__open_importers->end();)
 		if(iter->second==this)
@@ -162,6 +171,7 @@ Importer::~Importer()
 rendering::Surface::Handle
 Importer::get_frame(const RendDesc & /* renddesc */, const Time &time)
 {
+	Mutex::Lock lock(mutex_);
 	if (last_surface_ && last_surface_->is_exists() && !is_animated())
 		return last_surface_;
 
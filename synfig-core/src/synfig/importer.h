@@ -34,6 +34,7 @@
 #include <ETL/handle>
 
 #include "filesystem.h"
+#include "mutex.h"
 #include "progresscallback.h"
 #include "renddesc.h"
 #include "string.h"
@@ -147,6 +148,8 @@ public:
 
 private:
 	rendering::Surface::Handle last_surface_;
+	//! importers are shared by layers and their snapshots, which may load frames concurrently
+	Mutex mutex_;
 
 protected:
 
@@ -46,6 +46,7 @@
 #include "surface.h"
 #include "paramdesc.h"
 #include "transform.h"
+#include "valuenode_program.h"
 
 #include "layers/layer_composite.h"
 #include "layers/layer_bitmap.h"
@@ -380,6 +381,10 @@ Layer::on_changed()
 		printf("%s:%d Layer::on_changed()\n", __FILE__, __LINE__);
 
 	clear_time_mark();
+	{
+		Mutex::Lock lock(dynamic_param_program_mutex_);
+		dynamic_param_program_.reset();
+	}
 	Node::on_changed();
 }
 
@@ -403,6 +408,16 @@ Layer::set_param(const String &param, const ValueBase &value)
 	return false;
 }
 
+bool
+Layer::set_param(const String &param, ValueBase &&value)
+{
+	// parameters are imported by copy-assignment, which shares data of large values,
+	// so the data is released here to keep the parameter as the only owner
+	bool ret = set_param(param, (const ValueBase&)value);
+	value = ValueBase();
+	return ret;
+}
+
 etl::handle<Transform>
 Layer::get_transform()const
 {
@@ -434,7 +449,7 @@ Layer::get_true_z_depth()const
 Layer::Handle
 Layer::simple_clone()const
 {
-	if(!book().count(get_name())) return 0;
+	if(!book().count(get_name())) return Handle();
 	Handle ret = create(get_name()).get();
 	ret->group_=group_;
 	//ret->set_canvas(get_canvas());
@@ -451,7 +466,7 @@ Layer::simple_clone()const
 Layer::Handle
 Layer::clone(Canvas::LooseHandle canvas, const GUID& deriv_guid) const
 {
-	if(!book().count(get_name())) return 0;
+	if(!book().count(get_name())) return Handle();
 
 	//Layer *ret = book()[get_name()].factory();//create(get_name()).get();
 	Handle ret = create(get_name()).get();
@@ -524,12 +539,64 @@ Layer::clone(Canvas::LooseHandle canvas, const GUID& deriv_guid) const
 	return ret;
 }
 
+Layer::Handle
+Layer::snapshot()const
+{
+	if(!book().count(get_name())) return Handle();
+	Handle ret = create(get_name()).get();
+
+	RWLock::ReaderLock lock(get_rw_lock());
+
+	// don't use set_canvas(), it connects to signals of canvas
+	ret->canvas_ = canvas_;
+	ret->snapshot_source_ = snapshot_source_ ? snapshot_source_ : ConstHandle(this);
+	ret->set_description(get_description());
+	ret->set_active(active());
+	ret->set_optimized(optimized());
+	ret->set_exclude_from_rendering(get_exclude_from_rendering());
+
+	fill_snapshot_vfunc(*ret);
+
+	// canvases are copied by fill_snapshot_vfunc()
+	ParamList param_list(get_param_list());
+	for(ParamList::iterator i = param_list.begin(); i != param_list.end();)
+		if (i->second.get_type() == type_canvas) param_list.erase(i++); else ++i;
+	ret->set_param_list(param_list);
+
+	// parameters are actual for this time,
+	// set_param_list() resets marks, so they are assigned after it
+	ret->set_time_mark(get_time_mark());
+	ret->set_outline_grow_mark(get_outline_grow_mark());
+
+	return ret;
+}
+
+void
+Layer::fill_snapshot_vfunc(Layer &/*layer*/)const
+	{ }
+
 bool
 Layer::reads_context() const
 {
 	return false;
 }
 
+bool
+Layer::is_time_dependent() const
+{
+	const DynamicParamList &list = dynamic_param_list();
+	for(DynamicParamList::const_iterator i = list.begin(); i != list.end(); ++i)
+		if (i->second && i->second->is_time_dependent())
+			return true;
+	return is_time_dependent_vfunc();
+}
+
+bool
+Layer::is_time_dependent_vfunc() const
+{
+	return false;
+}
+
 Rect
 Layer::get_full_bounding_rect(Context context)const
 {
@@ -599,16 +666,48 @@ Layer::reset_version()
 	{ }
 
 
+ValueNodeProgram::Handle
+Layer::get_dynamic_param_program()const
+{
+	if (snapshot_source_)
+		return snapshot_source_->get_dynamic_param_program();
+
+	Mutex::Lock lock(dynamic_param_program_mutex_);
+	if (!dynamic_param_program_) {
+		dynamic_param_program_ = new ValueNodeProgram();
+		for(DynamicParamList::const_iterator i = dynamic_param_list_.begin(); i != dynamic_param_list_.end(); ++i)
+			dynamic_param_program_->add_output(i->first, i->second);
+	}
+	return dynamic_param_program_;
+}
+
 void
 Layer::set_time(IndependentContext context, Time time)const
 {
-	Layer::ParamList params;
-	Layer::DynamicParamList::const_iterator iter;
-	// For each parameter of the layer sets the time by the operator()(time)
-	for(iter=dynamic_param_list().begin();iter!=dynamic_param_list().end();iter++)
-		params[iter->first]=(*iter->second)(time);
-	// Sets the modified parameter list to the current context layer
-	const_cast<Layer*>(this)->set_param_list(params);
+	// Evaluates all dynamic params of the layer at once,
+	// value nodes linked several times are evaluated only once
+	// values of simple types are stored into the same ValueBase objects every time,
+	// set_time() of the same layer is not called concurrently, so buffer of layer is used
+	ValueNodeProgram::Handle program = get_dynamic_param_program();
+	std::vector<ValueBase> &values = dynamic_param_values_;
+	program->run(time, values);
+
+	// Sets the evaluated parameters to the current context layer
+	for(int i = 0; i < program->get_output_count(); ++i)
+	{
+		// snapshot has own copies of canvases
+		if (!snapshot_source_ || values[i].get_type() != type_canvas)
+		{
+			// don't keep copies of values which are not evaluated by program itself (lists, strings, etc)
+			if (program->get_output(i).reg < 0)
+				const_cast<Layer*>(this)->set_param(program->get_output(i).name, std::move(values[i]));
+			else
+				const_cast<Layer*>(this)->set_param(program->get_output(i).name, values[i]);
+		}
+		else
+		if (program->get_output(i).reg < 0)
+			values[i] = ValueBase();
+	}
 
 	set_time_mark(time);
 
@@ -905,10 +1004,18 @@ rendering::Task::Handle
 Layer::build_rendering_task_vfunc(Context context)const
 {
 	rendering::TaskLayer::Handle task = new rendering::TaskLayer();
-	// TODO: This is not thread-safe
-	//task->layer = const_cast<Layer*>(this);//clone(NULL);
-	task->layer = clone(NULL);
-	task->layer->set_canvas(get_canvas());
+	if (snapshot_source_)
+	{
+		// snapshots may be copied without locks and without changes of shared data
+		task->layer = snapshot();
+	}
+	else
+	{
+		// TODO: This is not thread-safe
+		//task->layer = const_cast<Layer*>(this);//clone(NULL);
+		task->layer = clone(NULL);
+		task->layer->set_canvas(get_canvas());
+	}
 
 	Real amount = Context::z_depth_visibility(context.get_params(), *this);
 	if (approximate_not_equal(amount, 1.0) && task->layer.type_is<Layer_Composite>())
@@ -30,6 +30,7 @@
 /* === H E A D E R S ======================================================= */
 
 #include <map>
+#include <vector>
 
 #include <ETL/handle>
 
@@ -184,6 +185,7 @@ class ContextParams;
 class IndependentContext;
 class Rect;
 class RendDesc;
+class ValueNodeProgram;
 class SoundProcessor;
 class Surface;
 class Transform;
@@ -298,6 +300,18 @@ private:
 	//! Map of parameter with animated value nodes
 	DynamicParamList dynamic_param_list_;
 
+	//! The layer which this layer is a snapshot of
+	//! \see Layer::snapshot()
+	ConstHandle snapshot_source_;
+
+	//! Dynamic params compiled into single program,
+	//! dropped when the layer or any of its value nodes is changed
+	//! \see get_dynamic_param_program()
+	mutable etl::handle<ValueNodeProgram> dynamic_param_program_;
+	mutable Mutex dynamic_param_program_mutex_;
+	//! Values evaluated by set_time(), kept to reuse their memory in the next call
+	mutable std::vector<ValueBase> dynamic_param_values_;
+
 	//! A description of what this layer does
 	String description_;
 
@@ -414,9 +428,11 @@ public:
 	//! Gets the name of the group that this layer belongs to
 	String get_group()const;
 
-	//! Retrieves the dynamic param list member
+	//! Retrieves the dynamic param list member,
+	//! snapshots share the dynamic param list of the source layer
 	//! \see DynamicParamList
-	const DynamicParamList &dynamic_param_list()const { return dynamic_param_list_; }
+	const DynamicParamList &dynamic_param_list()const
+		{ return snapshot_source_ ? snapshot_source_->dynamic_param_list_ : dynamic_param_list_; }
 
 	//! Enables the layer for rendering (Making it \em active)
 	void enable() { set_active(true); }
@@ -542,6 +558,10 @@ public:
 	*/
 	virtual bool set_param(const String &param, const ValueBase &value);
 
+	//!	Sets the parameter and releases \a value, so data of large values
+	//!	is not shared and the layer may reuse it when the parameter is set again
+	bool set_param(const String &param, ValueBase &&value);
+
 	//!	Sets a list of parameters
 	virtual bool set_param_list(const ParamList &);
 
@@ -616,6 +636,14 @@ protected:
 	virtual RendDesc get_sub_renddesc_vfunc(const RendDesc &renddesc) const;
 	virtual void get_sub_renddesc_vfunc(const RendDesc &renddesc, std::vector<RendDesc> &out_descs) const;
 
+	//! Copies the internal data, which is not available as parameters, into the new snapshot.
+	//! Called by snapshot() before copying of parameters.
+	virtual void fill_snapshot_vfunc(Layer &layer) const;
+
+	//! Returns true if the layer itself changes in time, even when parameters are static.
+	//! Called by is_time_dependent() after checking of dynamic parameters.
+	virtual bool is_time_dependent_vfunc() const;
+
 public:
 	void get_sub_renddesc(const RendDesc &renddesc, std::vector<RendDesc> &out_descs) const;
 	RendDesc get_sub_renddesc(const RendDesc &renddesc, int index = 0) const;
@@ -647,9 +675,36 @@ public:
 	**  context until the final blend operation. */
 	virtual bool reads_context()const;
 
+	//! Returns true if the layer may look different at different times
+	/*! The layer depends on time if any of its dynamic parameters depends
+	**  on time, or if is_time_dependent_vfunc() returns true. */
+	bool is_time_dependent()const;
+
 	//! Duplicates the Layer without duplicating the value nodes
 	virtual Handle simple_clone()const;
 
+	//! Makes a copy of the layer to evaluate it at any time without changing of this layer
+	/*!	Unlike clone() and simple_clone() the copy is not connected to value nodes
+	**	and canvas: parameters are evaluated by dynamic params of this layer,
+	**	inline canvases are replaced by snapshots of them.
+	**	So several snapshots may be made and evaluated concurrently.
+	**	Value nodes are shared with this layer, nodes with internal state
+	**	guard it (ValueNode_Dynamic, ValueNode_BoneInfluence, ValueNode_AnimatedFile).
+	**	Still not safe for concurrent use: the index of ValueNode_Duplicate
+	**	(Layer_Duplicate changes it under the mutex of the layer) and
+	**	the cached time sets of Node::get_times(), which are not used for rendering.
+	**	\see IndependentContext::snapshot()
+	*/
+	Handle snapshot()const;
+
+	//! Returns the layer which this layer is a snapshot of, or null if it is not a snapshot
+	const ConstHandle& get_snapshot_source()const { return snapshot_source_; }
+
+	//! Returns dynamic params compiled into program, which is used by set_time().
+	//! Program is built on demand and rebuilt only after changes of the layer
+	//! or its value nodes. Snapshots use the program of the source layer.
+	etl::handle<ValueNodeProgram> get_dynamic_param_program()const;
+
 	//! Connects the parameter to another Value Node
 	virtual bool connect_dynamic_param(const String& param, etl::loose_handle<ValueNode>);
 
@@ -627,6 +627,22 @@ Layer_Bitmap::get_bounding_rect()const
 	return Rect(tl,br);
 }
 
+void
+Layer_Bitmap::fill_snapshot_vfunc(Layer &layer)const
+{
+	Layer_Bitmap *bitmap = dynamic_cast<Layer_Bitmap*>(&layer);
+	if (!bitmap) return;
+
+	Mutex::Lock lock(mutex);
+	bitmap->surface_modification_id = surface_modification_id;
+	bitmap->rendering_surface = rendering_surface;
+	bitmap->trimmed = trimmed;
+	bitmap->left = left;
+	bitmap->top = top;
+	bitmap->width = width;
+	bitmap->height = height;
+}
+
 
 rendering::Task::Handle
 Layer_Bitmap::build_composite_task_vfunc(ContextParams /* context_params */) const
@@ -96,6 +96,8 @@ public:
 	
 protected:
 	virtual rendering::Task::Handle build_composite_task_vfunc(ContextParams context_params)const;
+	//! Shares the surface with the snapshot
+	virtual void fill_snapshot_vfunc(Layer &layer)const;
 }; // END of class Layer_Bitmap
 
 }; // END of namespace synfig
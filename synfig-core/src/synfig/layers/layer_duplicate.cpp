@@ -154,8 +154,8 @@ Layer_Duplicate::get_duplicate_param()const
 	const DynamicParamList &dpl = dynamic_param_list();
 	DynamicParamList::const_iterator iter = dpl.find("index");
 	if (iter == dpl.end()) return NULL;
-	etl::rhandle<ValueNode> param(iter->second);
-	return ValueNode_Duplicate::Handle::cast_dynamic(param);
+	// don't use rhandle here, it changes the shared value node and isn't thread-safe
+	return ValueNode_Duplicate::Handle::cast_dynamic(iter->second);
 }
 
 bool
@@ -269,17 +269,22 @@ Layer_Duplicate::build_rendering_task_vfunc(Context context) const
 
 	rendering::Task::Handle task;
 
-	Mutex::Lock lock(mutex);
+	// index is shared by the layer and all of its snapshots
+	const Layer_Duplicate *source = dynamic_cast<const Layer_Duplicate*>(get_snapshot_source().get());
+	Mutex::Lock lock(source ? source->mutex : mutex);
+
+	// Every copy is evaluated in own snapshot of context, so the context is not changed.
+	// Copies are built serially, because layers of the copy may evaluate
+	// the index again while building (see Layer_MotionBlur)
+	CanvasBase queue;
 	duplicate_param->reset_index(time_cur);
 	do
 	{
-		context.set_time(time_cur, true);
-
 		rendering::TaskBlend::Handle task_blend(new rendering::TaskBlend());
 		task_blend->amount = amount;
 		task_blend->blend_method = blend_method;
 		task_blend->sub_task_a() = task;
-		task_blend->sub_task_b() = context.build_rendering_task();
+		task_blend->sub_task_b() = context.snapshot(time_cur, queue).build_rendering_task();
 		task = task_blend;
 	}
 	while (duplicate_param->step(time_cur));
@@ -53,6 +53,8 @@ public:
 	virtual Vocab get_param_vocab()const;
 	//! Get the value of the specified parameter. \see Layer::get_param
 	virtual ValueBase get_param(const String & param)const;
+	//! Layers of the sub-canvas are applied to the context
+	virtual bool reads_context()const { return true; }
 
 protected:
 	virtual Context build_context_queue(Context context, CanvasBase &queue)const;
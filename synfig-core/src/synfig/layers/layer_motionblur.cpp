@@ -31,6 +31,7 @@
 #endif
 
 #include "layer_motionblur.h"
+#include "layer_composite_fork.h"
 
 #include <synfig/general.h>
 #include <synfig/localization.h>
@@ -44,8 +45,10 @@
 #include <synfig/time.h>
 #include <synfig/value.h>
 #include <synfig/valuenode.h>
+#include <synfig/threadpool.h>
 
 #include <synfig/rendering/common/task/taskblend.h>
+#include <synfig/rendering/common/task/taskmotionblur.h>
 
 #endif
 
@@ -57,6 +60,50 @@ using namespace std;
 
 /* === G L O B A L S ======================================================= */
 
+namespace {
+	//! builds task of the range [begin, end) of layers of the context,
+	//! end < 0 means the end of the context
+	rendering::Task::Handle build_range(Context context, int begin, int end)
+	{
+		for(int i = 0; i < begin && *context; ++i, ++context) { }
+		if (end < 0)
+			return context.build_rendering_task();
+
+		CanvasBase queue;
+		for(int i = begin; i < end && *context; ++i, ++context)
+			queue.push_back(*context);
+		queue.push_back(Layer::Handle());
+		return Context(queue.begin(), context).build_rendering_task();
+	}
+
+	//! returns true if the layer just paints over its context,
+	//! so the sum of subsamples of it may be painted over the context once
+	bool is_over(const Layer &layer)
+	{
+		const Layer_Composite *composite = dynamic_cast<const Layer_Composite*>(&layer);
+		return composite
+			&& !dynamic_cast<const Layer_CompositeFork*>(&layer)
+			&& !layer.reads_context()
+			&& composite->get_blend_method() == Color::BLEND_COMPOSITE;
+	}
+
+	struct Subsample {
+		Time time;
+		Real amount;
+		CanvasBase queue;
+		Context context;
+		rendering::Task::Handle task;
+		Subsample(): amount() { }
+	};
+
+	//! builds task of the snapshot of context, so subsamples may be built concurrently
+	void build_subsample(Context context, Subsample *subsample, int begin, int end)
+	{
+		subsample->context = context.snapshot(subsample->time, subsample->queue);
+		subsample->task = build_range(subsample->context, begin, end);
+	}
+} // end of anonimous namespace
+
 SYNFIG_LAYER_INIT(Layer_MotionBlur);
 SYNFIG_LAYER_SET_NAME(Layer_MotionBlur,"MotionBlur"); // todo: use motion_blur
 SYNFIG_LAYER_SET_LOCAL_NAME(Layer_MotionBlur,N_("Motion Blur"));
@@ -450,22 +497,83 @@ Layer_MotionBlur::build_rendering_task_vfunc(Context context) const
 		sum += scale;
 	}
 
-	Real k = 1.0/sum;
-	rendering::Task::Handle task;
-	for(int i = 0; i < samples; i++)
+	// Layers which don't depend on time (by parameters and value nodes) are static
+	// and rendered once (at the current time), when moving layers are painted over them
+	// or they are painted over the moving ones.
+	// Layers are indexed as in snapshots of the context, which contain active layers only.
+	vector<bool> over;
+	int first_moving = -1, last_moving = -1;
+	for(Context i = context; *i; ++i)
 	{
-		if (fabs(scales[i]*k) < 1e-8)
+		if (!(*i)->active())
 			continue;
+		if ((*i)->is_time_dependent())
+		{
+			if (first_moving < 0) first_moving = (int)over.size();
+			last_moving = (int)over.size();
+		}
+		over.push_back(!i.active() || is_over(**i));
+	}
+	int count = (int)over.size();
 
+	// nothing moves
+	if (last_moving < 0)
+		return context.build_rendering_task();
+
+	// range of blurred layers
+	int begin = first_moving, end = last_moving + 1;
+	for(int j = 0; j < count; ++j)
+	{
+		if (!over[j] && j < first_moving) begin = 0;
+		if (!over[j] && j >= first_moving && j <= last_moving) end = count;
+	}
+
+	Real k = 1.0/sum;
+	vector<Subsample> subsamples(samples);
+	for(int i = 0; i < samples; i++)
+	{
 		Real pos = (Real)i/(Real)(samples - 1);
 		Real ipos = 1.0 - pos;
-		context.set_time(get_time_mark() - aperture*ipos);
+		subsamples[i].time = get_time_mark() - aperture*ipos;
+		subsamples[i].amount = scales[i]*k;
+	}
 
+	// the last subsample is the current time, it's always added (even with zero weight),
+	// because draft and budget optimizers take it instead of the whole motion blur
+	Subsample &current_subsample = subsamples.back();
+
+	// context is not changed, every subsample evaluates own snapshot of it
+	ThreadPool::Group group;
+	for(vector<Subsample>::iterator i = subsamples.begin(); i != subsamples.end(); ++i)
+		if (fabs(i->amount) >= 1e-8 || &*i == &current_subsample)
+			group.enqueue(sigc::bind(sigc::ptr_fun(&build_subsample), context, &*i, begin, end < count ? end : -1));
+	group.run();
+
+	// subsamples are accumulated in one pass, order of them is kept,
+	// so result doesn't depend on count of threads
+	rendering::TaskMotionBlur::Handle task_motion_blur(new rendering::TaskMotionBlur());
+	for(vector<Subsample>::const_iterator i = subsamples.begin(); i != subsamples.end(); ++i)
+		if (fabs(i->amount) >= 1e-8 || &*i == &current_subsample)
+			task_motion_blur->add_subsample(i->task, i->amount);
+	rendering::Task::Handle task = task_motion_blur;
+
+	// static layers under the moving ones
+	if (end < count)
+	{
+		rendering::TaskBlend::Handle task_blend(new rendering::TaskBlend());
+		task_blend->blend_method = Color::BLEND_COMPOSITE;
+		task_blend->sub_task_a() = build_range(current_subsample.context, end, -1);
+		task_blend->sub_task_b() = task;
+		task = task_blend;
+	}
+
+	// static layers over the moving ones
+	if (begin > 0)
+	{
 		rendering::TaskBlend::Handle task_blend(new rendering::TaskBlend());
-		task_blend->amount = scales[i]*k;
-		task_blend->blend_method = Color::BLEND_ADD_COMPOSITE;
+		task_blend->blend_method = Color::BLEND_COMPOSITE;
 		task_blend->sub_task_a() = task;
-		task_blend->sub_task_b() = context.build_rendering_task();
+		task_blend->sub_task_b() = build_range(current_subsample.context, 0, begin);
 		task = task_blend;
 	}
 
@@ -322,6 +322,45 @@ Layer_PasteCanvas::set_time_vfunc(IndependentContext context, Time time)const
 	sub_canvas->set_time(time*time_dilation + time_offset);
 }
 
+void
+Layer_PasteCanvas::fill_snapshot_vfunc(Layer &layer)const
+{
+	// snapshots of the same layer may be made concurrently,
+	// so the member 'depth' cannot be used here
+	static thread_local int snapshot_depth = 0;
+
+	Layer_PasteCanvas *paste = dynamic_cast<Layer_PasteCanvas*>(&layer);
+	if (!paste || !sub_canvas || snapshot_depth == MAX_DEPTH)
+		return;
+	depth_counter counter(snapshot_depth);
+
+	// new inline canvas is not registered in the parent canvas,
+	// so the document will not be changed
+	Canvas::Handle canvas = layer.get_canvas()
+	                      ? Canvas::create_inline(layer.get_canvas())
+	                      : Canvas::create();
+	canvas->rend_desc() = sub_canvas->rend_desc();
+	for(IndependentContext i = sub_canvas->get_independent_context(); *i; ++i)
+		if ((*i)->active())
+			if (Layer::Handle sub_layer = (*i)->snapshot())
+				canvas->push_back_simple(sub_layer);
+	paste->set_sub_canvas(canvas);
+}
+
+bool
+Layer_PasteCanvas::is_time_dependent_vfunc()const
+{
+	static thread_local int time_dependent_depth = 0;
+
+	if (!sub_canvas)
+		return false;
+	// too deep recursion, so canvas may be a part of itself
+	if (time_dependent_depth == MAX_DEPTH)
+		return true;
+	depth_counter counter(time_dependent_depth);
+	return sub_canvas->is_time_dependent();
+}
+
 void
 Layer_PasteCanvas::load_resources_vfunc(IndependentContext context, Time time)const
 {
@@ -206,6 +206,12 @@ protected:
 	virtual void get_times_vfunc(Node::time_set &set) const;
 
 	virtual rendering::Task::Handle build_rendering_task_vfunc(Context context)const;
+
+	//! Replaces the canvas parameter of the snapshot by the snapshot of canvas
+	virtual void fill_snapshot_vfunc(Layer &layer)const;
+
+	//! The Paste Canvas Layer changes in time if any layer of the canvas does
+	virtual bool is_time_dependent_vfunc()const;
 }; // END of class Layer_PasteCanvas
 
 }; // END of namespace synfig
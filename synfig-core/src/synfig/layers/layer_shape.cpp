@@ -502,7 +502,7 @@ Layer_Shape::render_shape(Surface *surface, bool useblend, const RendDesc &rendd
 
 	rendering::software::Contour::render_contour(
 		*surface,
-		contour->get_chunks(),
+		*contour,
 		param_invert.get(bool(true)),
 		param_antialias.get(bool(true)),
 		(rendering::Contour::WindingStyle)param_winding_style.get(int()),
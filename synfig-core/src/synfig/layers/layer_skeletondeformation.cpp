@@ -41,6 +41,7 @@
 #include <synfig/time.h>
 #include <synfig/value.h>
 #include <synfig/valuenode.h>
+#include <synfig/threadpool.h>
 
 #include <synfig/rendering/common/task/taskblend.h>
 #include <synfig/rendering/common/task/tasklayer.h>
@@ -203,6 +204,17 @@ struct Layer_SkeletonDeformation::GridPoint {
 	}
 };
 
+struct Layer_SkeletonDeformation::BoneInfluence {
+	Bone::Shape shape;
+	Bone::Shape expanded_shape;
+	Real depth;
+	Matrix matrix;
+	//! range of grid points which may be affected by bone
+	int i0, j0, i1, j1;
+
+	inline BoneInfluence(): depth(), i0(), j0(), i1(), j1() { }
+};
+
 Real Layer_SkeletonDeformation::distance_to_line(const Vector &p0, const Vector &p1, const Vector &x)
 {
 	const Real epsilon = 1e-10;
@@ -224,6 +236,45 @@ Real Layer_SkeletonDeformation::distance_to_line(const Vector &p0, const Vector
 	return std::min(distance_to_line, std::min(distance_to_p0, distance_to_p1) );
 }
 
+void
+Layer_SkeletonDeformation::apply_bones(
+	const std::vector<BoneInfluence> *bones,
+	std::vector<GridPoint> *grid,
+	int grid_side_count_x,
+	int row_begin,
+	int row_end )
+{
+	static const Real precision = 1e-10;
+
+	for(std::vector<BoneInfluence>::const_iterator b = bones->begin(); b != bones->end(); ++b)
+	{
+		int j0 = std::max(row_begin, b->j0);
+		int j1 = std::min(row_end, b->j1);
+		for(int j = j0; j < j1; ++j)
+		{
+			GridPoint *row = &(*grid)[j*grid_side_count_x];
+			for(GridPoint *p = row + b->i0, *end = row + b->i1; p < end; ++p)
+			{
+				Real percent = Bone::distance_to_shape_center_percent(b->expanded_shape, p->initial_position);
+				if (percent > precision) {
+					Real distance = distance_to_line(b->shape.p0, b->shape.p1, p->initial_position);
+					if (distance < precision) distance = precision;
+					Real weight =
+						percent/(distance*distance);
+						// 1.0/distance;
+						// 1.0/(distance*distance);
+						// 1.0/(distance*distance*distance);
+						// exp(-4.0*distance);
+					p->summary_position += b->matrix.get_transformed(p->initial_position) * weight;
+					p->summary_depth += b->depth * weight;
+					p->summary_weight += weight;
+					p->used = true;
+				}
+			}
+		}
+	}
+}
+
 void
 Layer_SkeletonDeformation::prepare_mesh()
 {
@@ -251,22 +302,26 @@ Layer_SkeletonDeformation::prepare_mesh()
 				grid_p0[0] + i*grid_step_x,
 				grid_p0[1] + j*grid_step_y )));
 
-	// apply deformation
+	// collect bones and the ranges of grid points affected by them
+	std::vector<BoneInfluence> influences;
 	if (param_bones.can_get(ValueBase::List()))
 	{
 		const ValueBase::List &bones = param_bones.get_list();
+		influences.reserve(bones.size());
 		for(ValueBase::List::const_iterator i = bones.begin(); i != bones.end(); ++i)
 		{
 			if (i->can_get(BonePair()))
 			{
 				const BonePair &bone_pair = i->get(BonePair());
-				Bone::Shape shape0 = bone_pair.first.get_shape();
+				BoneInfluence b;
+				b.shape = bone_pair.first.get_shape();
 				Bone::Shape shape1 = bone_pair.second.get_shape();
-				Bone::Shape expandedShape0 = shape0;
-				expandedShape0.r0 += 2.0*grid_step_diagonal;
-				expandedShape0.r1 += 2.0*grid_step_diagonal;
-				Real depth = bone_pair.second.get_depth();
+				b.expanded_shape = b.shape;
+				b.expanded_shape.r0 += 2.0*grid_step_diagonal;
+				b.expanded_shape.r1 += 2.0*grid_step_diagonal;
+				b.depth = bone_pair.second.get_depth();
 
+				const Bone::Shape &shape0 = b.shape;
 				Matrix into_bone(
 					shape0.p1[0] - shape0.p0[0], shape0.p1[1] - shape0.p0[1], 0.0,
 					shape0.p0[1] - shape0.p1[1], shape0.p1[0] - shape0.p0[0], 0.0,
@@ -278,28 +333,71 @@ Layer_SkeletonDeformation::prepare_mesh()
 					shape1.p0[1] - shape1.p1[1], shape1.p1[0] - shape1.p0[0], 0.0,
 					shape1.p0[0], shape1.p0[1], 1.0
 				);
-				Matrix matrix = from_bone * into_bone;
-
-				for(std::vector<GridPoint>::iterator j = grid.begin(); j != grid.end(); ++j)
-				{
-					Real percent = Bone::distance_to_shape_center_percent(expandedShape0, j->initial_position);
-					if (percent > precision) {
-						Real distance = distance_to_line(shape0.p0, shape0.p1, j->initial_position);
-						if (distance < precision) distance = precision;
-						Real weight =
-							percent/(distance*distance);
-							// 1.0/distance;
-							// 1.0/(distance*distance);
-							// 1.0/(distance*distance*distance);
-							// exp(-4.0*distance);
-						j->summary_position += matrix.get_transformed(j->initial_position) * weight;
-						j->summary_depth += depth * weight;
-						j->summary_weight += weight;
-						j->used = true;
+				b.matrix = from_bone * into_bone;
+
+				// bone affects only points inside of its expanded shape,
+				// the shape is inside of bounds of its ends expanded by the max radius
+				Real r = std::max(fabs(b.expanded_shape.r0), fabs(b.expanded_shape.r1));
+				Rect bounds = Rect(b.shape.p0).expand(b.shape.p1);
+				int range[2][2] = { { 0, grid_side_count_x }, { 0, grid_side_count_y } };
+				const Real min[2] = { bounds.minx - r, bounds.miny - r };
+				const Real max[2] = { bounds.maxx + r, bounds.maxy + r };
+				const Real origin[2] = { grid_p0[0], grid_p0[1] };
+				const Real step[2] = { grid_step_x, grid_step_y };
+				for(int k = 0; k < 2; ++k) {
+					if (!std::isfinite(min[k]) || !std::isfinite(max[k]))
+						continue;
+					if (fabs(step[k]) <= precision) {
+						if (origin[k] < min[k] || origin[k] > max[k])
+							range[k][0] = range[k][1] = 0;
+						continue;
 					}
+					Real lo = (min[k] - origin[k])/step[k];
+					Real hi = (max[k] - origin[k])/step[k];
+					if (lo > hi) std::swap(lo, hi);
+					// one extra point at each side, there is no harm to check few more points
+					const Real count = range[k][1];
+					range[k][0] = (int)std::max(Real(0), std::min(count, floor(lo) - 1.0));
+					range[k][1] = (int)std::max(Real(0), std::min(count, ceil(hi) + 2.0));
 				}
+				b.i0 = range[0][0]; b.i1 = range[0][1];
+				b.j0 = range[1][0]; b.j1 = range[1][1];
+				if (b.i0 < b.i1 && b.j0 < b.j1)
+					influences.push_back(b);
+			}
+		}
+	}
+
+	// apply deformation,
+	// bands of rows are processed in parallel, but each point accumulates bones
+	// in the same order, so result doesn't depend on count of threads
+	if (!influences.empty())
+	{
+		Real work = 0.0;
+		std::vector<Real> row_work(grid_side_count_y, 0.0);
+		for(std::vector<BoneInfluence>::const_iterator i = influences.begin(); i != influences.end(); ++i)
+			for(int j = i->j0; j < i->j1; ++j)
+				{ row_work[j] += i->i1 - i->i0; work += i->i1 - i->i0; }
+
+		// about four bands per thread, but not too small
+		const Real chunk = std::max(
+			Real(16*1024),
+			work/(4*ThreadPool::instance.get_max_threads()) );
+		ThreadPool::Group group;
+		Real band_work = 0.0;
+		int band_begin = 0;
+		for(int j = 0; j < grid_side_count_y; ++j) {
+			band_work += row_work[j];
+			if (band_work >= chunk || j + 1 == grid_side_count_y) {
+				group.enqueue(
+					sigc::bind(sigc::ptr_fun(&Layer_SkeletonDeformation::apply_bones),
+						&influences, &grid, grid_side_count_x, band_begin, j + 1 ),
+					band_work/chunk );
+				band_begin = j + 1;
+				band_work = 0.0;
 			}
 		}
+		group.run();
 	}
 
 	// build vertices
@@ -59,7 +59,14 @@ private:
 	synfig::ValueBase param_y_subdivisions;
 
 	struct GridPoint;
+	struct BoneInfluence;
 	static Real distance_to_line(const Vector &p0, const Vector &p1, const Vector &x);
+	static void apply_bones(
+		const std::vector<BoneInfluence> *bones,
+		std::vector<GridPoint> *grid,
+		int grid_side_count_x,
+		int row_begin,
+		int row_end );
 
 public:
 	typedef std::pair<Bone, Bone> BonePair;
@@ -182,9 +182,8 @@ Layer_SolidColor::accelerated_render(Context context,Surface *surface,int qualit
 	apen.set_alpha(get_amount());
 	apen.set_blend_method(get_blend_method());
 
-	for(y=0;y<renddesc.get_h();y++,apen.inc_y(),apen.dec_x(x))
-		for(x=0;x<renddesc.get_w();x++,apen.inc_x())
-			apen.put_value();
+	for(y=0,x=renddesc.get_w();y<renddesc.get_h();y++,apen.inc_y(),apen.dec_x(x))
+		apen.put_hline(x);
 
 	// Mark our progress as finished
 	if(cb && !cb->amount_complete(10000,10000))
@@ -0,0 +1,167 @@
+/* === S Y N F I G ========================================================= */
+/*!	\file synfig/rendering/common/optimizer/optimizerbudget.cpp
+**	\brief OptimizerBudget
+**
+**	$Id$
+**
+**	\legal
+**	Copyright (c) 2019 Synfig Contributors
+**
+**	This package is free software; you can redistribute it and/or
+**	modify it under the terms of the GNU General Public License as
+**	published by the Free Software Foundation; either version 2 of
+**	the License, or (at your option) any later version.
+**
+**	This package is distributed in the hope that it will be useful,
+**	but WITHOUT ANY WARRANTY; without even the implied warranty of
+**	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+**	General Public License for more details.
+**	\endlegal
+*/
+/* ========================================================================= */
+
+/* === H E A D E R S ======================================================= */
+
+#ifdef USING_PCH
+#	include "pch.h"
+#else
+#ifdef HAVE_CONFIG_H
+#	include <config.h>
+#endif
+
+#include <algorithm>
+
+#include "optimizerbudget.h"
+
+#include "../task/taskcontour.h"
+#include "../task/taskblur.h"
+#include "../task/tasklayer.h"
+#include "../task/taskmotionblur.h"
+#include "../task/tasktransformation.h"
+
+#endif
+
+using namespace synfig;
+using namespace rendering;
+
+/* === M A C R O S ========================================================= */
+
+/* === G L O B A L S ======================================================= */
+
+/* === P R O C E D U R E S ================================================= */
+
+/* === M E T H O D S ======================================================= */
+
+OptimizerBudget::OptimizerBudget(int level):
+	level(level)
+{
+	category_id = CATEGORY_ID_BEGIN;
+	for_root_task = true;
+}
+
+Task::Handle
+OptimizerBudget::degrade(const Task::Handle &task, int level)
+{
+	if (!task)
+		return task;
+
+	// tasks are copied only when changed
+	Task::Handle result = task;
+
+	// motion blur renders the context several times, reduce count of subsamples,
+	// the last subsample is the current time
+	if (TaskMotionBlur::Handle motion_blur = TaskMotionBlur::Handle::cast_dynamic(task)) {
+		if (level >= 3 && !motion_blur->sub_tasks.empty())
+			return degrade(motion_blur->sub_tasks.back(), level);
+		int max_count = std::max(2, (int)motion_blur->sub_tasks.size() >> level);
+		if (max_count < (int)motion_blur->sub_tasks.size()) {
+			result = task->clone();
+			TaskMotionBlur::Handle::cast_dynamic(result)->reduce_subsamples(max_count);
+		}
+	}
+
+	for(int i = 0; i < (int)result->sub_tasks.size(); ++i) {
+		Task::Handle sub_task = degrade(result->sub_tasks[i], level);
+		if (sub_task != result->sub_tasks[i]) {
+			if (result == task) result = task->clone();
+			result->sub_tasks[i] = sub_task;
+		}
+	}
+
+	if (TaskLayer::Handle layer = TaskLayer::Handle::cast_dynamic(task)) {
+		// layers without own tasks are rendered by Layer::accelerated_render()
+		int quality = level >= 2 ? 9 : 7;
+		if (layer->quality < quality) {
+			if (result == task) result = task->clone();
+			TaskLayer::Handle::cast_dynamic(result)->quality = quality;
+		}
+	} else
+	if (TaskTransformation::Handle transformation = TaskTransformation::Handle::cast_dynamic(task)) {
+		if ( transformation->interpolation != Color::INTERPOLATION_NEAREST
+		  || approximate_greater_lp(transformation->supersample[0], 1.0)
+		  || approximate_greater_lp(transformation->supersample[1], 1.0) )
+		{
+			if (result == task) result = task->clone();
+			transformation = TaskTransformation::Handle::cast_dynamic(result);
+			transformation->interpolation = Color::INTERPOLATION_NEAREST;
+			transformation->supersample[0] = std::min(transformation->supersample[0], 1.0);
+			transformation->supersample[1] = std::min(transformation->supersample[1], 1.0);
+		}
+	} else
+	if (TaskBlur::Handle blur = TaskBlur::Handle::cast_dynamic(task)) {
+		if (level >= 2 && blur->blur.type != Blur::BOX && blur->blur.type != Blur::CROSS) {
+			if (result == task) result = task->clone();
+			TaskBlur::Handle::cast_dynamic(result)->blur.type = Blur::BOX;
+		}
+	} else
+	if (TaskContour::Handle contour = TaskContour::Handle::cast_dynamic(task)) {
+		if (level >= 2 && approximate_less_lp(contour->detail, 2.0)) {
+			if (result == task) result = task->clone();
+			TaskContour::Handle::cast_dynamic(result)->detail = 2.0;
+		}
+	}
+
+	return result;
+}
+
+Task::Handle
+OptimizerBudget::degrade_frame(const Task::Handle &root_task, int level)
+{
+	if (level <= 0 || !root_task || root_task.type_is<TaskSurface>())
+		return root_task;
+
+	Task::Handle task = degrade(root_task, level);
+
+	if (level >= 3) {
+		// render with lower resolution, see OptimizerDraftLowRes
+		Real scale = (Real)(1 << (level - 2));
+		Task::Handle sub_task = task == root_task ? task->clone() : task;
+
+		TaskTransformationAffine::Handle affine = new TaskTransformationAffine();
+		affine->sub_task() = sub_task;
+		affine->supersample = Vector(1.0/scale, 1.0/scale);
+		affine->interpolation = Color::INTERPOLATION_NEAREST;
+
+		// swap target
+		affine->assign_target(*sub_task);
+		sub_task->target_surface.reset();
+		sub_task->source_rect = Rect::infinite();
+		sub_task->target_rect = RectInt::zero();
+
+		task = affine;
+	}
+
+	return task;
+}
+
+void
+OptimizerBudget::run(const RunParams &params) const
+{
+	if (params.parent)
+		return;
+	Task::Handle task = degrade_frame(params.ref_task, level);
+	if (task != params.ref_task)
+		apply(params, task);
+}
+
+/* === E N T R Y P O I N T ================================================= */
@@ -0,0 +1,75 @@
+/* === S Y N F I G ========================================================= */
+/*!	\file synfig/rendering/common/optimizer/optimizerbudget.h
+**	\brief OptimizerBudget Header
+**
+**	$Id$
+**
+**	\legal
+**	Copyright (c) 2019 Synfig Contributors
+**
+**	This package is free software; you can redistribute it and/or
+**	modify it under the terms of the GNU General Public License as
+**	published by the Free Software Foundation; either version 2 of
+**	the License, or (at your option) any later version.
+**
+**	This package is distributed in the hope that it will be useful,
+**	but WITHOUT ANY WARRANTY; without even the implied warranty of
+**	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+**	General Public License for more details.
+**	\endlegal
+*/
+/* ========================================================================= */
+
+/* === S T A R T =========================================================== */
+
+#ifndef __SYNFIG_RENDERING_OPTIMIZERBUDGET_H
+#define __SYNFIG_RENDERING_OPTIMIZERBUDGET_H
+
+/* === H E A D E R S ======================================================= */
+
+#include "../../optimizer.h"
+
+/* === M A C R O S ========================================================= */
+
+/* === T Y P E D E F S ===================================================== */
+
+/* === C L A S S E S & S T R U C T S ======================================= */
+
+namespace synfig
+{
+namespace rendering
+{
+
+//! Lowers quality of the whole frame by the level chosen by RenderBudget.
+//! The level is fixed for optimizer, RendererBudgetSW reads it from RenderBudget once per frame
+//! and calls degrade_frame() directly, so all tasks of frame get the same quality:
+//!   level 1: transformations without supersampling and with nearest interpolation,
+//!            half of subsamples of motion blur, legacy layers with lower quality
+//!   level 2: box blur, contours with lower detail, quarter of subsamples of motion blur
+//!   level 3: half resolution, motion blur is skipped
+//!   level 4 and more: resolution is divided by 4, 8, etc
+class OptimizerBudget: public Optimizer
+{
+private:
+	int level;
+
+	static Task::Handle degrade(const Task::Handle &task, int level);
+
+public:
+	explicit OptimizerBudget(int level);
+
+	int get_level() const
+		{ return level; }
+
+	//! returns degraded copy of the root task, or the same task if nothing was changed
+	static Task::Handle degrade_frame(const Task::Handle &task, int level);
+
+	virtual void run(const RunParams &params) const;
+};
+
+} /* end namespace rendering */
+} /* end namespace synfig */
+
+/* -- E N D ----------------------------------------------------------------- */
+
+#endif
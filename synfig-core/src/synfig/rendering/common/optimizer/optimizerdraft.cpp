@@ -34,6 +34,7 @@
 #include "../task/taskcontour.h"
 #include "../task/taskblur.h"
 #include "../task/tasklayer.h"
+#include "../task/taskmotionblur.h"
 #include "../task/tasktransformation.h"
 
 #endif
@@ -154,6 +155,17 @@ OptimizerDraftBlur::run(const RunParams &params) const
 }
 
 
+// OptimizerDraftMotionBlur
+
+void
+OptimizerDraftMotionBlur::run(const RunParams &params) const
+{
+	if (TaskMotionBlur::Handle motion_blur = TaskMotionBlur::Handle::cast_dynamic(params.ref_task))
+		if (!motion_blur->sub_tasks.empty())
+			apply(params, motion_blur->sub_tasks.back());
+}
+
+
 // OptimizerDraftLayerRemove
 
 OptimizerDraftLayerRemove::OptimizerDraftLayerRemove(const String &layername):
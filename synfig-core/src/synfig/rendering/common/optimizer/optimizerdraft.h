@@ -82,6 +82,14 @@ public:
 };
 
 
+//! Renders the current time only instead of all subsamples of motion blur
+class OptimizerDraftMotionBlur: public OptimizerDraft
+{
+public:
+	virtual void run(const RunParams &params) const;
+};
+
+
 class OptimizerDraftLayerRemove: public OptimizerDraft
 {
 public:
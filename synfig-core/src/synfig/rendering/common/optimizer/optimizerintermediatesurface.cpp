@@ -0,0 +1,110 @@
+/* === S Y N F I G ========================================================= */
+/*!	\file synfig/rendering/common/optimizer/optimizerintermediatesurface.cpp
+**	\brief OptimizerIntermediateSurface
+**
+**	$Id$
+**
+**	\legal
+**	Copyright (c) 2019 Synfig Contributors
+**
+**	This package is free software; you can redistribute it and/or
+**	modify it under the terms of the GNU General Public License as
+**	published by the Free Software Foundation; either version 2 of
+**	the License, or (at your option) any later version.
+**
+**	This package is distributed in the hope that it will be useful,
+**	but WITHOUT ANY WARRANTY; without even the implied warranty of
+**	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+**	General Public License for more details.
+**	\endlegal
+*/
+/* ========================================================================= */
+
+
+/* === H E A D E R S ======================================================= */
+
+#ifdef USING_PCH
+#	include "pch.h"
+#else
+#ifdef HAVE_CONFIG_H
+#	include <config.h>
+#endif
+
+#include <set>
+
+#include "optimizerintermediatesurface.h"
+
+#include "../task/taskblend.h"
+#include "../task/taskblur.h"
+#include "../task/taskpixelprocessor.h"
+#include "../task/tasktransformation.h"
+
+#endif
+
+using namespace synfig;
+using namespace rendering;
+
+/* === M A C R O S ========================================================= */
+
+/* === G L O B A L S ======================================================= */
+
+/* === P R O C E D U R E S ================================================= */
+
+/* === M E T H O D S ======================================================= */
+
+OptimizerIntermediateSurface::OptimizerIntermediateSurface(const Surface::Token::Handle &token, int task_types):
+	token(token),
+	task_types(task_types)
+{
+	category_id = CATEGORY_ID_LIST;
+	depends_from = CATEGORY_SPECIALIZED;
+	for_list = true;
+}
+
+bool
+OptimizerIntermediateSurface::is_supported(const Task::Handle &task) const
+{
+	return ((task_types & TASKS_BLEND)          && task.type_is<TaskBlend>())
+	    || ((task_types & TASKS_BLUR)           && task.type_is<TaskBlur>())
+	    || ((task_types & TASKS_GAMMA)          && task.type_is<TaskPixelGamma>())
+	    || ((task_types & TASKS_TRANSFORMATION) && task.type_is<TaskTransformationAffine>());
+}
+
+void
+OptimizerIntermediateSurface::run(const RunParams &params) const
+{
+	if (!params.list || !token) return;
+
+	// find surfaces which are read by other tasks,
+	// surfaces given by caller are not intermediate and should not be changed,
+	// also skip surfaces which will be written by tasks without support of the intermediate surface
+	std::set<SurfaceResource::Handle> intermediate, skip;
+	for(Task::List::const_iterator i = params.list->begin(); i != params.list->end(); ++i)
+	{
+		if (!*i) continue;
+		if (!is_supported(*i))
+			skip.insert((*i)->target_surface);
+		for(Task::List::const_iterator j = (*i)->sub_tasks.begin(); j != (*i)->sub_tasks.end(); ++j)
+			if (*j && (*j)->target_surface && (*j)->target_surface != (*i)->target_surface)
+				intermediate.insert((*j)->target_surface);
+	}
+
+	for(Task::List::const_iterator i = params.list->begin(); i != params.list->end(); ++i)
+	{
+		if ( !*i
+		  || !(*i)->is_valid()
+		  || !is_supported(*i)
+		  || !intermediate.count((*i)->target_surface)
+		  || skip.count((*i)->target_surface) )
+			continue;
+
+		// create surface only in blank resource, so nothing will be converted
+		const SurfaceResource::Handle &surface = (*i)->target_surface;
+		if (!surface->is_blank() || surface->has_surface(token))
+			continue;
+		SurfaceResource::LockReadBase lock(surface);
+		lock.convert(token);
+	}
+}
+
+/* === E N T R Y P O I N T ================================================= */
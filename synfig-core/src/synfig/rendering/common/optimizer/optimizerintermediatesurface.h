@@ -0,0 +1,82 @@
+/* === S Y N F I G ========================================================= */
+/*!	\file synfig/rendering/common/optimizer/optimizerintermediatesurface.h
+**	\brief OptimizerIntermediateSurface Header
+**
+**	$Id$
+**
+**	\legal
+**	Copyright (c) 2019 Synfig Contributors
+**
+**	This package is free software; you can redistribute it and/or
+**	modify it under the terms of the GNU General Public License as
+**	published by the Free Software Foundation; either version 2 of
+**	the License, or (at your option) any later version.
+**
+**	This package is distributed in the hope that it will be useful,
+**	but WITHOUT ANY WARRANTY; without even the implied warranty of
+**	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+**	General Public License for more details.
+**	\endlegal
+*/
+/* ========================================================================= */
+
+/* === S T A R T =========================================================== */
+
+#ifndef __SYNFIG_RENDERING_OPTIMIZERINTERMEDIATESURFACE_H
+#define __SYNFIG_RENDERING_OPTIMIZERINTERMEDIATESURFACE_H
+
+/* === H E A D E R S ======================================================= */
+
+#include "../../optimizer.h"
+
+/* === M A C R O S ========================================================= */
+
+/* === T Y P E D E F S ===================================================== */
+
+/* === C L A S S E S & S T R U C T S ======================================= */
+
+namespace synfig
+{
+namespace rendering
+{
+
+//! Selects type of surfaces for intermediate results of blend, blur, gamma
+//! and affine transformation tasks (for example half-float surfaces to save memory),
+//! set of the task types is given by the TaskTypes flags.
+//! Surfaces of the given type are created in the target resources of such tasks,
+//! specialized tasks may write into them directly, other tasks will convert them.
+class OptimizerIntermediateSurface: public Optimizer
+{
+public:
+	//! types of tasks which can write into the surfaces directly
+	enum TaskTypes {
+		TASKS_BLEND          = 1 << 0,
+		TASKS_BLUR           = 1 << 1,
+		TASKS_GAMMA          = 1 << 2,
+		TASKS_TRANSFORMATION = 1 << 3,
+		TASKS_ALL            = TASKS_BLEND | TASKS_BLUR | TASKS_GAMMA | TASKS_TRANSFORMATION
+	};
+
+private:
+	Surface::Token::Handle token;
+	int task_types;
+
+	bool is_supported(const Task::Handle &task) const;
+
+public:
+	explicit OptimizerIntermediateSurface(const Surface::Token::Handle &token, int task_types = TASKS_ALL);
+
+	const Surface::Token::Handle& get_surface_token() const
+		{ return token; }
+	int get_task_types() const
+		{ return task_types; }
+
+	virtual void run(const RunParams &params) const;
+};
+
+} /* end namespace rendering */
+} /* end namespace synfig */
+
+/* -- E N D ----------------------------------------------------------------- */
+
+#endif
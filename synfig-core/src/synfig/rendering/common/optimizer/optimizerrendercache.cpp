@@ -0,0 +1,131 @@
+/* === S Y N F I G ========================================================= */
+/*!	\file synfig/rendering/common/optimizer/optimizerrendercache.cpp
+**	\brief OptimizerRenderCache
+**
+**	$Id$
+**
+**	\legal
+**	Copyright (c) 2019 Synfig Contributors
+**
+**	This package is free software; you can redistribute it and/or
+**	modify it under the terms of the GNU General Public License as
+**	published by the Free Software Foundation; either version 2 of
+**	the License, or (at your option) any later version.
+**
+**	This package is distributed in the hope that it will be useful,
+**	but WITHOUT ANY WARRANTY; without even the implied warranty of
+**	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+**	General Public License for more details.
+**	\endlegal
+*/
+/* ========================================================================= */
+
+/* === H E A D E R S ======================================================= */
+
+#ifdef USING_PCH
+#	include "pch.h"
+#else
+#ifdef HAVE_CONFIG_H
+#	include <config.h>
+#endif
+
+#include <cstdlib>
+
+#include <synfig/general.h>
+
+#include "optimizerrendercache.h"
+
+#include "../task/taskrendercache.h"
+
+#endif
+
+using namespace synfig;
+using namespace rendering;
+
+/* === M A C R O S ========================================================= */
+
+/* === G L O B A L S ======================================================= */
+
+/* === P R O C E D U R E S ================================================= */
+
+namespace {
+	size_t get_default_cache_size() {
+		if (const char *s = getenv("SYNFIG_RENDERING_CACHE_SIZE"))
+			return std::max(0, atoi(s))*(size_t)1024*(size_t)1024;
+		return 0;
+	}
+}
+
+/* === M E T H O D S ======================================================= */
+
+OptimizerRenderCache::OptimizerRenderCache():
+	OptimizerRenderCache(new RenderCache(get_default_cache_size()))
+{ }
+
+OptimizerRenderCache::OptimizerRenderCache(const RenderCache::Handle &cache):
+	cache(cache)
+{
+	category_id = CATEGORY_ID_COORDS;
+	depends_from = CATEGORY_BEGIN;
+	for_task = true;
+}
+
+OptimizerRenderCache::~OptimizerRenderCache()
+{
+	if (cache && cache->is_enabled() && getenv("SYNFIG_RENDERING_CACHE_STATISTICS"))
+		cache->log_statistics();
+}
+
+void
+OptimizerRenderCache::run(const RunParams& params) const
+{
+	if (!cache || !cache->is_enabled())
+		return;
+
+	// root tasks draws over the surface given by caller
+	if (!params.parent)
+		return;
+
+	// work with abstract tasks only, cache task cannot be inserted into specialized tree
+	const Task::Handle &task = params.ref_task;
+	if (!task || !task->is_valid() || !task->get_token()->is_abstract())
+		return;
+	if (task->target_surface == params.parent->ref_task->target_surface)
+		return;
+
+	// skip cache tasks and everything inside them
+	for(const RunParams *p = &params; p; p = p->parent)
+		if (TaskRenderCache::Handle::cast_dynamic(p->ref_task))
+			return;
+
+	Task::Hash hash;
+	if (!task->calc_hash(hash))
+		return;
+
+	TaskRenderCache::Handle cache_task(new TaskRenderCache());
+	cache_task->assign_target(*task);
+	cache_task->cache = cache;
+	cache_task->key = hash.get();
+	cache_task->cache_source_rect = task->source_rect;
+	cache_task->cache_target_rect = task->target_rect;
+	cache_task->cache_bounds = task->get_bounds();
+
+	if (SurfaceResource::Handle surface = cache->get(cache_task->key)) {
+		cache_task->surface = surface;
+		apply(params, cache_task);
+		return;
+	}
+
+	if (!cache->admit(cache_task->key))
+		return;
+
+	// move task to the own surface, so the result will not depend on anything outside the task
+	Task::Handle holder = task->clone();
+	holder->target_surface = new SurfaceResource();
+	holder->target_surface->create(task->target_surface->get_size());
+	cache_task->sub_task() = replace_target(holder, task);
+
+	apply(params, cache_task);
+}
+
+/* === E N T R Y P O I N T ================================================= */
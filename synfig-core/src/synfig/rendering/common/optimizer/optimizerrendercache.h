@@ -0,0 +1,70 @@
+/* === S Y N F I G ========================================================= */
+/*!	\file synfig/rendering/common/optimizer/optimizerrendercache.h
+**	\brief OptimizerRenderCache Header
+**
+**	$Id$
+**
+**	\legal
+**	Copyright (c) 2019 Synfig Contributors
+**
+**	This package is free software; you can redistribute it and/or
+**	modify it under the terms of the GNU General Public License as
+**	published by the Free Software Foundation; either version 2 of
+**	the License, or (at your option) any later version.
+**
+**	This package is distributed in the hope that it will be useful,
+**	but WITHOUT ANY WARRANTY; without even the implied warranty of
+**	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+**	General Public License for more details.
+**	\endlegal
+*/
+/* ========================================================================= */
+
+/* === S T A R T =========================================================== */
+
+#ifndef __SYNFIG_RENDERING_OPTIMIZERRENDERCACHE_H
+#define __SYNFIG_RENDERING_OPTIMIZERRENDERCACHE_H
+
+/* === H E A D E R S ======================================================= */
+
+#include "../../optimizer.h"
+#include "../rendercache.h"
+
+/* === M A C R O S ========================================================= */
+
+/* === T Y P E D E F S ===================================================== */
+
+/* === C L A S S E S & S T R U C T S ======================================= */
+
+namespace synfig
+{
+namespace rendering
+{
+
+//! Reuses results of unchanged subtrees between frames.
+//! Replaces the largest hashable subtrees (see Task::hash_params())
+//! by TaskRenderCache which loads result from the cache or stores it there.
+//! Cache size in megabytes is taken from SYNFIG_RENDERING_CACHE_SIZE environment variable,
+//! cache is disabled by default.
+class OptimizerRenderCache: public Optimizer
+{
+private:
+	RenderCache::Handle cache;
+
+public:
+	OptimizerRenderCache();
+	explicit OptimizerRenderCache(const RenderCache::Handle &cache);
+	~OptimizerRenderCache();
+
+	const RenderCache::Handle& get_cache() const
+		{ return cache; }
+
+	virtual void run(const RunParams &params) const;
+};
+
+} /* end namespace rendering */
+} /* end namespace synfig */
+
+/* -- E N D ----------------------------------------------------------------- */
+
+#endif
@@ -0,0 +1,148 @@
+/* === S Y N F I G ========================================================= */
+/*!	\file synfig/rendering/common/renderbudget.cpp
+**	\brief RenderBudget
+**
+**	$Id$
+**
+**	\legal
+**	Copyright (c) 2019 Synfig Contributors
+**
+**	This package is free software; you can redistribute it and/or
+**	modify it under the terms of the GNU General Public License as
+**	published by the Free Software Foundation; either version 2 of
+**	the License, or (at your option) any later version.
+**
+**	This package is distributed in the hope that it will be useful,
+**	but WITHOUT ANY WARRANTY; without even the implied warranty of
+**	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+**	General Public License for more details.
+**	\endlegal
+*/
+/* ========================================================================= */
+
+/* === H E A D E R S ======================================================= */
+
+#ifdef USING_PCH
+#	include "pch.h"
+#else
+#ifdef HAVE_CONFIG_H
+#	include <config.h>
+#endif
+
+#include <cmath>
+
+#include <glib.h>
+
+#include <synfig/general.h>
+
+#include "renderbudget.h"
+
+#endif
+
+using namespace synfig;
+using namespace rendering;
+
+/* === M A C R O S ========================================================= */
+
+/* === G L O B A L S ======================================================= */
+
+namespace {
+	//! expected ratio of frame time of the next level to the current one
+	const Real level_factor = 0.6;
+	//! weight of the last frame in the moving average of costs
+	const Real smoothing = 0.5;
+	//! finer level is chosen only when it fits into this part of the budget,
+	//! so the level will not jump back and forth at the boundary
+	const Real hysteresis = 0.8;
+}
+
+/* === P R O C E D U R E S ================================================= */
+
+/* === M E T H O D S ======================================================= */
+
+RenderBudget::RenderBudget(long long budget):
+	budget(budget),
+	level()
+{
+	for(int i = 0; i < LEVEL_COUNT; ++i)
+		costs[i] = 0.0;
+}
+
+Real
+RenderBudget::estimate(int level) const
+{
+	// mutex must be already locked
+	if (costs[level] > 0.0)
+		return costs[level];
+	for(int d = 1; d < LEVEL_COUNT; ++d) {
+		if (level - d >= 0 && costs[level - d] > 0.0)
+			return costs[level - d]*std::pow(level_factor, d);
+		if (level + d < LEVEL_COUNT && costs[level + d] > 0.0)
+			return costs[level + d]*std::pow(level_factor, -d);
+	}
+	return 0.0;
+}
+
+int
+RenderBudget::choose_level() const
+{
+	// mutex must be already locked
+	for(int i = 0; i < LEVEL_COUNT; ++i)
+		if (estimate(i) <= (i < level ? hysteresis : 1.0)*budget)
+			return i;
+	return LEVEL_COUNT - 1;
+}
+
+long long
+RenderBudget::get_budget() const
+	{ Glib::Threads::Mutex::Lock lock(mutex); return budget; }
+
+void
+RenderBudget::set_budget(long long budget)
+{
+	Glib::Threads::Mutex::Lock lock(mutex);
+	this->budget = budget;
+	level = choose_level();
+}
+
+int
+RenderBudget::get_level() const
+	{ Glib::Threads::Mutex::Lock lock(mutex); return level; }
+
+void
+RenderBudget::reset()
+{
+	Glib::Threads::Mutex::Lock lock(mutex);
+	for(int i = 0; i < LEVEL_COUNT; ++i)
+		costs[i] = 0.0;
+	level = 0;
+}
+
+void
+RenderBudget::frame_finished(int level, long long time)
+{
+	if (level < 0 || level >= LEVEL_COUNT || time <= 0)
+		return;
+
+	Glib::Threads::Mutex::Lock lock(mutex);
+	Real prev = costs[level];
+	Real cost = prev > 0.0 ? prev + smoothing*(time - prev) : (Real)time;
+
+	// complexity of the scene changes for all levels in the same way,
+	// keep ratios between levels
+	if (prev > 0.0)
+		for(int i = 0; i < LEVEL_COUNT; ++i)
+			if (i != level) costs[i] *= cost/prev;
+
+	costs[level] = cost;
+	this->level = choose_level();
+}
+
+void
+RenderBudget::frame_finished_func(bool success, RenderBudget::Handle budget, int level, long long begin_time)
+{
+	if (success && budget)
+		budget->frame_finished(level, g_get_monotonic_time() - begin_time);
+}
+
+/* === E N T R Y P O I N T ================================================= */
@@ -0,0 +1,95 @@
+/* === S Y N F I G ========================================================= */
+/*!	\file synfig/rendering/common/renderbudget.h
+**	\brief RenderBudget Header
+**
+**	$Id$
+**
+**	\legal
+**	Copyright (c) 2019 Synfig Contributors
+**
+**	This package is free software; you can redistribute it and/or
+**	modify it under the terms of the GNU General Public License as
+**	published by the Free Software Foundation; either version 2 of
+**	the License, or (at your option) any later version.
+**
+**	This package is distributed in the hope that it will be useful,
+**	but WITHOUT ANY WARRANTY; without even the implied warranty of
+**	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+**	General Public License for more details.
+**	\endlegal
+*/
+/* ========================================================================= */
+
+/* === S T A R T =========================================================== */
+
+#ifndef __SYNFIG_RENDERING_RENDERBUDGET_H
+#define __SYNFIG_RENDERING_RENDERBUDGET_H
+
+/* === H E A D E R S ======================================================= */
+
+#include <glibmm/threads.h>
+
+#include <ETL/handle>
+
+#include <synfig/real.h>
+
+/* === M A C R O S ========================================================= */
+
+/* === T Y P E D E F S ===================================================== */
+
+/* === C L A S S E S & S T R U C T S ======================================= */
+
+namespace synfig
+{
+namespace rendering
+{
+
+//! Chooses quality level of frames to fit the rendering time into the budget.
+//! Level 0 is the full quality, every next level is rougher (see OptimizerBudget).
+//! Measured time of finished frames is stored per level (moving average),
+//! levels which was not measured yet are estimated from the nearest measured one.
+//! All methods are thread-safe.
+class RenderBudget: public etl::shared_object
+{
+public:
+	typedef etl::handle<RenderBudget> Handle;
+
+	enum {
+		LEVEL_COUNT = 6
+	};
+
+private:
+	mutable Glib::Threads::Mutex mutex;
+	long long budget;             //!< target time of frame (microseconds)
+	int level;                    //!< level for the next frame
+	Real costs[LEVEL_COUNT];      //!< measured time of frame per level (microseconds), zero if unknown
+
+	Real estimate(int level) const;
+	int choose_level() const;
+
+public:
+	//! budget is the target time of frame in microseconds
+	explicit RenderBudget(long long budget);
+
+	long long get_budget() const;
+	void set_budget(long long budget);
+
+	//! level for the next frame
+	int get_level() const;
+
+	//! forget measured costs, for example when the document was changed
+	void reset();
+
+	//! stores measured time of frame rendered with the level
+	void frame_finished(int level, long long time);
+
+	// function to use in signals
+	static void frame_finished_func(bool success, RenderBudget::Handle budget, int level, long long begin_time);
+};
+
+} /* end namespace rendering */
+} /* end namespace synfig */
+
+/* -- E N D ----------------------------------------------------------------- */
+
+#endif
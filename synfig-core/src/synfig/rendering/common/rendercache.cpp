@@ -0,0 +1,181 @@
+/* === S Y N F I G ========================================================= */
+/*!	\file synfig/rendering/common/rendercache.cpp
+**	\brief RenderCache
+**
+**	$Id$
+**
+**	\legal
+**	Copyright (c) 2019 Synfig Contributors
+**
+**	This package is free software; you can redistribute it and/or
+**	modify it under the terms of the GNU General Public License as
+**	published by the Free Software Foundation; either version 2 of
+**	the License, or (at your option) any later version.
+**
+**	This package is distributed in the hope that it will be useful,
+**	but WITHOUT ANY WARRANTY; without even the implied warranty of
+**	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+**	General Public License for more details.
+**	\endlegal
+*/
+/* ========================================================================= */
+
+/* === H E A D E R S ======================================================= */
+
+#ifdef USING_PCH
+#	include "pch.h"
+#else
+#ifdef HAVE_CONFIG_H
+#	include <config.h>
+#endif
+
+#include <synfig/color.h>
+#include <synfig/general.h>
+
+#include "rendercache.h"
+
+#endif
+
+using namespace synfig;
+using namespace rendering;
+
+/* === M A C R O S ========================================================= */
+
+/* === G L O B A L S ======================================================= */
+
+/* === P R O C E D U R E S ================================================= */
+
+/* === M E T H O D S ======================================================= */
+
+RenderCache::RenderCache(size_t max_size):
+	max_size(max_size),
+	size(),
+	max_candidates(4096)
+{ }
+
+RenderCache::~RenderCache()
+	{ clear(); }
+
+void
+RenderCache::remove_entry(EntryList::iterator i)
+{
+	// mutex must be already locked
+	size -= i->size;
+	entries_map.erase(i->key);
+	entries.erase(i);
+}
+
+void
+RenderCache::shrink(size_t max_size)
+{
+	// mutex must be already locked
+	while(size > max_size && !entries.empty()) {
+		remove_entry(--entries.end());
+		++statistics.evictions;
+	}
+}
+
+size_t
+RenderCache::get_size() const
+	{ Glib::Threads::Mutex::Lock lock(mutex); return size; }
+
+size_t
+RenderCache::get_max_size() const
+	{ Glib::Threads::Mutex::Lock lock(mutex); return max_size; }
+
+void
+RenderCache::set_max_size(size_t max_size)
+{
+	Glib::Threads::Mutex::Lock lock(mutex);
+	this->max_size = max_size;
+	shrink(max_size);
+}
+
+SurfaceResource::Handle
+RenderCache::get(Key key)
+{
+	Glib::Threads::Mutex::Lock lock(mutex);
+	EntryMap::iterator i = entries_map.find(key);
+	if (i == entries_map.end())
+		{ ++statistics.misses; return SurfaceResource::Handle(); }
+	entries.splice(entries.begin(), entries, i->second);
+	++statistics.hits;
+	return i->second->surface;
+}
+
+bool
+RenderCache::admit(Key key)
+{
+	Glib::Threads::Mutex::Lock lock(mutex);
+	if (!max_size)
+		return false;
+
+	KeyMap::iterator i = candidates_map.find(key);
+	if (i != candidates_map.end()) {
+		candidates.erase(i->second);
+		candidates_map.erase(i);
+		return true;
+	}
+
+	candidates.push_front(key);
+	candidates_map[key] = candidates.begin();
+	while(candidates.size() > max_candidates) {
+		candidates_map.erase(candidates.back());
+		candidates.pop_back();
+	}
+	return false;
+}
+
+void
+RenderCache::put(Key key, const SurfaceResource::Handle &surface)
+{
+	if (!surface || !surface->is_exists())
+		return;
+
+	size_t surface_size = 0;
+	{
+		SurfaceResource::LockReadBase lock(surface);
+		if (!lock.convert(Surface::Token::Handle(), false, true))
+			return;
+		surface_size = lock.get_handle()->get_memory_size();
+	}
+
+	Glib::Threads::Mutex::Lock lock(mutex);
+	EntryMap::iterator i = entries_map.find(key);
+	if (i != entries_map.end())
+		remove_entry(i->second);
+	if (surface_size > max_size)
+		return;
+
+	shrink(max_size - surface_size);
+	entries.push_front(Entry(key, surface, surface_size));
+	entries_map[key] = entries.begin();
+	size += surface_size;
+	++statistics.stores;
+}
+
+void
+RenderCache::clear()
+{
+	Glib::Threads::Mutex::Lock lock(mutex);
+	entries_map.clear();
+	entries.clear();
+	candidates_map.clear();
+	candidates.clear();
+	size = 0;
+}
+
+RenderCache::Statistics
+RenderCache::get_statistics() const
+	{ Glib::Threads::Mutex::Lock lock(mutex); return statistics; }
+
+void
+RenderCache::log_statistics() const
+{
+	Statistics s = get_statistics();
+	info( "rendering cache: hits %lld, misses %lld, stores %lld, evictions %lld, size %.1fMb",
+		  s.hits, s.misses, s.stores, s.evictions,
+		  (double)get_size()/(1024.0*1024.0) );
+}
+
+/* === E N T R Y P O I N T ================================================= */
@@ -0,0 +1,129 @@
+/* === S Y N F I G ========================================================= */
+/*!	\file synfig/rendering/common/rendercache.h
+**	\brief RenderCache Header
+**
+**	$Id$
+**
+**	\legal
+**	Copyright (c) 2019 Synfig Contributors
+**
+**	This package is free software; you can redistribute it and/or
+**	modify it under the terms of the GNU General Public License as
+**	published by the Free Software Foundation; either version 2 of
+**	the License, or (at your option) any later version.
+**
+**	This package is distributed in the hope that it will be useful,
+**	but WITHOUT ANY WARRANTY; without even the implied warranty of
+**	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+**	General Public License for more details.
+**	\endlegal
+*/
+/* ========================================================================= */
+
+/* === S T A R T =========================================================== */
+
+#ifndef __SYNFIG_RENDERING_RENDERCACHE_H
+#define __SYNFIG_RENDERING_RENDERCACHE_H
+
+/* === H E A D E R S ======================================================= */
+
+#include <list>
+#include <map>
+
+#include <glibmm/threads.h>
+
+#include "../surface.h"
+
+/* === M A C R O S ========================================================= */
+
+/* === T Y P E D E F S ===================================================== */
+
+/* === C L A S S E S & S T R U C T S ======================================= */
+
+namespace synfig
+{
+namespace rendering
+{
+
+//! Bounded LRU storage of rendered surfaces, identified by hash of task tree.
+//! Surface stored only when the same key was requested at least twice,
+//! so subtrees which changes every frame will not wash out the cache.
+//! All methods are thread-safe.
+class RenderCache: public etl::shared_object
+{
+public:
+	typedef etl::handle<RenderCache> Handle;
+	typedef unsigned long long Key;
+
+	struct Statistics
+	{
+		long long hits;
+		long long misses;
+		long long stores;
+		long long evictions;
+		Statistics(): hits(), misses(), stores(), evictions() { }
+	};
+
+private:
+	struct Entry
+	{
+		Key key;
+		SurfaceResource::Handle surface;
+		size_t size;
+		Entry(): key(), size() { }
+		Entry(Key key, const SurfaceResource::Handle &surface, size_t size):
+			key(key), surface(surface), size(size) { }
+	};
+
+	typedef std::list<Entry> EntryList;
+	typedef std::map<Key, EntryList::iterator> EntryMap;
+	typedef std::list<Key> KeyList;
+	typedef std::map<Key, KeyList::iterator> KeyMap;
+
+	mutable Glib::Threads::Mutex mutex;
+
+	size_t max_size;
+	size_t size;
+	size_t max_candidates;
+
+	//! stored surfaces, most recently used first
+	EntryList entries;
+	EntryMap entries_map;
+	//! keys which was requested once, but not stored yet, most recent first
+	KeyList candidates;
+	KeyMap candidates_map;
+
+	Statistics statistics;
+
+	void remove_entry(EntryList::iterator i);
+	void shrink(size_t max_size);
+
+public:
+	explicit RenderCache(size_t max_size = 0);
+	~RenderCache();
+
+	//! returns size of stored pixels in bytes
+	size_t get_size() const;
+	size_t get_max_size() const;
+	void set_max_size(size_t max_size);
+	bool is_enabled() const
+		{ return get_max_size() > 0; }
+
+	//! returns stored surface or null, marks entry as recently used
+	SurfaceResource::Handle get(Key key);
+	//! returns true if key already was requested before and result should be stored
+	bool admit(Key key);
+	//! stores the surface, surface should not be changed after this call
+	void put(Key key, const SurfaceResource::Handle &surface);
+	void clear();
+
+	Statistics get_statistics() const;
+	void log_statistics() const;
+};
+
+} /* end namespace rendering */
+} /* end namespace synfig */
+
+/* -- E N D ----------------------------------------------------------------- */
+
+#endif
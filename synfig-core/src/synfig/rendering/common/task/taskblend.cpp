@@ -68,6 +68,13 @@ TaskBlend::get_pass_subtask_index() const
 	return PASSTO_THIS_TASK;
 }
 
+bool
+TaskBlend::hash_params(Hash &hash) const
+{
+	hash << blend_method << amount;
+	return true;
+}
+
 Rect
 TaskBlend::calc_bounds() const
 {
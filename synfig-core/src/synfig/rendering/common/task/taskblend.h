@@ -78,6 +78,7 @@ public:
 		blend_method(Color::BLEND_COMPOSITE), amount(1.0) { }
 
 	virtual int get_pass_subtask_index() const;
+	virtual bool hash_params(Hash &hash) const;
 
 	const Task::Handle& sub_task_a() const { return sub_task(0); }
 	Task::Handle& sub_task_a() { return sub_task(0); }
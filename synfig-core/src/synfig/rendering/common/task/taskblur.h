@@ -52,6 +52,8 @@ public:
 
 	virtual int get_pass_subtask_index() const
 		{ return sub_task() ? PASSTO_THIS_TASK : PASSTO_NO_TASK; }
+	virtual bool hash_params(Hash &hash) const
+		{ hash << blur.type << blur.size; return true; }
 
 	const Task::Handle& sub_task() const { return Task::sub_task(0); }
 	Task::Handle& sub_task() { return Task::sub_task(0); }
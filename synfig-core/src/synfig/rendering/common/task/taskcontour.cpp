@@ -57,4 +57,24 @@ TaskContour::calc_bounds() const
          :                   contour->calc_bounds(transformation->matrix);
 }
 
+bool
+TaskContour::hash_params(Hash &hash) const
+{
+	hash << detail << allow_antialias << transformation->matrix.m;
+	if (!contour)
+		{ hash << false; return true; }
+
+	const Contour::ChunkList &chunks = contour->get_chunks();
+	hash << true
+		 << contour->invert
+		 << contour->antialias
+		 << contour->winding_style
+		 << contour->color
+		 << contour->beginning_of_unclosed()
+		 << (int)chunks.size();
+	for(Contour::ChunkList::const_iterator i = chunks.begin(); i != chunks.end(); ++i)
+		hash << i->type << i->p1 << i->pp0 << i->pp1;
+	return true;
+}
+
 /* === E N T R Y P O I N T ================================================= */
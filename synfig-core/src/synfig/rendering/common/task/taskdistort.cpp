@@ -0,0 +1,139 @@
+/* === S Y N F I G ========================================================= */
+/*!	\file synfig/rendering/common/task/taskdistort.cpp
+**	\brief TaskDistort
+**
+**	$Id$
+**
+**	\legal
+**	Copyright (c) 2019 Synfig Contributors
+**
+**	This package is free software; you can redistribute it and/or
+**	modify it under the terms of the GNU General Public License as
+**	published by the Free Software Foundation; either version 2 of
+**	the License, or (at your option) any later version.
+**
+**	This package is distributed in the hope that it will be useful,
+**	but WITHOUT ANY WARRANTY; without even the implied warranty of
+**	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+**	General Public License for more details.
+**	\endlegal
+*/
+/* ========================================================================= */
+
+
+/* === H E A D E R S ======================================================= */
+
+#ifdef USING_PCH
+#	include "pch.h"
+#else
+#ifdef HAVE_CONFIG_H
+#	include <config.h>
+#endif
+
+#include <algorithm>
+#include <cmath>
+
+#include "taskdistort.h"
+
+#endif
+
+using namespace synfig;
+using namespace rendering;
+
+/* === M A C R O S ========================================================= */
+
+/* === G L O B A L S ======================================================= */
+
+/* === P R O C E D U R E S ================================================= */
+
+/* === M E T H O D S ======================================================= */
+
+
+Task::Token TaskDistort::token(
+	DescAbstract<TaskDistort>("Distort") );
+
+
+Rect
+TaskDistort::Distortion::map_rect(const Rect &rect, const Vector &pixel_size) const
+{
+	const int max_steps = 32;
+	if (!rect.is_valid() || rect.is_nan_or_inf())
+		return Rect::infinite();
+
+	Vector size = rect.get_size();
+	int steps_x = std::max(1, std::min(max_steps, (int)std::ceil(size[0]/std::max(std::fabs(pixel_size[0]), real_precision<Real>()))));
+	int steps_y = std::max(1, std::min(max_steps, (int)std::ceil(size[1]/std::max(std::fabs(pixel_size[1]), real_precision<Real>()))));
+	Vector step(size[0]/steps_x, size[1]/steps_y);
+
+	Rect bounds = Rect::zero();
+	bool first = true;
+	Point p;
+	for(int j = 0; j <= steps_y; ++j)
+		for(int i = 0; i <= steps_x; ++i)
+			if (map_visible(Point(rect.minx + i*step[0], rect.miny + j*step[1]), p)) {
+				if (first) bounds = Rect(p); else bounds.expand(p);
+				first = false;
+			}
+	if (first)
+		return Rect::zero();
+
+	// distortion may move some points between nodes of grid a bit farther
+	bounds.expand_x(step[0]);
+	bounds.expand_y(step[1]);
+	return bounds;
+}
+
+
+Rect
+TaskDistort::calc_bounds() const
+{
+	if (!sub_task() || !distortion)
+		return Rect::zero();
+	Rect bounds = sub_task()->get_bounds();
+	if (!bounds.is_valid())
+		return Rect::zero();
+	return distortion->map_bounds(bounds);
+}
+
+void
+TaskDistort::set_coords_sub_tasks()
+{
+	const int border = 4;
+	const Real max_scale = 4.0;
+
+	if (!sub_task())
+		{ trunc_to_zero(); return; }
+	if (!is_valid_coords() || !distortion)
+		{ sub_task()->set_coords_zero(); trunc_to_zero(); return; }
+
+	Rect rect = distortion->map_rect(source_rect, get_units_per_pixel());
+	rect &= sub_task()->get_bounds();
+	if (!rect.is_valid() || rect.is_nan_or_inf())
+		{ sub_task()->set_coords_zero(); return; }
+
+	// keep resolution of target, but don't allow too large sub-surface
+	Vector ppu = get_pixels_per_unit();
+	Vector size_real = ppu.multiply_coords(rect.get_size());
+	VectorInt target_size = target_rect.get_size();
+	for(int i = 0; i < 2; ++i)
+		size_real[i] = std::min(size_real[i], max_scale*std::max(target_size[i], 1));
+
+	VectorInt size( 2*border + (int)std::ceil(size_real[0]),
+	                2*border + (int)std::ceil(size_real[1]) );
+	Vector extra( 0.5*(size[0] - size_real[0])*rect.get_size()[0]/size_real[0],
+	              0.5*(size[1] - size_real[1])*rect.get_size()[1]/size_real[1] );
+	rect.expand_x(extra[0]);
+	rect.expand_y(extra[1]);
+	sub_task()->set_coords(rect, size);
+}
+
+bool
+TaskDistort::hash_params(Hash &hash) const
+{
+	if (!distortion || !distortion->hash_params(hash))
+		return false;
+	hash << interpolation;
+	return true;
+}
+
+/* === E N T R Y P O I N T ================================================= */
@@ -0,0 +1,98 @@
+/* === S Y N F I G ========================================================= */
+/*!	\file synfig/rendering/common/task/taskdistort.h
+**	\brief TaskDistort Header
+**
+**	$Id$
+**
+**	\legal
+**	Copyright (c) 2019 Synfig Contributors
+**
+**	This package is free software; you can redistribute it and/or
+**	modify it under the terms of the GNU General Public License as
+**	published by the Free Software Foundation; either version 2 of
+**	the License, or (at your option) any later version.
+**
+**	This package is distributed in the hope that it will be useful,
+**	but WITHOUT ANY WARRANTY; without even the implied warranty of
+**	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+**	General Public License for more details.
+**	\endlegal
+*/
+/* ========================================================================= */
+
+
+/* === S T A R T =========================================================== */
+
+#ifndef __SYNFIG_RENDERING_TASKDISTORT_H
+#define __SYNFIG_RENDERING_TASKDISTORT_H
+
+/* === H E A D E R S ======================================================= */
+
+#include "../../task.h"
+
+/* === M A C R O S ========================================================= */
+
+/* === T Y P E D E F S ===================================================== */
+
+/* === C L A S S E S & S T R U C T S ======================================= */
+
+namespace synfig
+{
+namespace rendering
+{
+
+//! Remaps pixels of sub-task by arbitrary function of point
+//! (twirl, noise distort and other layers which reads the context at the other point)
+class TaskDistort: public Task
+{
+public:
+	typedef etl::handle<TaskDistort> Handle;
+	static Token token;
+	virtual Token::Handle get_token() const { return token.handle(); }
+
+	//! Distortion is called simultaneously from several threads,
+	//! so it should keep own copy of all params and never refer to the layer
+	class Distortion: public etl::shared_object
+	{
+	public:
+		typedef etl::handle<Distortion> Handle;
+
+		virtual ~Distortion() { }
+
+		//! returns point of sub-task which should be visible at the given point
+		virtual Point map(const Point &point) const = 0;
+		//! returns false if nothing is visible at the given point (for example it is clipped),
+		//! otherwise writes mapped point to result, by default calls map()
+		virtual bool map_visible(const Point &point, Point &result) const
+			{ result = map(point); return true; }
+		//! returns bounds of result for the bounds of sub-task,
+		//! by default all points may be affected
+		virtual Rect map_bounds(const Rect & /* sub_bounds */) const
+			{ return Rect::infinite(); }
+		//! returns area of sub-task which required to draw the rect,
+		//! by default it is calculated by mapping of grid of points with step of pixel_size
+		virtual Rect map_rect(const Rect &rect, const Vector &pixel_size) const;
+		//! hash of params to allow render caching, see Task::hash_params()
+		virtual bool hash_params(Hash & /* hash */) const
+			{ return false; }
+	};
+
+	Distortion::Handle distortion;
+	Color::Interpolation interpolation;
+
+	TaskDistort(): interpolation(Color::INTERPOLATION_CUBIC) { }
+
+	const Task::Handle& sub_task() const { return Task::sub_task(0); }
+	Task::Handle& sub_task() { return Task::sub_task(0); }
+
+	virtual Rect calc_bounds() const;
+	virtual void set_coords_sub_tasks();
+	virtual bool hash_params(Hash &hash) const;
+};
+
+} /* end namespace rendering */
+} /* end namespace synfig */
+
+/* -- E N D ----------------------------------------------------------------- */
+
+#endif
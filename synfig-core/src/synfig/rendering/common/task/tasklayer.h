@@ -50,6 +50,10 @@ public:
 	virtual Token::Handle get_token() const { return token.handle(); }
 
 	Layer::Handle layer;
+	//! quality for Layer::accelerated_render(), 1 is the best and 10 is the roughest
+	int quality;
+
+	TaskLayer(): quality(4) { }
 
 	const Task::Handle& sub_task() const { return Task::sub_task(0); }
 	Task::Handle& sub_task() { return Task::sub_task(0); }
@@ -0,0 +1,128 @@
+/* === S Y N F I G ========================================================= */
+/*!	\file synfig/rendering/common/task/taskmotionblur.cpp
+**	\brief TaskMotionBlur
+**
+**	$Id$
+**
+**	\legal
+**	Copyright (c) 2019 Synfig Contributors
+**
+**	This package is free software; you can redistribute it and/or
+**	modify it under the terms of the GNU General Public License as
+**	published by the Free Software Foundation; either version 2 of
+**	the License, or (at your option) any later version.
+**
+**	This package is distributed in the hope that it will be useful,
+**	but WITHOUT ANY WARRANTY; without even the implied warranty of
+**	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+**	General Public License for more details.
+**	\endlegal
+*/
+/* ========================================================================= */
+
+/* === H E A D E R S ======================================================= */
+
+#ifdef USING_PCH
+#	include "pch.h"
+#else
+#ifdef HAVE_CONFIG_H
+#	include <config.h>
+#endif
+
+#include "taskmotionblur.h"
+
+#endif
+
+using namespace synfig;
+using namespace rendering;
+
+/* === M A C R O S ========================================================= */
+
+/* === G L O B A L S ======================================================= */
+
+/* === P R O C E D U R E S ================================================= */
+
+/* === M E T H O D S ======================================================= */
+
+
+Task::Token TaskMotionBlur::token(
+	DescAbstract<TaskMotionBlur>("MotionBlur") );
+
+
+void
+TaskMotionBlur::reduce_subsamples(int max_count)
+{
+	int count = (int)sub_tasks.size();
+	if (max_count < 1) max_count = 1;
+	if (count <= max_count)
+		return;
+
+	// every new subsample takes the nearest of old ones and sums weights of its neighbours,
+	// the last subsample is the current time, so it always remains
+	List new_sub_tasks(max_count);
+	std::vector<ColorReal> new_amounts(max_count, ColorReal(0.0));
+	for(int i = 0; i < count; ++i) {
+		int j = max_count > 1
+		      ? (int)round((Real)i*(Real)(max_count - 1)/(Real)(count - 1))
+		      : 0;
+		if (max_count == 1 || (int)round((Real)j*(Real)(count - 1)/(Real)(max_count - 1)) == i)
+			new_sub_tasks[j] = sub_tasks[i];
+		new_amounts[j] += get_amount(i);
+	}
+
+	sub_tasks.swap(new_sub_tasks);
+	amounts.swap(new_amounts);
+	reset_bounds();
+}
+
+void
+TaskMotionBlur::set_coords_sub_tasks()
+{
+	for(int i = 0; i < (int)sub_tasks.size(); ++i)
+		if (sub_tasks[i]) {
+			if (approximate_zero_lp(get_amount(i)))
+				sub_tasks[i]->set_coords_zero();
+			else
+				sub_tasks[i]->set_coords(source_rect, target_rect.get_size());
+		}
+}
+
+int
+TaskMotionBlur::get_pass_subtask_index() const
+{
+	int index = PASSTO_NO_TASK;
+	for(int i = 0; i < (int)sub_tasks.size(); ++i) {
+		if (!sub_tasks[i] || approximate_zero_lp(get_amount(i)))
+			continue;
+		if (index != PASSTO_NO_TASK)
+			return PASSTO_THIS_TASK;
+		index = i;
+	}
+	if (index >= 0 && !approximate_equal_lp(get_amount(index), ColorReal(1.0)))
+		return PASSTO_THIS_TASK;
+	return index;
+}
+
+bool
+TaskMotionBlur::hash_params(Hash &hash) const
+{
+	hash << (int)amounts.size();
+	for(std::vector<ColorReal>::const_iterator i = amounts.begin(); i != amounts.end(); ++i)
+		hash << *i;
+	return true;
+}
+
+Rect
+TaskMotionBlur::calc_bounds() const
+{
+	Rect bounds = Rect::zero();
+	for(int i = 0; i < (int)sub_tasks.size(); ++i) {
+		if (!sub_tasks[i] || approximate_zero_lp(get_amount(i))) continue;
+		Rect r = sub_tasks[i]->get_bounds();
+		if (!r.valid()) continue;
+		if (bounds.valid()) etl::set_union(bounds, bounds, r); else bounds = r;
+	}
+	return bounds;
+}
+
+/* === E N T R Y P O I N T ================================================= */
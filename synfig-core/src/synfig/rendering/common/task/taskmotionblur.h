@@ -0,0 +1,89 @@
+/* === S Y N F I G ========================================================= */
+/*!	\file synfig/rendering/common/task/taskmotionblur.h
+**	\brief TaskMotionBlur Header
+**
+**	$Id$
+**
+**	\legal
+**	Copyright (c) 2019 Synfig Contributors
+**
+**	This package is free software; you can redistribute it and/or
+**	modify it under the terms of the GNU General Public License as
+**	published by the Free Software Foundation; either version 2 of
+**	the License, or (at your option) any later version.
+**
+**	This package is distributed in the hope that it will be useful,
+**	but WITHOUT ANY WARRANTY; without even the implied warranty of
+**	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+**	General Public License for more details.
+**	\endlegal
+*/
+/* ========================================================================= */
+
+/* === S T A R T =========================================================== */
+
+#ifndef __SYNFIG_RENDERING_TASKMOTIONBLUR_H
+#define __SYNFIG_RENDERING_TASKMOTIONBLUR_H
+
+/* === H E A D E R S ======================================================= */
+
+#include <vector>
+
+#include "../../task.h"
+#include "tasktransformation.h"
+
+/* === M A C R O S ========================================================= */
+
+/* === T Y P E D E F S ===================================================== */
+
+/* === C L A S S E S & S T R U C T S ======================================= */
+
+namespace synfig
+{
+namespace rendering
+{
+
+//! Accumulates subsamples of motion blur (sub-tasks) in one pass.
+//! Result is the weighted sum of subsamples in premultiplied colors,
+//! equal to the chain of TaskBlend with BLEND_ADD_COMPOSITE,
+//! but intermediate surfaces of blends are not needed.
+//! Sub-tasks may be null (transparent subsamples).
+//! The last sub-task is the subsample at the current time, it may have zero weight,
+//! subsamples with zero weight are not rendered.
+class TaskMotionBlur: public Task,
+	public TaskInterfaceTransformationPass,
+	public TaskInterfaceSplit
+{
+public:
+	typedef etl::handle<TaskMotionBlur> Handle;
+	static Token token;
+	virtual Token::Handle get_token() const { return token.handle(); }
+
+	//! weights of subsamples, one per sub-task
+	std::vector<ColorReal> amounts;
+
+	ColorReal get_amount(int index) const
+		{ return index >= 0 && index < (int)amounts.size() ? amounts[index] : ColorReal(0.0); }
+
+	//! appends the subsample
+	void add_subsample(const Task::Handle &task, ColorReal amount)
+		{ sub_tasks.push_back(task); amounts.push_back(amount); }
+
+	//! leaves count of subsamples not greater than max_count,
+	//! removed subsamples are distributed uniformly over the aperture
+	//! and their weights are given to the nearest remaining subsamples
+	void reduce_subsamples(int max_count);
+
+	virtual void set_coords_sub_tasks();
+	virtual int get_pass_subtask_index() const;
+	virtual bool hash_params(Hash &hash) const;
+	virtual Rect calc_bounds() const;
+};
+
+
+} /* end namespace rendering */
+} /* end namespace synfig */
+
+/* -- E N D ----------------------------------------------------------------- */
+
+#endif
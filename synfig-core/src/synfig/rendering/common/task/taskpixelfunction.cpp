@@ -0,0 +1,73 @@
+/* === S Y N F I G ========================================================= */
+/*!	\file synfig/rendering/common/task/taskpixelfunction.cpp
+**	\brief TaskPixelFunction
+**
+**	$Id$
+**
+**	\legal
+**	Copyright (c) 2019 Synfig Contributors
+**
+**	This package is free software; you can redistribute it and/or
+**	modify it under the terms of the GNU General Public License as
+**	published by the Free Software Foundation; either version 2 of
+**	the License, or (at your option) any later version.
+**
+**	This package is distributed in the hope that it will be useful,
+**	but WITHOUT ANY WARRANTY; without even the implied warranty of
+**	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+**	General Public License for more details.
+**	\endlegal
+*/
+/* ========================================================================= */
+
+
+/* === H E A D E R S ======================================================= */
+
+#ifdef USING_PCH
+#	include "pch.h"
+#else
+#ifdef HAVE_CONFIG_H
+#	include <config.h>
+#endif
+
+#include "taskpixelfunction.h"
+
+#endif
+
+using namespace synfig;
+using namespace rendering;
+
+/* === M A C R O S ========================================================= */
+
+/* === G L O B A L S ======================================================= */
+
+/* === P R O C E D U R E S ================================================= */
+
+/* === M E T H O D S ======================================================= */
+
+
+Task::Token TaskPixelFunction::token(
+	DescAbstract<TaskPixelFunction>("PixelFunction") );
+
+
+Rect
+TaskPixelFunction::calc_bounds() const
+{
+	if (!function)
+		return Rect::zero();
+	Rect bounds = function->get_bounds();
+	if (!bounds.is_valid() || bounds.is_full_infinite())
+		return bounds;
+	return transformation->transform_bounds(bounds).rect;
+}
+
+bool
+TaskPixelFunction::hash_params(Hash &hash) const
+{
+	if (!function || !function->hash_params(hash))
+		return false;
+	hash << transformation->matrix.m;
+	return true;
+}
+
+/* === E N T R Y P O I N T ================================================= */
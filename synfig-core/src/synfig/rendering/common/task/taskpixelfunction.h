@@ -0,0 +1,90 @@
+/* === S Y N F I G ========================================================= */
+/*!	\file synfig/rendering/common/task/taskpixelfunction.h
+**	\brief TaskPixelFunction Header
+**
+**	$Id$
+**
+**	\legal
+**	Copyright (c) 2019 Synfig Contributors
+**
+**	This package is free software; you can redistribute it and/or
+**	modify it under the terms of the GNU General Public License as
+**	published by the Free Software Foundation; either version 2 of
+**	the License, or (at your option) any later version.
+**
+**	This package is distributed in the hope that it will be useful,
+**	but WITHOUT ANY WARRANTY; without even the implied warranty of
+**	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+**	General Public License for more details.
+**	\endlegal
+*/
+/* ========================================================================= */
+
+
+/* === S T A R T =========================================================== */
+
+#ifndef __SYNFIG_RENDERING_TASKPIXELFUNCTION_H
+#define __SYNFIG_RENDERING_TASKPIXELFUNCTION_H
+
+/* === H E A D E R S ======================================================= */
+
+#include "../../task.h"
+#include "../../primitive/transformationaffine.h"
+#include "tasktransformation.h"
+
+/* === M A C R O S ========================================================= */
+
+/* === T Y P E D E F S ===================================================== */
+
+/* === C L A S S E S & S T R U C T S ======================================= */
+
+namespace synfig
+{
+namespace rendering
+{
+
+//! Draws color calculated for each pixel by function of point
+//! (gradients, noise and other layers which does not read the context)
+class TaskPixelFunction: public Task, public TaskInterfaceTransformation
+{
+public:
+	typedef etl::handle<TaskPixelFunction> Handle;
+	static Token token;
+	virtual Token::Handle get_token() const { return token.handle(); }
+
+	//! Function is called simultaneously from several threads,
+	//! so it should keep own copy of all params and never refer to the layer
+	class Function: public etl::shared_object
+	{
+	public:
+		typedef etl::handle<Function> Handle;
+
+		virtual ~Function() { }
+
+		//! returns color at point,
+		//! pixel_size is a size of pixel in units of point (may be used for supersampling)
+		virtual Color get_color(const Point &point, const Vector &pixel_size) const = 0;
+		//! bounds of non-transparent area
+		virtual Rect get_bounds() const
+			{ return Rect::infinite(); }
+		//! hash of params to allow render caching, see Task::hash_params()
+		virtual bool hash_params(Hash & /* hash */) const
+			{ return false; }
+	};
+
+	Function::Handle function;
+	Holder<TransformationAffine> transformation;
+
+	virtual Rect calc_bounds() const;
+	virtual bool hash_params(Hash &hash) const;
+
+	virtual const Transformation::Handle get_transformation() const
+		{ return transformation.handle(); }
+};
+
+} /* end namespace rendering */
+} /* end namespace synfig */
+
+/* -- E N D ----------------------------------------------------------------- */
+
+#endif
@@ -95,6 +95,9 @@ public:
 	Gamma gamma;
 	TaskPixelGamma() { }
 
+	virtual bool hash_params(Hash &hash) const
+		{ hash << gamma.get_r() << gamma.get_g() << gamma.get_b(); return true; }
+
 	virtual bool is_transparent() const
 	{
 		return approximate_equal_lp(gamma.get_r(), ColorReal(1.0))
@@ -113,6 +116,9 @@ public:
 
 	ColorMatrix matrix;
 
+	virtual bool hash_params(Hash &hash) const
+		{ hash << matrix.c; return true; }
+
 	virtual bool is_zero() const
 		{ return matrix.is_transparent(); }
 	virtual bool is_transparent() const
@@ -0,0 +1,91 @@
+/* === S Y N F I G ========================================================= */
+/*!	\file synfig/rendering/common/task/taskrendercache.h
+**	\brief TaskRenderCache Header
+**
+**	$Id$
+**
+**	\legal
+**	Copyright (c) 2019 Synfig Contributors
+**
+**	This package is free software; you can redistribute it and/or
+**	modify it under the terms of the GNU General Public License as
+**	published by the Free Software Foundation; either version 2 of
+**	the License, or (at your option) any later version.
+**
+**	This package is distributed in the hope that it will be useful,
+**	but WITHOUT ANY WARRANTY; without even the implied warranty of
+**	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+**	General Public License for more details.
+**	\endlegal
+*/
+/* ========================================================================= */
+
+/* === S T A R T =========================================================== */
+
+#ifndef __SYNFIG_RENDERING_TASKRENDERCACHE_H
+#define __SYNFIG_RENDERING_TASKRENDERCACHE_H
+
+/* === H E A D E R S ======================================================= */
+
+#include "../../task.h"
+#include "../rendercache.h"
+
+/* === M A C R O S ========================================================= */
+
+/* === T Y P E D E F S ===================================================== */
+
+/* === C L A S S E S & S T R U C T S ======================================= */
+
+namespace synfig
+{
+namespace rendering
+{
+
+//! Created by OptimizerRenderCache.
+//! When sub-task is set, then task copies result of sub-task into the target
+//! and stores it in the cache. Otherwise it copies the previously cached surface.
+class TaskRenderCache: public Task
+{
+public:
+	typedef etl::handle<TaskRenderCache> Handle;
+	static Token token;
+	virtual Token::Handle get_token() const { return token.handle(); }
+
+	RenderCache::Handle cache;
+	RenderCache::Key key;
+
+	//! cached surface, used when there is no sub-task
+	SurfaceResource::Handle surface;
+
+	//! coordinates and bounds of the cached task,
+	//! pixel (0, 0) of the cached surface corresponds to cache_target_rect.get_min()
+	Rect cache_source_rect;
+	RectInt cache_target_rect;
+	Rect cache_bounds;
+
+	TaskRenderCache(): key() { }
+
+	const Task::Handle& sub_task() const { return Task::sub_task(0); }
+	Task::Handle& sub_task() { return Task::sub_task(0); }
+
+	//! offset of pixels of cached surface relative to the target
+	VectorInt get_offset() const;
+
+	virtual int get_pass_subtask_index() const
+		{ return surface || sub_task() ? PASSTO_THIS_TASK : PASSTO_NO_TASK; }
+
+	virtual Rect calc_bounds() const
+		{ return cache_bounds; }
+
+	//! coordinates of sub-task is a part of the key and should not be changed
+	virtual void set_coords_sub_tasks()
+		{ }
+};
+
+
+} /* end namespace rendering */
+} /* end namespace synfig */
+
+/* -- E N D ----------------------------------------------------------------- */
+
+#endif
@@ -134,6 +134,13 @@ TaskTransformation::set_coords_sub_tasks()
 }
 
 
+bool
+TaskTransformationAffine::hash_params(Hash &hash) const
+{
+	hash << interpolation << supersample << transformation->matrix.m;
+	return true;
+}
+
 int
 TaskTransformationAffine::get_pass_subtask_index() const
 {
@@ -99,6 +99,7 @@ public:
 		{ return transformation.handle(); }
 
 	virtual int get_pass_subtask_index() const;
+	virtual bool hash_params(Hash &hash) const;
 };
 
 
@@ -30,6 +30,7 @@
 #endif
 
 #include <algorithm>
+#include <cmath>
 
 #include <synfig/general.h>
 
@@ -53,6 +54,55 @@ using namespace rendering;
 
 class Contour::Helper {
 public:
+	enum {
+		polyline_max_segments = 1024,  //!< per one curve
+		polyline_max_levels = 8,       //!< count of cached polylines per contour
+		polyline_min_level = -60,
+		polyline_max_level = 60
+	};
+
+	//! count of segments of uniform subdivision,
+	//! error_factor/count^2 is the max distance between curve and segments
+	static int segments_count(Real error_factor, Real tolerance)
+	{
+		Real count = ceil(sqrt(error_factor/tolerance));
+		return !(count >= 1) ? 1
+		     : count > polyline_max_segments ? (int)polyline_max_segments
+		     : (int)count;
+	}
+
+	static void conic_flatten(std::vector<Vector> &points, const Vector &p0, const Vector &p1, const Vector &pp0, Real tolerance)
+	{
+		int count = segments_count(0.25*(p0 - pp0*2.0 + p1).mag(), tolerance);
+		for(int i = 1; i < count; ++i) {
+			Real t = (Real)i/(Real)count, s = 1.0 - t;
+			points.push_back(p0*(s*s) + pp0*(2.0*s*t) + p1*(t*t));
+		}
+		points.push_back(p1);
+	}
+
+	static void cubic_flatten(std::vector<Vector> &points, const Vector &p0, const Vector &p1, const Vector &pp0, const Vector &pp1, Real tolerance)
+	{
+		Real m = std::max( (p0 - pp0*2.0 + pp1).mag(),
+		                   (pp0 - pp1*2.0 + p1).mag() );
+		int count = segments_count(0.75*m, tolerance);
+		for(int i = 1; i < count; ++i) {
+			Real t = (Real)i/(Real)count, s = 1.0 - t;
+			points.push_back(p0*(s*s*s) + pp0*(3.0*s*s*t) + pp1*(3.0*s*t*t) + p1*(t*t*t));
+		}
+		points.push_back(p1);
+	}
+
+	//! finish subpath started from point with index 'first', subpaths with less than two points are dropped
+	static void polyline_end(Polyline &polyline, int first)
+	{
+		if ((int)polyline.points.size() - first < 2)
+			polyline.points.resize(first);
+		else
+			polyline.ends.push_back((int)polyline.points.size());
+	}
+
+
 	template<typename T>
 	struct SplitParams {
 		typedef T ContourType;
@@ -296,6 +346,7 @@ Contour::touch_chunks()
 	autocurve_end = false;
 	bounds_calculated = false;
 	intersector.reset();
+	polylines.clear();
 }
 
 void
@@ -461,6 +512,11 @@ Contour::assign(const Contour &other)
 		Mutex::Lock lock(other.intersector_read_mutex);
 		intersector = other.intersector;
 	}
+	{
+		// polylines are never modified after creation, so they may be shared
+		Mutex::Lock lock(other.polylines_read_mutex);
+		polylines = other.polylines;
+	}
 }
 
 void
@@ -582,12 +638,23 @@ Contour::calc_bounds(const Matrix &transform_matrix) const
 	return bounds;
 }
 
+Real
+Contour::get_default_tolerance() const
+{
+	Rect b = calc_bounds();
+	return std::max(1e-8, std::max(b.maxx - b.minx, b.maxy - b.miny)/1024.0);
+}
+
 Rect
 Contour::get_bounds() const
 {
 	Mutex::Lock lock(bounds_read_mutex);
 	if (!bounds_calculated) {
-		bounds = calc_bounds();
+		// bounds of polyline expanded by its tolerance contains all curves
+		Polyline::Handle polyline = get_polyline(get_default_tolerance());
+		bounds = polyline->bounds;
+		if (!polyline->points.empty())
+			bounds.expand(polyline->tolerance);
 		bounds_calculated = true;
 	}
 	return bounds;
@@ -623,16 +690,94 @@ Contour::get_intersector() const
 {
 	Mutex::Lock lock(intersector_read_mutex);
 	if (!intersector) {
+		// intersector keeps exact curves, hit tests should not depend on zoom
 		intersector = crerate_intersector();
-		Mutex::Lock lock(bounds_read_mutex);
-		if (!bounds_calculated) {
-			bounds = intersector->get_bounds();
-			bounds_calculated = true;
-		}
 	}
 	return *intersector;
 }
 
+void
+Contour::to_polyline(Polyline &out_polyline, Real tolerance) const
+{
+	out_polyline.tolerance = tolerance;
+	out_polyline.points.clear();
+	out_polyline.ends.clear();
+
+	std::vector<Vector> &points = out_polyline.points;
+	Vector current;
+	int first = 0;
+	bool opened = false;
+	for(ChunkList::const_iterator i = chunks.begin(); i != chunks.end(); ++i) {
+		if (i->type != CLOSE && i->type != MOVE && !opened) {
+			first = (int)points.size();
+			points.push_back(current);
+			opened = true;
+		}
+		switch(i->type) {
+		case CLOSE:
+			if (opened) {
+				current = points[first];
+				Helper::polyline_end(out_polyline, first);
+				opened = false;
+			}
+			break;
+		case MOVE:
+			if (opened) Helper::polyline_end(out_polyline, first);
+			first = (int)points.size();
+			points.push_back(i->p1);
+			opened = true;
+			break;
+		case LINE:
+			points.push_back(i->p1);
+			break;
+		case CONIC:
+			Helper::conic_flatten(points, current, i->p1, i->pp0, tolerance);
+			break;
+		case CUBIC:
+			Helper::cubic_flatten(points, current, i->p1, i->pp0, i->pp1, tolerance);
+			break;
+		default:
+			break;
+		}
+		if (i->type != CLOSE) current = i->p1;
+	}
+	if (opened) Helper::polyline_end(out_polyline, first);
+
+	if (points.empty()) {
+		out_polyline.bounds = Rect::zero();
+	} else {
+		out_polyline.bounds = Rect(points.front());
+		for(std::vector<Vector>::const_iterator i = points.begin(); i != points.end(); ++i)
+			out_polyline.bounds.expand(*i);
+	}
+}
+
+Contour::Polyline::Handle
+Contour::get_polyline(Real tolerance) const
+{
+	int level = std::isfinite(tolerance) && tolerance > 0.0
+	          ? (int)floor(log2(tolerance)) : (int)Helper::polyline_min_level;
+	level = std::max((int)Helper::polyline_min_level, std::min((int)Helper::polyline_max_level, level));
+
+	Mutex::Lock lock(polylines_read_mutex);
+	PolylineMap::const_iterator i = polylines.find(level);
+	if (i != polylines.end())
+		return i->second;
+
+	Polyline::Handle polyline(new Polyline());
+	to_polyline(*polyline, ldexp(1.0, level));
+
+	// forget the level most distant from the requested one
+	if ((int)polylines.size() >= Helper::polyline_max_levels) {
+		if (level - polylines.begin()->first > polylines.rbegin()->first - level)
+			polylines.erase(polylines.begin());
+		else
+			polylines.erase(--polylines.end());
+	}
+	polylines[level] = polyline;
+	return polyline;
+}
+
 void
 Contour::split(
 	Contour &out_contour,
@@ -28,6 +28,7 @@
 /* === H E A D E R S ======================================================= */
 
 #include <vector>
+#include <map>
 
 #include <ETL/handle>
 
@@ -95,6 +96,23 @@ public:
 
 	typedef std::vector<Chunk> ChunkList;
 
+	//! contour flattened with a given tolerance, curves are replaced by segments,
+	//! every subpath is implicitly closed
+	class Polyline: public etl::shared_object
+	{
+	public:
+		typedef etl::handle<Polyline> Handle;
+
+		Real tolerance;
+		std::vector<Vector> points;
+		std::vector<int> ends; //!< index of point next to the last point for each subpath
+		Rect bounds;
+
+		Polyline(): tolerance(), bounds(Rect::zero()) { }
+	};
+
+	typedef std::map<int, Polyline::Handle> PolylineMap;
+
 private:
 	class Helper;
 
@@ -109,6 +127,9 @@ private:
 	mutable Mutex intersector_read_mutex;
 	mutable etl::handle<Intersector> intersector;
 
+	mutable Mutex polylines_read_mutex;
+	mutable PolylineMap polylines; //!< key is a binary exponent of tolerance
+
 	//! call this when 'chunks' or 'first' was changed
 	void touch_chunks();
 
@@ -168,6 +189,9 @@ public:
 	Rect calc_bounds() const;
 	Rect calc_bounds(const Matrix &transform_matrix) const;
 
+	//! tolerance of polyline which is used for bounds
+	Real get_default_tolerance() const;
+
 	//! actualize internal value of bounds (if needed) and return it
 	//! method is thread-safe for constant contours - you must not modify a contour while this call
 	Rect get_bounds() const;
@@ -179,6 +203,14 @@ public:
 	//! method is thread-safe for constant contours - you must not modify a contour while this call
 	const Intersector& get_intersector() const;
 
+	//! flattens curves, distance between curve and its segments will not exceed the tolerance
+	void to_polyline(Polyline &out_polyline, Real tolerance) const;
+
+	//! returns cached polyline for the power of two nearest to the tolerance (but not greater),
+	//! polyline is shared by all users of contour (and its copies) and must not be modified,
+	//! method is thread-safe for constant contours - you must not modify a contour while this call
+	Polyline::Handle get_polyline(Real tolerance) const;
+
 	void split(
 		Contour &out_contour,
 		Rect &ref_bounds,
@@ -43,9 +43,11 @@
 
 #include "renderer.h"
 #include "renderqueue.h"
+#include "taskpool.h"
 
 #include "software/renderersw.h"
 #include "software/rendererdraftsw.h"
+#include "software/rendererbudgetsw.h"
 #include "software/rendererpreviewsw.h"
 #include "software/rendererlowressw.h"
 #include "software/renderersafe.h"
@@ -98,8 +100,10 @@ Renderer::initialize_renderers()
 
 	// register renderers
 	register_renderer("software", new RendererSW());
+	register_renderer("software-half", new RendererSW(true));
 	register_renderer("software-preview", new RendererPreviewSW());
 	register_renderer("software-draft", new RendererDraftSW());
+	register_renderer("software-budget", new RendererBudgetSW());
 	register_renderer("software-low2",  new RendererLowResSW(2));
 	register_renderer("software-low4",  new RendererLowResSW(4));
 	register_renderer("software-low8",  new RendererLowResSW(8));
@@ -802,6 +806,13 @@ Renderer::run(const Task::List &list, bool quiet) const
 		task_event->wait();
 	}
 
+	// tasks of the frame are released, drop memory cached for them
+	TaskPool::release();
+
+	// the frame is finished, write collected timings of its tasks
+	if (queue && queue->get_task_trace() && queue->get_task_trace()->is_enabled())
+		queue->get_task_trace()->flush();
+
 	if (!quiet && !get_debug_options().result_image.empty())
 		debug::DebugSurface::save_to_file(
 			!list.empty() && list.back()
@@ -813,6 +824,10 @@ Renderer::run(const Task::List &list, bool quiet) const
 	return task_event->is_done();
 }
 
+void
+Renderer::prepare_enqueue_vfunc(Task::List&, const TaskEvent::Handle&) const
+	{ }
+
 void
 Renderer::enqueue(const Task::List &list, const TaskEvent::Handle &finish_event_task, bool quiet) const
 {
@@ -835,6 +850,7 @@ Renderer::enqueue(const Task::List &list, const TaskEvent::Handle &finish_event_
 		log(get_debug_options().task_list_log, list, "input list");
 
 	Task::List optimized_list(list);
+	prepare_enqueue_vfunc(optimized_list, finish_event_task);
 	optimize(optimized_list);
 	find_deps(optimized_list, ++last_batch_index);
 
@@ -1005,6 +1021,9 @@ Renderer::deinitialize()
 
 	delete renderers;
 	delete queue;
+
+	if (getenv("SYNFIG_RENDERING_TASK_POOL_STATISTICS"))
+		TaskPool::log_statistics();
 }
 
 void
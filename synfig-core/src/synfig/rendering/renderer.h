@@ -138,6 +138,12 @@ private:
 
 	void find_deps(const Task::List &list, long long batch_index) const;
 
+protected:
+	//! called by enqueue() before optimization of the task list,
+	//! function may replace tasks in the list (tasks itself should not be changed),
+	//! finish_event_task will be finished when all tasks of the list are done
+	virtual void prepare_enqueue_vfunc(Task::List &list, const TaskEvent::Handle &finish_event_task) const;
+
 public:
 	int get_max_simultaneous_threads() const;
 	void optimize(Task::List &list) const;
@@ -182,6 +188,8 @@ public:
 
 	static const DebugOptions& get_debug_options()
 		{ return debug_options; }
+	static RenderQueue* get_queue()
+		{ return queue; }
 
 	static bool subsys_init()
 		{ initialize(); return true; }
@@ -33,6 +33,7 @@
 #include <climits>
 
 #include <typeinfo>
+#include <algorithm>
 
 #include <synfig/general.h>
 #include <synfig/localization.h>
@@ -42,6 +43,7 @@
 
 #include "renderqueue.h"
 #include "renderer.h"
+#include "taskpool.h"
 
 #endif
 
@@ -85,7 +87,19 @@ Task::Token TaskSubQueue::token(
 } // end of anonimous namespace
 
 
-RenderQueue::RenderQueue(): started(false) { start(); }
+RenderQueue::RenderQueue():
+	started(false),
+	ready_count(0),
+	stat_tasks(0),
+	stat_local_pops(0),
+	stat_global_pops(0),
+	stat_steals(0),
+	stat_idle_time(0),
+	stat_max_queue_depth(0),
+	stat_max_local_depth(0),
+	task_statistics_enabled(getenv("SYNFIG_RENDERING_TASK_STATISTICS") != NULL),
+	task_trace()
+	{ start(); }
 RenderQueue::~RenderQueue() { stop(); }
 
 void
@@ -109,6 +123,14 @@ RenderQueue::start()
 	if (count > SYNFIG_RENDERING_MAX_THREADS) count = SYNFIG_RENDERING_MAX_THREADS;
 	if (count < 2) count = 2;
 
+	// local queues should be created before threads
+	for(int i = 0; i < count; ++i)
+		local_queues.push_back(new LocalQueue());
+
+	task_trace = new TaskTrace(count);
+	if (const char *s = getenv("SYNFIG_RENDERING_TASK_TRACE"))
+		task_trace->open(s);
+
 	for(int i = 0; i < count; ++i)
 		threads.push_back(
 			Glib::Threads::Thread::create(
@@ -128,6 +150,17 @@ RenderQueue::stop()
 	}
 	while(!threads.empty())
 		{ threads.front()->join(); threads.pop_front(); }
+
+	if (getenv("SYNFIG_RENDERING_QUEUE_STATISTICS"))
+		log_statistics();
+	if (getenv("SYNFIG_RENDERING_TASK_STATISTICS"))
+		log_task_statistics();
+
+	while(!local_queues.empty())
+		{ delete local_queues.back(); local_queues.pop_back(); }
+
+	delete task_trace;
+	task_trace = NULL;
 }
 
 void
@@ -143,6 +176,8 @@ RenderQueue::process(int thread_index)
 			  task->get_token()->name.c_str() );
 		#endif
 
+		++stat_tasks;
+
 		if (TaskSubQueue::Handle task_sub_queue = TaskSubQueue::Handle::cast_dynamic(task))
 		{
 			done(thread_index, task_sub_queue->sub_task());
@@ -151,9 +186,34 @@ RenderQueue::process(int thread_index)
 		}
 
 		bool success = false;
+		bool trace = task_trace->is_enabled();
+		long long run_memory = trace && task->target_surface ? task->target_surface->get_memory_size() : -1;
+		long long run_begin = task_statistics_enabled || trace ? g_get_monotonic_time() : 0;
 		try {
 			success = task->run(task->renderer_data.params);
 		} catch(...) { }
+		long long run_end = run_begin ? g_get_monotonic_time() : 0;
+		if (task_statistics_enabled && run_begin) {
+			Glib::Threads::Mutex::Lock lock(task_statistics_mutex);
+			TaskStatistics &ts = task_statistics[task->get_token()->name];
+			++ts.count;
+			ts.time += run_end - run_begin;
+		}
+		if (trace && run_begin) {
+			TaskTrace::Record record;
+			record.token = task->get_token();
+			record.thread_index = thread_index;
+			record.batch_index = task->renderer_data.batch_index;
+			record.begin = run_begin;
+			record.end = run_end;
+			if (task->target_rect.is_valid())
+				record.area = (long long)task->target_rect.get_width()*task->target_rect.get_height();
+			if (run_memory >= 0) {
+				long long memory = task->target_surface->get_memory_size();
+				if (memory >= 0) record.memory = std::max(0ll, memory - run_memory);
+			}
+			task_trace->add(record);
+		}
 		if (!success)
 			task->renderer_data.success = false;
 
@@ -191,6 +251,51 @@ RenderQueue::process(int thread_index)
 	}
 }
 
+void
+RenderQueue::update_max_depth(std::atomic<int> &max_depth, int depth)
+{
+	int prev = max_depth;
+	while(prev < depth && !max_depth.compare_exchange_weak(prev, depth)) { }
+}
+
+void
+RenderQueue::push_ready(int thread_index, const Task::Handle &task, int &signals, int &single_signals)
+{
+	// mutex must be already locked
+
+	if (!task->get_allow_multithreading()) {
+		single_ready_tasks.push_back(task);
+		++single_signals;
+	} else
+	if (thread_index > 0 && thread_index < (int)local_queues.size()) {
+		// keep dependent task at the same thread, it will use just rendered surfaces
+		LocalQueue &local = *local_queues[thread_index];
+		Glib::Threads::Mutex::Lock lock(local.mutex);
+		local.tasks.push_back(task);
+		update_max_depth(stat_max_local_depth, (int)local.tasks.size());
+		++signals;
+	} else {
+		ready_tasks.push_back(task);
+		++signals;
+	}
+	update_max_depth(stat_max_queue_depth, ++ready_count);
+}
+
+void
+RenderQueue::wakeup(int signals, int single_signals)
+{
+	// mutex must be already locked
+
+	// limit signals count
+	int threads = get_threads_count() - 1;
+	if (signals > threads) signals = threads;
+	if (single_signals > 1) single_signals = 1;
+
+	// wake up
+	while(signals-- > 0) cond.signal();
+	while(single_signals-- > 0) single_cond.signal();
+}
+
 void
 RenderQueue::done(int thread_index, const Task::Handle &task)
 {
@@ -205,60 +310,107 @@ RenderQueue::done(int thread_index, const Task::Handle &task)
 		if ((*i)->renderer_data.deps.empty())
 		{
 			bool mt = (*i)->get_allow_multithreading();
-			TaskQueue &queue = mt ? ready_tasks     : single_ready_tasks;
-			TaskSet   &wait  = mt ? not_ready_tasks : single_not_ready_tasks;
-			wait.erase(*i);
-			queue.push_back(*i);
-			++(mt ? signals : single_signals);
+			(mt ? not_ready_tasks : single_not_ready_tasks).erase(*i);
+			push_ready(thread_index, *i, signals, single_signals);
 		}
 	}
 	task->renderer_data.back_deps.clear();
-	assert( tasks_in_process.count(thread_index) == 1 );
-	tasks_in_process.erase(thread_index);
-	//info("rendering threads used %d", tasks_in_process.size());
-
-	// limit signals count
-	int threads = get_threads_count() - 1;
-	if (signals > threads) signals = threads;
-	if (single_signals > 1) single_signals = 1;
 
 	// we don't need to wakeup the current thread
 	--(thread_index ? signals : single_signals);
 
-	// wake up
-	while(signals-- > 0) cond.signal();
-	while(single_signals-- > 0) single_cond.signal();
+	wakeup(signals, single_signals);
+}
+
+Task::Handle
+RenderQueue::pop_local(int thread_index)
+{
+	LocalQueue &local = *local_queues[thread_index];
+	Glib::Threads::Mutex::Lock lock(local.mutex);
+	while(!local.tasks.empty()) {
+		// take the last pushed task, it's sources most probably still in the cache
+		Task::Handle task = local.tasks.back();
+		local.tasks.pop_back();
+		--ready_count;
+		if (!task) continue;
+		++stat_local_pops;
+		return task;
+	}
+	return Task::Handle();
+}
+
+Task::Handle
+RenderQueue::steal(int thread_index)
+{
+	// thread 0 processes only single-thread tasks
+	int count = (int)local_queues.size();
+	for(int i = 1; i < count; ++i) {
+		int index = (thread_index + i) % count;
+		if (!index) continue;
+		LocalQueue &local = *local_queues[index];
+		Glib::Threads::Mutex::Lock lock(local.mutex);
+		while(!local.tasks.empty()) {
+			// take the oldest task, the owner of queue works with the newest
+			Task::Handle task = local.tasks.front();
+			local.tasks.pop_front();
+			--ready_count;
+			if (!task) continue;
+			++stat_steals;
+			return task;
+		}
+	}
+	return Task::Handle();
 }
 
 Task::Handle
 RenderQueue::get(int thread_index)
 {
+	// try to get task without locking of the main mutex
+	if (thread_index)
+		if (Task::Handle task = pop_local(thread_index))
+			return task;
+
 	Glib::Threads::Mutex::Lock lock(mutex);
 
-	TaskQueue &queue  = thread_index == 0 ? single_ready_tasks     : ready_tasks;
-	TaskQueue &queue2 = thread_index != 0 ? single_ready_tasks     : ready_tasks;
-	TaskSet   &wait   = thread_index == 0 ? single_not_ready_tasks : not_ready_tasks;
+	TaskQueue &queue = thread_index == 0 ? single_ready_tasks : ready_tasks;
+	TaskSet &not_ready = thread_index == 0 ? single_not_ready_tasks : not_ready_tasks;
+	bool released = false;
 	while(started)
 	{
 		if (!queue.empty())
 		{
 			Task::Handle task = queue.front();
 			queue.pop_front();
+			--ready_count;
 			if (!task) continue;
-			assert( tasks_in_process.count(thread_index) == 0 );
-			tasks_in_process[thread_index] = task;
-			//info("rendering threads used %d", tasks_in_process.size());
+			++stat_global_pops;
 			return task;
 		}
 
+		// tasks are pushed into local queues only while main mutex is locked,
+		// so we will not miss the signal
+		if (thread_index)
+			if (Task::Handle task = steal(thread_index))
+				return task;
+
 		#ifdef DEBUG_THREAD_WAIT
-		if (!wait.empty())
+		if (!(thread_index == 0 ? single_not_ready_tasks : not_ready_tasks).empty())
 			info("thread %d: rendering wait for task", thread_index);
 		#endif
 
-		assert( wait.empty() || !tasks_in_process.empty() || !queue2.empty() );
+		// thread has no more work, pass the cached task memory back to the system
+		if (!released && not_ready.empty())
+		{
+			released = true;
+			lock.release();
+			TaskPool::release();
+			lock.acquire();
+			continue;
+		}
 
+		long long idle_begin = g_get_monotonic_time();
 		(thread_index ? cond : single_cond).wait(mutex);
+		stat_idle_time += g_get_monotonic_time() - idle_begin;
 	}
 	return Task::Handle();
 }
@@ -279,6 +431,62 @@ RenderQueue::get_threads_count() const
 	return threads.size();
 }
 
+RenderQueue::Statistics
+RenderQueue::get_statistics() const
+{
+	Statistics s;
+	s.tasks           = stat_tasks;
+	s.local_pops      = stat_local_pops;
+	s.global_pops     = stat_global_pops;
+	s.steals          = stat_steals;
+	s.idle_time       = stat_idle_time;
+	s.queue_depth     = ready_count;
+	s.max_queue_depth = stat_max_queue_depth;
+	s.max_local_depth = stat_max_local_depth;
+	return s;
+}
+
+void
+RenderQueue::reset_statistics()
+{
+	stat_tasks = 0;
+	stat_local_pops = 0;
+	stat_global_pops = 0;
+	stat_steals = 0;
+	stat_idle_time = 0;
+	stat_max_queue_depth = (int)ready_count;
+	stat_max_local_depth = 0;
+
+	Glib::Threads::Mutex::Lock lock(task_statistics_mutex);
+	task_statistics.clear();
+}
+
+void
+RenderQueue::log_statistics() const
+{
+	Statistics s = get_statistics();
+	info( "rendering queue: tasks %lld, local %lld, global %lld, steals %lld, idle %.3fs, depth %d, max depth %d, max local depth %d",
+		  s.tasks, s.local_pops, s.global_pops, s.steals,
+		  (double)s.idle_time*1e-6,
+		  s.queue_depth, s.max_queue_depth, s.max_local_depth );
+}
+
+RenderQueue::TaskStatisticsMap
+RenderQueue::get_task_statistics() const
+{
+	Glib::Threads::Mutex::Lock lock(task_statistics_mutex);
+	return task_statistics;
+}
+
+void
+RenderQueue::log_task_statistics() const
+{
+	TaskStatisticsMap map = get_task_statistics();
+	for(TaskStatisticsMap::const_iterator i = map.begin(); i != map.end(); ++i)
+		info( "rendering task %s: count %lld, time %.3fs",
+			  i->first.c_str(), i->second.count, (double)i->second.time*1e-6 );
+}
+
 bool
 RenderQueue::remove_if_orphan(const Task::Handle &task, bool in_queue)
 {
@@ -323,9 +531,14 @@ RenderQueue::remove_orphans()
 	// mutex must be already locked
 
 	for(TaskQueue::iterator i = ready_tasks.begin(); i != ready_tasks.end();)
-		if (remove_if_orphan(*i, true)) ready_tasks.erase(i++); else ++i;
+		if (remove_if_orphan(*i, true)) ready_tasks.erase(i++), --ready_count; else ++i;
 	for(TaskQueue::iterator i = single_ready_tasks.begin(); i != single_ready_tasks.end();)
-		if (remove_if_orphan(*i, true)) single_ready_tasks.erase(i++); else ++i;
+		if (remove_if_orphan(*i, true)) single_ready_tasks.erase(i++), --ready_count; else ++i;
+	for(LocalQueueList::iterator j = local_queues.begin(); j != local_queues.end(); ++j) {
+		Glib::Threads::Mutex::Lock lock((*j)->mutex);
+		for(TaskDeque::iterator i = (*j)->tasks.begin(); i != (*j)->tasks.end();)
+			if (remove_if_orphan(*i, true)) i = (*j)->tasks.erase(i), --ready_count; else ++i;
+	}
 
 	for(TaskSet::iterator i = not_ready_tasks.begin(); i != not_ready_tasks.end();)
 		if (remove_if_orphan(*i, true)) not_ready_tasks.erase(i++); else ++i;
@@ -341,17 +554,15 @@ RenderQueue::enqueue(const Task::Handle &task, const Task::RunParams &params)
 	fix_task(*task, params);
 	Glib::Threads::Mutex::Lock lock(mutex);
 
-	bool mt = task->get_allow_multithreading();
-	TaskQueue &queue = mt ? ready_tasks     : single_ready_tasks;
-	TaskSet   &wait  = mt ? not_ready_tasks : single_not_ready_tasks;
+	int single_signals = 0;
+	int signals = 0;
 	if (task->renderer_data.deps.empty()) {
-		queue.push_back(task);
-		(mt ? cond : single_cond).signal();
-	}
-	else
-	{
-		wait.insert(task);
+		push_ready(0, task, signals, single_signals);
+	} else {
+		bool mt = task->get_allow_multithreading();
+		(mt ? not_ready_tasks : single_not_ready_tasks).insert(task);
 	}
+	wakeup(signals, single_signals);
 
 	remove_orphans();
 }
@@ -373,26 +584,16 @@ RenderQueue::enqueue(const Task::List &tasks, const Task::RunParams &params)
 	{
 		if (*i)
 		{
-			bool mt = (*i)->get_allow_multithreading();
-			TaskQueue &queue = mt ? ready_tasks     : single_ready_tasks;
-			TaskSet   &wait  = mt ? not_ready_tasks : single_not_ready_tasks;
 			if ((*i)->renderer_data.deps.empty()) {
-				queue.push_back(*i);
-				++(mt ? signals : single_signals);
+				push_ready(0, *i, signals, single_signals);
 			} else {
-				wait.insert(*i);
+				bool mt = (*i)->get_allow_multithreading();
+				(mt ? not_ready_tasks : single_not_ready_tasks).insert(*i);
 			}
 		}
 	}
 
-	// limit signals count
-	int threads = get_threads_count() - 1;
-	if (signals > threads) signals = threads;
-	if (single_signals > 1) single_signals = 1;
-
-	// wake up
-	while(signals-- > 0) cond.signal();
-	while(single_signals-- > 0) single_cond.signal();
+	wakeup(signals, single_signals);
 
 	remove_orphans();
 }
@@ -400,6 +601,8 @@ RenderQueue::enqueue(const Task::List &tasks, const Task::RunParams &params)
 bool
 RenderQueue::remove_task(const Task::Handle &task)
 {
+	// mutex must be already locked
+
 	bool found = false;
 	if (task) {
 		bool mt = task->get_allow_multithreading();
@@ -407,7 +610,13 @@ RenderQueue::remove_task(const Task::Handle &task)
 		TaskSet   &wait  = mt ? not_ready_tasks : single_not_ready_tasks;
 
 		for(TaskQueue::iterator i = queue.begin(); i != queue.end();)
-			if (*i == task) found = true, queue.erase(i++); else ++i;
+			if (*i == task) found = true, queue.erase(i++), --ready_count; else ++i;
+		if (mt)
+			for(LocalQueueList::iterator j = local_queues.begin(); j != local_queues.end(); ++j) {
+				Glib::Threads::Mutex::Lock lock((*j)->mutex);
+				for(TaskDeque::iterator i = (*j)->tasks.begin(); i != (*j)->tasks.end();)
+					if (*i == task) found = true, i = (*j)->tasks.erase(i), --ready_count; else ++i;
+			}
 		if (wait.erase(task)) found = true;
 	}
 	return found;
@@ -459,6 +668,11 @@ RenderQueue::clear()
 	single_ready_tasks.clear();
 	not_ready_tasks.clear();
 	single_not_ready_tasks.clear();
+	for(LocalQueueList::iterator j = local_queues.begin(); j != local_queues.end(); ++j) {
+		Glib::Threads::Mutex::Lock local_lock((*j)->mutex);
+		(*j)->tasks.clear();
+	}
+	ready_count = 0;
 }
 
 /* === E N T R Y P O I N T ================================================= */
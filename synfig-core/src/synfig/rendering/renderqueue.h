@@ -30,10 +30,14 @@
 #include <cstdio>
 
 #include <map>
+#include <deque>
+#include <vector>
+#include <atomic>
 
 #include <glibmm/threads.h>
 
 #include "task.h"
+#include "tasktrace.h"
 
 /* === M A C R O S ========================================================= */
 
@@ -46,17 +50,57 @@ namespace synfig
 namespace rendering
 {
 
+//! Queue of rendering tasks.
+//! Thread 0 processes tasks which are not allows multithreading (OpenGL),
+//! all other threads has own local deque of ready tasks.
+//! When task is done, it's dependents which became ready are pushed
+//! into local deque of the same thread (LIFO, to keep data in cache),
+//! idle threads steals tasks from the front of deques of other threads.
 class RenderQueue
 {
 public:
 	typedef std::list<Glib::Threads::Thread*> ThreadList;
-	typedef std::map<int, Task::Handle> ThreadTaskMap;
 	typedef std::set<Task::Handle> TaskSet;
 	typedef std::list<Task::Handle> TaskQueue;
+	typedef std::deque<Task::Handle> TaskDeque;
+
+	//! Counters of scheduler, see get_statistics()
+	struct Statistics {
+		long long tasks;          //!< count of processed tasks
+		long long local_pops;     //!< tasks taken from local deque of thread
+		long long global_pops;    //!< tasks taken from shared queue
+		long long steals;         //!< tasks stolen from deques of other threads
+		long long idle_time;      //!< summary time of waiting for tasks in all threads (microseconds)
+		int queue_depth;          //!< current count of ready tasks
+		int max_queue_depth;      //!< maximal count of ready tasks at once
+		int max_local_depth;      //!< maximal count of ready tasks in one local deque
+
+		Statistics():
+			tasks(), local_pops(), global_pops(), steals(),
+			idle_time(), queue_depth(), max_queue_depth(), max_local_depth() { }
+	};
+
+	//! Summary of executed tasks of one type, see get_task_statistics()
+	struct TaskStatistics {
+		long long count;          //!< count of executed tasks
+		long long time;           //!< summary time of execution (microseconds)
+		TaskStatistics(): count(), time() { }
+	};
+
+	//! statistics by name of task token
+	typedef std::map<String, TaskStatistics> TaskStatisticsMap;
 
 private:
+	struct LocalQueue {
+		Glib::Threads::Mutex mutex;
+		TaskDeque tasks;
+	};
+	typedef std::vector<LocalQueue*> LocalQueueList;
+
 	static int last_batch_index;
 
+	// lock order: 'mutex' first, then mutex of local queue,
+	// never lock two local queues simultaneously
 	Glib::Threads::Mutex mutex;
 	Glib::Threads::Mutex threads_mutex;
 	Glib::Threads::Cond cond;
@@ -66,11 +110,26 @@ private:
 	TaskQueue single_ready_tasks;
 	TaskSet not_ready_tasks;
 	TaskSet single_not_ready_tasks;
+	LocalQueueList local_queues;
 
 	bool started;
 
 	ThreadList threads;
-	ThreadTaskMap tasks_in_process;
+
+	std::atomic<int> ready_count;
+	std::atomic<long long> stat_tasks;
+	std::atomic<long long> stat_local_pops;
+	std::atomic<long long> stat_global_pops;
+	std::atomic<long long> stat_steals;
+	std::atomic<long long> stat_idle_time;
+	std::atomic<int> stat_max_queue_depth;
+	std::atomic<int> stat_max_local_depth;
+
+	std::atomic<bool> task_statistics_enabled;
+	mutable Glib::Threads::Mutex task_statistics_mutex;
+	TaskStatisticsMap task_statistics;
+
+	TaskTrace *task_trace;
 
 	void start();
 	void stop();
@@ -78,6 +137,11 @@ private:
 	void process(int thread_index);
 	void done(int thread_index, const Task::Handle &task);
 	Task::Handle get(int thread_index);
+	Task::Handle pop_local(int thread_index);
+	Task::Handle steal(int thread_index);
+	void push_ready(int thread_index, const Task::Handle &task, int &signals, int &single_signals);
+	void wakeup(int signals, int single_signals);
+	void update_max_depth(std::atomic<int> &max_depth, int depth);
 
 	static void fix_task(const Task &task, const Task::RunParams &params);
 	bool remove_if_orphan(const Task::Handle &task, bool in_queue);
@@ -89,6 +153,24 @@ public:
 	~RenderQueue();
 
 	int get_threads_count() const;
+	Statistics get_statistics() const;
+	void reset_statistics();
+	void log_statistics() const;
+
+	//! time measurement of tasks is disabled by default,
+	//! environment variable SYNFIG_RENDERING_TASK_STATISTICS enables it at start
+	void set_task_statistics_enabled(bool enabled)
+		{ task_statistics_enabled = enabled; }
+	bool get_task_statistics_enabled() const
+		{ return task_statistics_enabled; }
+	TaskStatisticsMap get_task_statistics() const;
+	void log_task_statistics() const;
+
+	//! tracing of tasks is disabled by default,
+	//! environment variable SYNFIG_RENDERING_TASK_TRACE=<filename> enables it at start
+	TaskTrace* get_task_trace() const
+		{ return task_trace; }
+
 	void enqueue(const Task::Handle &task, const Task::RunParams &params);
 	void enqueue(const Task::List &tasks, const Task::RunParams &params);
 	void cancel(const Task::Handle &task);
@@ -34,12 +34,17 @@
 #include <algorithm>
 #include <functional>
 
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
 #include "blur.h"
 
 #include "blurtemplates.h"
 #include "fft.h"
 #include <synfig/angle.h>
 #include <synfig/general.h>
+#include <synfig/threadpool.h>
 
 #endif
 
@@ -53,6 +58,171 @@ using namespace rendering;
 
 /* === P R O C E D U R E S ================================================= */
 
+namespace {
+
+// Pack holds all four channels of one pixel
+
+#ifdef __SSE2__
+typedef __m128 Pack;
+inline Pack pack_zero() { return _mm_setzero_ps(); }
+inline Pack pack_set(ColorReal x) { return _mm_set1_ps(x); }
+inline Pack pack_load(const ColorReal *x) { return _mm_loadu_ps(x); }
+inline void pack_store(ColorReal *x, const Pack &p) { _mm_storeu_ps(x, p); }
+inline Pack pack_add(const Pack &a, const Pack &b) { return _mm_add_ps(a, b); }
+inline Pack pack_sub(const Pack &a, const Pack &b) { return _mm_sub_ps(a, b); }
+inline Pack pack_mul(const Pack &a, const Pack &b) { return _mm_mul_ps(a, b); }
+#else
+struct Pack { ColorReal c[4]; };
+inline Pack pack_set(ColorReal x)
+	{ Pack p; p.c[0] = p.c[1] = p.c[2] = p.c[3] = x; return p; }
+inline Pack pack_zero()
+	{ return pack_set(ColorReal()); }
+inline Pack pack_load(const ColorReal *x)
+	{ Pack p; for(int i = 0; i < 4; ++i) p.c[i] = x[i]; return p; }
+inline void pack_store(ColorReal *x, const Pack &p)
+	{ for(int i = 0; i < 4; ++i) x[i] = p.c[i]; }
+inline Pack pack_add(const Pack &a, const Pack &b)
+	{ Pack p; for(int i = 0; i < 4; ++i) p.c[i] = a.c[i] + b.c[i]; return p; }
+inline Pack pack_sub(const Pack &a, const Pack &b)
+	{ Pack p; for(int i = 0; i < 4; ++i) p.c[i] = a.c[i] - b.c[i]; return p; }
+inline Pack pack_mul(const Pack &a, const Pack &b)
+	{ Pack p; for(int i = 0; i < 4; ++i) p.c[i] = a.c[i]*b.c[i]; return p; }
+#endif
+
+//! One-dimensional in-place pass over the interleaved 4-channel buffer.
+//! Horizontal pass: line is a row, vertical pass: line is a column.
+//! Neighbour lines are processed together (four columns of the vertical pass
+//! are 64 contiguous bytes), groups of lines are distributed over the thread pool.
+class LinePass
+{
+public:
+	enum { group_size = 4 };
+
+	ColorReal *data;
+	int lines;
+	int length;
+	int line_stride; //!< count of floats between first pixels of neighbour lines
+	int item_stride; //!< count of floats between neighbour pixels of line
+
+	LinePass(ColorReal *data, int lines, int length, int line_stride, int item_stride):
+		data(data), lines(lines), length(length), line_stride(line_stride), item_stride(item_stride) { }
+	virtual ~LinePass() { }
+
+	//! processes lines [begin, end)
+	virtual void process(int begin, int end) = 0;
+
+	void run()
+	{
+		const int min_pixels_per_thread = 64*1024;
+		int groups = (lines + group_size - 1)/group_size;
+		int chunks = std::min(groups, ThreadPool::instance.get_max_threads());
+		chunks = std::min(chunks, lines*length/min_pixels_per_thread);
+		if (chunks <= 1) { process(0, lines); return; }
+
+		ThreadPool::Group group;
+		for(int i = 0; i < chunks; ++i)
+			group.enqueue( sigc::bind( sigc::mem_fun(*this, &LinePass::process),
+				groups*i/chunks*group_size,
+				std::min(lines, groups*(i + 1)/chunks*group_size) ));
+		group.run();
+	}
+};
+
+//! Same as BlurTemplates::blur_box_discrete for each channel of each line
+class BoxPass: public LinePass
+{
+public:
+	int size;
+
+	BoxPass(ColorReal *data, int lines, int length, int line_stride, int item_stride, int size):
+		LinePass(data, lines, length, line_stride, item_stride), size(abs(size)) { }
+
+	virtual void process(int begin, int end)
+	{
+		const int full_size = 1 + 2*size;
+		if (size == 0 || length < full_size) return;
+
+		const Pack w = pack_set(ColorReal(1.0)/ColorReal(full_size));
+		std::vector<ColorReal> queue(full_size*group_size*4);
+		Pack sum[group_size];
+
+		for(int line = begin; line < end; line += group_size) {
+			ColorReal *first = data + line*line_stride;
+			int count = std::min((int)group_size, end - line);
+
+			for(int k = 0; k < count; ++k)
+				sum[k] = pack_zero();
+			for(int i = 0; i < full_size; ++i)
+				for(int k = 0; k < count; ++k) {
+					Pack p = pack_load(first + i*item_stride + k*line_stride);
+					pack_store(&queue[(i*group_size + k)*4], p);
+					sum[k] = pack_add(sum[k], p);
+				}
+
+			int head = 0;
+			for(int i = full_size, j = size; i < length; ++i, ++j) {
+				ColorReal *q = &queue[head*group_size*4];
+				for(int k = 0; k < count; ++k, q += 4) {
+					Pack p = pack_load(first + i*item_stride + k*line_stride);
+					pack_store(first + j*item_stride + k*line_stride, pack_mul(w, sum[k]));
+					sum[k] = pack_add(sum[k], pack_sub(p, pack_load(q)));
+					pack_store(q, p);
+				}
+				if (++head == full_size) head = 0;
+			}
+		}
+	}
+};
+
+//! Same as BlurTemplates::blur_iir for each channel of each line
+class IIRPass: public LinePass
+{
+public:
+	Pack k0, k1, k2, k3;
+
+	IIRPass(
+		ColorReal *data, int lines, int length, int line_stride, int item_stride,
+		ColorReal k0, ColorReal k1, ColorReal k2, ColorReal k3
+	):
+		LinePass(data, lines, length, line_stride, item_stride),
+		k0(pack_set(k0)), k1(pack_set(k1)), k2(pack_set(k2)), k3(pack_set(k3)) { }
+
+	void step(ColorReal *x, Pack &d1, Pack &d2, Pack &d3) const
+	{
+		Pack d0 = pack_add(pack_add(pack_add(
+			pack_mul(k0, pack_load(x)),
+			pack_mul(k1, d1) ),
+			pack_mul(k2, d2) ),
+			pack_mul(k3, d3) );
+		pack_store(x, d0);
+		d3 = d2, d2 = d1, d1 = d0;
+	}
+
+	virtual void process(int begin, int end)
+	{
+		Pack d1[group_size], d2[group_size], d3[group_size];
+
+		for(int line = begin; line < end; line += group_size) {
+			ColorReal *first = data + line*line_stride;
+			int count = std::min((int)group_size, end - line);
+
+			for(int k = 0; k < count; ++k)
+				d1[k] = d2[k] = d3[k] = pack_zero();
+			for(int i = 0; i < length; ++i)
+				for(int k = 0; k < count; ++k)
+					step(first + i*item_stride + k*line_stride, d1[k], d2[k], d3[k]);
+
+			for(int k = 0; k < count; ++k)
+				d1[k] = d2[k] = d3[k] = pack_zero();
+			for(int i = length - 1; i >= 0; --i)
+				for(int k = 0; k < count; ++k)
+					step(first + i*item_stride + k*line_stride, d1[k], d2[k], d3[k]);
+		}
+	}
+};
+
+} // end of anonimous namespace
+
 /* === M E T H O D S ======================================================= */
 
 bool
@@ -462,7 +632,6 @@ software::Blur::blur_fft(const Params &params)
 void
 software::Blur::blur_box(const Params &params)
 {
-	const Real precision(1e-5);
 	const int channels = 4;
 	int rows = params.src_rect.get_size()[1];
 	int cols = params.src_rect.get_size()[0];
@@ -495,7 +664,6 @@ software::Blur::blur_box(const Params &params)
 		return;
 	}
 
-	deque<ColorReal> q;
 	vector<ColorReal> surface_copy;
 	Array<ColorReal, 3> arr_surface_rows(arr_surface.reorder(2, 0, 1));
 	Array<ColorReal, 3> arr_surface_cols(arr_surface_rows.reorder(0, 2, 1));
@@ -507,27 +675,10 @@ software::Blur::blur_box(const Params &params)
 		arr_surface_cols.pointer = &surface_copy.front();
 	}
 
-	if (true || fabs(size[0] - round(size[0])) < precision)
-		for(Array<ColorReal, 3>::Iterator channel(arr_surface_rows); channel; ++channel)
-			for(Array<ColorReal, 2>::Iterator r(*channel); r; ++r)
-				for(int i = 0; i < count; ++i)
-					BlurTemplates::blur_box_discrete(*r, q, (int)round(size[0]));
-	else
-		for(Array<ColorReal, 3>::Iterator channel(arr_surface_rows); channel; ++channel)
-			for(Array<ColorReal, 2>::Iterator r(*channel); r; ++r)
-				for(int i = 0; i < count; ++i)
-					BlurTemplates::blur_box_aa(*r, q, (ColorReal)size[0]);
-
-	if (true || fabs(size[1] - round(size[1])) < precision)
-		for(Array<ColorReal, 3>::Iterator channel(arr_surface_cols); channel; ++channel)
-			for(Array<ColorReal, 2>::Iterator c(*channel); c; ++c)
-				for(int i = 0; i < count; ++i)
-					BlurTemplates::blur_box_discrete(*c, q, (int)round(size[1]));
-	else
-		for(Array<ColorReal, 3>::Iterator channel(arr_surface_cols); channel; ++channel)
-			for(Array<ColorReal, 2>::Iterator c(*channel); c; ++c)
-				for(int i = 0; i < count; ++i)
-					BlurTemplates::blur_box_aa(*c, q, (ColorReal)size[1]);
+	for(int i = 0; i < count; ++i)
+		BoxPass(arr_surface_rows.pointer, rows, cols, cols*channels, channels, (int)round(size[0])).run();
+	for(int i = 0; i < count; ++i)
+		BoxPass(arr_surface_cols.pointer, cols, rows, channels, cols*channels, (int)round(size[1])).run();
 
 	if (cross)
 		arr_surface_rows
@@ -675,9 +826,7 @@ software::Blur::blur_iir(const Params &params)
 		}
 		else
 		{
-			for(Array<ColorReal, 3>::Iterator channel(arr_surface_rows); channel; ++channel)
-				for(Array<ColorReal, 2>::Iterator r(*channel); r; ++r)
-					BlurTemplates::blur_iir(*r, cr0, cr1, cr2, cr3);
+			IIRPass(arr_surface_rows.pointer, rows, cols, cols*channels, channels, cr0, cr1, cr2, cr3).run();
 		}
 	}
 
@@ -692,9 +841,7 @@ software::Blur::blur_iir(const Params &params)
 		}
 		else
 		{
-			for(Array<ColorReal, 3>::Iterator channel(arr_surface_cols); channel; ++channel)
-				for(Array<ColorReal, 2>::Iterator c(*channel); c; ++c)
-					BlurTemplates::blur_iir(*c, cc0, cc1, cc2, cc3);
+			IIRPass(arr_surface_cols.pointer, cols, rows, channels, cols*channels, cc0, cc1, cc2, cc3).run();
 		}
 	}
 
@@ -29,9 +29,17 @@
 #	include <config.h>
 #endif
 
+#include <algorithm>
+#include <cmath>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
 #include "contour.h"
 
 #include <synfig/debug/debugsurface.h>
+#include <synfig/threadpool.h>
 
 #endif
 
@@ -44,8 +52,475 @@ using namespace rendering;
 
 /* === P R O C E D U R E S ================================================= */
 
+namespace {
+
+typedef software::Contour::Edge Edge;
+typedef software::Contour::EdgeList EdgeList;
+
+bool
+outside(const RectInt &window, const Vector *p, int count)
+{
+	bool left = true, right = true, top = true, bottom = true;
+	for(const Vector *i = p, *end = p + count; i < end; ++i) {
+		left   = left   && (*i)[0] <= window.minx;
+		right  = right  && (*i)[0] >= window.maxx;
+		top    = top    && (*i)[1] <= window.miny;
+		bottom = bottom && (*i)[1] >= window.maxy;
+	}
+	return left || right || top || bottom;
+}
+
+//! count of segments of uniform subdivision,
+//! error_factor/count^2 is the max distance between curve and segments
+int
+segments_count(Real error_factor, Real tolerance)
+{
+	const int max_segments = 1024;
+	Real count = ceil(sqrt(error_factor/tolerance));
+	return count < 1 ? 1 : count > max_segments ? max_segments : (int)count;
+}
+
+void
+add_line(EdgeList &edges, const RectInt &window, const Vector &p0, const Vector &p1)
+{
+	if ( !std::isfinite(p0[0]) || !std::isfinite(p0[1])
+	  || !std::isfinite(p1[0]) || !std::isfinite(p1[1]) )
+		return;
+	// horizontal lines and lines above or below of window doesn't change the coverage
+	if ( p0[1] == p1[1]
+	  || (p0[1] <= window.miny && p1[1] <= window.miny)
+	  || (p0[1] >= window.maxy && p1[1] >= window.maxy) )
+		return;
+
+	// split by vertical borders of window,
+	// parts outside of window are projected onto the border
+	const Real minx = window.minx, maxx = window.maxx;
+	Real t[4] = { 0.0, 0.0, 0.0, 1.0 };
+	int count = 1;
+	Real dx = p1[0] - p0[0];
+	if (dx) {
+		Real ta = (minx - p0[0])/dx, tb = (maxx - p0[0])/dx;
+		if (ta > tb) std::swap(ta, tb);
+		if (ta > 0.0 && ta < 1.0) t[count++] = ta;
+		if (tb > 0.0 && tb < 1.0) t[count++] = tb;
+	}
+	t[count++] = 1.0;
+
+	Vector prev(std::max(minx, std::min(maxx, p0[0])), p0[1]);
+	for(int i = 1; i < count; ++i) {
+		Vector p = i + 1 == count ? p1 : p0 + (p1 - p0)*t[i];
+		p[0] = std::max(minx, std::min(maxx, p[0]));
+		if (prev[1] != p[1])
+			edges.push_back(Edge(prev[0], prev[1], p[0], p[1]));
+		prev = p;
+	}
+}
+
+void
+add_conic(EdgeList &edges, const RectInt &window, const Vector *p, Real tolerance)
+{
+	if (outside(window, p, 3))
+		{ add_line(edges, window, p[0], p[2]); return; }
+
+	int count = segments_count(0.25*(p[0] - p[1]*2.0 + p[2]).mag(), tolerance);
+	Vector prev = p[0];
+	for(int i = 1; i < count; ++i) {
+		Real t = (Real)i/(Real)count, s = 1.0 - t;
+		Vector pp = p[0]*(s*s) + p[1]*(2.0*s*t) + p[2]*(t*t);
+		add_line(edges, window, prev, pp);
+		prev = pp;
+	}
+	add_line(edges, window, prev, p[2]);
+}
+
+void
+add_cubic(EdgeList &edges, const RectInt &window, const Vector *p, Real tolerance)
+{
+	if (outside(window, p, 4))
+		{ add_line(edges, window, p[0], p[3]); return; }
+
+	Real m = std::max( (p[0] - p[1]*2.0 + p[2]).mag(),
+			           (p[1] - p[2]*2.0 + p[3]).mag() );
+	int count = segments_count(0.75*m, tolerance);
+	Vector prev = p[0];
+	for(int i = 1; i < count; ++i) {
+		Real t = (Real)i/(Real)count, s = 1.0 - t;
+		Vector pp = p[0]*(s*s*s) + p[1]*(3.0*s*s*t) + p[2]*(3.0*s*t*t) + p[3]*(t*t*t);
+		add_line(edges, window, prev, pp);
+		prev = pp;
+	}
+	add_line(edges, window, prev, p[3]);
+}
+
+//! Renders band of rows of window.
+//! Each edge adds its signed area into the cells it crosses (the same way as font-rs does),
+//! so the prefix sum of row is the winding number (coverage) of pixels.
+class BandRenderer
+{
+public:
+	synfig::Surface &surface;
+	const RectInt window;
+	const EdgeList &edges;
+	const bool invert;
+	const bool antialias;
+	const rendering::Contour::WindingStyle winding_style;
+	const Color color;
+	const ColorReal opacity;
+	const Color::BlendMethod blend_method;
+	const bool simple_fill;
+
+	int band_height;
+	std::vector< std::vector<int> > bands; //!< indices of edges of each band
+
+	BandRenderer(
+		synfig::Surface &surface,
+		const RectInt &window,
+		const EdgeList &edges,
+		bool invert,
+		bool antialias,
+		rendering::Contour::WindingStyle winding_style,
+		const Color &color,
+		ColorReal opacity,
+		Color::BlendMethod blend_method
+	):
+		surface(surface),
+		window(window),
+		edges(edges),
+		invert(invert),
+		antialias(antialias),
+		winding_style(winding_style),
+		color(color),
+		opacity(opacity),
+		blend_method(blend_method),
+		simple_fill( (Color::BLEND_METHODS_OVERWRITE_ON_ALPHA_ONE & (1 << blend_method))
+			      && fabsf(1.f - opacity*color.get_a()) <= 1e-6 ),
+		band_height(1)
+	{ }
+
+	//! accumulates edge into the rows, rows are relative to the band, x is relative to the window
+	static void accumulate(
+		const Edge &edge,
+		ColorReal *rows,
+		int stride,
+		int *row_begin,
+		int band_miny,
+		int band_rows,
+		int minx,
+		int width )
+	{
+		Real x0 = edge.x0 - minx, y0 = edge.y0 - band_miny;
+		Real x1 = edge.x1 - minx, y1 = edge.y1 - band_miny;
+		Real dir = 1.0;
+		if (y0 > y1) { std::swap(x0, x1); std::swap(y0, y1); dir = -1.0; }
+
+		Real ya = std::max(y0, 0.0), yb = std::min(y1, (Real)band_rows);
+		if (ya >= yb) return;
+
+		const Real w = width;
+		Real dxdy = (x1 - x0)/(y1 - y0);
+		Real x = std::max(0.0, std::min(w, x0 + (ya - y0)*dxdy));
+		for(int y = (int)floor(ya), end = (int)ceil(yb); y < end; ++y) {
+			ColorReal *row = rows + y*stride;
+			Real dy = std::min((Real)(y + 1), yb) - std::max((Real)y, ya);
+			Real xnext = std::max(0.0, std::min(w, x + dxdy*dy));
+			Real d = dy*dir;
+
+			Real xa = std::min(x, xnext), xb = std::max(x, xnext);
+			Real xa_floor = floor(xa), xb_ceil = ceil(xb);
+			int xai = (int)xa_floor, xbi = (int)xb_ceil;
+			if (xai < row_begin[y]) row_begin[y] = xai;
+
+			if (xbi <= xai + 1) {
+				Real xmf = 0.5*(x + xnext) - xa_floor;
+				row[xai] += d - d*xmf;
+				row[xai + 1] += d*xmf;
+			} else {
+				Real s = 1.0/(xb - xa);
+				Real xaf = xa - xa_floor;
+				Real a0 = 0.5*s*(1.0 - xaf)*(1.0 - xaf);
+				Real xbf = xb - xb_ceil + 1.0;
+				Real am = 0.5*s*xbf*xbf;
+				row[xai] += d*a0;
+				if (xbi == xai + 2) {
+					row[xai + 1] += d*(1.0 - a0 - am);
+				} else {
+					Real a1 = s*(1.5 - xaf);
+					row[xai + 1] += d*(a1 - a0);
+					for(int xi = xai + 2; xi < xbi - 1; ++xi)
+						row[xi] += d*s;
+					Real a2 = a1 + (xbi - xai - 3)*s;
+					row[xbi - 1] += d*(1.0 - a2 - am);
+				}
+				row[xbi] += d*am;
+			}
+			x = xnext;
+		}
+	}
+
+	//! converts deltas into coverage in-place, count should be multiple of 4
+	static void prefix_sum(ColorReal *row, int count)
+	{
+	#ifdef __SSE2__
+		__m128 carry = _mm_setzero_ps();
+		for(ColorReal *end = row + count; row < end; row += 4) {
+			__m128 x = _mm_loadu_ps(row);
+			x = _mm_add_ps(x, _mm_castsi128_ps(_mm_slli_si128(_mm_castps_si128(x), 4)));
+			x = _mm_add_ps(x, _mm_castsi128_ps(_mm_slli_si128(_mm_castps_si128(x), 8)));
+			x = _mm_add_ps(x, carry);
+			_mm_storeu_ps(row, x);
+			carry = _mm_shuffle_ps(x, x, _MM_SHUFFLE(3, 3, 3, 3));
+		}
+	#else
+		ColorReal sum = 0;
+		for(ColorReal *end = row + count; row < end; ++row)
+			*row = (sum += *row);
+	#endif
+	}
+
+	ColorReal to_alpha(ColorReal coverage) const
+	{
+		ColorReal alpha = fabsf(coverage);
+		if (winding_style == rendering::Contour::WINDING_EVEN_ODD) {
+			alpha = fmodf(alpha, 2.f);
+			if (alpha > 1.f) alpha = 2.f - alpha;
+		} else
+		if (alpha > 1.f) alpha = 1.f;
+
+		// drop rounding errors of accumulation
+		const ColorReal precision = 1e-5f;
+		if (alpha < precision) alpha = 0.f; else
+		if (alpha > 1.f - precision) alpha = 1.f;
+
+		if (invert) alpha = 1.f - alpha;
+		if (!antialias) alpha = alpha >= 0.5f ? 1.f : 0.f;
+		return alpha;
+	}
+
+	void put_span(Color *dst, int count) const
+	{
+		if (simple_fill)
+			std::fill(dst, dst + count, color);
+		else
+			Color::blend_row(dst, color, count, opacity, blend_method);
+	}
+
+	//! blends color into row of surface using alpha of pixels
+	void put_row(Color *dst, const ColorReal *alpha, int begin, int end) const
+	{
+		for(int x = begin; x < end; ) {
+			ColorReal a = alpha[x];
+			if (a == 0.f) { ++x; continue; }
+			if (a == 1.f) {
+				int e = x + 1;
+				while(e < end && alpha[e] == 1.f) ++e;
+				put_span(dst + x, e - x);
+				x = e;
+				continue;
+			}
+			dst[x] = Color::blend(color, dst[x], opacity*a, blend_method);
+			++x;
+		}
+	}
+
+	void process(int band)
+	{
+		const int width = window.get_width();
+		const int miny = window.miny + band*band_height;
+		const int rows = std::min(band_height, window.maxy - miny);
+		const std::vector<int> &list = bands[band];
+
+		if (list.empty()) {
+			// there is no edges, so coverage is zero
+			if (invert)
+				for(int y = miny; y < miny + rows; ++y)
+					put_span(&surface[y][window.minx], width);
+			return;
+		}
+
+		// two extra cells for edges at the right border of window
+		const int stride = (width + 2 + 3) & ~3;
+		std::vector<ColorReal> cells(stride*rows, ColorReal());
+		std::vector<int> row_begin(rows, width);
+
+		for(std::vector<int>::const_iterator i = list.begin(); i != list.end(); ++i)
+			accumulate(edges[*i], &cells.front(), stride, &row_begin.front(), miny, rows, window.minx, width);
+
+		for(int r = 0; r < rows; ++r) {
+			Color *dst = &surface[miny + r][window.minx];
+			int begin = std::min(row_begin[r], width);
+			if (invert && begin > 0)
+				put_span(dst, begin);
+			if (begin >= width)
+				continue;
+
+			int begin4 = begin & ~3;
+			ColorReal *row = &cells[r*stride];
+			prefix_sum(row + begin4, stride - begin4);
+			for(int x = begin; x < width; ++x)
+				row[x] = to_alpha(row[x]);
+			put_row(dst, row, begin, width);
+		}
+	}
+
+	void run()
+	{
+		const int min_band_height = 16;
+		const int min_pixels_per_band = 16*1024;
+		const int width = window.get_width();
+		const int height = window.get_height();
+		if (width <= 0 || height <= 0)
+			return;
+
+		int count = std::max(1, 4*ThreadPool::instance.get_max_threads());
+		count = std::min(count, (height + min_band_height - 1)/min_band_height);
+		count = std::min(count, width*height/min_pixels_per_band);
+		count = std::max(1, count);
+		band_height = (height + count - 1)/count;
+		count = (height + band_height - 1)/band_height;
+
+		// bin edges by bands
+		bands.resize(count);
+		for(int i = 0; i < (int)edges.size(); ++i) {
+			const Edge &e = edges[i];
+			int y0 = std::max(0, (int)floor(std::min(e.y0, e.y1)) - window.miny);
+			int y1 = std::min(height, (int)ceil(std::max(e.y0, e.y1)) - window.miny);
+			if (y0 >= y1) continue;
+			for(int b = y0/band_height, end = (y1 - 1)/band_height; b <= end; ++b)
+				bands[b].push_back(i);
+		}
+
+		if (count == 1)
+			{ process(0); return; }
+
+		ThreadPool::Group group;
+		for(int i = 0; i < count; ++i)
+			group.enqueue( sigc::bind( sigc::mem_fun(*this, &BandRenderer::process), i ));
+		group.run();
+	}
+};
+
+} // end of anonimous namespace
+
 /* === M E T H O D S ======================================================= */
 
+void
+software::Contour::build_edges(
+	const rendering::Contour::ChunkList &chunks,
+	const Matrix &transform_matrix,
+	const RectInt &window,
+	EdgeList &out_edges,
+	Real detail )
+{
+	// max distance between curve and its segments in pixels
+	const Real tolerance = std::max(0.01, 0.1*detail);
+
+	Vector first, current, p[4];
+	bool opened = false;
+	for(rendering::Contour::ChunkList::const_iterator i = chunks.begin(); i != chunks.end(); ++i)
+	{
+		switch(i->type)
+		{
+			case rendering::Contour::CLOSE:
+				if (opened) add_line(out_edges, window, current, first);
+				current = first;
+				opened = false;
+				break;
+			case rendering::Contour::MOVE:
+				if (opened) add_line(out_edges, window, current, first);
+				first = current = transform_matrix.get_transformed(i->p1);
+				opened = true;
+				break;
+			case rendering::Contour::LINE:
+				if (!opened) { first = current; opened = true; }
+				p[0] = transform_matrix.get_transformed(i->p1);
+				add_line(out_edges, window, current, p[0]);
+				current = p[0];
+				break;
+			case rendering::Contour::CONIC:
+				if (!opened) { first = current; opened = true; }
+				p[0] = current;
+				p[1] = transform_matrix.get_transformed(i->pp0);
+				p[2] = transform_matrix.get_transformed(i->p1);
+				add_conic(out_edges, window, p, tolerance);
+				current = p[2];
+				break;
+			case rendering::Contour::CUBIC:
+				if (!opened) { first = current; opened = true; }
+				p[0] = current;
+				p[1] = transform_matrix.get_transformed(i->pp0);
+				p[2] = transform_matrix.get_transformed(i->pp1);
+				p[3] = transform_matrix.get_transformed(i->p1);
+				add_cubic(out_edges, window, p, tolerance);
+				current = p[3];
+				break;
+			default:
+				break;
+		}
+	}
+	if (opened) add_line(out_edges, window, current, first);
+}
+
+void
+software::Contour::build_edges(
+	const rendering::Contour &contour,
+	const Matrix &transform_matrix,
+	const RectInt &window,
+	EdgeList &out_edges,
+	Real detail )
+{
+	const Matrix &m = transform_matrix;
+	// for affine transformation length of any vector grows not more than in this number of times
+	Real scale = sqrt(m.m00*m.m00 + m.m01*m.m01 + m.m10*m.m10 + m.m11*m.m11);
+	if ( m.m02 != 0.0 || m.m12 != 0.0 || m.m22 != 1.0
+	  || !std::isfinite(scale) || !(scale > 0.0) )
+		{ build_edges(contour.get_chunks(), transform_matrix, window, out_edges, detail); return; }
+
+	const Real tolerance = std::max(0.01, 0.1*detail);
+	rendering::Contour::Polyline::Handle polyline = contour.get_polyline(tolerance/scale);
+	const std::vector<Vector> &points = polyline->points;
+
+	int first = 0;
+	for(std::vector<int>::const_iterator i = polyline->ends.begin(); i != polyline->ends.end(); first = *i++) {
+		Vector p0 = transform_matrix.get_transformed(points[first]), prev = p0;
+		for(int j = first + 1; j < *i; ++j) {
+			Vector p = transform_matrix.get_transformed(points[j]);
+			add_line(out_edges, window, prev, p);
+			prev = p;
+		}
+		add_line(out_edges, window, prev, p0);
+	}
+}
+
+void
+software::Contour::render_edges(
+	synfig::Surface &target_surface,
+	const RectInt &window,
+	const EdgeList &edges,
+	bool invert,
+	bool antialias,
+	rendering::Contour::WindingStyle winding_style,
+	const Color &color,
+	Color::value_type opacity,
+	Color::BlendMethod blend_method )
+{
+	RectInt r = window;
+	etl::set_intersect(r, r, RectInt(0, 0, target_surface.get_w(), target_surface.get_h()));
+	if (!r.is_valid())
+		return;
+
+	BandRenderer renderer(
+		target_surface,
+		r,
+		edges,
+		invert,
+		antialias,
+		winding_style,
+		color,
+		opacity,
+		blend_method );
+	renderer.run();
+}
+
 void
 software::Contour::render_polyspan(
 	synfig::Surface &target_surface,
@@ -313,14 +788,42 @@ software::Contour::render_contour(
 	Color::value_type opacity,
 	Color::BlendMethod blend_method )
 {
-	Polyspan polyspan;
-	polyspan.init(0, 0, target_surface.get_w(), target_surface.get_h());
-	build_polyspan(chunks, transform_matrix, polyspan);
-	polyspan.sort_marks();
+	RectInt window(0, 0, target_surface.get_w(), target_surface.get_h());
+	EdgeList edges;
+	build_edges(chunks, transform_matrix, window, edges);
+
+	render_edges(
+		target_surface,
+		window,
+		edges,
+		invert,
+		antialias,
+		winding_style,
+		color,
+		opacity,
+		blend_method );
+}
+
+void
+software::Contour::render_contour(
+	synfig::Surface &target_surface,
+	const rendering::Contour &contour,
+	bool invert,
+	bool antialias,
+	rendering::Contour::WindingStyle winding_style,
+	const Matrix &transform_matrix,
+	const Color &color,
+	Color::value_type opacity,
+	Color::BlendMethod blend_method )
+{
+	RectInt window(0, 0, target_surface.get_w(), target_surface.get_h());
+	EdgeList edges;
+	build_edges(contour, transform_matrix, window, edges);
 
-	return render_polyspan(
+	render_edges(
 		target_surface,
-		polyspan,
+		window,
+		edges,
 		invert,
 		antialias,
 		winding_style,
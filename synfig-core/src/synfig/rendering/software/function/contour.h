@@ -27,6 +27,8 @@
 
 /* === H E A D E R S ======================================================= */
 
+#include <vector>
+
 #include <synfig/surface.h>
 
 #include "../../primitive/contour.h"
@@ -48,6 +50,17 @@ namespace software
 class Contour
 {
 public:
+	//! line segment of flattened contour, in pixels of target surface
+	struct Edge
+	{
+		Real x0, y0, x1, y1;
+		Edge(): x0(), y0(), x1(), y1() { }
+		Edge(Real x0, Real y0, Real x1, Real y1):
+			x0(x0), y0(y0), x1(x1), y1(y1) { }
+	};
+
+	typedef std::vector<Edge> EdgeList;
+
 	static void render_polyspan(
 		synfig::Surface &target_surface,
 		const Polyspan &polyspan,
@@ -64,6 +77,38 @@ public:
 		Polyspan &out_polyspan,
 		Real detail = 0.25 );
 
+	//! flattens curves of contour into line segments,
+	//! parts of segments outside of window by x are projected onto the window border,
+	//! it keeps coverage of all pixels inside window
+	static void build_edges(
+		const rendering::Contour::ChunkList &chunks,
+		const Matrix &transform_matrix,
+		const RectInt &window,
+		EdgeList &out_edges,
+		Real detail = 0.25 );
+	//! the same as above, but for affine transformations it uses cached polyline of contour,
+	//! so curves are not flattened again while the contour is unchanged
+	static void build_edges(
+		const rendering::Contour &contour,
+		const Matrix &transform_matrix,
+		const RectInt &window,
+		EdgeList &out_edges,
+		Real detail = 0.25 );
+
+	//! renders edges into window of target surface by accumulation of signed area,
+	//! window should be the same as for build_edges and should be inside of surface,
+	//! edges are binned by horizontal bands of window, bands are rendered in parallel
+	static void render_edges(
+		synfig::Surface &target_surface,
+		const RectInt &window,
+		const EdgeList &edges,
+		bool invert,
+		bool antialias,
+		rendering::Contour::WindingStyle winding_style,
+		const Color &color,
+		Color::value_type opacity,
+		Color::BlendMethod blend_method );
+
 	static void render_contour(
 		synfig::Surface &target_surface,
 		const rendering::Contour::ChunkList &chunks,
@@ -74,6 +119,16 @@ public:
 		const Color &color,
 		Color::value_type opacity,
 		Color::BlendMethod blend_method );
+	static void render_contour(
+		synfig::Surface &target_surface,
+		const rendering::Contour &contour,
+		bool invert,
+		bool antialias,
+		rendering::Contour::WindingStyle winding_style,
+		const Matrix &transform_matrix,
+		const Color &color,
+		Color::value_type opacity,
+		Color::BlendMethod blend_method );
 };
 
 } /* end namespace software */
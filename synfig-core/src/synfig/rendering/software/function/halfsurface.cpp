@@ -0,0 +1,251 @@
+/* === S Y N F I G ========================================================= */
+/*!	\file synfig/rendering/software/function/halfsurface.cpp
+**	\brief HalfSurface
+**
+**	$Id$
+**
+**	\legal
+**	Copyright (c) 2019 Synfig Contributors
+**
+**	This package is free software; you can redistribute it and/or
+**	modify it under the terms of the GNU General Public License as
+**	published by the Free Software Foundation; either version 2 of
+**	the License, or (at your option) any later version.
+**
+**	This package is distributed in the hope that it will be useful,
+**	but WITHOUT ANY WARRANTY; without even the implied warranty of
+**	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+**	General Public License for more details.
+**	\endlegal
+*/
+/* ========================================================================= */
+
+
+/* === H E A D E R S ======================================================= */
+
+#ifdef USING_PCH
+#	include "pch.h"
+#else
+#ifdef HAVE_CONFIG_H
+#	include <config.h>
+#endif
+
+#include <algorithm>
+#include <cassert>
+
+#include <stdint.h>
+
+#ifdef __F16C__
+#include <immintrin.h>
+#endif
+
+#include "halfsurface.h"
+
+#endif
+
+using namespace synfig;
+using namespace rendering;
+using namespace software;
+
+/* === M A C R O S ========================================================= */
+
+/* === G L O B A L S ======================================================= */
+
+static_assert(sizeof(Color) == 4*sizeof(float), "Color should contain four floats");
+
+/* === P R O C E D U R E S ================================================= */
+
+/* === M E T H O D S ======================================================= */
+
+HalfSurface::HalfSurface():
+	width(), height() { }
+
+HalfSurface::Half
+HalfSurface::pack(float x)
+{
+	union { float f; uint32_t u; } v;
+	v.f = x;
+	uint32_t sign = (v.u >> 16) & 0x8000u;
+	uint32_t u = v.u & 0x7fffffffu;
+
+	// infinity, nan or overflow
+	if (u >= 0x47800000u)
+		return Half(sign | (u > 0x7f800000u ? 0x7e00u : 0x7c00u));
+
+	// normal, round to nearest even
+	if (u >= 0x38800000u) {
+		u -= 0x38000000u;
+		return Half(sign | ((u + 0x0fffu + ((u >> 13) & 1u)) >> 13));
+	}
+
+	// too small, round to zero
+	if (u < 0x33000000u)
+		return Half(sign);
+
+	// subnormal, round to nearest even
+	int shift = 126 - int(u >> 23);
+	uint32_t m = (u & 0x007fffffu) | 0x00800000u;
+	uint32_t h = m >> shift;
+	uint32_t rem = m & ((1u << shift) - 1u);
+	uint32_t mid = 1u << (shift - 1);
+	if (rem > mid || (rem == mid && (h & 1u))) ++h;
+	return Half(sign | h);
+}
+
+float
+HalfSurface::unpack(Half x)
+{
+	uint32_t sign = uint32_t(x & 0x8000u) << 16;
+	uint32_t e = (x >> 10) & 0x1fu;
+	uint32_t m = x & 0x03ffu;
+
+	union { float f; uint32_t u; } v;
+	if (e == 0x1fu) {
+		v.u = sign | 0x7f800000u | (m << 13);
+	} else
+	if (e) {
+		v.u = sign | ((e + 112u) << 23) | (m << 13);
+	} else
+	if (m) {
+		// subnormal, normalize it
+		e = 113u;
+		while(!(m & 0x0400u)) { m <<= 1; --e; }
+		v.u = sign | (e << 23) | ((m & 0x03ffu) << 13);
+	} else {
+		v.u = sign;
+	}
+	return v.f;
+}
+
+void
+HalfSurface::pack(Half *dest, const Color *src, int count)
+{
+	#ifdef __F16C__
+	// one pixel is one register, round to nearest even
+	for(const Color *end = src + count; src < end; ++src, dest += Channels)
+		_mm_storel_epi64(
+			(__m128i*)dest,
+			_mm_cvtps_ph(_mm_loadu_ps(&src->get_r()), 0) );
+	#else
+	for(const Color *end = src + count; src < end; ++src) {
+		*dest++ = pack(src->get_r());
+		*dest++ = pack(src->get_g());
+		*dest++ = pack(src->get_b());
+		*dest++ = pack(src->get_a());
+	}
+	#endif
+}
+
+void
+HalfSurface::unpack(Color *dest, const Half *src, int count)
+{
+	#ifdef __F16C__
+	for(Color *end = dest + count; dest < end; ++dest, src += Channels)
+		_mm_storeu_ps(
+			(float*)dest,
+			_mm_cvtph_ps(_mm_loadl_epi64((const __m128i*)src)) );
+	#else
+	for(Color *end = dest + count; dest < end; ++dest, src += Channels)
+		*dest = Color(unpack(src[0]), unpack(src[1]), unpack(src[2]), unpack(src[3]));
+	#endif
+}
+
+void
+HalfSurface::create(int width, int height)
+{
+	reset();
+	if (width <= 0 || height <= 0)
+		return;
+	this->width = width;
+	this->height = height;
+	// zero bits means transparent pixel
+	data.resize(Channels*width*height, Half());
+}
+
+void
+HalfSurface::clear()
+{
+	std::fill(data.begin(), data.end(), Half());
+}
+
+void
+HalfSurface::reset()
+{
+	width = height = 0;
+	std::vector<Half>().swap(data);
+}
+
+void
+HalfSurface::assign(const HalfSurface &other)
+{
+	if (&other == this) return;
+	width = other.width;
+	height = other.height;
+	data = other.data;
+}
+
+Color
+HalfSurface::get_pixel(int x, int y) const
+{
+	assert(x >= 0 && x < width && y >= 0 && y < height);
+	const Half *p = get_pointer(x, y);
+	return Color(unpack(p[0]), unpack(p[1]), unpack(p[2]), unpack(p[3]));
+}
+
+void
+HalfSurface::read_row(Color *dest, int x, int y, int count) const
+{
+	assert(x >= 0 && x + count <= width && y >= 0 && y < height);
+	unpack(dest, get_pointer(x, y), count);
+}
+
+void
+HalfSurface::write_row(const Color *src, int x, int y, int count)
+{
+	assert(x >= 0 && x + count <= width && y >= 0 && y < height);
+	pack(get_pointer(x, y), src, count);
+}
+
+void
+HalfSurface::set_pixels(const Color *pixels, int width, int height, int pitch)
+{
+	create(width, height);
+	if (pixels && width > 0 && height > 0)
+		set_pixels(RectInt(0, 0, width, height), pixels, pitch);
+}
+
+void
+HalfSurface::set_pixels(const RectInt &rect, const Color *pixels, int pitch)
+{
+	if (!pixels || !rect.is_valid())
+		return;
+	assert(rect.minx >= 0 && rect.maxx <= width && rect.miny >= 0 && rect.maxy <= height);
+
+	if (pitch == 0) pitch = sizeof(Color)*rect.get_width();
+	assert(pitch % sizeof(Color) == 0);
+	int src_pitch = pitch/sizeof(Color);
+
+	for(int y = rect.miny; y < rect.maxy; ++y, pixels += src_pitch)
+		write_row(pixels, rect.minx, y, rect.get_width());
+}
+
+void
+HalfSurface::get_pixels(Color *target, int pitch) const
+	{ get_pixels(RectInt(0, 0, width, height), target, pitch); }
+
+void
+HalfSurface::get_pixels(const RectInt &rect, Color *target, int pitch) const
+{
+	if (!target || !rect.is_valid())
+		return;
+	assert(rect.minx >= 0 && rect.maxx <= width && rect.miny >= 0 && rect.maxy <= height);
+
+	if (pitch == 0) pitch = sizeof(Color)*rect.get_width();
+	assert(pitch % sizeof(Color) == 0);
+	int dst_pitch = pitch/sizeof(Color);
+
+	for(int y = rect.miny; y < rect.maxy; ++y, target += dst_pitch)
+		read_row(target, rect.minx, y, rect.get_width());
+}
+
+/* === E N T R Y P O I N T ================================================= */
@@ -0,0 +1,136 @@
+/* === S Y N F I G ========================================================= */
+/*!	\file synfig/rendering/software/function/halfsurface.h
+**	\brief HalfSurface Header
+**
+**	$Id$
+**
+**	\legal
+**	Copyright (c) 2019 Synfig Contributors
+**
+**	This package is free software; you can redistribute it and/or
+**	modify it under the terms of the GNU General Public License as
+**	published by the Free Software Foundation; either version 2 of
+**	the License, or (at your option) any later version.
+**
+**	This package is distributed in the hope that it will be useful,
+**	but WITHOUT ANY WARRANTY; without even the implied warranty of
+**	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+**	General Public License for more details.
+**	\endlegal
+*/
+/* ========================================================================= */
+
+/* === S T A R T =========================================================== */
+
+#ifndef __SYNFIG_RENDERING_SOFTWARE_HALFSURFACE_H
+#define __SYNFIG_RENDERING_SOFTWARE_HALFSURFACE_H
+
+/* === H E A D E R S ======================================================= */
+
+#include <vector>
+
+#include <synfig/color.h>
+#include <synfig/rect.h>
+#include <synfig/surface.h>
+
+/* === M A C R O S ========================================================= */
+
+/* === T Y P E D E F S ===================================================== */
+
+/* === C L A S S E S & S T R U C T S ======================================= */
+
+namespace synfig
+{
+namespace rendering
+{
+namespace software
+{
+
+//! Surface with four 16-bit floating point channels per pixel (RGBA16F).
+//! Uses half of memory of synfig::Surface, pixels converted to Color on the fly.
+class HalfSurface
+{
+public:
+	typedef unsigned short Half;
+
+	enum { Channels = 4 };
+
+	class Reader
+	{
+	public:
+		template< etl::clamping::func clamp_x = etl::clamping::clamp,
+				  etl::clamping::func clamp_y = etl::clamping::clamp >
+		inline static Color reader(const void *surf, int x, int y)
+		{
+			const HalfSurface &s = *(const HalfSurface*)surf;
+			return clamp_x(x, s.width) && clamp_y(y, s.height)
+			     ? s.get_pixel(x, y) : Color();
+		}
+
+		template< etl::clamping::func clamp_x = etl::clamping::clamp,
+				  etl::clamping::func clamp_y = etl::clamping::clamp >
+		inline static ColorAccumulator reader_cook(const void *surf, int x, int y)
+		{
+			const HalfSurface &s = *(const HalfSurface*)surf;
+			return clamp_x(x, s.width) && clamp_y(y, s.height)
+				 ? ColorPrep::cook_static(s.get_pixel(x, y)) : Color();
+		}
+	};
+
+private:
+	int width;
+	int height;
+	std::vector<Half> data;
+
+public:
+	HalfSurface();
+
+	static Half pack(float x);
+	static float unpack(Half x);
+	//! converts count of pixels into half-float format
+	static void pack(Half *dest, const Color *src, int count);
+	//! converts count of pixels from half-float format
+	static void unpack(Color *dest, const Half *src, int count);
+
+	//! creates transparent surface
+	void create(int width, int height);
+	void clear();
+	void reset();
+	void assign(const HalfSurface &other);
+
+	int get_width() const { return width; }
+	int get_height() const { return height; }
+
+	Half* get_pointer(int x, int y)
+		{ return &data[Channels*(y*width + x)]; }
+	const Half* get_pointer(int x, int y) const
+		{ return &data[Channels*(y*width + x)]; }
+
+	Color get_pixel(int x, int y) const;
+
+	//! reads count of pixels of row y starting from x
+	void read_row(Color *dest, int x, int y, int count) const;
+	//! writes count of pixels of row y starting from x
+	void write_row(const Color *src, int x, int y, int count);
+
+	//! replaces content of surface, pitch is in bytes
+	void set_pixels(const Color *pixels, int width, int height, int pitch = 0);
+	//! copies the rect of pixels from the buffer, pixel (0, 0) of buffer is rect.get_min()
+	void set_pixels(const RectInt &rect, const Color *pixels, int pitch);
+	//! copies whole surface into the buffer
+	void get_pixels(Color *target, int pitch = 0) const;
+	//! copies the rect of surface into the buffer, pixel (0, 0) of target is rect.get_min()
+	void get_pixels(const RectInt &rect, Color *target, int pitch) const;
+
+	//! returns size of allocated pixels in bytes
+	size_t get_memory_size() const
+		{ return data.size()*sizeof(Half); }
+};
+
+} /* end namespace software */
+} /* end namespace rendering */
+} /* end namespace synfig */
+
+/* -- E N D ----------------------------------------------------------------- */
+
+#endif
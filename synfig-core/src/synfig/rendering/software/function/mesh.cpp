@@ -29,6 +29,16 @@
 #	include <config.h>
 #endif
 
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+#include <synfig/threadpool.h>
+
 #include "mesh.h"
 
 #endif
@@ -84,6 +94,336 @@ namespace {
 				coords[1] -= floor(coords[1]/size[1])*size[1];
 		}
 	};
+
+	//! Renders whole mesh at once.
+	//! Vertices are transformed only once, triangles are binned by tiles of target,
+	//! and tiles are rasterized in parallel using incremental edge functions.
+	//! Triangles within a tile are drawn in the original order,
+	//! so the result is the same as for sequential rendering.
+	class MeshRenderer {
+	public:
+		enum {
+			TILE_SIZE = 64,
+			SUBPIXEL_BITS = 4,
+			SUBPIXELS = 1 << SUBPIXEL_BITS
+		};
+
+		typedef long long Fixed;
+
+		struct Triangle
+		{
+			//! edge functions in subpixels: e[i]*x + f[i]*y + g[i] >= 0 for pixels inside
+			Fixed e[3], f[3], g[3];
+			RectInt bounds;
+			Matrix tex_matrix; //!< target pixels to texture pixels
+			bool solid;        //!< triangle without texture
+		};
+
+	private:
+		synfig::Surface &target_surface;
+		const RectInt bounds;
+		const synfig::Surface *texture;
+		const Rect tex_bounds;
+		const Color color;
+		const Color::value_type opacity;
+		const Color::BlendMethod blend_method;
+
+		std::vector<Vector> positions;
+		std::vector<Vector> tex_coords;
+		std::vector<Triangle> triangles;
+
+		int tiles_x, tiles_y;
+		std::vector< std::vector<int> > tiles;
+		std::vector<Real> tiles_work;
+
+		static void fill_cubic_polinomial(float x, float *tx)
+		{
+			tx[0] = 0.5f*x*(x*(-x + 2.f) - 1.f);
+			tx[1] = 0.5f*(x*(x*(3.f*x - 5.f)) + 2.f);
+			tx[2] = 0.5f*x*(x*(-3.f*x + 4.f) + 1.f);
+			tx[3] = 0.5f*x*x*(x - 1.f);
+		}
+
+		//! the same as synfig::Surface::cubic_sample(),
+		//! processes all channels of pixel at once when SSE2 is available
+		static Color cubic_sample(const synfig::Surface &surface, float x, float y)
+		{
+		#ifdef __SSE2__
+			const int w = surface.get_w(), h = surface.get_h();
+			const int xi = (int)floor(x), yi = (int)floor(y);
+			float tx[4], ty[4];
+			fill_cubic_polinomial(x - (float)xi, tx);
+			fill_cubic_polinomial(y - (float)yi, ty);
+
+			int xa[4];
+			for(int i = 0; i < 4; ++i)
+				xa[i] = std::max(0, std::min(w - 1, xi - 1 + i));
+
+			// colors are premultiplied by alpha before interpolation, alpha channel itself is kept
+			const __m128 alpha_mask = _mm_castsi128_ps(_mm_set_epi32(-1, 0, 0, 0));
+			__m128 sum = _mm_setzero_ps();
+			for(int j = 0; j < 4; ++j) {
+				const Color *row = surface[std::max(0, std::min(h - 1, yi - 1 + j))];
+				__m128 sum_row = _mm_setzero_ps();
+				for(int i = 0; i < 4; ++i) {
+					__m128 c = _mm_loadu_ps((const float*)&row[xa[i]]);
+					__m128 a = _mm_shuffle_ps(c, c, _MM_SHUFFLE(3, 3, 3, 3));
+					c = _mm_or_ps(_mm_and_ps(alpha_mask, c), _mm_andnot_ps(alpha_mask, _mm_mul_ps(c, a)));
+					sum_row = _mm_add_ps(sum_row, _mm_mul_ps(c, _mm_set1_ps(tx[i])));
+				}
+				sum = _mm_add_ps(sum, _mm_mul_ps(sum_row, _mm_set1_ps(ty[j])));
+			}
+
+			float v[4];
+			_mm_storeu_ps(v, sum);
+			if (!v[3]) return Color::alpha();
+			const float k = 1.f/v[3];
+			return Color(v[0]*k, v[1]*k, v[2]*k, v[3]);
+		#else
+			return surface.cubic_sample(x, y);
+		#endif
+		}
+
+		static Fixed to_fixed(Real x)
+			{ return (Fixed)round(x*SUBPIXELS); }
+
+		bool setup(Triangle &t, int i0, int i1, int i2) const
+		{
+			const Vector &p0 = positions[i0], &p1 = positions[i1], &p2 = positions[i2];
+
+			// coordinates are limited to avoid overflow of edge functions
+			const Real max_coord = Real(1 << 25);
+			const Vector *p[3] = { &p0, &p1, &p2 };
+			for(int i = 0; i < 3; ++i)
+				if (!(std::fabs((*p[i])[0]) < max_coord && std::fabs((*p[i])[1]) < max_coord))
+					return false;
+
+			Rect rect = Rect(p0).expand(p1).expand(p2);
+			t.bounds = RectInt( (int)floor(rect.minx), (int)floor(rect.miny),
+			                    (int)ceil(rect.maxx), (int)ceil(rect.maxy) );
+			etl::set_intersect(t.bounds, t.bounds, bounds);
+			if (!t.bounds.is_valid())
+				return false;
+
+			Fixed x[3], y[3];
+			for(int i = 0; i < 3; ++i)
+				{ x[i] = to_fixed((*p[i])[0]); y[i] = to_fixed((*p[i])[1]); }
+
+			for(int i = 0; i < 3; ++i) {
+				int a = (i + 1)%3, b = (i + 2)%3;
+				t.e[i] = y[a] - y[b];
+				t.f[i] = x[b] - x[a];
+				t.g[i] = x[a]*y[b] - y[a]*x[b];
+			}
+
+			Fixed area = t.e[0]*x[0] + t.f[0]*y[0] + t.g[0];
+			if (!area)
+				return false;
+			for(int i = 0; i < 3; ++i) {
+				if (area < 0)
+					{ t.e[i] = -t.e[i]; t.f[i] = -t.f[i]; t.g[i] = -t.g[i]; }
+				// pixels exactly on the edge belongs to one of adjacent triangles only
+				if (!(t.e[i] > 0 || (t.e[i] == 0 && t.f[i] > 0)))
+					--t.g[i];
+			}
+
+			t.solid = !texture;
+			if (texture) {
+				const Vector &t0 = tex_coords[i0], &t1 = tex_coords[i1], &t2 = tex_coords[i2];
+				if ( (t0[0] < tex_bounds.minx && t1[0] < tex_bounds.minx && t2[0] < tex_bounds.minx)
+				  || (t0[1] < tex_bounds.miny && t1[1] < tex_bounds.miny && t2[1] < tex_bounds.miny)
+				  || (t0[0] > tex_bounds.maxx && t1[0] > tex_bounds.maxx && t2[0] > tex_bounds.maxx)
+				  || (t0[1] > tex_bounds.maxy && t1[1] > tex_bounds.maxy && t2[1] > tex_bounds.maxy) )
+				{
+					// triangle outside of texture clears the target for straight blending only
+					if (!Color::is_straight(blend_method))
+						return false;
+					t.solid = true;
+				} else {
+					// the same mapping as in render_triangle(), tex_bounds are in the same space
+					Matrix matrix_of_texture_triangle(
+						t1[0]-t0[0], t1[1]-t0[1], 0.0,
+						t2[0]-t0[0], t2[1]-t0[1], 0.0,
+						t0[0], t0[1], 1.0 );
+					Matrix matrix_of_target_triangle(
+						p1[0]-p0[0], p1[1]-p0[1], 0.0,
+						p2[0]-p0[0], p2[1]-p0[1], 0.0,
+						p0[0], p0[1], 1.0 );
+					if (!matrix_of_target_triangle.is_invertible())
+						return false;
+					matrix_of_target_triangle.invert();
+					t.tex_matrix = matrix_of_texture_triangle * matrix_of_target_triangle;
+				}
+			}
+			return true;
+		}
+
+		void put_span(Color *dst, const Triangle &t, int x0, int x1, int y, std::vector<Color> &buffer) const
+		{
+			if (t.solid) {
+				Color::blend_row(dst + x0, texture ? Color() : color, x1 - x0, opacity, blend_method);
+				return;
+			}
+
+			Vector tex_point = t.tex_matrix.get_transformed(Vector(Real(x0), Real(y)));
+			Vector tdx = t.tex_matrix.get_transformed(Vector(1.0, 0.0), false);
+			Color *buf = &buffer.front() - x0;
+			int begin = x0;
+			for(int x = x0; x < x1; ++x, tex_point += tdx) {
+				if ( tex_point[0] < tex_bounds.minx || tex_point[0] > tex_bounds.maxx
+				  || tex_point[1] < tex_bounds.miny || tex_point[1] > tex_bounds.maxy )
+				{
+					// pixels outside of texture are not touched
+					if (begin < x)
+						Color::blend_row(dst + begin, buf + begin, x - begin, opacity, blend_method);
+					begin = x + 1;
+					continue;
+				}
+				buf[x] = cubic_sample(*texture, (float)tex_point[0], (float)tex_point[1]);
+			}
+			if (begin < x1)
+				Color::blend_row(dst + begin, buf + begin, x1 - begin, opacity, blend_method);
+		}
+
+		void render_triangle(const Triangle &t, const RectInt &tile, std::vector<Color> &buffer) const
+		{
+			RectInt r = t.bounds;
+			etl::set_intersect(r, r, tile);
+			if (!r.is_valid())
+				return;
+
+			const Fixed half = SUBPIXELS/2;
+			const Fixed cx = r.minx*(Fixed)SUBPIXELS + half;
+			const Fixed de0 = t.e[0]*SUBPIXELS, de1 = t.e[1]*SUBPIXELS, de2 = t.e[2]*SUBPIXELS;
+			for(int y = r.miny; y < r.maxy; ++y) {
+				const Fixed cy = y*(Fixed)SUBPIXELS + half;
+				Fixed w0 = t.e[0]*cx + t.f[0]*cy + t.g[0];
+				Fixed w1 = t.e[1]*cx + t.f[1]*cy + t.g[1];
+				Fixed w2 = t.e[2]*cx + t.f[2]*cy + t.g[2];
+
+				// triangle is convex, so pixels inside are contiguous
+				int x = r.minx;
+				while(x < r.maxx && (w0 | w1 | w2) < 0)
+					{ w0 += de0; w1 += de1; w2 += de2; ++x; }
+				int x0 = x;
+				while(x < r.maxx && (w0 | w1 | w2) >= 0)
+					{ w0 += de0; w1 += de1; w2 += de2; ++x; }
+				if (x0 < x)
+					put_span(target_surface[y], t, x0, x, y, buffer);
+			}
+		}
+
+		void process_tile(int index) const
+		{
+			int tx = index % tiles_x, ty = index / tiles_x;
+			RectInt tile(
+				bounds.minx + tx*TILE_SIZE,
+				bounds.miny + ty*TILE_SIZE,
+				std::min(bounds.maxx, bounds.minx + (tx + 1)*TILE_SIZE),
+				std::min(bounds.maxy, bounds.miny + (ty + 1)*TILE_SIZE) );
+			std::vector<Color> buffer(TILE_SIZE);
+			const std::vector<int> &list = tiles[index];
+			for(std::vector<int>::const_iterator i = list.begin(); i != list.end(); ++i)
+				render_triangle(triangles[*i], tile, buffer);
+		}
+
+	public:
+		MeshRenderer(
+			synfig::Surface &target_surface,
+			const RectInt &bounds,
+			const synfig::Surface *texture,
+			const Rect &tex_bounds,
+			const Color &color,
+			Color::value_type opacity,
+			Color::BlendMethod blend_method
+		):
+			target_surface(target_surface),
+			bounds(bounds),
+			texture(texture),
+			tex_bounds(tex_bounds),
+			color(color),
+			opacity(opacity),
+			blend_method(blend_method),
+			tiles_x(),
+			tiles_y()
+		{ }
+
+		void render(
+			const Vector *vertices,
+			int vertices_strip,
+			const Vector *tex_coords_ptr,
+			int tex_coords_strip,
+			const int *triangles_ptr,
+			int triangles_strip,
+			int triangles_count,
+			const Matrix &transform_matrix,
+			const Matrix &texture_matrix )
+		{
+			// transform each vertex only once
+			int vertices_count = 0;
+			for(int i = 0; i < triangles_count; ++i) {
+				const int *triangle = (const int*)((const char*)triangles_ptr + i*triangles_strip);
+				vertices_count = std::max(vertices_count, 1 + std::max(triangle[0], std::max(triangle[1], triangle[2])));
+			}
+			positions.resize(vertices_count);
+			for(int i = 0; i < vertices_count; ++i)
+				positions[i] = transform_matrix.get_transformed(*(const Vector*)((const char*)vertices + i*vertices_strip));
+			if (texture) {
+				tex_coords.resize(vertices_count);
+				for(int i = 0; i < vertices_count; ++i)
+					tex_coords[i] = texture_matrix.get_transformed(*(const Vector*)((const char*)tex_coords_ptr + i*tex_coords_strip));
+			}
+
+			// bin triangles by tiles
+			tiles_x = (bounds.get_width() + TILE_SIZE - 1)/TILE_SIZE;
+			tiles_y = (bounds.get_height() + TILE_SIZE - 1)/TILE_SIZE;
+			tiles.resize(tiles_x*tiles_y);
+			tiles_work.resize(tiles.size(), 0.0);
+			triangles.reserve(triangles_count);
+			Real work = 0.0;
+			for(int i = 0; i < triangles_count; ++i) {
+				const int *triangle = (const int*)((const char*)triangles_ptr + i*triangles_strip);
+				Triangle t;
+				if ( triangle[0] < 0 || triangle[1] < 0 || triangle[2] < 0
+				  || !setup(t, triangle[0], triangle[1], triangle[2]) )
+					continue;
+
+				int index = (int)triangles.size();
+				triangles.push_back(t);
+				int tx0 = (t.bounds.minx - bounds.minx)/TILE_SIZE;
+				int ty0 = (t.bounds.miny - bounds.miny)/TILE_SIZE;
+				int tx1 = (t.bounds.maxx - bounds.minx - 1)/TILE_SIZE;
+				int ty1 = (t.bounds.maxy - bounds.miny - 1)/TILE_SIZE;
+				for(int ty = ty0; ty <= ty1; ++ty)
+					for(int tx = tx0; tx <= tx1; ++tx) {
+						int tile = ty*tiles_x + tx;
+						tiles[tile].push_back(index);
+						RectInt r = t.bounds;
+						etl::set_intersect(r, r, RectInt(
+							bounds.minx + tx*TILE_SIZE, bounds.miny + ty*TILE_SIZE,
+							bounds.minx + (tx + 1)*TILE_SIZE, bounds.miny + (ty + 1)*TILE_SIZE ));
+						// sampling of texture is much more expensive than filling
+						Real w = r.get_width()*r.get_height()*(t.solid ? 1.0 : 8.0);
+						tiles_work[tile] += w;
+						work += w;
+					}
+			}
+			if (triangles.empty())
+				return;
+
+			// about four chunks per thread, but not too small
+			Real chunk = std::max(
+				Real(64*1024),
+				work/(4*ThreadPool::instance.get_max_threads()) );
+			ThreadPool::Group group;
+			for(int i = 0; i < (int)tiles.size(); ++i)
+				if (!tiles[i].empty())
+					group.enqueue(
+						sigc::bind(sigc::mem_fun(*this, &MeshRenderer::process_tile), i),
+						tiles_work[i]/chunk );
+			group.run();
+		}
+	};
 }
 
 void
@@ -393,19 +733,19 @@ software::Mesh::render_polygon(
 	if (vertices_strip <= 0) vertices_strip = sizeof(Vector);
 	if (triangles_strip <= 0) triangles_strip = sizeof(int[3]);
 
-	for(int i = 0; i < triangles_count; ++i)
-	{
-		int *triangle = (int*)((char*)triangles + i*triangles_strip);
-		render_triangle(
-			target_surface,
-			target_rect,
-			transform_matrix.get_transformed(*(Vector*)((char*)vertices + triangle[0]*vertices_strip)),
-			transform_matrix.get_transformed(*(Vector*)((char*)vertices + triangle[1]*vertices_strip)),
-			transform_matrix.get_transformed(*(Vector*)((char*)vertices + triangle[2]*vertices_strip)),
-			color,
-			opacity,
-			blend_method );
-	}
+	MeshRenderer renderer(
+		target_surface,
+		bounds,
+		NULL,
+		Rect(),
+		color,
+		opacity,
+		blend_method );
+	renderer.render(
+		vertices, vertices_strip,
+		NULL, 0,
+		triangles, triangles_strip, triangles_count,
+		transform_matrix, Matrix() );
 }
 
 void
@@ -471,23 +811,19 @@ software::Mesh::render_mesh(
 	if (tex_coords_strip <= 0) tex_coords_strip = sizeof(Vector);
 	if (triangles_strip <= 0) triangles_strip = sizeof(int[3]);
 
-	for(int i = 0; i < triangles_count; ++i)
-	{
-		int *triangle = (int*)((char*)triangles + i*triangles_strip);
-		render_triangle(
-			target_surface,
-			target_rect,
-			transform_matrix.get_transformed(*(Vector*)((char*)vertices + triangle[0]*vertices_strip)),
-			texture_matrix.get_transformed(*(Vector*)((char*)tex_coords + triangle[0]*tex_coords_strip)),
-			transform_matrix.get_transformed(*(Vector*)((char*)vertices + triangle[1]*vertices_strip)),
-			texture_matrix.get_transformed(*(Vector*)((char*)tex_coords + triangle[1]*tex_coords_strip)),
-			transform_matrix.get_transformed(*(Vector*)((char*)vertices + triangle[2]*vertices_strip)),
-			texture_matrix.get_transformed(*(Vector*)((char*)tex_coords + triangle[2]*tex_coords_strip)),
-			texture,
-			texture_rect,
-			opacity,
-			blend_method );
-	}
+	MeshRenderer renderer(
+		target_surface,
+		bounds,
+		&texture,
+		texture_rect & Rect(0.0, 0.0, texture.get_w(), texture.get_h()),
+		Color(),
+		opacity,
+		blend_method );
+	renderer.render(
+		vertices, vertices_strip,
+		tex_coords, tex_coords_strip,
+		triangles, triangles_strip, triangles_count,
+		transform_matrix, texture_matrix );
 }
 
 void
@@ -564,4 +564,87 @@ software::Resample::resample(
 }
 
 
+void
+software::Resample::resample(
+	synfig::Surface &dest,
+	const RectInt &dest_bounds,
+	const software::HalfSurface &src,
+	const RectInt &src_bounds,
+	const Matrix &transformation,
+	Color::Interpolation interpolation,
+	bool blend,
+	ColorReal blend_amount,
+	Color::BlendMethod blend_method )
+{
+	typedef software::HalfSurface::Reader Reader;
+	Helper::Generic<Reader::reader, Reader::reader_cook>::resample_with_downscale(
+		dest,
+		dest_bounds,
+		&src,
+		src_bounds,
+		transformation,
+		interpolation,
+		blend,
+		blend_amount,
+		blend_method );
+}
+
+void
+software::Resample::resample(
+	synfig::Surface &dest,
+	const RectInt &dest_bounds,
+	const software::TiledSurface &src,
+	const RectInt &src_bounds,
+	const Matrix &transformation,
+	Color::Interpolation interpolation,
+	bool blend,
+	ColorReal blend_amount,
+	Color::BlendMethod blend_method )
+{
+	RectInt bounds = dest_bounds;
+	if (blend && !Color::is_straight(blend_method)) {
+		// margins covers interpolation kernel in source and destination pixels
+		const int src_margin = 2;
+		const int dest_margin = 3;
+
+		RectInt populated = src.get_populated_rect();
+		if (!populated.is_valid())
+			return;
+		populated.expand(src_margin);
+
+		Vector corners[] = {
+			transformation.get_transformed(Vector( Real(populated.minx), Real(populated.miny) )),
+			transformation.get_transformed(Vector( Real(populated.maxx), Real(populated.miny) )),
+			transformation.get_transformed(Vector( Real(populated.minx), Real(populated.maxy) )),
+			transformation.get_transformed(Vector( Real(populated.maxx), Real(populated.maxy) )) };
+
+		Rect boundsf(   corners[0] );
+		boundsf.expand( corners[1] );
+		boundsf.expand( corners[2] );
+		boundsf.expand( corners[3] );
+
+		RectInt populated_dest(
+			(int)approximate_floor(boundsf.minx) - dest_margin,
+			(int)approximate_floor(boundsf.miny) - dest_margin,
+			(int)approximate_ceil (boundsf.maxx) + dest_margin,
+			(int)approximate_ceil (boundsf.maxy) + dest_margin );
+
+		etl::set_intersect(bounds, bounds, populated_dest);
+		if (!bounds.is_valid())
+			return;
+	}
+
+	typedef software::TiledSurface::Reader Reader;
+	Helper::Generic<Reader::reader, Reader::reader_cook>::resample_with_downscale(
+		dest,
+		bounds,
+		&src,
+		src_bounds,
+		transformation,
+		interpolation,
+		blend,
+		blend_amount,
+		blend_method );
+}
+
 /* === E N T R Y P O I N T ================================================= */
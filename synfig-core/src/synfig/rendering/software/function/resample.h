@@ -31,6 +31,8 @@
 #include <synfig/surface.h>
 
 #include "../surfaceswpacked.h"
+#include "halfsurface.h"
+#include "tiledsurface.h"
 
 /* === M A C R O S ========================================================= */
 
@@ -83,6 +85,30 @@ public:
 		bool blend,
 		ColorReal blend_amount,
 		Color::BlendMethod blend_method );
+
+	static void resample(
+		synfig::Surface &dest,
+		const RectInt &dest_bounds,
+		const software::HalfSurface &src,
+		const RectInt &src_bounds,
+		const Matrix &transformation,
+		Color::Interpolation interpolation,
+		bool blend,
+		ColorReal blend_amount,
+		Color::BlendMethod blend_method );
+
+	//! when transparent pixels doesn't change the destination
+	//! then only area of non-transparent tiles will be processed
+	static void resample(
+		synfig::Surface &dest,
+		const RectInt &dest_bounds,
+		const software::TiledSurface &src,
+		const RectInt &src_bounds,
+		const Matrix &transformation,
+		Color::Interpolation interpolation,
+		bool blend,
+		ColorReal blend_amount,
+		Color::BlendMethod blend_method );
 };
 
 } /* end namespace software */
@@ -0,0 +1,255 @@
+/* === S Y N F I G ========================================================= */
+/*!	\file synfig/rendering/software/function/tiledsurface.cpp
+**	\brief TiledSurface
+**
+**	$Id$
+**
+**	\legal
+**	Copyright (c) 2019 Synfig Contributors
+**
+**	This package is free software; you can redistribute it and/or
+**	modify it under the terms of the GNU General Public License as
+**	published by the Free Software Foundation; either version 2 of
+**	the License, or (at your option) any later version.
+**
+**	This package is distributed in the hope that it will be useful,
+**	but WITHOUT ANY WARRANTY; without even the implied warranty of
+**	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+**	General Public License for more details.
+**	\endlegal
+*/
+/* ========================================================================= */
+
+/* === H E A D E R S ======================================================= */
+
+#ifdef USING_PCH
+#	include "pch.h"
+#else
+#ifdef HAVE_CONFIG_H
+#	include <config.h>
+#endif
+
+#include <cassert>
+#include <cstring>
+
+#include "tiledsurface.h"
+
+#endif
+
+using namespace synfig;
+using namespace rendering;
+using namespace software;
+
+/* === M A C R O S ========================================================= */
+
+/* === G L O B A L S ======================================================= */
+
+/* === P R O C E D U R E S ================================================= */
+
+/* === M E T H O D S ======================================================= */
+
+TiledSurface::TiledSurface():
+	width(), height(), tiles_width(), tiles_height() { }
+
+void
+TiledSurface::fill(Color *dest, int pitch, int width, int height, const Color &color)
+{
+	for(Color *row = dest, *end = row + pitch*height; row < end; row += pitch)
+		for(Color *c = row, *row_end = c + width; c < row_end; ++c)
+			*c = color;
+}
+
+bool
+TiledSurface::is_constant(const Color *pixels, int pitch, int width, int height)
+{
+	const Color &color = *pixels;
+	for(const Color *row = pixels, *end = row + pitch*height; row < end; row += pitch)
+		for(const Color *c = row, *row_end = c + width; c < row_end; ++c)
+			if (*c != color) return false;
+	return true;
+}
+
+void
+TiledSurface::create(int width, int height)
+{
+	reset();
+	if (width <= 0 || height <= 0)
+		return;
+	this->width = width;
+	this->height = height;
+	tiles_width = (width + TileSize - 1)/TileSize;
+	tiles_height = (height + TileSize - 1)/TileSize;
+	tiles.resize(tiles_width*tiles_height);
+}
+
+void
+TiledSurface::clear()
+{
+	for(std::vector<Tile>::iterator i = tiles.begin(); i != tiles.end(); ++i)
+		{ i->data.reset(); i->constant = Color(); }
+}
+
+void
+TiledSurface::reset()
+{
+	width = height = tiles_width = tiles_height = 0;
+	tiles.clear();
+}
+
+void
+TiledSurface::assign(const TiledSurface &other)
+{
+	if (&other == this) return;
+	width = other.width;
+	height = other.height;
+	tiles_width = other.tiles_width;
+	tiles_height = other.tiles_height;
+	tiles = other.tiles;
+}
+
+RectInt
+TiledSurface::get_tile_rect(int tx, int ty) const
+{
+	return RectInt(
+		tx*TileSize,
+		ty*TileSize,
+		std::min(width, (tx + 1)*TileSize),
+		std::min(height, (ty + 1)*TileSize) );
+}
+
+RectInt
+TiledSurface::get_tiles_range(const RectInt &rect) const
+{
+	RectInt r = rect;
+	etl::set_intersect(r, r, RectInt(0, 0, width, height));
+	if (!r.is_valid())
+		return RectInt::zero();
+	return RectInt(
+		r.minx/TileSize,
+		r.miny/TileSize,
+		(r.maxx + TileSize - 1)/TileSize,
+		(r.maxy + TileSize - 1)/TileSize );
+}
+
+Color*
+TiledSurface::get_tile_pixels(int tx, int ty)
+{
+	Tile &tile = tiles[ty*tiles_width + tx];
+	if (!tile.data) {
+		tile.data = new TileData();
+		fill(tile.data->pixels, TileSize, TileSize, TileSize, tile.constant);
+	} else
+	if (!tile.data.unique()) {
+		// tile is shared with another surface, make own copy
+		TileData::Handle data = new TileData();
+		memcpy(data->pixels, tile.data->pixels, sizeof(data->pixels));
+		tile.data = data;
+	}
+	return tile.data->pixels;
+}
+
+void
+TiledSurface::set_tile_constant(int tx, int ty, const Color &color)
+{
+	Tile &tile = tiles[ty*tiles_width + tx];
+	tile.data.reset();
+	tile.constant = color;
+}
+
+Color
+TiledSurface::get_pixel(int x, int y) const
+{
+	assert(x >= 0 && x < width && y >= 0 && y < height);
+	const Tile &tile = get_tile(x/TileSize, y/TileSize);
+	return tile.data
+		 ? tile.data->pixels[(y%TileSize)*TileSize + x%TileSize]
+		 : tile.constant;
+}
+
+void
+TiledSurface::set_pixels(const Color *pixels, int width, int height, int pitch)
+{
+	create(width, height);
+	if (!pixels || tiles.empty())
+		return;
+
+	if (pitch == 0) pitch = sizeof(Color)*width;
+	assert(pitch % sizeof(Color) == 0);
+	int src_pitch = pitch/sizeof(Color);
+
+	for(int ty = 0; ty < tiles_height; ++ty) {
+		for(int tx = 0; tx < tiles_width; ++tx) {
+			RectInt r = get_tile_rect(tx, ty);
+			const Color *src = pixels + r.miny*src_pitch + r.minx;
+			int w = r.get_width(), h = r.get_height();
+
+			if (is_constant(src, src_pitch, w, h)) {
+				set_tile_constant(tx, ty, *src);
+				continue;
+			}
+
+			Color *dst = get_tile_pixels(tx, ty);
+			for(int y = 0; y < h; ++y, src += src_pitch, dst += TileSize)
+				memcpy(dst, src, w*sizeof(Color));
+		}
+	}
+}
+
+void
+TiledSurface::get_pixels(Color *target, int pitch) const
+	{ get_pixels(RectInt(0, 0, width, height), target, pitch); }
+
+void
+TiledSurface::get_pixels(const RectInt &rect, Color *target, int pitch) const
+{
+	if (!target || !rect.is_valid())
+		return;
+
+	if (pitch == 0) pitch = sizeof(Color)*rect.get_width();
+	assert(pitch % sizeof(Color) == 0);
+	int dst_pitch = pitch/sizeof(Color);
+
+	RectInt range = get_tiles_range(rect);
+	for(int ty = range.miny; ty < range.maxy; ++ty) {
+		for(int tx = range.minx; tx < range.maxx; ++tx) {
+			RectInt r = get_tile_rect(tx, ty);
+			etl::set_intersect(r, r, rect);
+			if (!r.is_valid()) continue;
+
+			Color *dst = target + (r.miny - rect.miny)*dst_pitch + (r.minx - rect.minx);
+			int w = r.get_width(), h = r.get_height();
+
+			const Tile &tile = get_tile(tx, ty);
+			if (!tile.data) {
+				fill(dst, dst_pitch, w, h, tile.constant);
+				continue;
+			}
+
+			const Color *src = tile.data->pixels + (r.miny%TileSize)*TileSize + r.minx%TileSize;
+			for(int y = 0; y < h; ++y, src += TileSize, dst += dst_pitch)
+				memcpy(dst, src, w*sizeof(Color));
+		}
+	}
+}
+
+RectInt
+TiledSurface::get_populated_rect() const
+{
+	RectInt rect = RectInt::zero();
+	for(int ty = 0; ty < tiles_height; ++ty)
+		for(int tx = 0; tx < tiles_width; ++tx)
+			if (!get_tile(tx, ty).is_transparent())
+				rect |= get_tile_rect(tx, ty);
+	return rect;
+}
+
+size_t
+TiledSurface::get_memory_size() const
+{
+	size_t size = tiles.size()*sizeof(Tile);
+	for(std::vector<Tile>::const_iterator i = tiles.begin(); i != tiles.end(); ++i)
+		if (i->data) size += sizeof(TileData);
+	return size;
+}
+
+/* === E N T R Y P O I N T ================================================= */
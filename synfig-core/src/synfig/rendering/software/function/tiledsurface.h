@@ -0,0 +1,163 @@
+/* === S Y N F I G ========================================================= */
+/*!	\file synfig/rendering/software/function/tiledsurface.h
+**	\brief TiledSurface Header
+**
+**	$Id$
+**
+**	\legal
+**	Copyright (c) 2019 Synfig Contributors
+**
+**	This package is free software; you can redistribute it and/or
+**	modify it under the terms of the GNU General Public License as
+**	published by the Free Software Foundation; either version 2 of
+**	the License, or (at your option) any later version.
+**
+**	This package is distributed in the hope that it will be useful,
+**	but WITHOUT ANY WARRANTY; without even the implied warranty of
+**	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+**	General Public License for more details.
+**	\endlegal
+*/
+/* ========================================================================= */
+
+/* === S T A R T =========================================================== */
+
+#ifndef __SYNFIG_RENDERING_SOFTWARE_TILEDSURFACE_H
+#define __SYNFIG_RENDERING_SOFTWARE_TILEDSURFACE_H
+
+/* === H E A D E R S ======================================================= */
+
+#include <vector>
+
+#include <ETL/handle>
+
+#include <synfig/color.h>
+#include <synfig/rect.h>
+#include <synfig/surface.h>
+
+/* === M A C R O S ========================================================= */
+
+/* === T Y P E D E F S ===================================================== */
+
+/* === C L A S S E S & S T R U C T S ======================================= */
+
+namespace synfig
+{
+namespace rendering
+{
+namespace software
+{
+
+//! Surface divided into square tiles.
+//! Pixels of tile are allocated only when tile is written with non-constant values,
+//! tiles filled by the single color stores only this color.
+//! Copies of surface shares pixels of tiles until the tile will be changed (copy-on-write).
+class TiledSurface
+{
+public:
+	enum {
+		TileSize = 64,
+		TilePixels = TileSize*TileSize
+	};
+
+	class TileData: public etl::shared_object
+	{
+	public:
+		typedef etl::handle<TileData> Handle;
+		//! pixels of tile, row pitch is always TileSize
+		Color pixels[TilePixels];
+	};
+
+	struct Tile
+	{
+		//! pixels of tile, null for constant tile
+		TileData::Handle data;
+		//! color of all pixels of tile, when there is no data
+		Color constant;
+
+		bool is_constant() const
+			{ return !data; }
+		bool is_transparent() const
+			{ return !data && constant.get_a() == ColorReal(0); }
+	};
+
+	class Reader
+	{
+	public:
+		template< etl::clamping::func clamp_x = etl::clamping::clamp,
+				  etl::clamping::func clamp_y = etl::clamping::clamp >
+		inline static Color reader(const void *surf, int x, int y)
+		{
+			const TiledSurface &s = *(const TiledSurface*)surf;
+			return clamp_x(x, s.width) && clamp_y(y, s.height)
+			     ? s.get_pixel(x, y) : Color();
+		}
+
+		template< etl::clamping::func clamp_x = etl::clamping::clamp,
+				  etl::clamping::func clamp_y = etl::clamping::clamp >
+		inline static ColorAccumulator reader_cook(const void *surf, int x, int y)
+		{
+			const TiledSurface &s = *(const TiledSurface*)surf;
+			return clamp_x(x, s.width) && clamp_y(y, s.height)
+				 ? ColorPrep::cook_static(s.get_pixel(x, y)) : Color();
+		}
+	};
+
+private:
+	int width;
+	int height;
+	int tiles_width;
+	int tiles_height;
+	std::vector<Tile> tiles;
+
+	static void fill(Color *dest, int pitch, int width, int height, const Color &color);
+	static bool is_constant(const Color *pixels, int pitch, int width, int height);
+
+public:
+	TiledSurface();
+
+	//! creates transparent surface, pixels are not allocated
+	void create(int width, int height);
+	//! makes all tiles transparent
+	void clear();
+	void reset();
+	//! makes copy of other surface, pixels are shared until modification
+	void assign(const TiledSurface &other);
+
+	int get_width() const { return width; }
+	int get_height() const { return height; }
+	int get_tiles_width() const { return tiles_width; }
+	int get_tiles_height() const { return tiles_height; }
+
+	const Tile& get_tile(int tx, int ty) const
+		{ return tiles[ty*tiles_width + tx]; }
+	RectInt get_tile_rect(int tx, int ty) const;
+	//! returns range of tiles which intersects with the rect
+	RectInt get_tiles_range(const RectInt &rect) const;
+
+	//! returns pixels of tile for writing, allocates them or makes own copy if need
+	Color* get_tile_pixels(int tx, int ty);
+	void set_tile_constant(int tx, int ty, const Color &color);
+
+	Color get_pixel(int x, int y) const;
+
+	//! replaces content of surface, tiles with the same pixels are stored as constant
+	void set_pixels(const Color *pixels, int width, int height, int pitch = 0);
+	//! copies whole surface into the buffer
+	void get_pixels(Color *target, int pitch = 0) const;
+	//! copies the rect of surface into the buffer, pixel (0, 0) of target is rect.get_min()
+	void get_pixels(const RectInt &rect, Color *target, int pitch) const;
+
+	//! returns bounds of all tiles, which contains non-transparent pixels
+	RectInt get_populated_rect() const;
+	//! returns size of allocated pixels in bytes
+	size_t get_memory_size() const;
+};
+
+} /* end namespace software */
+} /* end namespace rendering */
+} /* end namespace synfig */
+
+/* -- E N D ----------------------------------------------------------------- */
+
+#endif
@@ -0,0 +1,119 @@
+/* === S Y N F I G ========================================================= */
+/*!	\file synfig/rendering/software/rendererbudgetsw.cpp
+**	\brief RendererBudgetSW
+**
+**	$Id$
+**
+**	\legal
+**	Copyright (c) 2019 Synfig Contributors
+**
+**	This package is free software; you can redistribute it and/or
+**	modify it under the terms of the GNU General Public License as
+**	published by the Free Software Foundation; either version 2 of
+**	the License, or (at your option) any later version.
+**
+**	This package is distributed in the hope that it will be useful,
+**	but WITHOUT ANY WARRANTY; without even the implied warranty of
+**	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+**	General Public License for more details.
+**	\endlegal
+*/
+/* ========================================================================= */
+
+/* === H E A D E R S ======================================================= */
+
+#ifdef USING_PCH
+#	include "pch.h"
+#else
+#ifdef HAVE_CONFIG_H
+#	include <config.h>
+#endif
+
+#include <cstdlib>
+
+#include <glib.h>
+
+#include <synfig/localization.h>
+
+#include "rendererbudgetsw.h"
+
+#include "task/tasksw.h"
+
+#include "function/fft.h"
+
+#include "../common/optimizer/optimizerblendassociative.h"
+#include "../common/optimizer/optimizerblendmerge.h"
+#include "../common/optimizer/optimizerblendtotarget.h"
+#include "../common/optimizer/optimizerbudget.h"
+#include "../common/optimizer/optimizerlist.h"
+#include "../common/optimizer/optimizersplit.h"
+#include "../common/optimizer/optimizertransformation.h"
+#include "../common/optimizer/optimizerpass.h"
+
+#endif
+
+using namespace synfig;
+using namespace rendering;
+
+/* === M A C R O S ========================================================= */
+
+/* === G L O B A L S ======================================================= */
+
+/* === P R O C E D U R E S ================================================= */
+
+/* === M E T H O D S ======================================================= */
+
+RendererBudgetSW::RendererBudgetSW()
+{
+	long long budget_ms = 40;
+	if (const char *s = getenv("SYNFIG_RENDERING_FRAME_BUDGET"))
+		if (atoll(s) > 0) budget_ms = atoll(s);
+	budget = new RenderBudget(budget_ms*1000);
+
+	register_mode(TaskSW::mode_token.handle());
+
+	// register optimizers
+	register_optimizer(new OptimizerTransformation());
+
+	register_optimizer(new OptimizerPass(false));
+	register_optimizer(new OptimizerPass(true));
+	register_optimizer(new OptimizerBlendMerge());
+	register_optimizer(new OptimizerList());
+	register_optimizer(new OptimizerBlendToTarget());
+	register_optimizer(new OptimizerBlendAssociative());
+	//register_optimizer(new OptimizerSplit());
+}
+
+RendererBudgetSW::~RendererBudgetSW() { }
+
+String RendererBudgetSW::get_name() const
+	{ return _("Cobra Budget (software)"); }
+
+void RendererBudgetSW::initialize()
+{
+	software::FFT::initialize();
+}
+
+void RendererBudgetSW::deinitialize()
+{
+	software::FFT::deinitialize();
+}
+
+void RendererBudgetSW::prepare_enqueue_vfunc(Task::List &list, const TaskEvent::Handle &finish_event_task) const
+{
+	// read level only once, other frames may change it concurrently,
+	// so the measured time will be stored for the level which was really used
+	int level = budget->get_level();
+
+	for(Task::List::iterator i = list.begin(); i != list.end(); ++i)
+		*i = OptimizerBudget::degrade_frame(*i, level);
+
+	finish_event_task->signal_finished.connect(
+		sigc::bind(
+			sigc::ptr_fun(&RenderBudget::frame_finished_func),
+			budget,
+			level,
+			(long long)g_get_monotonic_time() ));
+}
+
+/* === E N T R Y P O I N T ================================================= */
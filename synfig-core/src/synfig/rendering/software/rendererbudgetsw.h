@@ -0,0 +1,75 @@
+/* === S Y N F I G ========================================================= */
+/*!	\file synfig/rendering/software/rendererbudgetsw.h
+**	\brief RendererBudgetSW Header
+**
+**	$Id$
+**
+**	\legal
+**	Copyright (c) 2019 Synfig Contributors
+**
+**	This package is free software; you can redistribute it and/or
+**	modify it under the terms of the GNU General Public License as
+**	published by the Free Software Foundation; either version 2 of
+**	the License, or (at your option) any later version.
+**
+**	This package is distributed in the hope that it will be useful,
+**	but WITHOUT ANY WARRANTY; without even the implied warranty of
+**	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+**	General Public License for more details.
+**	\endlegal
+*/
+/* ========================================================================= */
+
+/* === S T A R T =========================================================== */
+
+#ifndef __SYNFIG_RENDERING_RENDERERBUDGETSW_H
+#define __SYNFIG_RENDERING_RENDERERBUDGETSW_H
+
+/* === H E A D E R S ======================================================= */
+
+#include "../renderer.h"
+#include "../common/renderbudget.h"
+
+/* === M A C R O S ========================================================= */
+
+/* === T Y P E D E F S ===================================================== */
+
+/* === C L A S S E S & S T R U C T S ======================================= */
+
+namespace synfig
+{
+namespace rendering
+{
+
+//! Software renderer which keeps time of frame inside the budget.
+//! Time of every finished frame is measured, and quality of the next frames
+//! is lowered or raised accordingly (see RenderBudget and OptimizerBudget).
+//! Budget in milliseconds may be set by environment variable
+//! SYNFIG_RENDERING_FRAME_BUDGET, default is 40 (25 frames per second).
+class RendererBudgetSW: public Renderer
+{
+private:
+	RenderBudget::Handle budget;
+
+protected:
+	virtual void prepare_enqueue_vfunc(Task::List &list, const TaskEvent::Handle &finish_event_task) const;
+
+public:
+	typedef etl::handle<RendererBudgetSW> Handle;
+	RendererBudgetSW();
+	virtual ~RendererBudgetSW();
+	virtual String get_name() const;
+
+	const RenderBudget::Handle& get_budget() const
+		{ return budget; }
+
+	virtual void initialize();
+	virtual void deinitialize();
+};
+
+}; /* end namespace rendering */
+}; /* end namespace synfig */
+
+/* -- E N D ----------------------------------------------------------------- */
+
+#endif
@@ -38,10 +38,15 @@
 #include "../common/optimizer/optimizerblendassociative.h"
 #include "../common/optimizer/optimizerblendmerge.h"
 #include "../common/optimizer/optimizerblendtotarget.h"
+#include "../common/optimizer/optimizerintermediatesurface.h"
 #include "../common/optimizer/optimizerlist.h"
 #include "../common/optimizer/optimizersplit.h"
 #include "../common/optimizer/optimizertransformation.h"
 #include "../common/optimizer/optimizerpass.h"
+#include "../common/optimizer/optimizerrendercache.h"
+
+#include "surfaceswhalf.h"
+#include "surfaceswtiled.h"
 
 #include "function/fft.h"
 
@@ -58,12 +63,14 @@ using namespace rendering;
 
 /* === M E T H O D S ======================================================= */
 
-RendererSW::RendererSW()
+RendererSW::RendererSW(bool half_float):
+	half_float(half_float)
 {
 	register_mode(TaskSW::mode_token.handle());
 
 	// register optimizers
 	register_optimizer(new OptimizerTransformation());
+	register_optimizer(new OptimizerRenderCache());
 
 	register_optimizer(new OptimizerPass(false));
 	register_optimizer(new OptimizerPass(true));
@@ -72,11 +79,20 @@ RendererSW::RendererSW()
 	register_optimizer(new OptimizerBlendToTarget());
 	register_optimizer(new OptimizerBlendAssociative());
 	//register_optimizer(new OptimizerSplit());
+
+	// intermediate results of blending are stored in tiled surfaces,
+	// so tiles which are not touched by the blended layers take no memory
+	if (half_float)
+		register_optimizer(new OptimizerIntermediateSurface(SurfaceSWHalf::token.handle()));
+	else
+		register_optimizer(new OptimizerIntermediateSurface(
+			SurfaceSWTiled::token.handle(), OptimizerIntermediateSurface::TASKS_BLEND ));
 }
 
 RendererSW::~RendererSW() { }
 
-String RendererSW::get_name() const { return _("Cobra (software)"); }
+String RendererSW::get_name() const
+	{ return half_float ? _("Cobra (software, half-float)") : _("Cobra (software)"); }
 
 void RendererSW::initialize()
 {
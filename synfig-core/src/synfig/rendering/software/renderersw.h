@@ -42,12 +42,19 @@ namespace rendering
 
 class RendererSW: public Renderer
 {
+private:
+	bool half_float;
+
 public:
 	typedef etl::handle<RendererSW> Handle;
 
-	RendererSW();
+	//! when half_float is set then intermediate surfaces are stored in half-float format
+	explicit RendererSW(bool half_float = false);
 	~RendererSW();
 
+	bool is_half_float() const
+		{ return half_float; }
+
 	virtual String get_name() const;
 
 	static void initialize();
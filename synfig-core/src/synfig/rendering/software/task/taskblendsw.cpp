@@ -29,11 +29,16 @@
 #	include <config.h>
 #endif
 
+#include <algorithm>
+#include <vector>
+
 #include <synfig/general.h>
 
 #include <synfig/debug/debugsurface.h>
 
 #include "../../common/task/taskblend.h"
+#include "../surfaceswhalf.h"
+#include "../surfaceswtiled.h"
 #include "tasksw.h"
 
 #endif
@@ -71,9 +76,259 @@ public:
 		}
 	}
 
+	//! copies rect of tiled surface a, offset is position of rect in the surface a
+	static void blit_tiled(
+		synfig::Surface &c,
+		const RectInt &rect,
+		const software::TiledSurface &a,
+		const VectorInt &offset )
+	{
+		a.get_pixels(rect + offset, &c[rect.miny][rect.minx], c.get_pitch());
+	}
+
+	//! blend methods which keep destination when source is fully transparent
+	static bool is_transparent_source_skippable(Color::BlendMethod method)
+	{
+		switch(method) {
+		case Color::BLEND_COMPOSITE:
+		case Color::BLEND_BEHIND:
+		case Color::BLEND_ONTO:
+		case Color::BLEND_ADD_COMPOSITE:
+		case Color::BLEND_MULTIPLY:
+		case Color::BLEND_SCREEN:
+		case Color::BLEND_OVERLAY:
+		case Color::BLEND_HARD_LIGHT:
+		case Color::BLEND_ALPHA_DARKEN:
+			return true;
+		default:
+			return false;
+		}
+	}
+
+	//! blends rect of tiled surface b, transparent tiles skipped when blend method allows it
+	void blend_tiled(
+		synfig::Surface &c,
+		const RectInt &rect,
+		const software::TiledSurface &b,
+		const VectorInt &offset ) const
+	{
+		typedef software::TiledSurface TiledSurface;
+		const bool skip_transparent = is_transparent_source_skippable(blend_method);
+		const RectInt rb = rect + offset;
+		const RectInt range = b.get_tiles_range(rb);
+		for(int ty = range.miny; ty < range.maxy; ++ty) {
+			for(int tx = range.minx; tx < range.maxx; ++tx) {
+				const TiledSurface::Tile &tile = b.get_tile(tx, ty);
+				if (skip_transparent && tile.is_transparent())
+					continue;
+
+				RectInt r = b.get_tile_rect(tx, ty);
+				etl::set_intersect(r, r, rb);
+				if (!r.is_valid())
+					continue;
+
+				const int w = r.get_width();
+				for(int y = r.miny; y < r.maxy; ++y) {
+					Color *dst = &c[y - offset[1]][r.minx - offset[0]];
+					if (tile.data)
+						Color::blend_row(
+							dst,
+							&tile.data->pixels[(y % TiledSurface::TileSize)*TiledSurface::TileSize + r.minx % TiledSurface::TileSize],
+							w, amount, blend_method );
+					else
+						Color::blend_row(dst, tile.constant, w, amount, blend_method);
+				}
+			}
+		}
+	}
+
+	//! blends rect of surface b row by row, surface b may be in any of software formats
+	void blend_rows(
+		synfig::Surface &c,
+		const RectInt &rect,
+		const RowReader &b,
+		const VectorInt &offset ) const
+	{
+		std::vector<Color> row(rect.get_width());
+		for(int y = rect.miny; y < rect.maxy; ++y) {
+			b.read(&row.front(), rect.minx + offset[0], y + offset[1], rect.get_width());
+			Color::blend_row(&c[y][rect.minx], &row.front(), rect.get_width(), amount, blend_method);
+		}
+	}
+
+	//! processes pixels [x0, x1) of row y, dst points to pixel x = 0 of the row,
+	//! surface a is copied only when la is set (otherwise a is the target itself)
+	void process_row(
+		Color *dst, int x0, int x1, int y,
+		const RectInt &ra, const VectorInt &oa, const RowReader *la,
+		const RectInt &rb, const VectorInt &ob, const RowReader *lb,
+		Color *buffer ) const
+	{
+		const bool in_a = ra.is_valid() && ra.miny <= y && y < ra.maxy
+		               && std::max(ra.minx, x0) < std::min(ra.maxx, x1);
+		const bool in_b = rb.is_valid() && rb.miny <= y && y < rb.maxy
+		               && std::max(rb.minx, x0) < std::min(rb.maxx, x1);
+		const int ax0 = std::max(ra.minx, x0), ax1 = std::min(ra.maxx, x1);
+		const int bx0 = std::max(rb.minx, x0), bx1 = std::min(rb.maxx, x1);
+
+		// copy surface a
+		if (in_a && la)
+			la->read(dst + ax0, ax0 + oa[0], y + oa[1], ax1 - ax0);
+
+		// blend surface b
+		if (in_b) {
+			lb->read(buffer, bx0 + ob[0], y + ob[1], bx1 - bx0);
+			Color::blend_row(dst + bx0, buffer, bx1 - bx0, amount, blend_method);
+		}
+
+		// process unfilled region
+		if (in_a && Color::is_straight(blend_method)) {
+			int fx0 = in_b ? std::max(ax0, std::min(ax1, bx0)) : ax1;
+			int fx1 = in_b ? std::max(ax0, std::min(ax1, bx1)) : ax1;
+			if (ax0 < fx0)
+				Color::blend_row(dst + ax0, Color(0, 0, 0, 0), fx0 - ax0, amount, blend_method);
+			if (fx1 < ax1)
+				Color::blend_row(dst + fx1, Color(0, 0, 0, 0), ax1 - fx1, amount, blend_method);
+		}
+	}
+
+	//! processes target surface stored in half-float format row by row
+	bool run_half() const {
+		SurfaceResource::SemiLockWrite<SurfaceSWHalf> lc(target_surface, target_rect);
+		if (!lc) return false;
+		software::HalfSurface &c = lc->get_surface();
+		RectInt r = target_rect;
+
+		RectInt ra = RectInt::zero();
+		VectorInt oa;
+		bool copy_a = false;
+		if (sub_task_a() && sub_task_a()->is_valid()) {
+			oa = get_offset_a();
+			ra = sub_task_a()->target_rect - oa;
+			if (ra.is_valid()) {
+				etl::set_intersect(ra, ra, r);
+				copy_a = ra.is_valid() && sub_task_a()->target_surface != target_surface;
+			}
+		}
+
+		RectInt rb = RectInt::zero();
+		VectorInt ob;
+		if (sub_task_b() && sub_task_b()->is_valid()) {
+			ob = get_offset_b();
+			rb = sub_task_b()->target_rect - ob;
+			if (rb.is_valid())
+				etl::set_intersect(rb, rb, r);
+		}
+
+		if (!ra.is_valid() && !rb.is_valid())
+			return true;
+
+		RowReader la(copy_a ? sub_task_a()->target_surface : SurfaceResource::Handle());
+		RowReader lb(rb.is_valid() ? sub_task_b()->target_surface : SurfaceResource::Handle());
+		if ((copy_a && !la) || (rb.is_valid() && !lb))
+			return false;
+
+		std::vector<Color> row(r.get_width()), row_b(r.get_width());
+		for(int y = r.miny; y < r.maxy; ++y) {
+			const bool in_a = ra.is_valid() && ra.miny <= y && y < ra.maxy;
+			const bool in_b = rb.is_valid() && rb.miny <= y && y < rb.maxy;
+			if (!in_a && !in_b) continue;
+
+			const int x0 = in_a && in_b ? std::min(ra.minx, rb.minx) : in_a ? ra.minx : rb.minx;
+			const int x1 = in_a && in_b ? std::max(ra.maxx, rb.maxx) : in_a ? ra.maxx : rb.maxx;
+			c.read_row(&row.front(), x0, y, x1 - x0);
+			process_row(
+				&row.front() - x0, x0, x1, y,
+				ra, oa, copy_a ? &la : nullptr,
+				rb, ob, &lb,
+				&row_b.front() );
+			c.write_row(&row.front(), x0, y, x1 - x0);
+		}
+
+		return true;
+	}
+
+	//! processes tiled target surface tile by tile,
+	//! tiles which will not be changed by blending are not allocated
+	bool run_tiled() const {
+		typedef software::TiledSurface TiledSurface;
+
+		SurfaceResource::LockWrite<SurfaceSWTiled> lc(target_surface, target_rect);
+		if (!lc) return false;
+		TiledSurface &c = lc->get_surface();
+		RectInt r = target_rect;
+
+		RectInt ra = RectInt::zero();
+		VectorInt oa;
+		bool copy_a = false;
+		if (sub_task_a() && sub_task_a()->is_valid()) {
+			oa = get_offset_a();
+			ra = sub_task_a()->target_rect - oa;
+			if (ra.is_valid()) {
+				etl::set_intersect(ra, ra, r);
+				copy_a = ra.is_valid() && sub_task_a()->target_surface != target_surface;
+			}
+		}
+
+		RectInt rb = RectInt::zero();
+		VectorInt ob;
+		if (sub_task_b() && sub_task_b()->is_valid()) {
+			ob = get_offset_b();
+			rb = sub_task_b()->target_rect - ob;
+			if (rb.is_valid())
+				etl::set_intersect(rb, rb, r);
+		}
+
+		if (!ra.is_valid() && !rb.is_valid())
+			return true;
+
+		RowReader la(copy_a ? sub_task_a()->target_surface : SurfaceResource::Handle());
+		RowReader lb(rb.is_valid() ? sub_task_b()->target_surface : SurfaceResource::Handle());
+		if ((copy_a && !la) || (rb.is_valid() && !lb))
+			return false;
+
+		const bool straight = Color::is_straight(blend_method);
+		const bool skip_transparent = is_transparent_source_skippable(blend_method);
+		std::vector<Color> row_b(TiledSurface::TileSize);
+		const RectInt range = c.get_tiles_range(r);
+		for(int ty = range.miny; ty < range.maxy; ++ty) {
+			for(int tx = range.minx; tx < range.maxx; ++tx) {
+				RectInt tile = c.get_tile_rect(tx, ty);
+				etl::set_intersect(tile, tile, r);
+
+				RectInt ta = ra, tb = rb;
+				etl::set_intersect(ta, ta, tile);
+				etl::set_intersect(tb, tb, tile);
+				const bool touch_a = ta.is_valid()
+				                  && ( straight
+				                    || (copy_a && !(c.get_tile(tx, ty).is_transparent() && la.is_transparent(ta + oa))) );
+				const bool touch_b = tb.is_valid() && !(skip_transparent && lb.is_transparent(tb + ob));
+				if (!touch_a && !touch_b)
+					continue;
+
+				const RectInt tile_rect = c.get_tile_rect(tx, ty);
+				Color *pixels = c.get_tile_pixels(tx, ty);
+				for(int y = tile.miny; y < tile.maxy; ++y)
+					process_row(
+						pixels + (y - tile_rect.miny)*TiledSurface::TileSize - tile_rect.minx,
+						tile.minx, tile.maxx, y,
+						ra, oa, copy_a ? &la : nullptr,
+						touch_b ? rb : RectInt::zero(), ob, &lb,
+						&row_b.front() );
+			}
+		}
+
+		return true;
+	}
+
 	virtual bool run(RunParams&) const {
 		if (!is_valid()) return true;
 
+		if (is_half_only(target_surface))
+			return run_half();
+		if (is_tiled_only(target_surface))
+			return run_tiled();
+
 		LockWrite lc(this);
 		if (!lc) return false;
 		synfig::Surface &c = lc->get_surface();
@@ -90,22 +345,36 @@ public:
 				etl::set_intersect(ra, ra, r);
 				if (ra.is_valid() && sub_task_a()->target_surface != target_surface)
 				{
-					LockRead la(sub_task_a());
-					if (!la) return false;
-					synfig::Surface &a = la.cast_handle()->get_surface(); // TODO: make blit_to constant
-
-					assert( 0 <= ra.minx && ra.minx < ra.maxx && ra.maxx <= c.get_w()
-						 && 0 <= ra.miny && ra.miny < ra.maxy && ra.miny <= c.get_h() );
-					assert( 0 <= ra.minx + oa[0] && ra.maxx + oa[0] <= a.get_w()
-						 && 0 <= ra.miny + oa[1] && ra.maxy + oa[1] <= a.get_h() );
-
-					synfig::Surface::pen p = c.get_pen(ra.minx, ra.miny);
-					a.blit_to(
-						p,
-						ra.minx + oa[0],
-						ra.miny + oa[1],
-						ra.maxx - ra.minx,
-						ra.maxy - ra.miny );
+					if (is_tiled_only(sub_task_a()->target_surface))
+					{
+						SurfaceResource::LockRead<SurfaceSWTiled> la(sub_task_a()->target_surface);
+						if (!la) return false;
+						blit_tiled(c, ra, la->get_surface(), oa);
+					} else
+					if (is_half_only(sub_task_a()->target_surface))
+					{
+						SurfaceResource::LockRead<SurfaceSWHalf> la(sub_task_a()->target_surface);
+						if (!la) return false;
+						la->get_surface().get_pixels(ra + oa, &c[ra.miny][ra.minx], c.get_pitch());
+					} else
+					{
+						LockRead la(sub_task_a());
+						if (!la) return false;
+						synfig::Surface &a = la.cast_handle()->get_surface(); // TODO: make blit_to constant
+
+						assert( 0 <= ra.minx && ra.minx < ra.maxx && ra.maxx <= c.get_w()
+							 && 0 <= ra.miny && ra.miny < ra.maxy && ra.miny <= c.get_h() );
+						assert( 0 <= ra.minx + oa[0] && ra.maxx + oa[0] <= a.get_w()
+							 && 0 <= ra.miny + oa[1] && ra.maxy + oa[1] <= a.get_h() );
+
+						synfig::Surface::pen p = c.get_pen(ra.minx, ra.miny);
+						a.blit_to(
+							p,
+							ra.minx + oa[0],
+							ra.miny + oa[1],
+							ra.maxx - ra.minx,
+							ra.maxy - ra.miny );
+					}
 				}
 			}
 		}
@@ -121,24 +390,38 @@ public:
 				etl::set_intersect(rb, rb, r);
 				if (rb.is_valid())
 				{
-					LockRead lb(sub_task_b());
-					if (!lb) return false;
-					synfig::Surface &b = lb.cast_handle()->get_surface(); // TODO: make blit_to constant
+					if (is_tiled_only(sub_task_b()->target_surface))
+					{
+						SurfaceResource::LockRead<SurfaceSWTiled> lb(sub_task_b()->target_surface);
+						if (!lb) return false;
+						blend_tiled(c, rb, lb->get_surface(), ob);
+					} else
+					if (is_half_only(sub_task_b()->target_surface))
+					{
+						RowReader lb(sub_task_b()->target_surface);
+						if (!lb) return false;
+						blend_rows(c, rb, lb, ob);
+					} else
+					{
+						LockRead lb(sub_task_b());
+						if (!lb) return false;
+						synfig::Surface &b = lb.cast_handle()->get_surface(); // TODO: make blit_to constant
 
-					assert( 0 <= rb.minx && rb.minx < rb.maxx && rb.maxx <= c.get_w()
-						 && 0 <= rb.miny && rb.miny < rb.maxy && rb.miny <= c.get_h() );
-					assert( 0 <= rb.minx + ob[0] && rb.maxx + ob[0] <= b.get_w()
-						 && 0 <= rb.miny + ob[1] && rb.maxy + ob[1] <= b.get_h() );
+						assert( 0 <= rb.minx && rb.minx < rb.maxx && rb.maxx <= c.get_w()
+							 && 0 <= rb.miny && rb.miny < rb.maxy && rb.miny <= c.get_h() );
+						assert( 0 <= rb.minx + ob[0] && rb.maxx + ob[0] <= b.get_w()
+							 && 0 <= rb.miny + ob[1] && rb.maxy + ob[1] <= b.get_h() );
 
-					synfig::Surface::alpha_pen ap(c.get_pen(rb.minx, rb.miny));
-					ap.set_blend_method(blend_method);
-					ap.set_alpha(amount);
-					b.blit_to(
-						ap,
-						rb.minx + ob[0],
-						rb.miny + ob[1],
-						rb.maxx - rb.minx,
-						rb.maxy - rb.miny );
+						synfig::Surface::alpha_pen ap(c.get_pen(rb.minx, rb.miny));
+						ap.set_blend_method(blend_method);
+						ap.set_alpha(amount);
+						b.blit_to(
+							ap,
+							rb.minx + ob[0],
+							rb.miny + ob[1],
+							rb.maxx - rb.minx,
+							rb.maxy - rb.miny );
+					}
 
 					if (ra.is_valid())
 					{
@@ -34,6 +34,8 @@
 #include "../../common/task/taskblur.h"
 #include "../../common/task/taskblend.h"
 #include "tasksw.h"
+#include "../surfaceswhalf.h"
+#include "../surfaceswtiled.h"
 #include "../function/blur.h"
 
 #endif
@@ -63,18 +65,113 @@ public:
 	virtual Color::BlendMethodFlags get_supported_blend_methods() const
 		{ return Color::BLEND_METHODS_ALL & ~Color::BLEND_METHODS_STRAIGHT; }
 
+private:
+	//! blurs tiled or half-float surfaces,
+	//! only the needed parts of source and target are unpacked
+	bool run_unpacked(const Vector &s) const {
+		const SurfaceResource::Handle &src_resource = sub_task()->target_surface;
+		SurfaceResource::LockReadBase lb(src_resource);
+		const software::TiledSurface *tiled = NULL;
+		const software::HalfSurface *half = NULL;
+		const synfig::Surface *dense = NULL;
+		if (is_tiled_only(src_resource) && lb.convert<SurfaceSWTiled>(false))
+			tiled = &lb.cast<SurfaceSWTiled>()->get_surface();
+		else
+		if (is_half_only(src_resource) && lb.convert<SurfaceSWHalf>(false))
+			half = &lb.cast<SurfaceSWHalf>()->get_surface();
+		else
+		if (lb.convert<SurfaceSW>())
+			dense = &lb.cast<SurfaceSW>()->get_surface();
+		else
+			return false;
+
+		VectorInt offset = TaskList::calc_target_offset(*this, *sub_task());
+		VectorInt extra_size = software::Blur::get_extra_size(blur.type, s);
+		RectInt src_bounds(VectorInt::zero(), src_resource->get_size());
+
+		RectInt rd = target_rect;
+		if (tiled && blend && !Color::is_straight(blend_method)) {
+			// transparent pixels doesn't change the target
+			RectInt populated = tiled->get_populated_rect();
+			if (!populated.is_valid())
+				return true;
+			populated.minx -= extra_size[0];
+			populated.miny -= extra_size[1];
+			populated.maxx += extra_size[0];
+			populated.maxy += extra_size[1];
+			etl::set_intersect(rd, rd, populated - offset);
+			if (!rd.is_valid())
+				return true;
+		}
+
+		RectInt rs = rd + offset;
+		rs.minx -= extra_size[0];
+		rs.miny -= extra_size[1];
+		rs.maxx += extra_size[0];
+		rs.maxy += extra_size[1];
+		etl::set_intersect(rs, rs, src_bounds);
+		if (!rs.is_valid())
+			return true;
+
+		const synfig::Surface *src = dense;
+		VectorInt src_offset = rd.get_min() + offset;
+		synfig::Surface src_surface;
+		if (!dense) {
+			src_surface.set_wh(rs.get_width(), rs.get_height());
+			if (tiled)
+				tiled->get_pixels(rs, &src_surface[0][0], src_surface.get_pitch());
+			else
+				half->get_pixels(rs, &src_surface[0][0], src_surface.get_pitch());
+			src = &src_surface;
+			src_offset -= rs.get_min();
+		}
+
+		if (is_half_only(target_surface)) {
+			SurfaceResource::SemiLockWrite<SurfaceSWHalf> la(target_surface, target_rect);
+			if (!la) return false;
+			software::HalfSurface &dst = la->get_surface();
+
+			synfig::Surface dst_surface(rd.get_width(), rd.get_height());
+			dst.get_pixels(rd, &dst_surface[0][0], dst_surface.get_pitch());
+			software::Blur::blur(
+				software::Blur::Params(
+					dst_surface, RectInt(VectorInt::zero(), rd.get_size()),
+					*src, src_offset,
+					blur.type, s,
+					blend, blend_method, amount ));
+			dst.set_pixels(rd, &dst_surface[0][0], dst_surface.get_pitch());
+		} else {
+			LockWrite la(this);
+			if (!la) return false;
+			software::Blur::blur(
+				software::Blur::Params(
+					la->get_surface(), rd,
+					*src, src_offset,
+					blur.type, s,
+					blend, blend_method, amount ));
+		}
+
+		return true;
+	}
+
+public:
 	virtual bool run(RunParams&) const {
 		if (!is_valid() || !sub_task() || !sub_task()->is_valid())
 			return true;
 
+		Vector ppu = get_pixels_per_unit();
+		Vector s = blur.size.multiply_coords(ppu);
+
+		if ( is_tiled_only(sub_task()->target_surface)
+		  || is_half_only(sub_task()->target_surface)
+		  || is_half_only(target_surface) )
+			return run_unpacked(s);
+
 		LockWrite la(this);
 		LockRead lb(sub_task());
 		if (!la || !lb)
 			return false;
 
-		Vector ppu = get_pixels_per_unit();
-		Vector s = blur.size.multiply_coords(ppu);
-
 		VectorInt offset = TaskList::calc_target_offset(*this, *sub_task());
 		offset += target_rect.get_min();
 
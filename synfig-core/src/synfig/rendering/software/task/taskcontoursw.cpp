@@ -31,7 +31,6 @@
 
 #include <synfig/debug/debugsurface.h>
 
-#include "../../primitive/polyspan.h"
 #include "../../common/task/taskcontour.h"
 #include "../../common/task/taskblend.h"
 #include "tasksw.h"
@@ -53,8 +52,7 @@ using namespace rendering;
 namespace {
 
 class TaskContourSW: public TaskContour, public TaskSW,
-	public TaskInterfaceBlendToTarget,
-	public TaskInterfaceSplit
+	public TaskInterfaceBlendToTarget
 {
 public:
 	typedef etl::handle<TaskContourSW> Handle;
@@ -92,19 +90,19 @@ public:
 
 		Matrix matrix = bounds_transfromation * transformation->matrix;
 
-		Polyspan polyspan;
-		polyspan.init(target_rect);
-		software::Contour::build_polyspan(contour->get_chunks(), matrix, polyspan, detail);
-		polyspan.close();
-		polyspan.sort_marks();
+		// curves are flattened once and cached by contour,
+		// rows are rendered in parallel by the rasterizer itself
+		software::Contour::EdgeList edges;
+		software::Contour::build_edges(*contour, matrix, target_rect, edges, detail);
 
 		LockWrite la(this);
 		if (!la)
 			return false;
 
-		software::Contour::render_polyspan(
+		software::Contour::render_edges(
 			la->get_surface(),
-			polyspan,
+			target_rect,
+			edges,
 			contour->invert,
 			allow_antialias && contour->antialias,
 			contour->winding_style,
@@ -0,0 +1,125 @@
+/* === S Y N F I G ========================================================= */
+/*!	\file synfig/rendering/software/task/taskdistortsw.cpp
+**	\brief TaskDistortSW
+**
+**	$Id$
+**
+**	\legal
+**	Copyright (c) 2019 Synfig Contributors
+**
+**	This package is free software; you can redistribute it and/or
+**	modify it under the terms of the GNU General Public License as
+**	published by the Free Software Foundation; either version 2 of
+**	the License, or (at your option) any later version.
+**
+**	This package is distributed in the hope that it will be useful,
+**	but WITHOUT ANY WARRANTY; without even the implied warranty of
+**	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+**	General Public License for more details.
+**	\endlegal
+*/
+/* ========================================================================= */
+
+
+/* === H E A D E R S ======================================================= */
+
+#ifdef USING_PCH
+#	include "pch.h"
+#else
+#ifdef HAVE_CONFIG_H
+#	include <config.h>
+#endif
+
+#include <synfig/general.h>
+
+#include "../../common/task/taskdistort.h"
+#include "tasksw.h"
+
+#endif
+
+using namespace synfig;
+using namespace rendering;
+
+/* === M A C R O S ========================================================= */
+
+/* === G L O B A L S ======================================================= */
+
+/* === P R O C E D U R E S ================================================= */
+
+/* === M E T H O D S ======================================================= */
+
+namespace {
+
+class TaskDistortSW: public TaskDistort, public TaskSW,
+	public TaskInterfaceSplit
+{
+public:
+	typedef etl::handle<TaskDistortSW> Handle;
+	static Token token;
+	virtual Token::Handle get_token() const { return token.handle(); }
+
+private:
+	typedef Color (synfig::Surface::*Sampler)(float, float) const;
+
+	static Sampler get_sampler(Color::Interpolation interpolation)
+	{
+		switch(interpolation)
+		{
+		case Color::INTERPOLATION_LINEAR: return &synfig::Surface::linear_sample;
+		case Color::INTERPOLATION_COSINE: return &synfig::Surface::cosine_sample;
+		case Color::INTERPOLATION_CUBIC:  return &synfig::Surface::cubic_sample;
+		default: break;
+		}
+		return &synfig::Surface::nearest_sample;
+	}
+
+public:
+	virtual bool run(RunParams&) const {
+		if (!is_valid() || !distortion || !sub_task() || !sub_task()->is_valid())
+			return true;
+
+		LockRead lsrc(sub_task());
+		if (!lsrc)
+			return false;
+		const synfig::Surface &src = lsrc->get_surface();
+
+		LockWrite ldst(this);
+		if (!ldst)
+			return false;
+		synfig::Surface &dst = ldst->get_surface();
+
+		// units of sub-task to coordinates of sampler (integer coordinates at pixel centers)
+		Vector src_ppu = sub_task()->get_pixels_per_unit();
+		Vector src_origin(
+			sub_task()->target_rect.minx - src_ppu[0]*sub_task()->source_rect.minx - 0.5,
+			sub_task()->target_rect.miny - src_ppu[1]*sub_task()->source_rect.miny - 0.5 );
+
+		Sampler sampler = get_sampler(interpolation);
+		Vector upp = get_units_per_pixel();
+		Point origin = source_rect.get_min() + upp*0.5;
+		int width = target_rect.get_width();
+
+		for(int y = target_rect.miny; y < target_rect.maxy; ++y, origin[1] += upp[1]) {
+			Color *c = &dst[y][target_rect.minx];
+			Point p = origin;
+			for(Color *end = c + width; c < end; ++c, p[0] += upp[0]) {
+				Point s;
+				*c = distortion->map_visible(p, s)
+				   ? (src.*sampler)(
+				         src_origin[0] + src_ppu[0]*s[0],
+				         src_origin[1] + src_ppu[1]*s[1] )
+				   : Color::alpha();
+			}
+		}
+
+		return true;
+	}
+};
+
+
+Task::Token TaskDistortSW::token(
+	DescReal<TaskDistortSW, TaskDistort>("DistortSW") );
+
+} // end of anonimous namespace
+
+/* === E N T R Y P O I N T ================================================= */
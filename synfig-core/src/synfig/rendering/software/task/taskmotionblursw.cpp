@@ -0,0 +1,163 @@
+/* === S Y N F I G ========================================================= */
+/*!	\file synfig/rendering/software/task/taskmotionblursw.cpp
+**	\brief TaskMotionBlurSW
+**
+**	$Id$
+**
+**	\legal
+**	Copyright (c) 2019 Synfig Contributors
+**
+**	This package is free software; you can redistribute it and/or
+**	modify it under the terms of the GNU General Public License as
+**	published by the Free Software Foundation; either version 2 of
+**	the License, or (at your option) any later version.
+**
+**	This package is distributed in the hope that it will be useful,
+**	but WITHOUT ANY WARRANTY; without even the implied warranty of
+**	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+**	General Public License for more details.
+**	\endlegal
+*/
+/* ========================================================================= */
+
+/* === H E A D E R S ======================================================= */
+
+#ifdef USING_PCH
+#	include "pch.h"
+#else
+#ifdef HAVE_CONFIG_H
+#	include <config.h>
+#endif
+
+#include <algorithm>
+#include <list>
+#include <vector>
+
+#include <synfig/general.h>
+
+#include "../../common/task/taskmotionblur.h"
+#include "../surfaceswhalf.h"
+#include "tasksw.h"
+
+#endif
+
+using namespace synfig;
+using namespace rendering;
+
+/* === M A C R O S ========================================================= */
+
+/* === G L O B A L S ======================================================= */
+
+/* === P R O C E D U R E S ================================================= */
+
+/* === M E T H O D S ======================================================= */
+
+namespace {
+
+class TaskMotionBlurSW: public TaskMotionBlur, public TaskSW
+{
+public:
+	typedef etl::handle<TaskMotionBlurSW> Handle;
+	static Token token;
+	virtual Token::Handle get_token() const { return token.handle(); }
+
+private:
+	struct Subsample {
+		RowReader reader;
+		RectInt rect;       //!< rect in coordinates of target
+		VectorInt offset;
+		ColorReal amount;
+
+		Subsample(const Task &task, const VectorInt &offset, ColorReal amount):
+			reader(task.target_surface),
+			rect(task.target_rect - offset),
+			offset(offset),
+			amount(amount) { }
+	};
+	typedef std::list<Subsample> SubsampleList;
+
+	//! accumulates premultiplied colors of subsamples for the row y,
+	//! subsamples are read row by row, so they may be stored in any software format
+	static void accumulate_row(
+		Color *dest,
+		Color *buffer,
+		const RectInt &r,
+		int y,
+		const SubsampleList &subsamples )
+	{
+		std::fill(dest, dest + r.get_width(), Color(0, 0, 0, 0));
+		for(SubsampleList::const_iterator i = subsamples.begin(); i != subsamples.end(); ++i) {
+			if (y < i->rect.miny || y >= i->rect.maxy)
+				continue;
+			const int x0 = std::max(r.minx, i->rect.minx);
+			const int x1 = std::min(r.maxx, i->rect.maxx);
+			if (x0 >= x1)
+				continue;
+
+			i->reader.read(buffer, x0 + i->offset[0], y + i->offset[1], x1 - x0);
+			Color *d = dest + (x0 - r.minx);
+			for(const Color *s = buffer, *end = s + (x1 - x0); s != end; ++s, ++d) {
+				const ColorReal a = s->get_a()*i->amount;
+				d->set_r(d->get_r() + s->get_r()*a);
+				d->set_g(d->get_g() + s->get_g()*a);
+				d->set_b(d->get_b() + s->get_b()*a);
+				d->set_a(d->get_a() + a);
+			}
+		}
+
+		// back to straight colors, see Color::BLEND_ADD_COMPOSITE
+		for(Color *d = dest, *end = d + r.get_width(); d != end; ++d) {
+			const ColorReal alpha = std::max(ColorReal(0.0), std::min(ColorReal(1.0), d->get_a()));
+			const ColorReal k = std::fabs(d->get_a()) > 1e-8 ? 1.0/d->get_a() : 0.0;
+			*d = Color(d->get_r()*k, d->get_g()*k, d->get_b()*k, alpha);
+		}
+	}
+
+public:
+	virtual bool run(RunParams&) const {
+		if (!is_valid()) return true;
+
+		const RectInt r = target_rect;
+		SubsampleList subsamples;
+		for(int i = 0; i < (int)sub_tasks.size(); ++i) {
+			const Task::Handle &sub_task = sub_tasks[i];
+			if (!sub_task || !sub_task->is_valid() || approximate_zero_lp(get_amount(i)))
+				continue;
+			// readers hold locks of surfaces, so they are constructed in place
+			subsamples.emplace_back(*sub_task, TaskList::calc_target_offset(*this, *sub_task), get_amount(i));
+			if (!subsamples.back().reader)
+				return false;
+			if (!etl::intersect(subsamples.back().rect, r))
+				subsamples.pop_back();
+		}
+
+		std::vector<Color> row(r.get_width()), buffer(r.get_width());
+		if (is_half_only(target_surface)) {
+			SurfaceResource::SemiLockWrite<SurfaceSWHalf> lc(target_surface, target_rect);
+			if (!lc) return false;
+			software::HalfSurface &c = lc->get_surface();
+			for(int y = r.miny; y < r.maxy; ++y) {
+				accumulate_row(&row.front(), &buffer.front(), r, y, subsamples);
+				c.write_row(&row.front(), r.minx, y, r.get_width());
+			}
+		} else {
+			LockWrite lc(this);
+			if (!lc) return false;
+			synfig::Surface &c = lc->get_surface();
+			for(int y = r.miny; y < r.maxy; ++y) {
+				accumulate_row(&row.front(), &buffer.front(), r, y, subsamples);
+				std::copy(row.begin(), row.end(), &c[y][r.minx]);
+			}
+		}
+
+		return true;
+	}
+};
+
+
+Task::Token TaskMotionBlurSW::token(
+	DescReal<TaskMotionBlurSW, TaskMotionBlur>("MotionBlurSW") );
+
+} // end of anonimous namespace
+
+/* === E N T R Y P O I N T ================================================= */
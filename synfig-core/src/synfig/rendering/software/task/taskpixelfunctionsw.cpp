@@ -0,0 +1,124 @@
+/* === S Y N F I G ========================================================= */
+/*!	\file synfig/rendering/software/task/taskpixelfunctionsw.cpp
+**	\brief TaskPixelFunctionSW
+**
+**	$Id$
+**
+**	\legal
+**	Copyright (c) 2019 Synfig Contributors
+**
+**	This package is free software; you can redistribute it and/or
+**	modify it under the terms of the GNU General Public License as
+**	published by the Free Software Foundation; either version 2 of
+**	the License, or (at your option) any later version.
+**
+**	This package is distributed in the hope that it will be useful,
+**	but WITHOUT ANY WARRANTY; without even the implied warranty of
+**	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+**	General Public License for more details.
+**	\endlegal
+*/
+/* ========================================================================= */
+
+
+/* === H E A D E R S ======================================================= */
+
+#ifdef USING_PCH
+#	include "pch.h"
+#else
+#ifdef HAVE_CONFIG_H
+#	include <config.h>
+#endif
+
+#include <vector>
+
+#include <synfig/general.h>
+
+#include "../../common/task/taskblend.h"
+#include "../../common/task/taskpixelfunction.h"
+#include "tasksw.h"
+
+#endif
+
+using namespace synfig;
+using namespace rendering;
+
+/* === M A C R O S ========================================================= */
+
+/* === G L O B A L S ======================================================= */
+
+/* === P R O C E D U R E S ================================================= */
+
+/* === M E T H O D S ======================================================= */
+
+namespace {
+
+class TaskPixelFunctionSW: public TaskPixelFunction, public TaskSW,
+	public TaskInterfaceBlendToTarget,
+	public TaskInterfaceSplit
+{
+public:
+	typedef etl::handle<TaskPixelFunctionSW> Handle;
+	static Token token;
+	virtual Token::Handle get_token() const { return token.handle(); }
+
+	virtual void on_target_set_as_source() {
+		Task::Handle &subtask = sub_task(0);
+		if ( subtask
+		  && subtask->target_surface == target_surface
+		  && !Color::is_straight(blend_method) )
+		{
+			trunc_by_bounds();
+			subtask->source_rect = source_rect;
+			subtask->target_rect = target_rect;
+		}
+	}
+
+	virtual Color::BlendMethodFlags get_supported_blend_methods() const
+		{ return Color::BLEND_METHODS_ALL & ~Color::BLEND_METHODS_STRAIGHT; }
+
+	virtual bool run(RunParams&) const {
+		if (!is_valid())
+			return true;
+		if (!function)
+			return false;
+		if (!transformation->matrix.is_invertible())
+			return true;
+
+		// function is called with points in own coordinates,
+		// so walk over centers of target pixels with back transformation
+		Matrix matrix = transformation->matrix.get_inverted();
+		Vector upp = get_units_per_pixel();
+		Point origin = matrix.get_transformed(source_rect.get_min() + upp*0.5);
+		Vector dx = matrix.get_transformed(Vector(upp[0], 0.0), false);
+		Vector dy = matrix.get_transformed(Vector(0.0, upp[1]), false);
+		Vector pixel_size(dx.mag(), dy.mag());
+
+		LockWrite la(this);
+		if (!la)
+			return false;
+		synfig::Surface &surface = la->get_surface();
+
+		int width = target_rect.get_width();
+		std::vector<Color> row(blend ? width : 0);
+		for(int y = target_rect.miny; y < target_rect.maxy; ++y, origin += dy) {
+			Color *dst = &surface[y][target_rect.minx];
+			Color *c = blend ? &row.front() : dst;
+			Point p = origin;
+			for(Color *end = c + width; c < end; ++c, p += dx)
+				*c = function->get_color(p, pixel_size);
+			if (blend)
+				Color::blend_row(dst, &row.front(), width, amount, blend_method);
+		}
+
+		return true;
+	}
+};
+
+
+Task::Token TaskPixelFunctionSW::token(
+	DescReal<TaskPixelFunctionSW, TaskPixelFunction>("PixelFunctionSW") );
+
+} // end of anonimous namespace
+
+/* === E N T R Y P O I N T ================================================= */
@@ -29,10 +29,14 @@
 #	include <config.h>
 #endif
 
+#include <cstring>
+#include <vector>
+
 #include <synfig/debug/debugsurface.h>
 #include <synfig/general.h>
 
 #include "../../common/task/taskpixelprocessor.h"
+#include "../surfaceswhalf.h"
 #include "tasksw.h"
 
 #endif
@@ -185,6 +189,36 @@ private:
 				                                              process_r<func_copy>(p);
 	}
 
+	//! processes surfaces in half-float format row by row
+	bool run_half(const RectInt &rs, const VectorInt &src_offset) const {
+		RowReader lsrc(sub_task()->target_surface);
+		if (!lsrc) return false;
+
+		const bool half_target = is_half_only(target_surface);
+		SurfaceResource::SemiLockWrite<SurfaceSWHalf> lhalf(
+			half_target ? target_surface : SurfaceResource::Handle(), target_rect );
+		LockWrite ldst(half_target ? NULL : this);
+		if (half_target ? !lhalf : !ldst) return false;
+
+		std::vector<Color> row(rs.get_width());
+		for(int y = rs.miny; y < rs.maxy; ++y) {
+			lsrc.read(&row.front(), rs.minx + src_offset[0], y + src_offset[1], rs.get_width());
+			process(Params(
+				&row.front(), rs.get_width(),
+				&row.front(), rs.get_width(),
+				rs.get_width(), 1,
+				clamp_positive(gamma.get_r()),
+				clamp_positive(gamma.get_g()),
+				clamp_positive(gamma.get_b()) ));
+			if (half_target)
+				lhalf->get_surface().write_row(&row.front(), rs.minx, y, rs.get_width());
+			else
+				memcpy(&ldst->get_surface()[y][rs.minx], &row.front(), rs.get_width()*sizeof(Color));
+		}
+
+		return true;
+	}
+
 public:
 	virtual bool run(RunParams&) const {
 		if (!is_valid() || !sub_task() || !sub_task()->is_valid())
@@ -194,6 +228,8 @@ public:
 		VectorInt offset = get_offset();
 		RectInt rs = sub_task()->target_rect + rd.get_min() + offset;
 		etl::set_intersect(rs, rs, rd);
+		if (rs.is_valid() && (is_half_only(target_surface) || is_half_only(sub_task()->target_surface)))
+			return run_half(rs, -rd.get_min() - offset);
 		if (rs.is_valid())
 		{
 			LockWrite ldst(this);
@@ -0,0 +1,165 @@
+/* === S Y N F I G ========================================================= */
+/*!	\file synfig/rendering/software/task/taskrendercachesw.cpp
+**	\brief TaskRenderCacheSW
+**
+**	$Id$
+**
+**	\legal
+**	Copyright (c) 2019 Synfig Contributors
+**
+**	This package is free software; you can redistribute it and/or
+**	modify it under the terms of the GNU General Public License as
+**	published by the Free Software Foundation; either version 2 of
+**	the License, or (at your option) any later version.
+**
+**	This package is distributed in the hope that it will be useful,
+**	but WITHOUT ANY WARRANTY; without even the implied warranty of
+**	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+**	General Public License for more details.
+**	\endlegal
+*/
+/* ========================================================================= */
+
+/* === H E A D E R S ======================================================= */
+
+#ifdef USING_PCH
+#	include "pch.h"
+#else
+#ifdef HAVE_CONFIG_H
+#	include <config.h>
+#endif
+
+#include <cstring>
+
+#include <synfig/general.h>
+
+#include "../../common/task/taskrendercache.h"
+#include "../surfaceswtiled.h"
+#include "tasksw.h"
+
+#endif
+
+using namespace synfig;
+using namespace rendering;
+
+/* === M A C R O S ========================================================= */
+
+/* === G L O B A L S ======================================================= */
+
+/* === P R O C E D U R E S ================================================= */
+
+/* === M E T H O D S ======================================================= */
+
+namespace {
+
+class TaskRenderCacheSW: public TaskRenderCache, public TaskSW
+{
+public:
+	typedef etl::handle<TaskRenderCacheSW> Handle;
+	static Token token;
+	virtual Token::Handle get_token() const { return token.handle(); }
+
+private:
+	//! copies rect of dst from src, src_offset is position of src pixels relative to dst
+	static void copy(
+		synfig::Surface &dst,
+		const RectInt &rect,
+		const synfig::Surface &src,
+		const VectorInt &src_offset )
+	{
+		if (!rect.is_valid()) return;
+		size_t row_size = rect.get_width()*sizeof(Color);
+		for(int y = rect.miny; y < rect.maxy; ++y)
+			memcpy(&dst[y][rect.minx], &src[y + src_offset[1]][rect.minx + src_offset[0]], row_size);
+	}
+
+	SurfaceResource::Handle store(const synfig::Surface &src) const
+	{
+		// src is a whole surface of sub-task,
+		// pixel (0, 0) of cache corresponds to cache_target_rect.get_min() of src
+		RectInt rs = sub_task()->target_rect;
+		etl::set_intersect(rs, rs, cache_target_rect);
+		rs -= cache_target_rect.get_min();
+
+		// cached surfaces are stored as tiled, so transparent areas takes no memory
+		SurfaceSWTiled::Handle tiled = new SurfaceSWTiled();
+		if (rs == RectInt(VectorInt::zero(), cache_target_rect.get_size())) {
+			tiled->set_pixels(
+				&src[cache_target_rect.miny][cache_target_rect.minx],
+				rs.get_width(), rs.get_height(), src.get_pitch() );
+		} else {
+			synfig::Surface dst(cache_target_rect.get_width(), cache_target_rect.get_height());
+			dst.clear();
+			copy(dst, rs, src, cache_target_rect.get_min());
+			tiled->set_pixels(&dst[0][0], dst.get_w(), dst.get_h(), dst.get_pitch());
+		}
+		return new SurfaceResource(tiled);
+	}
+
+	bool load(const RectInt &rd, const VectorInt &offset) const
+	{
+		SurfaceResource::LockRead<SurfaceSWTiled> lsrc(surface);
+		if (!lsrc) return false;
+		const software::TiledSurface &src = lsrc->get_surface();
+
+		// when whole target is covered then just share tiles with the cached surface
+		RectInt full(VectorInt::zero(), target_surface->get_size());
+		if ( rd == full
+		  && offset == VectorInt::zero()
+		  && full.get_size() == VectorInt(src.get_width(), src.get_height()) )
+		{
+			SurfaceSWTiled::Handle copy = new SurfaceSWTiled(*lsrc);
+			target_surface->assign(copy);
+			return true;
+		}
+
+		LockWrite ldst(this);
+		if (!ldst) return false;
+		synfig::Surface &dst = ldst->get_surface();
+		src.get_pixels(rd + offset, &dst[rd.miny][rd.minx], dst.get_pitch());
+		return true;
+	}
+
+public:
+	virtual bool run(RunParams&) const {
+		if (!is_valid())
+			return true;
+
+		VectorInt offset = get_offset();
+		RectInt rd = RectInt(VectorInt::zero(), cache_target_rect.get_size()) - offset;
+		etl::set_intersect(rd, rd, target_rect);
+
+		if (sub_task()) {
+			if (!sub_task()->is_valid())
+				return true;
+
+			LockRead lsrc(sub_task());
+			if (!lsrc) return false;
+			const synfig::Surface &src = lsrc->get_surface();
+
+			if (cache)
+				if (SurfaceResource::Handle cached_surface = store(src))
+					cache->put(key, cached_surface);
+
+			if (rd.is_valid()) {
+				LockWrite ldst(this);
+				if (!ldst) return false;
+				copy(ldst->get_surface(), rd, src, offset + cache_target_rect.get_min());
+			}
+		} else
+		if (surface && rd.is_valid()) {
+			if (!load(rd, offset))
+				return false;
+		}
+
+		return true;
+	}
+};
+
+
+Task::Token TaskRenderCacheSW::token(
+	DescReal<TaskRenderCacheSW, TaskRenderCache>("RenderCacheSW") );
+
+} // end of anonimous namespace
+
+/* === E N T R Y P O I N T ================================================= */
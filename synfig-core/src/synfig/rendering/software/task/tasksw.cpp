@@ -32,7 +32,11 @@
 #include <synfig/general.h>
 #include <synfig/localization.h>
 
+#include <cstring>
+
 #include "tasksw.h"
+#include "../surfaceswhalf.h"
+#include "../surfaceswtiled.h"
 
 #endif
 
@@ -49,4 +53,61 @@ using namespace rendering;
 
 ModeToken TaskSW::mode_token("software");
 
+TaskSW::RowReader::RowReader(const SurfaceResource::Handle &resource):
+	lock(resource), surface(), tiled(), half()
+{
+	if (is_tiled_only(resource)) {
+		if (lock.convert<SurfaceSWTiled>(false))
+			tiled = &lock.cast<SurfaceSWTiled>()->get_surface();
+	} else
+	if (is_half_only(resource)) {
+		if (lock.convert<SurfaceSWHalf>(false))
+			half = &lock.cast<SurfaceSWHalf>()->get_surface();
+	} else
+	if (lock.convert<SurfaceSW>()) {
+		surface = &lock.cast<SurfaceSW>()->get_surface();
+	}
+}
+
+void
+TaskSW::RowReader::read(Color *dest, int x, int y, int count) const
+{
+	if (surface)
+		memcpy(dest, &(*surface)[y][x], count*sizeof(Color));
+	else
+	if (tiled)
+		tiled->get_pixels(RectInt(x, y, x + count, y + 1), dest, 0);
+	else
+	if (half)
+		half->read_row(dest, x, y, count);
+}
+
+bool
+TaskSW::RowReader::is_transparent(const RectInt &rect) const
+{
+	if (!tiled) return false;
+	const RectInt range = tiled->get_tiles_range(rect);
+	for(int ty = range.miny; ty < range.maxy; ++ty)
+		for(int tx = range.minx; tx < range.maxx; ++tx)
+			if (!tiled->get_tile(tx, ty).is_transparent())
+				return false;
+	return true;
+}
+
+bool
+TaskSW::is_tiled_only(const SurfaceResource::Handle &surface)
+{
+	return surface
+		&& surface->has_surface<SurfaceSWTiled>()
+		&& !surface->has_surface<SurfaceSW>();
+}
+
+bool
+TaskSW::is_half_only(const SurfaceResource::Handle &surface)
+{
+	return surface
+		&& surface->has_surface<SurfaceSWHalf>()
+		&& !surface->has_surface<SurfaceSW>();
+}
+
 /* === E N T R Y P O I N T ================================================= */
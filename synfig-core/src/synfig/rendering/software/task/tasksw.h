@@ -29,6 +29,8 @@
 
 #include "../../task.h"
 #include "../surfacesw.h"
+#include "../function/halfsurface.h"
+#include "../function/tiledsurface.h"
 
 /* === M A C R O S ========================================================= */
 
@@ -55,6 +57,36 @@ public:
 		{ return true; }
 	virtual bool get_mode_allow_simultaneous_write() const
 		{ return true; }
+
+	//! Reads rows of surface stored in any of software formats,
+	//! tiled and half-float surfaces are read without conversion of whole surface
+	class RowReader
+	{
+	private:
+		SurfaceResource::LockReadBase lock;
+		const synfig::Surface *surface;
+		const software::TiledSurface *tiled;
+		const software::HalfSurface *half;
+
+	public:
+		explicit RowReader(const SurfaceResource::Handle &resource);
+
+		//! reads count of pixels of row y starting from x
+		void read(Color *dest, int x, int y, int count) const;
+		//! returns true if all pixels of rect are known to be transparent without reading,
+		//! only transparent tiles of tiled surfaces can be detected
+		bool is_transparent(const RectInt &rect) const;
+
+		operator bool() const
+			{ return surface || tiled || half; }
+	};
+
+	//! returns true if the surface exists in the tiled form only,
+	//! such surfaces should be read as SurfaceSWTiled to avoid allocation of full-size buffer
+	static bool is_tiled_only(const SurfaceResource::Handle &surface);
+	//! returns true if the surface exists in the half-float form only,
+	//! supported tasks reads and writes such surfaces directly as SurfaceSWHalf
+	static bool is_half_only(const SurfaceResource::Handle &surface);
 };
 
 } /* end namespace rendering */
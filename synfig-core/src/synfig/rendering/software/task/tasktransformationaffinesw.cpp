@@ -38,7 +38,9 @@
 #include "../../common/task/taskpixelprocessor.h"
 #include "tasksw.h"
 
+#include "../surfaceswhalf.h"
 #include "../surfaceswpacked.h"
+#include "../surfaceswtiled.h"
 #include "../function/resample.h"
 
 #endif
@@ -71,17 +73,11 @@ public:
 	virtual Color::BlendMethodFlags get_supported_blend_methods() const
 		{ return Color::BLEND_METHODS_ALL; }
 
-	virtual bool run(RunParams&) const
+private:
+	//! returns matrix which transforms pixels of sub-task into pixels of target,
+	//! dst_origin is a position of the target pixel which will be (0, 0)
+	Matrix get_matrix(const VectorInt &dst_origin) const
 	{
-		if (!is_valid() || !sub_task() || !sub_task()->is_valid())
-			return true;
-
-		LockWrite ldst(this);
-		if (!ldst)
-			return false;
-
-		// transformation matrix
-
 		Vector src_upp = sub_task()->get_units_per_pixel();
 		Matrix src_pixels_to_units;
 		src_pixels_to_units.m00 = src_upp[0];
@@ -93,19 +89,49 @@ public:
 		Matrix dst_units_to_pixels;
 		dst_units_to_pixels.m00 = dst_ppu[0];
 		dst_units_to_pixels.m11 = dst_ppu[1];
-		dst_units_to_pixels.m20 = target_rect.minx - dst_ppu[0]*source_rect.minx;
-		dst_units_to_pixels.m21 = target_rect.miny - dst_ppu[1]*source_rect.miny;
+		dst_units_to_pixels.m20 = target_rect.minx - dst_origin[0] - dst_ppu[0]*source_rect.minx;
+		dst_units_to_pixels.m21 = target_rect.miny - dst_origin[1] - dst_ppu[1]*source_rect.miny;
 
-		Matrix matrix = dst_units_to_pixels * transformation->matrix * src_pixels_to_units;
+		return dst_units_to_pixels * transformation->matrix * src_pixels_to_units;
+	}
 
-		// resample
+	bool resample(synfig::Surface &dst, const RectInt &dst_rect, const Matrix &matrix) const
+	{
 		LockReadBase lsrc(sub_task());
 		if (lsrc.convert<SurfaceSWPacked>(false)) {
 			SurfaceSWPacked::Handle src = lsrc.cast<SurfaceSWPacked>();
 			if (!src) return false;
 			software::Resample::resample(
-				ldst->get_surface(),
-				target_rect,
+				dst,
+				dst_rect,
+				src->get_surface(),
+				sub_task()->target_rect,
+				matrix,
+				interpolation,
+				blend,
+				amount,
+				blend_method );
+		} else
+		if (is_tiled_only(sub_task()->target_surface) && lsrc.convert<SurfaceSWTiled>(false)) {
+			SurfaceSWTiled::Handle src = lsrc.cast<SurfaceSWTiled>();
+			if (!src) return false;
+			software::Resample::resample(
+				dst,
+				dst_rect,
+				src->get_surface(),
+				sub_task()->target_rect,
+				matrix,
+				interpolation,
+				blend,
+				amount,
+				blend_method );
+		} else
+		if (is_half_only(sub_task()->target_surface) && lsrc.convert<SurfaceSWHalf>(false)) {
+			SurfaceSWHalf::Handle src = lsrc.cast<SurfaceSWHalf>();
+			if (!src) return false;
+			software::Resample::resample(
+				dst,
+				dst_rect,
 				src->get_surface(),
 				sub_task()->target_rect,
 				matrix,
@@ -118,8 +144,8 @@ public:
 			TargetSurface::Handle src = lsrc.cast<TargetSurface>();
 			if (!src) return false;
 			software::Resample::resample(
-				ldst->get_surface(),
-				target_rect,
+				dst,
+				dst_rect,
 				src->get_surface(),
 				sub_task()->target_rect,
 				matrix,
@@ -130,9 +156,34 @@ public:
 		} else {
 			return false;
 		}
-
 		return true;
 	}
+
+public:
+	virtual bool run(RunParams&) const
+	{
+		if (!is_valid() || !sub_task() || !sub_task()->is_valid())
+			return true;
+
+		if (is_half_only(target_surface)) {
+			// resample into the temporary surface and pack it back
+			SurfaceResource::SemiLockWrite<SurfaceSWHalf> ldst(target_surface, target_rect);
+			if (!ldst)
+				return false;
+			software::HalfSurface &half = ldst->get_surface();
+			synfig::Surface dst(target_rect.get_width(), target_rect.get_height());
+			half.get_pixels(target_rect, &dst[0][0], dst.get_pitch());
+			if (!resample(dst, RectInt(VectorInt::zero(), target_rect.get_size()), get_matrix(target_rect.get_min())))
+				return false;
+			half.set_pixels(target_rect, &dst[0][0], dst.get_pitch());
+			return true;
+		}
+
+		LockWrite ldst(this);
+		if (!ldst)
+			return false;
+		return resample(ldst->get_surface(), target_rect, get_matrix(VectorInt::zero()));
+	}
 };
 
 Task::Token TaskTransformationAffineSW::token(
@@ -336,4 +336,19 @@ SurfaceResource::reset()
 	surfaces.clear();
 }
 
+long long
+SurfaceResource::get_memory_size() const
+{
+	// don't wait for writers, surfaces may be changed by them
+	Glib::Threads::RWLock::ReaderLock lock(rwlock, Glib::Threads::TRY_LOCK);
+	if (!lock.locked())
+		return -1;
+
+	Glib::Threads::Mutex::Lock short_lock(mutex);
+	long long size = 0;
+	for(Map::const_iterator i = surfaces.begin(); i != surfaces.end(); ++i)
+		size += (long long)i->second->get_memory_size();
+	return size;
+}
+
 /* === E N T R Y P O I N T ================================================= */
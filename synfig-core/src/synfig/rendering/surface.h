@@ -154,6 +154,9 @@ public:
 		{ return get_width()*get_height(); }
 	size_t get_buffer_size() const
 		{ return get_pixels_count()*sizeof(Color); }
+	//! size of memory used by pixels of surface in bytes
+	virtual size_t get_memory_size() const
+		{ return get_buffer_size(); }
 	bool is_exists() const
 		{ return get_width() > 0 && get_height() > 0; }
 	bool is_blank() const
@@ -371,6 +374,9 @@ public:
 	template<typename T>
 	bool has_surface() const
 		{ return has_surface(T::token.handle()); }
+	//! size of memory used by all surfaces of resource in bytes,
+	//! returns -1 if resource is locked for writing at the moment
+	long long get_memory_size() const;
 	bool get_tokens(std::vector<Surface::Token::Handle> &outTokens) const {
 		Glib::Threads::Mutex::Lock lock(mutex);
 		for(Map::const_iterator i = surfaces.begin(); i != surfaces.end(); ++i)
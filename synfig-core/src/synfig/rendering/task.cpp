@@ -298,6 +298,24 @@ Task::allow_run_before(Task &other) const {
 	return true;
 }
 
+bool
+Task::calc_hash(Hash &hash) const
+{
+	hash << get_token()->name << source_rect << target_rect;
+	if (!hash_params(hash))
+		return false;
+	hash << (int)sub_tasks.size();
+	for(List::const_iterator i = sub_tasks.begin(); i != sub_tasks.end(); ++i)
+		if (*i) {
+			hash << true;
+			if (!(*i)->calc_hash(hash))
+				return false;
+		} else {
+			hash << false;
+		}
+	return true;
+}
+
 void
 Task::set_coords_zero()
 	{ set_coords(Rect::zero(), VectorInt::zero()); }
@@ -36,6 +36,7 @@
 #include <synfig/vector.h>
 
 #include "surface.h"
+#include "taskpool.h"
 
 /* === M A C R O S ========================================================= */
 
@@ -129,7 +130,7 @@ class Task: public etl::shared_object
 {
 public:
 	typedef etl::handle<Task> Handle;
-	typedef std::vector<Handle> List;
+	typedef std::vector<Handle, TaskPool::Allocator<Handle> > List;
 	typedef std::set<Handle> Set;
 
 	typedef Task* (*Fabric)();
@@ -286,6 +287,35 @@ public:
 		RendererData(): batch_index(), index(), success() { }
 	};
 
+	//! Accumulates 64-bit FNV-1a hash of task parameters, see Task::hash_params()
+	class Hash
+	{
+	private:
+		unsigned long long value;
+
+	public:
+		Hash(): value(14695981039346656037ull) { }
+
+		void add(const void *data, size_t size) {
+			for(const unsigned char *i = (const unsigned char*)data, *end = i + size; i != end; ++i)
+				value = (value ^ *i)*1099511628211ull;
+		}
+		void add(const String &x)
+			{ add((int)x.size()); add(x.data(), x.size()); }
+
+		//! use for plain types without paddings only
+		template<typename T>
+		void add(const T &x)
+			{ add(&x, sizeof(x)); }
+
+		template<typename T>
+		Hash& operator<< (const T &x)
+			{ add(x); return *this; }
+
+		unsigned long long get() const
+			{ return value; }
+	};
+
 	class LockReadBase: public SurfaceResource::LockReadBase
 	{
 	public:
@@ -365,6 +395,12 @@ public:
 	Task();
 	virtual ~Task();
 
+	//! tasks are allocated from the pool, see TaskPool
+	static void* operator new(std::size_t size)
+		{ return TaskPool::allocate(size); }
+	static void operator delete(void *p, std::size_t size)
+		{ TaskPool::deallocate(p, size); }
+
 	void assign_target(const Task &other);
 	void assign(const Task &other);
 	Task& operator=(const Task &other);
@@ -446,6 +482,16 @@ public:
 	virtual int get_pass_subtask_index() const
 		{ return PASSTO_THIS_TASK; }
 
+	//! Adds to hash all parameters which affects to result of this task,
+	//! except coordinates and sub-tasks.
+	//! Returns false when result of task cannot be identified by hash (by default),
+	//! for example when task reads external surfaces or layers.
+	virtual bool hash_params(Hash & /* hash */) const
+		{ return false; }
+	//! Calculates hash of whole tree of tasks including coordinates,
+	//! returns false if any task in tree cannot be hashed (see hash_params())
+	bool calc_hash(Hash &hash) const;
+
 	void touch_coords();
 	void set_coords(const Rect &source_rect, const VectorInt &target_size);
 	void set_coords_zero();
@@ -0,0 +1,286 @@
+/* === S Y N F I G ========================================================= */
+/*!	\file synfig/rendering/taskpool.cpp
+**	\brief TaskPool
+**
+**	$Id$
+**
+**	\legal
+**	Copyright (c) 2019 Synfig Contributors
+**
+**	This package is free software; you can redistribute it and/or
+**	modify it under the terms of the GNU General Public License as
+**	published by the Free Software Foundation; either version 2 of
+**	the License, or (at your option) any later version.
+**
+**	This package is distributed in the hope that it will be useful,
+**	but WITHOUT ANY WARRANTY; without even the implied warranty of
+**	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+**	General Public License for more details.
+**	\endlegal
+*/
+/* ========================================================================= */
+
+/* === H E A D E R S ======================================================= */
+
+#ifdef USING_PCH
+#	include "pch.h"
+#else
+#ifdef HAVE_CONFIG_H
+#	include <config.h>
+#endif
+
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <new>
+#include <set>
+
+#include <glibmm/threads.h>
+
+#include <synfig/general.h>
+
+#include "taskpool.h"
+
+#endif
+
+using namespace synfig;
+using namespace rendering;
+
+/* === M A C R O S ========================================================= */
+
+/* === G L O B A L S ======================================================= */
+
+namespace {
+
+// blocks are aligned by granularity, it should be not less than alignment of operator new
+const size_t granularity = 16;
+const size_t classes_count = 64;
+const size_t max_block_size = granularity*classes_count;
+// blocks freed over this limit are passed back to the system immediately
+const size_t cache_limit = 4*1024*1024;
+
+struct FreeBlock
+{
+	FreeBlock *next;
+};
+
+class ThreadCache;
+
+struct State
+{
+	bool enabled;
+	Glib::Threads::Mutex mutex;
+	std::set<ThreadCache*> caches;
+	//! statistics of finished threads
+	TaskPool::Statistics finished;
+
+	State(): enabled(true)
+	{
+		if (const char *s = getenv("SYNFIG_RENDERING_TASK_POOL"))
+			enabled = atoi(s) != 0;
+	}
+};
+
+State&
+get_state()
+{
+	// state is never destroyed, because tasks may be released
+	// by destructors of another static objects
+	static State *state = new State();
+	return *state;
+}
+
+void
+add_statistics(TaskPool::Statistics &dst, const TaskPool::Statistics &src)
+{
+	dst.allocations += src.allocations;
+	dst.deallocations += src.deallocations;
+	dst.reused += src.reused;
+	dst.system_allocations += src.system_allocations;
+	dst.released += src.released;
+	dst.max_cached_size = std::max(dst.max_cached_size, src.max_cached_size);
+}
+
+//! Counter, written only by the owner thread and read by TaskPool::get_statistics()
+class Counter
+{
+	std::atomic<long long> value;
+public:
+	Counter(): value(0) { }
+	void add(long long x)
+		{ value.store(value.load(std::memory_order_relaxed) + x, std::memory_order_relaxed); }
+	void set_max(long long x)
+		{ if (x > get()) value.store(x, std::memory_order_relaxed); }
+	long long get() const
+		{ return value.load(std::memory_order_relaxed); }
+};
+
+//! Free blocks of single thread
+class ThreadCache
+{
+private:
+	FreeBlock *free_blocks[classes_count];
+	size_t cached_size;
+
+	Counter allocations;
+	Counter deallocations;
+	Counter reused;
+	Counter system_allocations;
+	Counter released;
+	Counter max_cached_size;
+
+public:
+	ThreadCache(): free_blocks(), cached_size(0)
+	{
+		State &state = get_state();
+		Glib::Threads::Mutex::Lock lock(state.mutex);
+		state.caches.insert(this);
+	}
+
+	~ThreadCache()
+	{
+		release();
+		State &state = get_state();
+		Glib::Threads::Mutex::Lock lock(state.mutex);
+		state.caches.erase(this);
+		add_statistics(state.finished, get_statistics());
+	}
+
+	void* allocate(size_t size, bool enabled)
+	{
+		allocations.add(1);
+		if (enabled && size <= max_block_size) {
+			size_t index = (size - 1)/granularity;
+			if (FreeBlock *block = free_blocks[index]) {
+				free_blocks[index] = block->next;
+				cached_size -= (index + 1)*granularity;
+				reused.add(1);
+				return block;
+			}
+			size = (index + 1)*granularity;
+		}
+		system_allocations.add(1);
+		return ::operator new(size);
+	}
+
+	void deallocate(void *p, size_t size, bool enabled)
+	{
+		deallocations.add(1);
+		if (enabled && size <= max_block_size) {
+			size_t index = (size - 1)/granularity;
+			size_t block_size = (index + 1)*granularity;
+			if (cached_size + block_size <= cache_limit) {
+				FreeBlock *block = static_cast<FreeBlock*>(p);
+				block->next = free_blocks[index];
+				free_blocks[index] = block;
+				cached_size += block_size;
+				max_cached_size.set_max(cached_size);
+				return;
+			}
+			released.add(1);
+		}
+		::operator delete(p);
+	}
+
+	void release()
+	{
+		for(size_t i = 0; i < classes_count; ++i) {
+			while(FreeBlock *block = free_blocks[i]) {
+				free_blocks[i] = block->next;
+				::operator delete(block);
+				released.add(1);
+			}
+		}
+		cached_size = 0;
+	}
+
+	TaskPool::Statistics get_statistics() const
+	{
+		TaskPool::Statistics s;
+		s.allocations = allocations.get();
+		s.deallocations = deallocations.get();
+		s.reused = reused.get();
+		s.system_allocations = system_allocations.get();
+		s.released = released.get();
+		s.max_cached_size = max_cached_size.get();
+		return s;
+	}
+};
+
+// marked when cache of the thread is destroyed,
+// blocks released after that (by destructors of another thread local
+// or static objects) are passed to the system allocator directly
+thread_local bool cache_destroyed = false;
+
+struct ThreadCacheHolder
+{
+	ThreadCache cache;
+	~ThreadCacheHolder() { cache_destroyed = true; }
+};
+
+ThreadCache*
+get_cache()
+{
+	if (cache_destroyed) return NULL;
+	static thread_local ThreadCacheHolder holder;
+	return &holder.cache;
+}
+
+} // end of anonimous namespace
+
+/* === P R O C E D U R E S ================================================= */
+
+/* === M E T H O D S ======================================================= */
+
+void*
+TaskPool::allocate(size_t size)
+{
+	if (!size) size = 1;
+	if (ThreadCache *cache = get_cache())
+		return cache->allocate(size, get_state().enabled);
+	return ::operator new(size);
+}
+
+void
+TaskPool::deallocate(void *p, size_t size)
+{
+	if (!p) return;
+	if (!size) size = 1;
+	if (ThreadCache *cache = get_cache())
+		cache->deallocate(p, size, get_state().enabled);
+	else
+		::operator delete(p);
+}
+
+void
+TaskPool::release()
+{
+	if (ThreadCache *cache = get_cache())
+		cache->release();
+}
+
+bool
+TaskPool::is_enabled()
+	{ return get_state().enabled; }
+
+TaskPool::Statistics
+TaskPool::get_statistics()
+{
+	State &state = get_state();
+	Glib::Threads::Mutex::Lock lock(state.mutex);
+	Statistics statistics = state.finished;
+	for(std::set<ThreadCache*>::const_iterator i = state.caches.begin(); i != state.caches.end(); ++i)
+		add_statistics(statistics, (*i)->get_statistics());
+	return statistics;
+}
+
+void
+TaskPool::log_statistics()
+{
+	Statistics s = get_statistics();
+	info( "rendering task pool: allocations %lld, deallocations %lld, reused %lld, system allocations %lld, released %lld, max cached %.1fMb per thread",
+		  s.allocations, s.deallocations, s.reused, s.system_allocations, s.released,
+		  (double)s.max_cached_size/(1024.0*1024.0) );
+}
+
+/* === E N T R Y P O I N T ================================================= */
@@ -0,0 +1,112 @@
+/* === S Y N F I G ========================================================= */
+/*!	\file synfig/rendering/taskpool.h
+**	\brief TaskPool Header
+**
+**	$Id$
+**
+**	\legal
+**	Copyright (c) 2019 Synfig Contributors
+**
+**	This package is free software; you can redistribute it and/or
+**	modify it under the terms of the GNU General Public License as
+**	published by the Free Software Foundation; either version 2 of
+**	the License, or (at your option) any later version.
+**
+**	This package is distributed in the hope that it will be useful,
+**	but WITHOUT ANY WARRANTY; without even the implied warranty of
+**	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+**	General Public License for more details.
+**	\endlegal
+*/
+/* ========================================================================= */
+
+/* === S T A R T =========================================================== */
+
+#ifndef __SYNFIG_RENDERING_TASKPOOL_H
+#define __SYNFIG_RENDERING_TASKPOOL_H
+
+/* === H E A D E R S ======================================================= */
+
+#include <cstddef>
+
+/* === M A C R O S ========================================================= */
+
+/* === T Y P E D E F S ===================================================== */
+
+/* === C L A S S E S & S T R U C T S ======================================= */
+
+namespace synfig
+{
+namespace rendering
+{
+
+//! Memory pool for tasks and lists of sub-tasks.
+//! Tasks are created and destroyed thousands times per frame,
+//! so freed blocks are kept in the per-thread lists by size and reused for the next tasks
+//! instead of passing them back to the system allocator.
+//! Lists are not shared between threads, so no locks are required.
+//! Blocks cached by thread are passed back to the system in one shot by release(),
+//! renderer calls it when the frame is finished and when rendering thread becomes idle.
+//! Pool may be disabled by environment variable SYNFIG_RENDERING_TASK_POOL=0,
+//! statistics printed by Renderer::deinitialize() when SYNFIG_RENDERING_TASK_POOL_STATISTICS is set.
+//! All methods are thread-safe.
+class TaskPool
+{
+public:
+	struct Statistics
+	{
+		long long allocations;        //!< total count of allocations
+		long long deallocations;      //!< total count of deallocations
+		long long reused;             //!< allocations served by previously freed blocks
+		long long system_allocations; //!< requests to the system allocator
+		long long released;           //!< freed blocks passed back to the system allocator
+		long long max_cached_size;    //!< maximal size of blocks cached by single thread in bytes
+		Statistics():
+			allocations(), deallocations(), reused(), system_allocations(), released(), max_cached_size() { }
+	};
+
+	//! STL allocator, used for lists of sub-tasks
+	template<typename T>
+	class Allocator
+	{
+	public:
+		typedef T value_type;
+		typedef T* pointer;
+		typedef const T* const_pointer;
+		typedef T& reference;
+		typedef const T& const_reference;
+		typedef std::size_t size_type;
+		typedef std::ptrdiff_t difference_type;
+		template<typename TT> struct rebind { typedef Allocator<TT> other; };
+
+		Allocator() { }
+		template<typename TT> Allocator(const Allocator<TT>&) { }
+
+		pointer allocate(size_type n, const void* = 0)
+			{ return static_cast<pointer>(TaskPool::allocate(n*sizeof(T))); }
+		void deallocate(pointer p, size_type n)
+			{ TaskPool::deallocate(p, n*sizeof(T)); }
+		size_type max_size() const
+			{ return size_type(-1)/sizeof(T); }
+
+		template<typename TT> bool operator== (const Allocator<TT>&) const { return true; }
+		template<typename TT> bool operator!= (const Allocator<TT>&) const { return false; }
+	};
+
+	static void* allocate(std::size_t size);
+	static void deallocate(void *p, std::size_t size);
+
+	//! passes all blocks cached by the current thread back to the system allocator
+	static void release();
+
+	static bool is_enabled();
+	static Statistics get_statistics();
+	static void log_statistics();
+};
+
+} /* end namespace rendering */
+} /* end namespace synfig */
+
+/* -- E N D ----------------------------------------------------------------- */
+
+#endif
@@ -0,0 +1,213 @@
+/* === S Y N F I G ========================================================= */
+/*!	\file synfig/rendering/tasktrace.cpp
+**	\brief TaskTrace
+**
+**	$Id$
+**
+**	\legal
+**	Copyright (c) 2019 Synfig Contributors
+**
+**	This package is free software; you can redistribute it and/or
+**	modify it under the terms of the GNU General Public License as
+**	published by the Free Software Foundation; either version 2 of
+**	the License, or (at your option) any later version.
+**
+**	This package is distributed in the hope that it will be useful,
+**	but WITHOUT ANY WARRANTY; without even the implied warranty of
+**	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+**	General Public License for more details.
+**	\endlegal
+*/
+/* ========================================================================= */
+
+/* === H E A D E R S ======================================================= */
+
+#ifdef USING_PCH
+#	include "pch.h"
+#else
+#ifdef HAVE_CONFIG_H
+#	include <config.h>
+#endif
+
+#include <glib.h>
+
+#include <synfig/general.h>
+#include <synfig/localization.h>
+
+#include "tasktrace.h"
+
+#endif
+
+using namespace synfig;
+using namespace rendering;
+
+/* === M A C R O S ========================================================= */
+
+/* === G L O B A L S ======================================================= */
+
+namespace {
+	//! records are written to file when the buffer of thread reaches this size
+	const size_t buffer_size = 4096;
+}
+
+/* === P R O C E D U R E S ================================================= */
+
+/* === M E T H O D S ======================================================= */
+
+TaskTrace::TaskTrace(int threads_count):
+	enabled(false),
+	file(),
+	format(FORMAT_CHROME),
+	start_time(),
+	empty(true)
+{
+	for(int i = 0; i < threads_count; ++i)
+		buffers.push_back(new Buffer());
+}
+
+TaskTrace::~TaskTrace()
+{
+	close();
+	while(!buffers.empty())
+		{ delete buffers.back(); buffers.pop_back(); }
+}
+
+bool
+TaskTrace::open(const String &filename)
+{
+	bool csv = filename.size() >= 4
+			&& filename.compare(filename.size() - 4, 4, ".csv") == 0;
+	return open(filename, csv ? FORMAT_CSV : FORMAT_CHROME);
+}
+
+bool
+TaskTrace::open(const String &filename, Format format)
+{
+	close();
+
+	Glib::Threads::Mutex::Lock lock(file_mutex);
+	file = fopen(filename.c_str(), "w");
+	if (!file) {
+		error("rendering: cannot open task trace file '%s'", filename.c_str());
+		return false;
+	}
+	this->format = format;
+	start_time = g_get_monotonic_time();
+	empty = true;
+	write_header();
+
+	// drop records left from previous session
+	for(BufferList::const_iterator i = buffers.begin(); i != buffers.end(); ++i) {
+		Glib::Threads::Mutex::Lock buffer_lock((*i)->mutex);
+		(*i)->records.clear();
+	}
+
+	enabled = true;
+	info("rendering: task trace enabled, file '%s'", filename.c_str());
+	return true;
+}
+
+void
+TaskTrace::close()
+{
+	if (!enabled) return;
+	enabled = false;
+	flush();
+
+	Glib::Threads::Mutex::Lock lock(file_mutex);
+	if (!file) return;
+	if (format == FORMAT_CHROME)
+		fputs("\n]\n", file);
+	fclose(file);
+	file = NULL;
+}
+
+void
+TaskTrace::write_header()
+{
+	// mutex must be already locked
+	if (format == FORMAT_CSV) {
+		fputs("batch,thread,task,begin_us,end_us,duration_us,area,bytes\n", file);
+		return;
+	}
+
+	fputs("[", file);
+	for(int i = 0; i < (int)buffers.size(); ++i) {
+		fprintf( file,
+				 "%s\n{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 1, \"tid\": %d, \"args\": {\"name\": \"%s %d\"}}",
+				 empty ? "" : ",",
+				 i,
+				 i ? "rendering thread" : "rendering single thread",
+				 i );
+		empty = false;
+	}
+}
+
+void
+TaskTrace::write(const RecordList &records)
+{
+	// mutex must be already locked
+	if (!file) return;
+	for(RecordList::const_iterator i = records.begin(); i != records.end(); ++i) {
+		const char *name = i->token ? i->token->name.c_str() : "";
+		if (format == FORMAT_CSV) {
+			fprintf( file, "%d,%d,%s,%lld,%lld,%lld,%lld,%lld\n",
+					 i->batch_index, i->thread_index, name,
+					 i->begin - start_time, i->end - start_time, i->end - i->begin,
+					 i->area, i->memory );
+		} else {
+			fprintf( file,
+					 "%s\n{\"name\": \"%s\", \"cat\": \"task\", \"ph\": \"X\", \"pid\": 1, \"tid\": %d, \"ts\": %lld, \"dur\": %lld, "
+					 "\"args\": {\"batch\": %d, \"area\": %lld, \"bytes\": %lld}}",
+					 empty ? "" : ",",
+					 name, i->thread_index,
+					 i->begin - start_time, i->end - i->begin,
+					 i->batch_index, i->area, i->memory );
+			empty = false;
+		}
+	}
+}
+
+void
+TaskTrace::flush()
+{
+	RecordList records;
+	for(BufferList::const_iterator i = buffers.begin(); i != buffers.end(); ++i) {
+		{
+			Glib::Threads::Mutex::Lock lock((*i)->mutex);
+			records.swap((*i)->records);
+		}
+		if (!records.empty()) {
+			Glib::Threads::Mutex::Lock lock(file_mutex);
+			write(records);
+			records.clear();
+		}
+	}
+	Glib::Threads::Mutex::Lock lock(file_mutex);
+	if (file) fflush(file);
+}
+
+void
+TaskTrace::add(const Record &record)
+{
+	if (record.thread_index < 0 || record.thread_index >= (int)buffers.size())
+		return;
+
+	RecordList records;
+	{
+		Buffer &buffer = *buffers[record.thread_index];
+		Glib::Threads::Mutex::Lock lock(buffer.mutex);
+		if (buffer.records.capacity() < buffer_size)
+			buffer.records.reserve(buffer_size);
+		buffer.records.push_back(record);
+		if (buffer.records.size() >= buffer_size)
+			records.swap(buffer.records);
+	}
+
+	if (!records.empty()) {
+		Glib::Threads::Mutex::Lock lock(file_mutex);
+		write(records);
+	}
+}
+
+/* === E N T R Y P O I N T ================================================= */
@@ -0,0 +1,121 @@
+/* === S Y N F I G ========================================================= */
+/*!	\file synfig/rendering/tasktrace.h
+**	\brief TaskTrace Header
+**
+**	$Id$
+**
+**	\legal
+**	Copyright (c) 2019 Synfig Contributors
+**
+**	This package is free software; you can redistribute it and/or
+**	modify it under the terms of the GNU General Public License as
+**	published by the Free Software Foundation; either version 2 of
+**	the License, or (at your option) any later version.
+**
+**	This package is distributed in the hope that it will be useful,
+**	but WITHOUT ANY WARRANTY; without even the implied warranty of
+**	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+**	General Public License for more details.
+**	\endlegal
+*/
+/* ========================================================================= */
+
+/* === S T A R T =========================================================== */
+
+#ifndef __SYNFIG_RENDERING_TASKTRACE_H
+#define __SYNFIG_RENDERING_TASKTRACE_H
+
+/* === H E A D E R S ======================================================= */
+
+#include <cstdio>
+
+#include <vector>
+#include <atomic>
+
+#include <glibmm/threads.h>
+
+#include "task.h"
+
+/* === M A C R O S ========================================================= */
+
+/* === T Y P E D E F S ===================================================== */
+
+/* === C L A S S E S & S T R U C T S ======================================= */
+
+namespace synfig
+{
+namespace rendering
+{
+
+//! Writes a record about every executed task into a file.
+//! Records are collected in per-thread buffers and written by portions,
+//! so tracing may stay enabled during rendering of long sequences.
+//! Two formats are supported: Chrome trace events (JSON array, open it
+//! in chrome://tracing) and CSV with one row per task.
+class TaskTrace
+{
+public:
+	enum Format {
+		FORMAT_CHROME,
+		FORMAT_CSV
+	};
+
+	struct Record {
+		Task::Token::Handle token;
+		int thread_index;
+		int batch_index;          //!< index of enqueued task list, one per frame
+		long long begin;          //!< monotonic time of start of Task::run() (microseconds)
+		long long end;            //!< monotonic time of finish of Task::run() (microseconds)
+		long long area;           //!< count of pixels in target_rect
+		long long memory;         //!< bytes allocated in target surface, -1 if unknown
+
+		Record(): thread_index(), batch_index(), begin(), end(), area(), memory(-1) { }
+	};
+
+private:
+	typedef std::vector<Record> RecordList;
+
+	struct Buffer {
+		Glib::Threads::Mutex mutex;
+		RecordList records;
+	};
+	typedef std::vector<Buffer*> BufferList;
+
+	BufferList buffers;
+	std::atomic<bool> enabled;
+
+	Glib::Threads::Mutex file_mutex;
+	FILE *file;
+	Format format;
+	long long start_time;
+	bool empty;
+
+	void write_header();
+	void write(const RecordList &records);
+
+public:
+	explicit TaskTrace(int threads_count);
+	~TaskTrace();
+
+	//! opens file and enables tracing,
+	//! format is CSV if file name ends with ".csv" and Chrome trace events otherwise
+	bool open(const String &filename);
+	bool open(const String &filename, Format format);
+	//! writes all collected records and disables tracing
+	void close();
+	//! writes all collected records, called by Renderer when the frame is finished
+	void flush();
+
+	bool is_enabled() const
+		{ return enabled; }
+
+	//! should be called from the thread thread_index only
+	void add(const Record &record);
+};
+
+} /* end namespace rendering */
+} /* end namespace synfig */
+
+/* -- E N D ----------------------------------------------------------------- */
+
+#endif
@@ -271,7 +271,37 @@ synfig::Surface::blit_to(alpha_pen& pen, int x, int y, int w, int h)
 		return;
 	}
 #endif
-	etl::surface<Color, ColorAccumulator, ColorPrep>::blit_to(pen,x,y,w,h);
+
+	if(x>=get_w() || y>=get_h())
+		return;
+
+	//clip source origin
+	if(x<0)
+	{
+		w+=x;	//decrease
+		x=0;
+	}
+
+	if(y<0)
+	{
+		h+=y;	//decrease
+		y=0;
+	}
+
+	//clip width against dest width
+	w = min((long)w,(long)(pen.end_x()-pen.x()));
+	h = min((long)h,(long)(pen.end_y()-pen.y()));
+
+	//clip width against src width
+	w = min(w,get_w()-x);
+	h = min(h,get_h()-y);
+
+	if(w<=0 || h<=0)
+		return;
+
+	// blend whole rows instead of separate pixels
+	for(int i=0;i<h;i++,pen.inc_y())
+		Color::blend_row(pen.x(), operator[](y+i)+x, w, alpha, pen.get_blend_method());
 }
 
 void
@@ -235,6 +235,14 @@ public:
 
 	//! Returns the blend method being used for this pen
 	Color::BlendMethod get_blend_method()const { return affine_func_.blend_method; }
+
+	//! Blends pen value onto \a l pixels at once, see Color::blend_row()
+	void put_hline(int l, const alpha_type &a = 1)
+	{
+		if (l <= 0) return;
+		Color::blend_row(x(), get_pen_value(), l, get_alpha()*a, get_blend_method());
+		inc_x(l);
+	}
 };	// END of class Surface::alpha_pen
 
 
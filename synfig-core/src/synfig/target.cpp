@@ -92,7 +92,8 @@ Target::Target():
 	quality_(4),
 	alpha_mode(TARGET_ALPHA_MODE_KEEP),
 	avoid_time_sync_(false),
-	curr_frame_(0)
+	curr_frame_(0),
+	frame_threads(1)
 {
 }
 
@@ -115,8 +116,8 @@ Target::create(const String &name, const String &filename,
 	return Target::Handle(book()[name].factory(filename.c_str(), params));
 }
 
-int
-Target::next_frame(Time& time)
+Time
+Target::get_frame_time(int index)const
 {
 	int
 	total_frames(1),
@@ -140,13 +141,17 @@ Target::next_frame(Time& time)
 	if(total_frames<=0)total_frames=1;
 
 	if(total_frames == 1)
-	{
-		time=time_start;
-	}
-	else
-	{
-		time=(time_end-time_start)*curr_frame_/(total_frames-(exclude_last_frame?0:1))+time_start;
-	}
+		return time_start;
+	return (time_end-time_start)*index/(total_frames-(exclude_last_frame?0:1))+time_start;
+}
+
+int
+Target::next_frame(Time& time)
+{
+	int total_frames=desc.get_frame_end()-desc.get_frame_start()+1;
+	if(total_frames<=0)total_frames=1;
+
+	time=get_frame_time(curr_frame_);
 
 //	synfig::info("before curr_frame_: %d",curr_frame_);
 	curr_frame_++;
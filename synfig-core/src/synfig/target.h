@@ -185,6 +185,9 @@ public:
 	//! The current frame being rendered
 	int curr_frame_;
 
+	//! Number of frames to render simultaneously
+	int frame_threads;
+
 protected:
 	//! Default constructor
 	Target();
@@ -210,6 +213,12 @@ public:
 	virtual void set_canvas(etl::handle<Canvas> c);
 	//! Gets the target canvas.
 	const etl::handle<Canvas> &get_canvas()const { return canvas; }
+	//! Sets the number of frames to render simultaneously,
+	//! targets which supports it builds each frame from own snapshot of the canvas
+	//! \see Canvas::build_rendering_task(Time, const ContextParams&)
+	void set_frame_threads(int x) { frame_threads=x; }
+	//! Gets the number of frames to render simultaneously
+	int get_frame_threads()const { return frame_threads; }
 	//! Gets the target particular render description
 	RendDesc &rend_desc() { return desc; }
 	//! Gets the target particular render description
@@ -241,6 +250,10 @@ public:
 	 **	\sa curr_frame_
 	*/
 	virtual int	next_frame(Time& time);
+
+	//! Returns the time of frame with given index, counting from zero
+	/*! \sa next_frame() */
+	Time get_frame_time(int index)const;
 }; // END of class Target
 
 }; // END of namespace synfig
@@ -31,6 +31,10 @@
 #	include <config.h>
 #endif
 
+#include <map>
+
+#include <glibmm/threads.h>
+
 #include "target_scanline.h"
 
 #include "general.h"
@@ -65,6 +69,49 @@ using namespace rendering;
 
 /* === P R O C E D U R E S ================================================= */
 
+/* === C L A S S E S ======================================================= */
+
+struct Target_Scanline::FrameQueue
+{
+	typedef std::map<int, SurfaceResource::Handle> Map;
+
+	Glib::Threads::Mutex mutex;
+	Glib::Threads::Cond cond;
+
+	const int total_frames;
+	//! how many frames may be rendered ahead of the last frame put onto the target,
+	//! limits memory usage when target is slower than renderer
+	const int max_ahead;
+
+	int next_index; //!< index of next frame to render
+	int written;    //!< count of frames which already put onto the target
+	bool stop;
+	bool failed;
+	Map ready;      //!< rendered frames waiting for their turn
+
+	std::vector<Glib::Threads::Thread*> threads;
+
+	FrameQueue(int total_frames, int max_ahead):
+		total_frames(total_frames),
+		max_ahead(max_ahead),
+		next_index(),
+		written(),
+		stop(),
+		failed()
+	{ }
+
+	void join()
+	{
+		{
+			Glib::Threads::Mutex::Lock lock(mutex);
+			stop = true;
+			cond.broadcast();
+		}
+		while(!threads.empty())
+			{ threads.back()->join(); threads.pop_back(); }
+	}
+};
+
 /* === M E T H O D S ======================================================= */
 
 Target_Scanline::Target_Scanline():
@@ -87,9 +134,18 @@ synfig::Target_Scanline::call_renderer(
 	Canvas &canvas,
 	const ContextParams &context_params,
 	const RendDesc &renddesc )
+{
+	return call_renderer(surface, canvas.build_rendering_task(context_params), renddesc);
+}
+
+bool
+synfig::Target_Scanline::call_renderer(
+	const etl::handle<rendering::SurfaceResource> &surface,
+	const etl::handle<rendering::Task> &frame_task,
+	const RendDesc &renddesc )
 {
 	surface->create(renddesc.get_w(), renddesc.get_h());
-	rendering::Task::Handle task = canvas.build_rendering_task(context_params);
+	rendering::Task::Handle task = frame_task;
 
 	if (task)
 	{
@@ -120,6 +176,132 @@ synfig::Target_Scanline::call_renderer(
 	return true;
 }
 
+void
+synfig::Target_Scanline::process_frames(
+	FrameQueue *queue,
+	ContextParams context_params )
+{
+	while(true)
+	{
+		int index;
+		{
+			Glib::Threads::Mutex::Lock lock(queue->mutex);
+			while( !queue->stop
+				&& queue->next_index < queue->total_frames
+				&& queue->next_index >= queue->written + queue->max_ahead )
+					queue->cond.wait(queue->mutex);
+			if (queue->stop || queue->next_index >= queue->total_frames)
+				return;
+			index = queue->next_index++;
+		}
+
+		Time t = get_frame_time(index);
+		SurfaceResource::Handle surface = new SurfaceResource();
+		bool success = false;
+		try
+		{
+			// canvas is shared by threads, so it is not changed here,
+			// the frame is built from the snapshot of the canvas at time t
+			success = call_renderer(surface, canvas->build_rendering_task(t, context_params), desc);
+		}
+		catch(const String &str)
+		{
+			synfig::error("Target_Scanline: frame %d: %s", index, str.c_str());
+		}
+		catch(...)
+		{
+			synfig::error("Target_Scanline: frame %d: unknown error", index);
+		}
+
+		Glib::Threads::Mutex::Lock lock(queue->mutex);
+		if (success)
+			queue->ready[index] = surface;
+		else
+			queue->failed = true;
+		queue->cond.broadcast();
+	}
+}
+
+bool
+synfig::Target_Scanline::render_frames(
+	ProgressCallback *cb,
+	const ContextParams &context_params,
+	int total_frames )
+{
+	synfig::info("Render %d frames simultaneously", frame_threads);
+
+	// outline grow doesn't depend on time, snapshots copy it from the canvas
+	canvas->set_outline_grow(desc.get_outline_grow());
+
+	FrameQueue queue(total_frames, 2*frame_threads);
+	for(int i = 0; i < frame_threads; ++i)
+		queue.threads.push_back(
+			Glib::Threads::Thread::create(
+				sigc::bind(sigc::mem_fun(*this, &Target_Scanline::process_frames), &queue, context_params) ));
+
+	bool success = true;
+	try
+	{
+		Time t;
+		for(int index = 0; ; ++index)
+		{
+			// keep curr_frame_ in sync, targets may use it
+			int frames = next_frame(t);
+
+			if(cb && !cb->amount_complete(total_frames-frames,total_frames))
+				{ success = false; break; }
+
+			SurfaceResource::Handle surface;
+			{
+				Glib::Threads::Mutex::Lock lock(queue.mutex);
+				while(!queue.failed && !queue.ready.count(index))
+					queue.cond.wait(queue.mutex);
+				if (queue.failed)
+				{
+					if(cb)cb->error(_("Accelerated Renderer Failure"));
+					success = false;
+					break;
+				}
+				FrameQueue::Map::iterator i = queue.ready.find(index);
+				surface = i->second;
+				queue.ready.erase(i);
+			}
+
+			{
+				SurfaceResource::LockRead<SurfaceSW> lock(surface);
+				if(!lock)
+				{
+					if(cb)cb->error(_("Bad surface"));
+					success = false;
+					break;
+				}
+				if(!add_frame(&lock->get_surface()))
+				{
+					if(cb)cb->error(_("Unable to put surface on target"));
+					success = false;
+					break;
+				}
+			}
+
+			{
+				Glib::Threads::Mutex::Lock lock(queue.mutex);
+				queue.written = index + 1;
+				queue.cond.broadcast();
+			}
+
+			if (!frames) break;
+		}
+	}
+	catch(...)
+	{
+		queue.join();
+		throw;
+	}
+
+	queue.join();
+	return success;
+}
+
 bool
 synfig::Target_Scanline::render(ProgressCallback *cb)
 {
@@ -153,6 +335,17 @@ synfig::Target_Scanline::render(ProgressCallback *cb)
 
 	//synfig::info("1time_set_to %s",t.get_string().c_str());
 
+	#if USE_PIXELRENDERING_LIMIT
+	bool allow_frame_threads = desc.get_w()*desc.get_h() <= PIXEL_RENDERING_LIMIT;
+	#else
+	bool allow_frame_threads = true;
+	#endif
+
+	if(total_frames>1 && allow_frame_threads && frame_threads>1)
+	{
+		return render_frames(cb, context_params, total_frames);
+	}
+	else
 	if(total_frames>=1)
 	{
 		do{
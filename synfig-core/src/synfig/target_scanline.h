@@ -38,7 +38,7 @@
 
 namespace synfig {
 
-namespace rendering { class SurfaceResource; }
+namespace rendering { class SurfaceResource; class Task; }
 
 /*!	\class Target_Scanline
 **	\brief This is a Target class that implements the render function
@@ -57,6 +57,27 @@ class Target_Scanline : public Target
 		const ContextParams &context_params,
 		const RendDesc &renddesc );
 
+	bool call_renderer(
+		const etl::handle<rendering::SurfaceResource> &surface,
+		const etl::handle<rendering::Task> &task,
+		const RendDesc &renddesc );
+
+	//! Reorder buffer for simultaneous rendering of frames
+	struct FrameQueue;
+
+	//! Renders frames from queue, runs in several threads,
+	//! every frame is built from own snapshot of the canvas
+	void process_frames(
+		FrameQueue *queue,
+		ContextParams context_params );
+
+	//! Renders several frames simultaneously (see set_frame_threads())
+	//! and puts them onto the target in order
+	bool render_frames(
+		ProgressCallback *cb,
+		const ContextParams &context_params,
+		int total_frames );
+
 public:
 	typedef etl::handle<Target_Scanline> Handle;
 	typedef etl::loose_handle<Target_Scanline> LooseHandle;
@@ -31,6 +31,7 @@
 #	include <config.h>
 #endif
 
+#include <cmath>
 #include <vector>
 #include <algorithm>
 
@@ -52,6 +53,7 @@
 #include "rendering/renderer.h"
 #include "rendering/surface.h"
 #include "rendering/software/surfacesw.h"
+#include "rendering/common/task/taskblend.h"
 #include "rendering/common/task/tasktransformation.h"
 
 #endif
@@ -67,6 +69,10 @@ using namespace rendering;
 
 const unsigned int	DEF_TILE_WIDTH = TILE_SIZE / 2;
 const unsigned int	DEF_TILE_HEIGHT = TILE_SIZE / 2;
+const int			MIN_AUTO_TILE_SIZE = TILE_SIZE / 2;
+const int			MAX_AUTO_TILE_SIZE = TILE_SIZE * 8;
+//! count of tiles per rendering thread for automatic tile size
+const int			AUTO_TILES_PER_THREAD = 4;
 
 #ifdef _DEBUG
 //#define DEBUG_MEASURE
@@ -76,12 +82,96 @@ const unsigned int	DEF_TILE_HEIGHT = TILE_SIZE / 2;
 
 /* === P R O C E D U R E S ================================================= */
 
+namespace {
+	struct Tile
+	{
+		RectInt rect;
+		long long cost;
+		Tile(): cost() { }
+		Tile(const RectInt &rect, long long cost): rect(rect), cost(cost) { }
+		//! expensive tiles goes first
+		bool operator< (const Tile &other) const
+			{ return cost > other.cost; }
+	};
+
+	//! converts rect in canvas units into the pixels of frame
+	RectInt
+	to_pixels(const Rect &rect, const RendDesc &rend_desc)
+	{
+		const RectInt frame(0, 0, rend_desc.get_w(), rend_desc.get_h());
+		const Vector tl = rend_desc.get_tl();
+		const Vector br = rend_desc.get_br();
+		if (!rect.is_valid() || approximate_equal(tl[0], br[0]) || approximate_equal(tl[1], br[1]))
+			return RectInt::zero();
+
+		Rect r = rect;
+		r &= Rect(tl, br);
+		if (!r.is_valid())
+			return RectInt::zero();
+
+		Real kx = frame.maxx/(br[0] - tl[0]);
+		Real ky = frame.maxy/(br[1] - tl[1]);
+		Real x0 = (r.minx - tl[0])*kx, x1 = (r.maxx - tl[0])*kx;
+		Real y0 = (r.miny - tl[1])*ky, y1 = (r.maxy - tl[1])*ky;
+		RectInt pixels(
+			(int)floor(std::min(x0, x1)), (int)floor(std::min(y0, y1)),
+			(int)ceil (std::max(x0, x1)), (int)ceil (std::max(y0, y1)) );
+		pixels &= frame;
+		return pixels.is_valid() ? pixels : RectInt::zero();
+	}
+
+	//! collects bounds of layers which are blended together in the same coordinate system
+	void
+	collect_bounds(const rendering::Task::Handle &task, const RendDesc &rend_desc, std::vector<RectInt> &bounds)
+	{
+		if (!task)
+			return;
+		if (TaskBlend::Handle blend = TaskBlend::Handle::cast_dynamic(task)) {
+			collect_bounds(blend->sub_task_a(), rend_desc, bounds);
+			collect_bounds(blend->sub_task_b(), rend_desc, bounds);
+			return;
+		}
+		RectInt r = to_pixels(task->get_bounds(), rend_desc);
+		if (r.is_valid())
+			bounds.push_back(r);
+	}
+
+	//! estimates count of pixels which should be processed to render the tile
+	long long
+	estimate_cost(const RectInt &rect, const RectInt &content, const std::vector<RectInt> &bounds)
+	{
+		if (!(rect && content))
+			return 0;
+		long long cost = 0;
+		for(std::vector<RectInt>::const_iterator i = bounds.begin(); i != bounds.end(); ++i) {
+			RectInt r = rect;
+			r &= *i;
+			if (r.is_valid())
+				cost += (long long)r.get_width()*r.get_height();
+		}
+		return cost;
+	}
+
+	//! chooses size of square tile to get a few tiles per thread
+	int
+	choose_tile_size(const RectInt &content, int threads)
+	{
+		if (!content.is_valid())
+			return MAX_AUTO_TILE_SIZE;
+		Real area = (Real)content.get_width()*(Real)content.get_height();
+		int size = (int)ceil(sqrt(area/(std::max(1, threads)*AUTO_TILES_PER_THREAD)));
+		size = (size + 15)/16*16;
+		return std::max(MIN_AUTO_TILE_SIZE, std::min(MAX_AUTO_TILE_SIZE, size));
+	}
+}
+
 /* === M E T H O D S ======================================================= */
 
 Target_Tile::Target_Tile():
 	threads_(2),
 	tile_w_(DEF_TILE_WIDTH),
 	tile_h_(DEF_TILE_HEIGHT),
+	tile_auto_(true),
 	curr_tile_(0),
 	clipping_(true)
 {
@@ -179,18 +269,38 @@ synfig::Target_Tile::render_frame_(Canvas::Handle canvas, ContextParams context_
 	etl::clock tile_timer;
 	tile_timer.reset();
 
+	// Estimate where the content of frame is
+	RectInt content(0, 0, rend_desc.get_w(), rend_desc.get_h());
+	std::vector<RectInt> bounds;
+	if (rendering::Task::Handle task = canvas->build_rendering_task(context_params)) {
+		content = to_pixels(task->get_bounds(), rend_desc);
+		collect_bounds(task, rend_desc, bounds);
+	} else {
+		content = RectInt::zero();
+	}
+
+	if (tile_auto_) {
+		int threads = 1;
+		if (rendering::Renderer::Handle renderer = rendering::Renderer::get_renderer(get_engine()))
+			threads = renderer->get_max_simultaneous_threads();
+		tile_w_ = tile_h_ = choose_tile_size(content, threads);
+	}
+
 	// Gather tiles
-	std::vector<RectInt> tiles;
+	std::vector<Tile> tiles;
 	RectInt rect;
 	while(next_tile(rect)) {
 		if (clipping_)
 			if (rect.minx >= rend_desc.get_w() || rect.miny >= rend_desc.get_h())
 				continue;
-		tiles.push_back(rect);
+		tiles.push_back(Tile(rect, estimate_cost(rect, content, bounds)));
 	}
 
+	// Most expensive tiles goes first, so the last rendered tiles are the cheapest
+	std::stable_sort(tiles.begin(), tiles.end());
+
 	// Render tiles
-	for(std::vector<RectInt>::iterator i = tiles.begin(); i != tiles.end(); ++i)
+	for(std::vector<Tile>::iterator i = tiles.begin(); i != tiles.end(); ++i)
 	{
 		// Progress callback
 		int index = i - tiles.begin();
@@ -202,13 +312,20 @@ synfig::Target_Tile::render_frame_(Canvas::Handle canvas, ContextParams context_
 		// Render tile
 		tile_timer.reset();
 
-		rect = *i;
+		rect = i->rect;
 		if (clipping_)
 			etl::set_intersect(rect, rect, RectInt(0, 0, rend_desc.get_w(), rend_desc.get_h()));
 
 		if (!rect.valid())
 			continue;
 
+		// Tile outside of all layers, nothing to render
+		if (!i->cost) {
+			if (!add_empty_tile(rect, &super))
+				return false;
+			continue;
+		}
+
 		RendDesc tile_desc=rend_desc;
 		tile_desc.set_subwindow(rect.minx, rect.miny, rect.maxx - rect.minx, rect.maxy - rect.miny);
 
@@ -224,6 +341,51 @@ synfig::Target_Tile::render_frame_(Canvas::Handle canvas, ContextParams context_
 	return true;
 }
 
+void
+synfig::Target_Tile::apply_alpha_mode(synfig::Surface &surface) const
+{
+	synfig::Surface &s = surface;
+	int cnt = s.get_w() * s.get_h();
+
+	switch(get_alpha_mode())
+	{
+		case TARGET_ALPHA_MODE_FILL:
+			for(int i = 0; i < cnt; ++i)
+				s[0][i] = Color::blend(s[0][i], desc.get_bg_color(), 1.0f);
+			break;
+		case TARGET_ALPHA_MODE_EXTRACT:
+			for(int i = 0; i< cnt; ++i)
+			{
+				float a = s[0][i].get_a();
+				s[0][i] = Color(a,a,a,a);
+			}
+			break;
+		case TARGET_ALPHA_MODE_REDUCE:
+			for(int i = 0; i < cnt; ++i)
+				s[0][i].set_a(1.0f);
+			break;
+		default:
+			break;
+	}
+}
+
+bool
+synfig::Target_Tile::add_empty_tile(const RectInt &rect, ProgressCallback *cb)
+{
+	synfig::Surface s(rect.get_width(), rect.get_height());
+	s.clear();
+	apply_alpha_mode(s);
+
+	if (!add_tile(s, rect.minx, rect.miny))
+	{
+		if(cb)cb->error(_("add_tile():Unable to put surface on target"));
+		return false;
+	}
+
+	signal_progress()();
+	return true;
+}
+
 bool
 synfig::Target_Tile::async_render_tile(
 	etl::handle<Canvas> canvas,
@@ -250,28 +412,7 @@ synfig::Target_Tile::async_render_tile(
 	}
 
 	synfig::Surface &s = lock->get_surface();
-	int cnt = s.get_w() * s.get_h();
-
-	switch(get_alpha_mode())
-	{
-		case TARGET_ALPHA_MODE_FILL:
-			for(int i = 0; i < cnt; ++i)
-				s[0][i] = Color::blend(s[0][i], desc.get_bg_color(), 1.0f);
-			break;
-		case TARGET_ALPHA_MODE_EXTRACT:
-			for(int i = 0; i< cnt; ++i)
-			{
-				float a = s[0][i].get_a();
-				s[0][i] = Color(a,a,a,a);
-			}
-			break;
-		case TARGET_ALPHA_MODE_REDUCE:
-			for(int i = 0; i < cnt; ++i)
-				s[0][i].set_a(1.0f);
-			break;
-		default:
-			break;
-	}
+	apply_alpha_mode(s);
 
 	// Add the tile to the target
 	if (!add_tile(s, rect.minx, rect.miny))
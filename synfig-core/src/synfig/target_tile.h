@@ -55,6 +55,9 @@ class Target_Tile : public Target
 	int tile_w_;
 	//! Tile height in pixles
 	int tile_h_;
+	//! Determines if the tile size should be chosen for each frame
+	//! from bounds of the content and count of rendering threads
+	bool tile_auto_;
 	//! The current tile being rendered
 	int curr_tile_;
 	//! Determines if the tiles should be clipped to the redener description
@@ -118,14 +121,18 @@ public:
 	void set_threads(int x) { threads_=x; }
 	//!Gets the number of threads
 	int get_threads()const { return threads_; }
-	//!Sets the tile width
-	void set_tile_w(int w) { tile_w_=w; }
+	//!Sets the tile width, disables automatic tile size
+	void set_tile_w(int w) { tile_w_=w; tile_auto_=false; }
 	//!Gets the tile width
 	int get_tile_w()const { return tile_w_; }
-	//!Sets the tile height
-	void set_tile_h(int h) { tile_h_=h; }
+	//!Sets the tile height, disables automatic tile size
+	void set_tile_h(int h) { tile_h_=h; tile_auto_=false; }
 	//!Gets the tile height
 	int get_tile_h()const { return tile_h_; }
+	//! Sets automatic choosing of the tile size
+	void set_tile_auto(bool x) { tile_auto_=x; }
+	//! Gets automatic choosing of the tile size
+	bool get_tile_auto()const { return tile_auto_; }
 	//! Gets clipping
 	bool get_clipping()const { return clipping_; }
 	//! Sets clipping
@@ -139,6 +146,12 @@ private:
 	//! Renders the context to the surface
 	bool render_frame_(etl::handle<Canvas> canvas, ContextParams context_params, ProgressCallback *cb);
 
+	//! Applies alpha mode of the target to the rendered tile
+	void apply_alpha_mode(synfig::Surface &surface) const;
+
+	//! Adds the tile without rendering, used for tiles outside of all layers
+	bool add_empty_tile(const RectInt &rect, ProgressCallback *cb);
+
 }; // END of class Target_Tile
 
 }; // END of namespace synfig
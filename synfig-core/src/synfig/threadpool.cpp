@@ -37,6 +37,8 @@
 #include <time.h>
 #endif
 
+#include <cstdlib>
+
 #include <synfig/localization.h>
 #include <synfig/general.h>
 
@@ -137,8 +139,11 @@ ThreadPool::ThreadPool():
 	stopped(false)
 {
 	max_running_threads = g_get_num_processors();
-	if (max_running_threads < 1) max_running_threads = 1;
 	if (max_running_threads > 2) --max_running_threads;
+	// the same variable limits the rendering queue, so whole rendering uses the given count of threads
+	if (const char *s = getenv("SYNFIG_RENDERING_THREADS"))
+		max_running_threads = atoi(s);
+	if (max_running_threads < 1) max_running_threads = 1;
 	++running_threads;
 }
 
@@ -247,6 +252,14 @@ ThreadPool::wakeup() {
 		cond.signal();
 }
 
+void
+ThreadPool::set_max_threads(int count) {
+	Glib::Threads::Mutex::Lock lock(mutex);
+	max_running_threads = std::max(1, count);
+	// extra threads will wait in thread_loop() when they finish the current tasks
+	wakeup();
+}
+
 void
 ThreadPool::enqueue(const Slot &slot) {
 	Glib::Threads::Mutex::Lock lock(mutex);
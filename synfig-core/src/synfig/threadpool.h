@@ -73,7 +73,7 @@ public:
 private:
 	Glib::Threads::Mutex mutex;
 	Glib::Threads::Cond cond;
-	int max_running_threads;
+	std::atomic<int> max_running_threads;
 	std::atomic<int> running_threads;
 	std::atomic<int> ready_threads;
 	std::atomic<int> queue_size;
@@ -97,6 +97,9 @@ public:
 
 	int get_max_threads() const
 		{ return max_running_threads; }
+	//! changes count of threads, the initial value is taken from SYNFIG_RENDERING_THREADS
+	//! at the start of program, so tools should call this after parsing of command line
+	void set_max_threads(int count);
 	int get_running_threads() const
 		{ return running_threads; }
 	int get_queue_size() const
@@ -28,9 +28,11 @@
 /* === H E A D E R S ======================================================= */
 
 #include <cassert>
+#include <new>
 #include <vector>
 #include <map>
 #include <typeinfo>
+#include <type_traits>
 #include "string.h"
 
 /* === M A C R O S ========================================================= */
@@ -144,9 +146,16 @@ public:
 		TYPE_EQUAL,
 		TYPE_LESS,
 		TYPE_TO_STRING,
+		TYPE_CONSTRUCT,
 	};
 
+	//! Values of types which fits into this size and have trivial destructor
+	//! are constructed inside of ValueBase without allocation
+	//! (size of the internal storage of Real and Time, Vector, Color and Angle fit too)
+	enum { INLINE_SIZE = 3*sizeof(Real) };
+
 	typedef InternalPointer	(*CreateFunc)	();
+	typedef void			(*ConstructFunc)(InternalPointer place);
 	typedef void			(*DestroyFunc)	(ConstInternalPointer);
 	typedef void			(*CopyFunc)		(InternalPointer dest, ConstInternalPointer src);
 	typedef bool			(*EqualFunc)	(ConstInternalPointer, ConstInternalPointer);
@@ -174,6 +183,9 @@ public:
 		template<typename Inner>
 		static void destroy(ConstInternalPointer x)
 			{ return delete (Inner*)x; }
+		template<typename Inner>
+		static void construct(InternalPointer place)
+			{ new(place) Inner(); }
 		template<typename Inner, typename Outer>
 		static void set(InternalPointer dest, const Outer &src)
 			{ *(Inner*)dest = src; }
@@ -228,6 +240,8 @@ public:
 			{ return Description(TYPE_CREATE, type); }
 		inline static Description get_destroy(TypeId type)
 			{ return Description(TYPE_DESTROY, 0, type); }
+		inline static Description get_construct(TypeId type)
+			{ return Description(TYPE_CONSTRUCT, type); }
 		inline static Description get_set(TypeId type)
 			{ return Description(TYPE_SET, 0, type); }
 		inline static Description get_put(TypeId type)
@@ -485,6 +499,8 @@ private:
 		{ register_operation(Operation::Description::get_create(type), func); }
 	inline void register_destroy(TypeId type, Operation::DestroyFunc func)
 		{ register_operation(Operation::Description::get_destroy(type), func); }
+	inline void register_construct(TypeId type, Operation::ConstructFunc func)
+		{ register_operation(Operation::Description::get_construct(type), func); }
 	template<typename T>
 	inline void register_set(TypeId type, typename Operation::GenericFuncs<T>::SetFunc func)
 		{ register_operation(Operation::Description::get_set(type), func); }
@@ -519,6 +535,8 @@ protected:
 		{ register_create(identifier, func); }
 	inline void register_destroy(Operation::DestroyFunc func)
 		{ register_destroy(identifier, func); }
+	inline void register_construct(Operation::ConstructFunc func)
+		{ register_construct(identifier, func); }
 	template<typename T>
 	inline void register_set(typename Operation::GenericFuncs<T>::SetFunc func)
 		{ register_set<T>(identifier, func); }
@@ -545,11 +563,23 @@ protected:
 		register_get<Outer> ( Operation::DefaultFuncs::get<Inner, Outer>      );
 	}
 
+	//! Small values with trivial destructor will be stored inside of ValueBase,
+	//! other values are allocated by create() and destroyed by destroy()
+	template<typename Inner>
+	inline void register_inline()
+	{
+		if ( sizeof(Inner) <= Operation::INLINE_SIZE
+		  && alignof(Inner) <= alignof(Real)
+		  && std::is_trivially_destructible<Inner>::value )
+			register_construct( Operation::DefaultFuncs::construct<Inner> );
+	}
+
 	template<typename Inner, typename Outer, String (*Func)(const Inner&)>
 	inline void register_all_but_compare()
 	{
 		register_create     ( Operation::DefaultFuncs::create<Inner>          );
 		register_destroy    ( Operation::DefaultFuncs::destroy<Inner>         );
+		register_inline<Inner>();
 		register_copy       ( Operation::DefaultFuncs::copy<Inner>            );
 		register_to_string  ( Operation::DefaultFuncs::to_string<Inner, Func> );
 		register_alias<Inner, Outer>();
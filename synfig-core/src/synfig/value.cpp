@@ -83,6 +83,30 @@ ValueBase::ValueBase(Type &x):
 	create(x);
 }
 
+ValueBase::ValueBase(const ValueBase &x):
+	type(&type_nil),data(0),ref_count(0),loop_(0),static_(0),interpolation_(INTERPOLATION_UNDEFINED)
+{
+	*this = x;
+}
+
+ValueBase::ValueBase(ValueBase &&x) noexcept:
+	type(&type_nil),data(0),ref_count(0),loop_(0),static_(0),interpolation_(INTERPOLATION_UNDEFINED)
+{
+	if (x.is_inline())
+	{
+		*this = (const ValueBase&)x;
+		x.clear();
+		return;
+	}
+	type=x.type;
+	data=x.data;
+	ref_count=x.ref_count;
+	x.ref_count.detach();
+	x.data=0;
+	x.type=&type_nil;
+	copy_properties_of(x);
+}
+
 ValueBase::~ValueBase()
 {
 	clear();
@@ -102,7 +126,7 @@ ValueBase::get_string() const
 bool
 ValueBase::is_valid()const
 {
-	return type != &type_nil && ref_count;
+	return type != &type_nil && (is_inline() || ref_count);
 }
 
 void
@@ -112,12 +136,23 @@ ValueBase::create(Type &type)
 	type.initialize();
 #endif
 	if (type == type_nil) { clear(); return; }
+	clear();
+	this->type = &type;
+
+	// small values are constructed in place, without allocation
+	Operation::ConstructFunc construct_func =
+		Type::get_operation<Operation::ConstructFunc>(
+			Operation::Description::get_construct(type.identifier) );
+	if (construct_func != NULL) {
+		data = inline_data;
+		construct_func(data);
+		return;
+	}
+
 	Operation::CreateFunc func =
 		Type::get_operation<Operation::CreateFunc>(
 			Operation::Description::get_create(type.identifier) );
 	assert(func != NULL);
-	clear();
-	this->type = &type;
 	data = func();
 	ref_count.reset();
 }
@@ -130,7 +165,7 @@ ValueBase::copy(const ValueBase& x)
 			Operation::Description::get_copy(type->identifier, x.type->identifier));
 	if (func != NULL)
 	{
-		if (!ref_count.unique()) create();
+		if (!is_unique()) create();
 		func(data, x.data);
 	}
 	else
@@ -140,7 +175,7 @@ ValueBase::copy(const ValueBase& x)
 				Operation::Description::get_copy(x.type->identifier, x.type->identifier));
 		if (func != NULL)
 		{
-			if (!ref_count.unique()) create(*x.type);
+			if (!is_unique()) create(*x.type);
 			func(data, x.data);
 		}
 	}
@@ -181,10 +216,22 @@ ValueBase::operator=(const ValueBase& x)
 				Operation::Description::get_copy(current_type.identifier, new_type.identifier) );
 		if (func != NULL)
 		{
-			create(current_type);
+			// own data is reused when it is not shared
+			if (!is_unique()) create(current_type);
 			func(data, x.data);
 		}
 		else
+		if (x.is_inline())
+		{
+			// small values are copied instead of sharing
+			create(new_type);
+			Operation::CopyFunc copy_func =
+				Type::get_operation<Operation::CopyFunc>(
+					Operation::Description::get_copy(new_type.identifier) );
+			assert(copy_func != NULL);
+			copy_func(data, x.data);
+		}
+		else
 		{
 			clear();
 			type=x.type;
@@ -198,10 +245,38 @@ ValueBase::operator=(const ValueBase& x)
 	return *this;
 }
 
+ValueBase&
+ValueBase::operator=(ValueBase&& x)
+{
+	if (&x == this)
+		return *this;
+
+	// take the data of large values, when it will not be converted to the current type
+	bool take = x.data && !x.is_inline()
+			 && ( type == x.type
+			   || !can_copy(*type, *x.type) );
+	if (!take)
+	{
+		*this = (const ValueBase&)x;
+		x.clear();
+		return *this;
+	}
+
+	clear();
+	type=x.type;
+	data=x.data;
+	ref_count=x.ref_count;
+	x.ref_count.detach();
+	x.data=0;
+	x.type=&type_nil;
+	copy_properties_of(x);
+	return *this;
+}
+
 void
 ValueBase::clear()
 {
-	if(ref_count.unique() && data)
+	if(!is_inline() && ref_count.unique() && data)
 	{
 		Operation::DestroyFunc func =
 			Type::get_operation<Operation::DestroyFunc>(
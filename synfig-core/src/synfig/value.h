@@ -78,12 +78,17 @@ public:
 protected:
 	//! The type of value
 	Type *type;
-	//! Pointer to hold the data of the value
+	//! Pointer to hold the data of the value,
+	//! points to inline_data for small values
 	void *data;
 	//! Counter of Value Nodes that refers to this Value Base
 	//! Value base can only be destructed if the ref_count is not greater than 0
+	//! Not used for small values, they are copied instead of sharing
 	//!\see etl::reference_counter
 	etl::reference_counter ref_count;
+	//! Storage for small values (Real, Vector, Color, Angle, Time, etc.)
+	//! \see Operation::INLINE_SIZE
+	Real inline_data[Operation::INLINE_SIZE/sizeof(Real)];
 	//! For Values with loop option like TYPE_LIST
 	bool loop_;
 	//! For Values of Constant Value Nodes
@@ -126,6 +131,12 @@ public:
 	//! Copy constructor. The data is not copied, just the type.
 	ValueBase(Type &x);
 
+	//! Copy constructor. Data of large values is shared, small values are copied.
+	ValueBase(const ValueBase &x);
+
+	//! Move constructor. Data of large values is moved without copying.
+	ValueBase(ValueBase &&x) noexcept;
+
 	//! Default destructor
 	~ValueBase();
 
@@ -143,6 +154,9 @@ public:
 	//!Operator asignation for ValueBase classes. Does a exact copy of \x
 	ValueBase& operator=(const ValueBase& x);
 
+	//! Move assignment, \x will be cleared
+	ValueBase& operator=(ValueBase&& x);
+
 	//! Equal than operator. Segment, Gradient and Bline Points cannot be compared.
 	bool operator==(const ValueBase& rhs)const;
 
@@ -338,6 +352,11 @@ private:
 	void create(Type &type);
 	inline void create() { create(*type); }
 
+	//! Returns true if value is stored in inline_data
+	bool is_inline()const { return data == (const void*)inline_data; }
+	//! Returns true if data is not shared with other ValueBase and may be changed
+	bool is_unique()const { return is_inline() || ref_count.unique(); }
+
 	template <typename T>
 	inline static bool _can_get(const TypeId type, const T &)
 	{
@@ -413,7 +432,7 @@ private:
 					Operation::Description::get_set(current_type.identifier) );
 			if (func != NULL)
 			{
-				if (!ref_count.unique()) create(current_type);
+				if (!is_unique()) create(current_type);
 				func(data, x);
 				return;
 			}
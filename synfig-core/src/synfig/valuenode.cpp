@@ -802,6 +802,16 @@ LinkableValueNode::set_root_canvas(etl::loose_handle<Canvas> x)
 		get_link(i)->set_root_canvas(x);
 }
 
+bool
+LinkableValueNode::is_time_dependent()const
+{
+	for(int i = 0; i < link_count(); ++i)
+		if (ValueNode::Handle link = get_link(i))
+			if (link->is_time_dependent())
+				return true;
+	return false;
+}
+
 void
 LinkableValueNode::get_values_vfunc(std::map<Time, ValueBase> &x) const
 {
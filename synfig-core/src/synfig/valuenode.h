@@ -261,6 +261,10 @@ public:
 	//! Set the default interpolation for Value Nodes
 	virtual void set_interpolation(Interpolation /* i*/) { }
 
+	//! Returns false if the value is known to be the same at any time,
+	//! returns true if it may change in time (or if it's unknown)
+	virtual bool is_time_dependent()const { return true; }
+
 	// TODO: cache of values (we need to fix chain of signals 'changed' in LinkableValueNodes
 	void get_values(std::set<ValueBase> &x) const;
 	void get_value_change_times(std::set<Time> &x) const;
@@ -426,6 +430,9 @@ public:
 
 	virtual void set_root_canvas(etl::loose_handle<Canvas> x);
 
+	//! Returns true if any of linked Value Nodes depends on time
+	virtual bool is_time_dependent()const;
+
 protected:
 	//! Member to store the children vocabulary
 	Vocab children_vocab;
@@ -0,0 +1,535 @@
+/* === S Y N F I G ========================================================= */
+/*!	\file valuenode_program.cpp
+**	\brief Compiled graph of value nodes
+**
+**	\legal
+**	Copyright (c) 2019 Synfig Contributors
+**
+**	This package is free software; you can redistribute it and/or
+**	modify it under the terms of the GNU General Public License as
+**	published by the Free Software Foundation; either version 2 of
+**	the License, or (at your option) any later version.
+**
+**	This package is distributed in the hope that it will be useful,
+**	but WITHOUT ANY WARRANTY; without even the implied warranty of
+**	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+**	General Public License for more details.
+**	\endlegal
+*/
+/* ========================================================================= */
+
+/* === H E A D E R S ======================================================= */
+
+#ifdef USING_PCH
+#	include "pch.h"
+#else
+#ifdef HAVE_CONFIG_H
+#	include <config.h>
+#endif
+
+#include <cmath>
+#include <algorithm>
+
+#include <ETL/misc>
+
+#include "valuenode_program.h"
+
+#include "angle.h"
+#include "color.h"
+#include "vector.h"
+
+#include "valuenodes/valuenode_add.h"
+#include "valuenodes/valuenode_atan2.h"
+#include "valuenodes/valuenode_composite.h"
+#include "valuenodes/valuenode_const.h"
+#include "valuenodes/valuenode_cos.h"
+#include "valuenodes/valuenode_exp.h"
+#include "valuenodes/valuenode_linear.h"
+#include "valuenodes/valuenode_reciprocal.h"
+#include "valuenodes/valuenode_reference.h"
+#include "valuenodes/valuenode_scale.h"
+#include "valuenodes/valuenode_subtract.h"
+#include "valuenodes/valuenode_vectorangle.h"
+#include "valuenodes/valuenode_vectorlength.h"
+#include "valuenodes/valuenode_vectorx.h"
+#include "valuenodes/valuenode_vectory.h"
+
+#endif
+
+/* === U S I N G =========================================================== */
+
+using namespace synfig;
+
+/* === M A C R O S ========================================================= */
+
+/* === G L O B A L S ======================================================= */
+
+namespace {
+
+typedef ValueNodeProgram::Register Register;
+
+// registers stores all values as Real, the same as ValueBase conversions
+// it is exact for all supported types (float, int and bool values fits into double)
+
+template<typename T> inline T get(const Register &r);
+template<> inline Real get<Real>(const Register &r)
+	{ return r.data[0]; }
+template<> inline Angle get<Angle>(const Register &r)
+	{ return Angle::rad(r.data[0]); }
+template<> inline Time get<Time>(const Register &r)
+	{ return Time(r.data[0]); }
+template<> inline int get<int>(const Register &r)
+	{ return (int)r.data[0]; }
+template<> inline bool get<bool>(const Register &r)
+	{ return r.data[0] != 0.0; }
+template<> inline Vector get<Vector>(const Register &r)
+	{ return Vector(r.data[0], r.data[1]); }
+template<> inline Color get<Color>(const Register &r)
+	{ return Color(r.data[0], r.data[1], r.data[2], r.data[3]); }
+
+template<typename T> inline void put(Register &r, const T &x);
+template<> inline void put<Real>(Register &r, const Real &x)
+	{ r.data[0] = x; }
+template<> inline void put<Angle>(Register &r, const Angle &x)
+	{ r.data[0] = Angle::rad(x).get(); }
+template<> inline void put<Time>(Register &r, const Time &x)
+	{ r.data[0] = (Real)x; }
+template<> inline void put<int>(Register &r, const int &x)
+	{ r.data[0] = x; }
+template<> inline void put<bool>(Register &r, const bool &x)
+	{ r.data[0] = x ? 1.0 : 0.0; }
+template<> inline void put<Vector>(Register &r, const Vector &x)
+	{ r.data[0] = x[0]; r.data[1] = x[1]; }
+template<> inline void put<Color>(Register &r, const Color &x)
+	{ r.data[0] = x.get_r(); r.data[1] = x.get_g(); r.data[2] = x.get_b(); r.data[3] = x.get_a(); }
+
+// formulas below should be the same as in operator()(Time) of corresponding value nodes
+
+template<typename T>
+inline void op_add(Register &r, const Register &a, const Register &b, const Register &s)
+	{ put<T>(r, (get<T>(a) + get<T>(b))*get<Real>(s)); }
+template<>
+inline void op_add<int>(Register &r, const Register &a, const Register &b, const Register &s)
+	{ put<int>(r, etl::round_to_int((get<int>(a) + get<int>(b))*get<Real>(s))); }
+
+template<typename T>
+inline void op_subtract(Register &r, const Register &a, const Register &b, const Register &s)
+	{ put<T>(r, (get<T>(a) - get<T>(b))*get<Real>(s)); }
+template<>
+inline void op_subtract<int>(Register &r, const Register &a, const Register &b, const Register &s)
+	{ put<int>(r, etl::round_to_int((get<int>(a) - get<int>(b))*get<Real>(s))); }
+
+template<typename T>
+inline void op_scale(Register &r, const Register &a, const Register &s)
+	{ put<T>(r, get<T>(a)*get<Real>(s)); }
+template<>
+inline void op_scale<int>(Register &r, const Register &a, const Register &s)
+	{ put<int>(r, etl::round_to_int(get<int>(a)*get<Real>(s))); }
+template<>
+inline void op_scale<Time>(Register &r, const Register &a, const Register &s)
+	{ put<Time>(r, get<Time>(a)*get<Time>(s)); }
+template<>
+inline void op_scale<Color>(Register &r, const Register &a, const Register &s)
+{
+	Color color(get<Color>(a));
+	Real scalar(get<Real>(s));
+	color.set_r(color.get_r()*scalar);
+	color.set_g(color.get_g()*scalar);
+	color.set_b(color.get_b()*scalar);
+	put<Color>(r, color);
+}
+
+template<typename T>
+inline void op_linear(Register &r, const Register &slope, const Register &offset, Time t)
+	{ put<T>(r, get<T>(slope)*t + get<T>(offset)); }
+template<>
+inline void op_linear<int>(Register &r, const Register &slope, const Register &offset, Time t)
+	{ put<int>(r, etl::round_to_int(get<int>(slope)*t + get<int>(offset))); }
+
+// registers of large programs are allocated once per thread,
+// nested run() (from the called nodes) uses own registers
+class ThreadRegisters {
+private:
+	static thread_local std::vector<Register> registers;
+	static thread_local bool used;
+	std::vector<Register> own_registers;
+	bool acquired;
+public:
+	ThreadRegisters(): acquired() { }
+	~ThreadRegisters()
+		{ if (acquired) used = false; }
+
+	Register* acquire(const std::vector<Register> &constants)
+	{
+		std::vector<Register> &r = used ? own_registers : registers;
+		if (!used) acquired = used = true;
+		r = constants;
+		return &r.front();
+	}
+};
+
+thread_local std::vector<Register> ThreadRegisters::registers;
+thread_local bool ThreadRegisters::used = false;
+
+} // end of anonimous namespace
+
+/* === P R O C E D U R E S ================================================= */
+
+/* === M E T H O D S ======================================================= */
+
+ValueNodeProgram::Kind
+ValueNodeProgram::get_kind(Type &type)
+{
+	if (type == type_real)    return KIND_REAL;
+	if (type == type_angle)   return KIND_ANGLE;
+	if (type == type_time)    return KIND_TIME;
+	if (type == type_integer) return KIND_INTEGER;
+	if (type == type_bool)    return KIND_BOOL;
+	if (type == type_vector)  return KIND_VECTOR;
+	if (type == type_color)   return KIND_COLOR;
+	return KIND_NONE;
+}
+
+bool
+ValueNodeProgram::load(Register &reg, Kind kind, const ValueBase &value)
+{
+	switch(kind) {
+	case KIND_REAL:    put<Real>(reg, value.get(Real()));     return true;
+	case KIND_ANGLE:   put<Angle>(reg, value.get(Angle()));   return true;
+	case KIND_TIME:    put<Time>(reg, value.get(Time()));     return true;
+	case KIND_INTEGER: put<int>(reg, value.get(int()));       return true;
+	case KIND_BOOL:    put<bool>(reg, value.get(bool()));     return true;
+	case KIND_VECTOR:  put<Vector>(reg, value.get(Vector())); return true;
+	case KIND_COLOR:   put<Color>(reg, value.get(Color()));   return true;
+	default: break;
+	}
+	return false;
+}
+
+void
+ValueNodeProgram::store(ValueBase &value, Kind kind, const Register &reg)
+{
+	// ValueBase reuses own data when type is not changed
+	switch(kind) {
+	case KIND_REAL:    value = get<Real>(reg);   break;
+	case KIND_ANGLE:   value = get<Angle>(reg);  break;
+	case KIND_TIME:    value = get<Time>(reg);   break;
+	case KIND_INTEGER: value = get<int>(reg);    break;
+	case KIND_BOOL:    value = get<bool>(reg);   break;
+	case KIND_VECTOR:  value = get<Vector>(reg); break;
+	case KIND_COLOR:   value = get<Color>(reg);  break;
+	default: value = ValueBase(); break;
+	}
+}
+
+int
+ValueNodeProgram::add_register()
+{
+	constants.push_back(Register());
+	return (int)constants.size() - 1;
+}
+
+int
+ValueNodeProgram::compile_link(const ValueNode &node, int index, Type &type)
+{
+	const LinkableValueNode *linkable = dynamic_cast<const LinkableValueNode*>(&node);
+	ValueNode::ConstHandle link = linkable ? ValueNode::ConstHandle(linkable->get_link(index).get()) : ValueNode::ConstHandle();
+	return link && link->get_type() == type ? compile(link) : -1;
+}
+
+bool
+ValueNodeProgram::compile_operation(const ValueNode &node, Instruction &instruction)
+{
+	const LinkableValueNode *linkable = dynamic_cast<const LinkableValueNode*>(&node);
+	if (!linkable)
+		return false;
+
+	Type &type = node.get_type();
+	Kind kind = instruction.kind;
+	bool arithmetic = kind != KIND_NONE && kind != KIND_BOOL;
+
+	// expected types of links
+	Type* links[4] = { NULL, NULL, NULL, NULL };
+
+	if (arithmetic && dynamic_cast<const ValueNode_Add*>(&node)) {
+		instruction.operation = OP_ADD;
+		links[0] = &type; links[1] = &type; links[2] = &type_real;
+	} else
+	if (arithmetic && dynamic_cast<const ValueNode_Subtract*>(&node)) {
+		instruction.operation = OP_SUBTRACT;
+		links[0] = &type; links[1] = &type; links[2] = &type_real;
+	} else
+	if (arithmetic && dynamic_cast<const ValueNode_Scale*>(&node)) {
+		instruction.operation = OP_SCALE;
+		links[0] = &type; links[1] = kind == KIND_TIME ? &type_time : &type_real;
+	} else
+	if (arithmetic && dynamic_cast<const ValueNode_Linear*>(&node)) {
+		instruction.operation = OP_LINEAR;
+		links[0] = &type; links[1] = &type;
+	} else
+	if (kind == KIND_VECTOR && dynamic_cast<const ValueNode_Composite*>(&node)) {
+		instruction.operation = OP_COMPOSITE;
+		links[0] = &type_real; links[1] = &type_real;
+	} else
+	if (kind == KIND_COLOR && dynamic_cast<const ValueNode_Composite*>(&node)) {
+		instruction.operation = OP_COMPOSITE;
+		links[0] = &type_real; links[1] = &type_real; links[2] = &type_real; links[3] = &type_real;
+	} else
+	if (kind == KIND_REAL && dynamic_cast<const ValueNode_Cos*>(&node)) {
+		instruction.operation = OP_COS;
+		links[0] = &type_angle; links[1] = &type_real;
+	} else
+	if (kind == KIND_REAL && dynamic_cast<const ValueNode_Exp*>(&node)) {
+		instruction.operation = OP_EXP;
+		links[0] = &type_real; links[1] = &type_real;
+	} else
+	if (kind == KIND_REAL && dynamic_cast<const ValueNode_Reciprocal*>(&node)) {
+		instruction.operation = OP_RECIPROCAL;
+		links[0] = &type_real; links[1] = &type_real; links[2] = &type_real;
+	} else
+	if (kind == KIND_ANGLE && dynamic_cast<const ValueNode_Atan2*>(&node)) {
+		instruction.operation = OP_ATAN2;
+		links[0] = &type_real; links[1] = &type_real;
+	} else
+	if (kind == KIND_REAL && dynamic_cast<const ValueNode_VectorX*>(&node)) {
+		instruction.operation = OP_VECTOR_X;
+		links[0] = &type_vector;
+	} else
+	if (kind == KIND_REAL && dynamic_cast<const ValueNode_VectorY*>(&node)) {
+		instruction.operation = OP_VECTOR_Y;
+		links[0] = &type_vector;
+	} else
+	if (kind == KIND_REAL && dynamic_cast<const ValueNode_VectorLength*>(&node)) {
+		instruction.operation = OP_VECTOR_LENGTH;
+		links[0] = &type_vector;
+	} else
+	if (kind == KIND_ANGLE && dynamic_cast<const ValueNode_VectorAngle*>(&node)) {
+		instruction.operation = OP_VECTOR_ANGLE;
+		links[0] = &type_vector;
+	} else {
+		return false;
+	}
+
+	// check all links before compilation, to avoid unused instructions
+	for(int i = 0; i < 4 && links[i]; ++i) {
+		ValueNode::LooseHandle link = linkable->get_link(i);
+		if (!link || link->get_type() != *links[i])
+			return false;
+	}
+
+	for(int i = 0; i < 4 && links[i]; ++i) {
+		instruction.args[i] = compile_link(node, i, *links[i]);
+		if (instruction.args[i] < 0)
+			return false;
+	}
+	return true;
+}
+
+int
+ValueNodeProgram::compile(const ValueNode::ConstHandle &node)
+{
+	std::map<const ValueNode*, int>::const_iterator i = registers.find(node.get());
+	if (i != registers.end())
+		return i->second;
+
+	Kind kind = get_kind(node->get_type());
+	if (kind == KIND_NONE)
+		return -1;
+
+	int reg = -1;
+
+	// reference is just another name of the same value
+	if (const ValueNode_Reference *reference = dynamic_cast<const ValueNode_Reference*>(node.get()))
+		reg = compile_link(*reference, 0, node->get_type());
+
+	if (reg < 0)
+	if (const ValueNode_Const *value_node_const = dynamic_cast<const ValueNode_Const*>(node.get()))
+	if (value_node_const->get_value().get_type() == node->get_type())
+	{
+		reg = add_register();
+		load(constants[reg], kind, value_node_const->get_value());
+	}
+
+	if (reg < 0) {
+		Instruction instruction;
+		instruction.kind = kind;
+		if (!compile_operation(*node, instruction)) {
+			instruction = Instruction();
+			instruction.kind = kind;
+			instruction.operation = OP_CALL;
+			instruction.node = node.get();
+			nodes.push_back(node);
+		}
+		instruction.result = reg = add_register();
+		instructions.push_back(instruction);
+	}
+
+	registers[node.get()] = reg;
+	return reg;
+}
+
+void
+ValueNodeProgram::add_output(const String &name, const ValueNode::Handle &node)
+{
+	Output output;
+	output.name = name;
+	output.node = node;
+	output.kind = node ? get_kind(node->get_type()) : KIND_NONE;
+
+	// constants are returned as is, without copying of data
+	if (output.kind != KIND_NONE && !dynamic_cast<const ValueNode_Const*>(node.get())) {
+		bool compiled = registers.count(node.get());
+		output.reg = compile(node);
+
+		// single called node has nothing to share, so call it directly
+		if ( !compiled
+		  && !instructions.empty()
+		  && instructions.back().operation == OP_CALL
+		  && instructions.back().node == node.get() )
+		{
+			instructions.pop_back();
+			constants.pop_back();
+			nodes.pop_back();
+			registers.erase(node.get());
+			output.reg = -1;
+		}
+	}
+
+	outputs.push_back(output);
+}
+
+void
+ValueNodeProgram::execute(const Instruction &instruction, Register *regs, Time time) const
+{
+	Register &r = regs[instruction.result];
+	const int *a = instruction.args;
+
+	switch(instruction.operation) {
+	case OP_CALL:
+		load(r, instruction.kind, (*instruction.node)(time));
+		break;
+	case OP_ADD:
+		switch(instruction.kind) {
+		case KIND_REAL:    op_add<Real>  (r, regs[a[0]], regs[a[1]], regs[a[2]]); break;
+		case KIND_ANGLE:   op_add<Angle> (r, regs[a[0]], regs[a[1]], regs[a[2]]); break;
+		case KIND_TIME:    op_add<Time>  (r, regs[a[0]], regs[a[1]], regs[a[2]]); break;
+		case KIND_INTEGER: op_add<int>   (r, regs[a[0]], regs[a[1]], regs[a[2]]); break;
+		case KIND_VECTOR:  op_add<Vector>(r, regs[a[0]], regs[a[1]], regs[a[2]]); break;
+		case KIND_COLOR:   op_add<Color> (r, regs[a[0]], regs[a[1]], regs[a[2]]); break;
+		default: break;
+		}
+		break;
+	case OP_SUBTRACT:
+		switch(instruction.kind) {
+		case KIND_REAL:    op_subtract<Real>  (r, regs[a[0]], regs[a[1]], regs[a[2]]); break;
+		case KIND_ANGLE:   op_subtract<Angle> (r, regs[a[0]], regs[a[1]], regs[a[2]]); break;
+		case KIND_TIME:    op_subtract<Time>  (r, regs[a[0]], regs[a[1]], regs[a[2]]); break;
+		case KIND_INTEGER: op_subtract<int>   (r, regs[a[0]], regs[a[1]], regs[a[2]]); break;
+		case KIND_VECTOR:  op_subtract<Vector>(r, regs[a[0]], regs[a[1]], regs[a[2]]); break;
+		case KIND_COLOR:   op_subtract<Color> (r, regs[a[0]], regs[a[1]], regs[a[2]]); break;
+		default: break;
+		}
+		break;
+	case OP_SCALE:
+		switch(instruction.kind) {
+		case KIND_REAL:    op_scale<Real>  (r, regs[a[0]], regs[a[1]]); break;
+		case KIND_ANGLE:   op_scale<Angle> (r, regs[a[0]], regs[a[1]]); break;
+		case KIND_TIME:    op_scale<Time>  (r, regs[a[0]], regs[a[1]]); break;
+		case KIND_INTEGER: op_scale<int>   (r, regs[a[0]], regs[a[1]]); break;
+		case KIND_VECTOR:  op_scale<Vector>(r, regs[a[0]], regs[a[1]]); break;
+		case KIND_COLOR:   op_scale<Color> (r, regs[a[0]], regs[a[1]]); break;
+		default: break;
+		}
+		break;
+	case OP_LINEAR:
+		switch(instruction.kind) {
+		case KIND_REAL:    op_linear<Real>  (r, regs[a[0]], regs[a[1]], time); break;
+		case KIND_ANGLE:   op_linear<Angle> (r, regs[a[0]], regs[a[1]], time); break;
+		case KIND_TIME:    op_linear<Time>  (r, regs[a[0]], regs[a[1]], time); break;
+		case KIND_INTEGER: op_linear<int>   (r, regs[a[0]], regs[a[1]], time); break;
+		case KIND_VECTOR:  op_linear<Vector>(r, regs[a[0]], regs[a[1]], time); break;
+		case KIND_COLOR:   op_linear<Color> (r, regs[a[0]], regs[a[1]], time); break;
+		default: break;
+		}
+		break;
+	case OP_COMPOSITE:
+		if (instruction.kind == KIND_VECTOR) {
+			put<Vector>(r, Vector(get<Real>(regs[a[0]]), get<Real>(regs[a[1]])));
+		} else {
+			Color color;
+			color.set_r(get<Real>(regs[a[0]]));
+			color.set_g(get<Real>(regs[a[1]]));
+			color.set_b(get<Real>(regs[a[2]]));
+			color.set_a(get<Real>(regs[a[3]]));
+			put<Color>(r, color);
+		}
+		break;
+	case OP_COS:
+		put<Real>(r, Angle::cos(get<Angle>(regs[a[0]])).get() * get<Real>(regs[a[1]]));
+		break;
+	case OP_EXP:
+		put<Real>(r, std::exp(get<Real>(regs[a[0]])) * get<Real>(regs[a[1]]));
+		break;
+	case OP_RECIPROCAL:
+		{
+			Real link     = get<Real>(regs[a[0]]);
+			Real epsilon  = get<Real>(regs[a[1]]);
+			Real infinite = get<Real>(regs[a[2]]);
+			if (epsilon < 0.00000001)
+				epsilon = 0.00000001;
+			if (std::fabs(link) < epsilon)
+				put<Real>(r, link < 0 ? -infinite : infinite);
+			else
+				put<Real>(r, 1.0f / link);
+		}
+		break;
+	case OP_ATAN2:
+		put<Angle>(r, Angle::tan(get<Real>(regs[a[1]]), get<Real>(regs[a[0]])));
+		break;
+	case OP_VECTOR_X:
+		put<Real>(r, get<Vector>(regs[a[0]])[0]);
+		break;
+	case OP_VECTOR_Y:
+		put<Real>(r, get<Vector>(regs[a[0]])[1]);
+		break;
+	case OP_VECTOR_LENGTH:
+		put<Real>(r, get<Vector>(regs[a[0]]).mag());
+		break;
+	case OP_VECTOR_ANGLE:
+		put<Angle>(r, get<Vector>(regs[a[0]]).angle());
+		break;
+	}
+}
+
+void
+ValueNodeProgram::run(Time time, std::vector<ValueBase> &values) const
+{
+	values.resize(outputs.size());
+
+	// temporary values are placed in stack,
+	// or in registers of thread when program is too large
+	Register stack_registers[STACK_REGISTERS];
+	Register *regs = stack_registers;
+	ThreadRegisters thread_registers;
+	if (constants.size() > STACK_REGISTERS) {
+		regs = thread_registers.acquire(constants);
+	} else {
+		std::copy(constants.begin(), constants.end(), stack_registers);
+	}
+
+	for(std::vector<Instruction>::const_iterator i = instructions.begin(); i != instructions.end(); ++i)
+		execute(*i, regs, time);
+
+	for(int i = 0; i < (int)outputs.size(); ++i) {
+		const Output &output = outputs[i];
+		if (output.reg >= 0)
+			store(values[i], output.kind, regs[output.reg]);
+		else
+		if (output.node)
+			values[i] = (*output.node)(time);
+		else
+			values[i] = ValueBase();
+	}
+}
+
+/* === E N T R Y P O I N T ================================================= */
@@ -0,0 +1,154 @@
+/* === S Y N F I G ========================================================= */
+/*!	\file valuenode_program.h
+**	\brief Compiled graph of value nodes
+**
+**	\legal
+**	Copyright (c) 2019 Synfig Contributors
+**
+**	This package is free software; you can redistribute it and/or
+**	modify it under the terms of the GNU General Public License as
+**	published by the Free Software Foundation; either version 2 of
+**	the License, or (at your option) any later version.
+**
+**	This package is distributed in the hope that it will be useful,
+**	but WITHOUT ANY WARRANTY; without even the implied warranty of
+**	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+**	General Public License for more details.
+**	\endlegal
+*/
+/* ========================================================================= */
+
+/* === S T A R T =========================================================== */
+
+#ifndef __SYNFIG_VALUENODE_PROGRAM_H
+#define __SYNFIG_VALUENODE_PROGRAM_H
+
+/* === H E A D E R S ======================================================= */
+
+#include <map>
+#include <vector>
+
+#include <ETL/handle>
+
+#include "real.h"
+#include "string.h"
+#include "time.h"
+#include "value.h"
+#include "valuenode.h"
+
+/* === M A C R O S ========================================================= */
+
+/* === C L A S S E S & S T R U C T S ======================================= */
+
+namespace synfig {
+
+//! Flat list of instructions which evaluates a set of value nodes.
+//! Value nodes of simple types (real, angle, vector, color, etc.)
+//! are evaluated into typed registers without creation of ValueBase,
+//! every node is evaluated only once even if it is linked several times.
+//! Arithmetic nodes (Add, Scale, Composite, ...) are executed by the program itself,
+//! all other nodes are called via ValueNode::operator()(Time).
+//! Constants are copied into the program, so it should be rebuilt
+//! when any of the nodes is changed.
+//! Method run() is thread-safe.
+class ValueNodeProgram: public etl::shared_object
+{
+public:
+	typedef etl::handle<ValueNodeProgram> Handle;
+
+	enum Kind {
+		KIND_NONE,
+		KIND_REAL,
+		KIND_ANGLE,
+		KIND_TIME,
+		KIND_INTEGER,
+		KIND_BOOL,
+		KIND_VECTOR,
+		KIND_COLOR
+	};
+
+	enum Operation {
+		OP_CALL,
+		OP_ADD,
+		OP_SUBTRACT,
+		OP_SCALE,
+		OP_LINEAR,
+		OP_COMPOSITE,
+		OP_COS,
+		OP_EXP,
+		OP_RECIPROCAL,
+		OP_ATAN2,
+		OP_VECTOR_X,
+		OP_VECTOR_Y,
+		OP_VECTOR_LENGTH,
+		OP_VECTOR_ANGLE
+	};
+
+	//! enough for any supported type
+	struct Register {
+		Real data[4];
+	};
+
+	struct Instruction {
+		Operation operation;
+		Kind kind;
+		int result;
+		int args[4];
+		const ValueNode *node; //!< for OP_CALL
+
+		Instruction(): operation(OP_CALL), kind(KIND_NONE), result(-1), args{-1, -1, -1, -1}, node() { }
+	};
+
+	struct Output {
+		String name;
+		Kind kind;
+		int reg;                //!< register with result, or -1 if node should be called
+		ValueNode::ConstHandle node;
+
+		Output(): kind(KIND_NONE), reg(-1) { }
+	};
+
+	//! programs with greater count of registers will use registers in heap,
+	//! allocated once per thread
+	enum { STACK_REGISTERS = 64 };
+
+private:
+	std::vector<Instruction> instructions;
+	std::vector<Register> constants; //!< initial state of registers
+	std::vector<Output> outputs;
+	std::vector<ValueNode::ConstHandle> nodes; //!< keeps called nodes alive
+	std::map<const ValueNode*, int> registers;
+
+	int add_register();
+	int compile(const ValueNode::ConstHandle &node);
+	int compile_link(const ValueNode &node, int index, Type &type);
+	bool compile_operation(const ValueNode &node, Instruction &instruction);
+
+	void execute(const Instruction &instruction, Register *regs, Time time) const;
+
+public:
+	static Kind get_kind(Type &type);
+	static bool load(Register &reg, Kind kind, const ValueBase &value);
+	static void store(ValueBase &value, Kind kind, const Register &reg);
+
+	//! compiles node and adds it into list of outputs
+	void add_output(const String &name, const ValueNode::Handle &node);
+
+	int get_output_count() const
+		{ return (int)outputs.size(); }
+	const Output& get_output(int index) const
+		{ return outputs[index]; }
+	int get_instruction_count() const
+		{ return (int)instructions.size(); }
+	int get_register_count() const
+		{ return (int)constants.size(); }
+
+	//! evaluates all outputs at time, values will be resized to count of outputs
+	void run(Time time, std::vector<ValueBase> &values) const;
+};
+
+}; // END of namespace synfig
+
+/* === E N D =============================================================== */
+
+#endif
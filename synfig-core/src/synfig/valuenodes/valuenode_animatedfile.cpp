@@ -40,6 +40,7 @@
 #include <synfig/valuenode_registry.h>
 #include <synfig/general.h>
 #include <synfig/canvasfilenaming.h>
+#include <synfig/mutex.h>
 
 #include "valuenode_animatedfile.h"
 #include "valuenode_const.h"
@@ -66,6 +67,8 @@ class ValueNode_AnimatedFile::Internal
 {
 public:
 	Glib::RefPtr<Gio::FileMonitor> file_monitor;
+	//! node may be evaluated from several threads, but load_file() changes waypoints
+	Mutex mutex;
 };
 
 class ValueNode_AnimatedFile::Parser
@@ -180,7 +183,10 @@ ValueNode_AnimatedFile::create(const ValueBase &x)
 void
 ValueNode_AnimatedFile::file_changed()
 {
-	load_file(current_filename, true);
+	{
+		Mutex::Lock lock(internal->mutex);
+		load_file(current_filename, true);
+	}
 	changed();
 }
 
@@ -258,7 +264,9 @@ ValueNode_AnimatedFile::on_changed()
 ValueBase
 ValueNode_AnimatedFile::operator()(Time t) const
 {
-	const_cast<ValueNode_AnimatedFile*>(this)->load_file((*filename)(t).get(String()));
+	String filename_value = (*filename)(t).get(String());
+	Mutex::Lock lock(internal->mutex);
+	const_cast<ValueNode_AnimatedFile*>(this)->load_file(filename_value);
 	return ValueNode_AnimatedInterfaceConst::operator()(t);
 }
 
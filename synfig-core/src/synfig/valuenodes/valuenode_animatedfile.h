@@ -65,6 +65,8 @@ public:
 	virtual String get_name()const;
 	virtual String get_local_name()const;
 
+	virtual bool is_time_dependent()const { return true; }
+
 	using synfig::LinkableValueNode::get_link_vfunc;
 	using synfig::LinkableValueNode::set_link_vfunc;
 	virtual ValueNode::LooseHandle get_link_vfunc(int i) const;
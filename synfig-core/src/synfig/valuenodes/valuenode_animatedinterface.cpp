@@ -33,6 +33,7 @@
 #include <cmath>
 
 #include <algorithm>
+#include <atomic>
 #include <typeinfo>
 #include <vector>
 #include <list>
@@ -236,7 +237,42 @@ class ValueNode_AnimatedInterfaceConst::Interpolator
 public:
 	ValueNode_AnimatedInterfaceConst &animated;
 
-	explicit Interpolator(ValueNode_AnimatedInterfaceConst &animated): animated(animated) { }
+protected:
+	//! index returned by the last call of find_segment()
+	mutable std::atomic<int> cursor;
+
+	template<typename Item, typename TimeFunc>
+	struct SegmentCmp {
+		TimeFunc time_of;
+		explicit SegmentCmp(TimeFunc time_of): time_of(time_of) { }
+		bool operator()(const Time &t, const Item &x) const { return !(t >= time_of(x)); }
+	};
+
+	//! Returns index of the first item which time is after t, or count of items if none.
+	//! Items must be sorted by time. Neighbours of the previous result are checked first,
+	//! so evaluation of sequential frames costs O(1), otherwise binary search is used.
+	template<typename List, typename TimeFunc>
+	int find_segment(const List &list, const Time &t, TimeFunc time_of) const
+	{
+		int count = (int)list.size();
+		int hint = cursor.load(std::memory_order_relaxed);
+		for(int i = std::max(0, hint); i <= hint + 1 && i <= count; ++i)
+			if ( (i == count || !(t >= time_of(list[i])))
+			  && (i == 0     ||   t >= time_of(list[i-1])) )
+				{ cursor.store(i, std::memory_order_relaxed); return i; }
+
+		typedef typename List::value_type Item;
+		int i = (int)( std::upper_bound(list.begin(), list.end(), t, SegmentCmp<Item, TimeFunc>(time_of))
+					 - list.begin() );
+		cursor.store(i, std::memory_order_relaxed);
+		return i;
+	}
+
+	static Time waypoint_time(const Waypoint &x)
+		{ return x.get_time(); }
+
+public:
+	explicit Interpolator(ValueNode_AnimatedInterfaceConst &animated): animated(animated), cursor(0) { }
 	virtual ~Interpolator() { }
 
 	virtual Interpolator* create(ValueNode_AnimatedInterfaceConst &node) const = 0;
@@ -316,33 +352,38 @@ public:
 
 			value_type resolve(const Time &t)const
 			{
-				bool start_static(start->is_static());
-				bool end_static(end->is_static());
+				const hermite<value_type, Time> *curve = &second;
 
-				if(!start_static || !end_static)
+				// segment may be resolved concurrently for different times,
+				// so the shared curve is not modified
+				hermite<value_type, Time> animated_curve;
+				if(!start->is_static() || !end->is_static())
 				{
-					//if(!start_static)
-						second.p1()=start->get_value(t).get(value_type());
+					animated_curve = second;
+					animated_curve.p1()=start->get_value(t).get(value_type());
 					if(start->get_after()==INTERPOLATION_CONSTANT || end->get_before()==INTERPOLATION_CONSTANT)
-						return second.p1();
-					//if(!end_static)
-						second.p2()=end->get_value(t).get(value_type());
+						return animated_curve.p1();
+					animated_curve.p2()=end->get_value(t).get(value_type());
 
 					// At the moment, the only type of non-constant interpolation
 					// that we support is linear.
-					second.t1()=
-					second.t2()=subtract_func(second.p2(),second.p1());
+					animated_curve.t1()=
+					animated_curve.t2()=subtract_func(animated_curve.p2(),animated_curve.p1());
 
-					second.sync();
+					animated_curve.sync();
+					curve = &animated_curve;
 				}
 
-				return demult(second(first(t)));
+				return demult((*curve)(first(t)));
 			}
 		}; // END of struct PathSegment
 
 		typedef vector<PathSegment> curve_list_type;
 		curve_list_type curve_list;
 
+		static Time segment_end(const PathSegment &x)
+			{ return x.first.get_s(); }
+
 		// Bounds of this curve
 		Time r,s;
 
@@ -660,15 +701,10 @@ public:
 			if(t>=s)
 				return animated.waypoint_list_.back().get_value(t);
 
-			typename curve_list_type::const_iterator iter;
-
-			// This next line will set iter to the
-			// correct iterator for the given time.
-			for(iter=curve_list.begin();iter<curve_list.end() && t>=iter->first.get_s();++iter)
-				continue;
-			if(iter==curve_list.end())
+			int i = find_segment(curve_list, t, &segment_end);
+			if(i >= (int)curve_list.size())
 				return animated.waypoint_list_.back().get_value(t);
-			return iter->resolve(t);
+			return curve_list[i].resolve(t);
 		}
 	}; // END of class Hermite
 
@@ -751,15 +787,9 @@ public:
 			if(t>=s)
 				return animated.waypoint_list_.back().get_value(t);
 
-			WaypointList::const_iterator iter;
-			WaypointList::const_iterator next;
-
-			// This next line will set iter to the
-			// correct iterator for the given time.
-			for(next=animated.waypoint_list_.begin(),iter=next++;next!=animated.waypoint_list_.end() && t>=next->get_time();iter=next++)
-				continue;
-
-			return iter->get_value(t);
+			// waypoint before the first one which is after t
+			int i = find_segment(animated.waypoint_list_, t, &waypoint_time);
+			return animated.waypoint_list_[std::max(0, i - 1)].get_value(t);
 		}
 
 		virtual void get_values_vfunc(std::map<Time, ValueBase> &x) const
@@ -842,14 +872,10 @@ public:
 			if(t>s)
 				return animated.waypoint_list_.back().get_value(t);
 
-			WaypointList::const_iterator iter;
-			WaypointList::const_iterator next;
-
-			// This next line will set iter to the
-			// correct iterator for the given time.
-			for(next=animated.waypoint_list_.begin(),iter=next++;next!=animated.waypoint_list_.end() && t>=next->get_time();iter=next++)
-				if(iter->get_time()==t)
-					return iter->get_value(t);
+			// waypoint before the first one which is after t
+			int i = find_segment(animated.waypoint_list_, t, &waypoint_time);
+			WaypointList::const_iterator iter = animated.waypoint_list_.begin() + std::max(0, i - 1);
+			WaypointList::const_iterator next = iter + 1;
 
 			if(iter->get_time()==t)
 				return iter->get_value(t);
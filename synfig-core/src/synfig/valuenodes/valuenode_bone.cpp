@@ -72,8 +72,6 @@ static int bone_counter;
 // static map<ValueNode_Bone::Handle, Matrix> animated_matrix_map;
 static Time last_time = Time::begin();
 
-static ValueNode_Bone_Root::Handle rooot;
-
 /* === P R O C E D U R E S ================================================= */
 
 struct compare_bones
@@ -933,8 +931,9 @@ ValueNode_Bone::get_possible_parent_bones(ValueNode::Handle value_node)
 ValueNode_Bone::Handle
 ValueNode_Bone::get_root_bone()
 {
-	if (!rooot) rooot = new ValueNode_Bone_Root();
-	return rooot;
+	// initialization of local static is thread-safe, bones may be evaluated concurrently
+	static ValueNode_Bone::Handle root(new ValueNode_Bone_Root());
+	return root;
 }
 
 #ifdef _DEBUG
@@ -1044,7 +1043,7 @@ LinkableValueNode*
 ValueNode_Bone_Root::create_new()const
 {
 	assert(0);
-	return rooot.get();
+	return get_root_bone().get();
 }
 
 Matrix
@@ -118,7 +118,13 @@ ValueNode_BoneInfluence::operator()(Time t)const
 	if (getenv("SYNFIG_DEBUG_VALUENODE_OPERATORS"))
 		printf("%s:%d operator()\n", __FILE__, __LINE__);
 
-	Matrix transform(get_transform(true, t));
+	// cached transform is kept for get_inverse_transform(),
+	// but value is calculated from the local copy, other threads may change the cache
+	Matrix transform(calculate_transform(t));
+	{
+		Mutex::Lock lock(mutex_);
+		set_transform(transform);
+	}
 	Type &type(link_->get_type());
 	if (type == type_vector)
 	{
@@ -278,6 +284,7 @@ ValueNode_BoneInfluence::get_transform(bool rebuild, Time t)const
 bool
 ValueNode_BoneInfluence::has_inverse_transform()const
 {
+	Mutex::Lock lock(mutex_);
 	if (checked_inverse_)
 	{
 //		printf("%s:%d returning stored value %d for has_inverse\n", __FILE__, __LINE__, has_inverse_);
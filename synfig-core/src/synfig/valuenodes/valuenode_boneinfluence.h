@@ -29,6 +29,7 @@
 
 #include <synfig/valuenode.h>
 #include <synfig/matrix.h>
+#include <synfig/mutex.h>
 
 /* === M A C R O S ========================================================= */
 
@@ -43,6 +44,8 @@ class ValueNode_BoneInfluence : public LinkableValueNode
 
 	mutable Matrix transform_, inverse_transform_;
 	mutable bool checked_inverse_, has_inverse_;
+	//! operator() may be called from several threads, cached transform is changed under this mutex
+	mutable Mutex mutex_;
 
 public:
 	typedef etl::handle<ValueNode_BoneInfluence> Handle;
@@ -180,6 +180,23 @@ void ValueNode_Const::get_times_vfunc(Node::time_set &/*set*/) const
 {
 }
 
+bool
+ValueNode_Const::is_time_dependent()const
+{
+	// inline canvases and bones are shared by handle and may be animated
+	if (value.get_type() == type_canvas)
+	{
+		Canvas::Handle canvas = value.get(Canvas::Handle());
+		return canvas && canvas->is_time_dependent();
+	}
+	if (value.get_type() == type_bone_valuenode)
+	{
+		ValueNode_Bone::Handle bone = value.get(ValueNode_Bone::Handle());
+		return bone && bone->is_time_dependent();
+	}
+	return false;
+}
+
 void ValueNode_Const::get_values_vfunc(std::map<Time, ValueBase> &x) const
 {
 	add_value_to_map(x, 0, value);
@@ -60,6 +60,7 @@ public:
 	void set_static(bool x) { get_value().set_static(x); }
 	virtual Interpolation get_interpolation()const {return get_value().get_interpolation();}
 	virtual void set_interpolation(Interpolation x) { get_value().set_interpolation(x); }
+	virtual bool is_time_dependent()const;
 	virtual String get_name()const;
 	virtual String get_local_name()const;
 
@@ -122,6 +122,7 @@ ValueNode_Dynamic::operator()(Time t)const
 {
 	if (getenv("SYNFIG_DEBUG_VALUENODE_OPERATORS"))
 		printf("%s:%d operator()\n", __FILE__, __LINE__);
+	Mutex::Lock lock(mutex);
 	double t0=last_time;
 	double t1=t;
 	double step;
@@ -28,6 +28,7 @@
 /* === H E A D E R S ======================================================= */
 
 #include <synfig/valuenode.h>
+#include <synfig/mutex.h>
 #include "valuenode_derivative.h"
 #include "valuenode_const.h"
 
@@ -81,6 +82,8 @@ private:
 		b'=x[3]
 		*/
 	mutable std::vector<double> state;
+	//! state is simulated step by step, so concurrent evaluations are serialized
+	mutable Mutex mutex;
 	void reset_state(Time t)const;
 public:
 
@@ -94,6 +97,8 @@ public:
 	virtual String get_name()const;
 	virtual String get_local_name()const;
 
+	virtual bool is_time_dependent()const { return true; }
+
 	virtual ValueNode::LooseHandle get_link_vfunc(int i)const;
 
 protected:
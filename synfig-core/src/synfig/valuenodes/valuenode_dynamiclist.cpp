@@ -712,6 +712,16 @@ ValueNode_DynamicList::link_count()const
 	return list.size();
 }
 
+bool
+ValueNode_DynamicList::is_time_dependent()const
+{
+	// entries with activepoints are enabled and disabled in time
+	for(std::vector<ListEntry>::const_iterator i = list.begin(); i != list.end(); ++i)
+		if (!i->timing_info.empty())
+			return true;
+	return LinkableValueNode::is_time_dependent();
+}
+
 String
 ValueNode_DynamicList::link_local_name(int i)const
 {
@@ -189,6 +189,8 @@ public:
 
 	virtual String link_name(int i)const;
 
+	virtual bool is_time_dependent()const;
+
  	virtual ValueBase operator()(Time t)const;
 
 	virtual ~ValueNode_DynamicList();
@@ -57,6 +57,8 @@ public:
 	virtual String get_name()const;
 	virtual String get_local_name()const;
 
+	virtual bool is_time_dependent()const { return true; }
+
 	virtual ValueNode::LooseHandle get_link_vfunc(int i)const;
 
 protected:
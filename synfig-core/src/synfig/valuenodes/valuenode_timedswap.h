@@ -65,6 +65,8 @@ public:
 
 	virtual String get_name()const;
 	virtual String get_local_name()const;
+
+	virtual bool is_time_dependent()const { return true; }
 //	static bool check_type(Type &type);
 
 protected:
@@ -56,6 +56,7 @@ SynfigToolGeneralOptions::SynfigToolGeneralOptions(const char* argv0)
 	_should_be_quiet = false;
 	_should_print_benchmarks = false;
 	_threads = 1;
+	_frame_threads = 1;
 }
 
 std::string SynfigToolGeneralOptions::get_binary_path() const
@@ -73,6 +74,16 @@ void SynfigToolGeneralOptions::set_threads(size_t threads)
 	_threads = threads;
 }
 
+size_t SynfigToolGeneralOptions::get_frame_threads() const
+{
+	return _frame_threads;
+}
+
+void SynfigToolGeneralOptions::set_frame_threads(size_t frame_threads)
+{
+	_frame_threads = frame_threads;
+}
+
 int SynfigToolGeneralOptions::get_verbosity() const
 {
 	return _verbosity;
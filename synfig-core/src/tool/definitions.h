@@ -89,6 +89,10 @@ public:
 
 	void set_threads(size_t threads);
 
+	size_t get_frame_threads() const;
+
+	void set_frame_threads(size_t frame_threads);
+
 	int get_verbosity() const;
 
 	void set_verbosity(int verbosity);
@@ -107,6 +111,7 @@ private:
 	std::string _binary_path;
 	int _verbosity;
 	size_t _threads;
+	size_t _frame_threads;
 	bool _should_be_quiet,
 		 _should_print_benchmarks;
 
@@ -205,6 +205,10 @@ bool setup_job(Job& job, const TargetParam& target_parameters)
 		VERBOSE_OUT(4) << _("Setting the canvas on the target...") << std::endl;
 		job.target->set_canvas(job.canvas);
 
+		// every frame is built from own snapshot of the canvas, see Target_Scanline
+		VERBOSE_OUT(4) << _("Setting the count of simultaneously rendered frames of the target...") << std::endl;
+		job.target->set_frame_threads((int)SynfigToolGeneralOptions::instance()->get_frame_threads());
+
 		VERBOSE_OUT(4) << _("Setting the quality of the target...") << std::endl;
 		job.target->set_quality(job.quality);
 
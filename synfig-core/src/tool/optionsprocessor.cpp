@@ -49,6 +49,7 @@
 #include <synfig/filesystemgroup.h>
 #include <synfig/filesystemnative.h>
 #include <synfig/filecontainerzip.h>
+#include <synfig/threadpool.h>
 
 #include "definitions.h"
 #include "job.h"
@@ -100,9 +101,12 @@ SynfigCommandLineParser::SynfigCommandLineParser() :
 	set_antialias(),
 	set_quality(),
 	set_num_threads(),
+	set_num_frame_threads(),
+	set_engine(),
 	set_input_file(),
 	set_output_file(),
 	set_sequence_separator(),
+	set_task_trace(),
 	set_canvas_id(),
 	set_fps(),
 	set_time(),
@@ -158,9 +162,12 @@ SynfigCommandLineParser::SynfigCommandLineParser() :
 	add_option(og_set, "antialias",   'a', set_antialias,	_("Set antialias amount for parametric renderer."), "1..30");
 	//og_set.add_option("quality",     'Q', quality_arg_desc, etl::strprintf(_("Specify image quality for accelerated renderer (Default: %d)"), DEFAULT_QUALITY).c_str(), "NUM");
 	add_option(og_set, "threads",     'T', set_num_threads, _("Enable multithreaded renderer using the specified number of threads"), "NUM");
+	add_option(og_set, "frame-threads", ' ', set_num_frame_threads, _("Render the specified number of frames simultaneously"), "NUM");
+	add_option(og_set, "engine",      ' ', set_engine,		_("Set the rendering engine (e.g. software-half to keep intermediate surfaces in half-float format)"), "name");
 	add_option(og_set, "input-file",  'i', set_input_file, 	_("Specify input filename"), "filename");
 	add_option(og_set, "output-file", 'o', set_output_file, _("Specify output filename"), "filename");
 	add_option(og_set, "sequence-separator", ' ', set_sequence_separator, _("Output file sequence separator string (Use double quotes if you want to use spaces)"), "string");
+	add_option_filename(og_set, "task-trace", ' ', set_task_trace, _("Write timings of rendering tasks to <filename> (Chrome trace JSON, or CSV if the name ends with .csv)"), _("filename"));
 	add_option(og_set, "canvas",      'c', set_canvas_id, 	_("Render the canvas with the given id instead of the root."), "id");
 	add_option(og_set, "fps",         ' ', set_fps, 		_("Set the frame rate"), "NUM");
 	add_option(og_set, "time",        ' ', set_time, 		_("Render a single frame at <seconds>"), "seconds");
@@ -358,10 +365,39 @@ void SynfigCommandLineParser::process_settings_options()
 	if (set_num_threads > 0)
 	{
 		SynfigToolGeneralOptions::instance()->set_threads(set_num_threads);
+
+		// thread pool is created at the program start, before the command line is parsed
+		ThreadPool::instance.set_max_threads(set_num_threads);
+
+		// rendering threads are created at synfig::Main initialization,
+		// so pass the value through the environment
+		if (!Glib::getenv("SYNFIG_RENDERING_THREADS").size())
+			Glib::setenv("SYNFIG_RENDERING_THREADS", etl::strprintf("%d", set_num_threads));
+	}
+
+	if (!set_task_trace.empty())
+	{
+		// render queue opens the trace file at synfig::Main initialization
+		Glib::setenv("SYNFIG_RENDERING_TASK_TRACE", set_task_trace);
+		VERBOSE_OUT(1) << _("Task trace will be written to ") << set_task_trace << std::endl;
+	}
+
+	if (set_num_frame_threads > 0)
+	{
+		SynfigToolGeneralOptions::instance()->set_frame_threads(set_num_frame_threads);
+	}
+
+	if (!set_engine.empty())
+	{
+		// targets takes the engine from the environment when created
+		Glib::setenv("SYNFIG_TARGET_DEFAULT_ENGINE", set_engine);
+		VERBOSE_OUT(1) << _("Rendering engine set to ") << set_engine << std::endl;
 	}
 
 	VERBOSE_OUT(1) << _("Threads set to ")
 				   << SynfigToolGeneralOptions::instance()->get_threads() << std::endl;
+	VERBOSE_OUT(1) << _("Frame threads set to ")
+				   << SynfigToolGeneralOptions::instance()->get_frame_threads() << std::endl;
 }
 
 void SynfigCommandLineParser::process_trivial_info_options()
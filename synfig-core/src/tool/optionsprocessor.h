@@ -155,9 +155,12 @@ private:
 	int				set_quality;
 //			(",Q", quality_arg_desc->default_value(DEFAULT_QUALITY), )
 	int				set_num_threads;
+	int				set_num_frame_threads;
+	Glib::ustring	set_engine;
 	Glib::ustring	set_input_file;
 	Glib::ustring	set_output_file;
 	Glib::ustring	set_sequence_separator;
+	std::string		set_task_trace;
 	Glib::ustring	set_canvas_id;
 	double			set_fps;
 	Glib::ustring	set_time;
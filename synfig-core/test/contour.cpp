@@ -0,0 +1,206 @@
+/* === S Y N F I G ========================================================= */
+/*!	\file contour.cpp
+**	\brief Software Contour Rasterizer Test File
+**
+**	$Id$
+**
+**	\legal
+**	Copyright (c) 2019 Synfig Contributors
+**
+**	This package is free software; you can redistribute it and/or
+**	modify it under the terms of the GNU General Public License as
+**	published by the Free Software Foundation; either version 2 of
+**	the License, or (at your option) any later version.
+**
+**	This package is distributed in the hope that it will be useful,
+**	but WITHOUT ANY WARRANTY; without even the implied warranty of
+**	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+**	General Public License for more details.
+**	\endlegal
+*/
+/* ========================================================================= */
+
+/* === H E A D E R S ======================================================= */
+
+#ifdef USING_PCH
+#	include "pch.h"
+#else
+#ifdef HAVE_CONFIG_H
+#	include <config.h>
+#endif
+
+#include <cmath>
+#include <iostream>
+
+#include <synfig/color.h>
+#include <synfig/matrix.h>
+#include <synfig/rect.h>
+#include <synfig/surface.h>
+#include <synfig/vector.h>
+#include <synfig/rendering/primitive/contour.h>
+#include <synfig/rendering/primitive/polyspan.h>
+#include <synfig/rendering/software/function/contour.h>
+
+#endif
+
+/* === U S I N G =========================================================== */
+
+using namespace std;
+using namespace etl;
+using namespace synfig;
+using namespace rendering;
+
+/* === M A C R O S ========================================================= */
+
+/* === G L O B A L S ======================================================= */
+
+// surface is large enough to be split by several bands
+static const int surface_size = 256;
+
+/* === P R O C E D U R E S ================================================= */
+
+// pentagram with self-intersections, center has winding number 2
+static void add_star(rendering::Contour &contour, const Vector &center, Real radius)
+{
+	for(int i = 0; i < 5; ++i)
+	{
+		Real a = 0.5*PI + 4.0*PI*i/5.0;
+		Vector p = center + Vector(cos(a), sin(a))*radius;
+		if (i) contour.line_to(p); else contour.move_to(p);
+	}
+	contour.close();
+}
+
+// circle from cubic curves
+static void add_circle(rendering::Contour &contour, const Vector &center, Real radius, bool reverse)
+{
+	const Real k = 0.5522847498*radius;
+	Real s = reverse ? -1.0 : 1.0;
+	contour.move_to(center + Vector(radius, 0.0));
+	contour.cubic_to(center + Vector(0.0, s*radius), center + Vector(radius, s*k), center + Vector(k, s*radius));
+	contour.cubic_to(center + Vector(-radius, 0.0), center + Vector(-k, s*radius), center + Vector(-radius, s*k));
+	contour.cubic_to(center + Vector(0.0, -s*radius), center + Vector(-radius, -s*k), center + Vector(-k, -s*radius));
+	contour.cubic_to(center + Vector(radius, 0.0), center + Vector(k, -s*radius), center + Vector(radius, -s*k));
+	contour.close();
+}
+
+static rendering::Contour::Handle create_shape()
+{
+	rendering::Contour::Handle contour = new rendering::Contour();
+	add_star(*contour, Vector(128.0, 120.0), 110.0);
+	// two overlapped circles with the same direction and one hole
+	add_circle(*contour, Vector(60.0, 190.0), 45.5, false);
+	add_circle(*contour, Vector(90.3, 200.1), 40.25, false);
+	add_circle(*contour, Vector(200.0, 200.0), 30.0, true);
+	// parts outside of surface, on the left and on the top
+	contour->move_to(Vector(-40.0, 30.0));
+	contour->conic_to(Vector(50.7, -20.0), Vector(20.0, 90.0));
+	contour->line_to(Vector(10.5, 120.25));
+	contour->close();
+	return contour;
+}
+
+static void render_old(
+	synfig::Surface &surface,
+	const RectInt &window,
+	const rendering::Contour &contour,
+	bool invert,
+	bool antialias,
+	rendering::Contour::WindingStyle winding_style )
+{
+	Polyspan polyspan;
+	polyspan.init(window);
+	software::Contour::build_polyspan(contour.get_chunks(), Matrix(), polyspan);
+	polyspan.close();
+	polyspan.sort_marks();
+	software::Contour::render_polyspan(
+		surface, polyspan, invert, antialias, winding_style,
+		Color::white(), 1.0, Color::BLEND_COMPOSITE );
+}
+
+static void render_new(
+	synfig::Surface &surface,
+	const RectInt &window,
+	const rendering::Contour &contour,
+	bool invert,
+	bool antialias,
+	rendering::Contour::WindingStyle winding_style )
+{
+	software::Contour::EdgeList edges;
+	software::Contour::build_edges(contour.get_chunks(), Matrix(), window, edges);
+	software::Contour::render_edges(
+		surface, window, edges, invert, antialias, winding_style,
+		Color::white(), 1.0, Color::BLEND_COMPOSITE );
+}
+
+// compares coverage produced by render_polyspan and by render_edges
+static int check(
+	const RectInt &window,
+	const rendering::Contour &contour,
+	bool invert,
+	bool antialias,
+	rendering::Contour::WindingStyle winding_style )
+{
+	synfig::Surface expected(surface_size, surface_size);
+	synfig::Surface actual(surface_size, surface_size);
+	expected.clear();
+	actual.clear();
+	render_old(expected, window, contour, invert, antialias, winding_style);
+	render_new(actual, window, contour, invert, antialias, winding_style);
+
+	// curves are flattened in different ways, so antialiased pixels near them
+	// may differ a bit, and aliased pixels on the edges may be flipped
+	Real max = 0.0, sum = 0.0;
+	int flipped = 0;
+	for(int y = 0; y < surface_size; ++y)
+		for(int x = 0; x < surface_size; ++x)
+		{
+			Real diff = fabs(expected[y][x].get_a() - actual[y][x].get_a());
+			if (diff > 0.5) ++flipped;
+			if (diff > max) max = diff;
+			sum += diff;
+		}
+
+	bool success = antialias
+	             ? max <= 0.05 && sum <= 0.1*surface_size
+	             : flipped <= surface_size/16;
+	if (success)
+		return 0;
+
+	cerr << "contour test failed:"
+		 << " window " << window.minx << " " << window.miny << " " << window.maxx << " " << window.maxy
+		 << (invert ? ", invert" : "")
+		 << (antialias ? ", antialias" : "")
+		 << (winding_style == rendering::Contour::WINDING_EVEN_ODD ? ", even-odd" : ", non-zero")
+		 << ": max difference " << max
+		 << ", total difference " << sum
+		 << ", flipped pixels " << flipped << endl;
+	return 1;
+}
+
+static int contour_test_coverage()
+{
+	rendering::Contour::Handle contour = create_shape();
+
+	RectInt windows[] = {
+		RectInt(0, 0, surface_size, surface_size), // several bands
+		RectInt(10, 20, 200, 130),                 // window with offset
+		RectInt(5, 100, 60, 110) };                // single band
+
+	int failures = 0;
+	for(int i = 0; i < (int)(sizeof(windows)/sizeof(windows[0])); ++i)
+		for(int invert = 0; invert < 2; ++invert)
+			for(int antialias = 0; antialias < 2; ++antialias)
+			{
+				failures += check(windows[i], *contour, invert, antialias, rendering::Contour::WINDING_NON_ZERO);
+				failures += check(windows[i], *contour, invert, antialias, rendering::Contour::WINDING_EVEN_ODD);
+			}
+	return failures;
+}
+
+/* === E N T R Y P O I N T ================================================= */
+
+int main()
+{
+	return contour_test_coverage();
+}
@@ -0,0 +1,240 @@
+/* === S Y N F I G ========================================================= */
+/*!	\file value.cpp
+**	\brief ValueBase Test File
+**
+**	$Id$
+**
+**	\legal
+**	Copyright (c) 2019 Synfig Contributors
+**
+**	This package is free software; you can redistribute it and/or
+**	modify it under the terms of the GNU General Public License as
+**	published by the Free Software Foundation; either version 2 of
+**	the License, or (at your option) any later version.
+**
+**	This package is distributed in the hope that it will be useful,
+**	but WITHOUT ANY WARRANTY; without even the implied warranty of
+**	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+**	General Public License for more details.
+**	\endlegal
+*/
+/* ========================================================================= */
+
+/* === H E A D E R S ======================================================= */
+
+#ifdef USING_PCH
+#	include "pch.h"
+#else
+#ifdef HAVE_CONFIG_H
+#	include <config.h>
+#endif
+
+#include <iostream>
+#include <utility>
+#include <vector>
+
+#include <ETL/stringf>
+
+#include <synfig/angle.h>
+#include <synfig/blinepoint.h>
+#include <synfig/color.h>
+#include <synfig/matrix.h>
+#include <synfig/time.h>
+#include <synfig/type.h>
+#include <synfig/value.h>
+#include <synfig/vector.h>
+
+#endif
+
+/* === U S I N G =========================================================== */
+
+using namespace std;
+using namespace etl;
+using namespace synfig;
+
+/* === M A C R O S ========================================================= */
+
+#define CHECK(x) \
+	do { if (!(x)) { cerr << __FILE__ << ":" << __LINE__ << ": failed: " #x << endl; ++failures; } } while(0)
+
+/* === G L O B A L S ======================================================= */
+
+/* === P R O C E D U R E S ================================================= */
+
+static BLinePoint blinepoint(Real x, Real y)
+{
+	BLinePoint p;
+	p.set_vertex(Point(x, y));
+	return p;
+}
+
+// small values (stored inline) and large values (shared in heap)
+static int value_test_copy()
+{
+	int failures = 0;
+
+	ValueBase a(Real(1.5));
+	ValueBase b(a);
+	b = Real(2.5);
+	CHECK(a.get(Real()) == 1.5);
+	CHECK(b.get(Real()) == 2.5);
+
+	ValueBase c(Color(0.1, 0.2, 0.3, 0.4));
+	ValueBase d(c);
+	CHECK(d == c);
+	d = Color(1.0, 1.0, 1.0, 1.0);
+	CHECK(c.get(Color()) == Color(0.1, 0.2, 0.3, 0.4));
+
+	ValueBase m(Matrix().set_translate(Vector(1.0, 2.0)));
+	ValueBase n(m);
+	CHECK(n.get(Matrix()) == m.get(Matrix()));
+
+	ValueBase s(String("first"));
+	ValueBase t(s);
+	CHECK(t.get(String()) == "first");
+	t = String("second");
+	CHECK(s.get(String()) == "first");
+	CHECK(t.get(String()) == "second");
+
+	ValueBase p(blinepoint(1.0, 2.0));
+	ValueBase q(p);
+	q = blinepoint(3.0, 4.0);
+	CHECK(p.get(BLinePoint()).get_vertex() == Point(1.0, 2.0));
+	CHECK(q.get(BLinePoint()).get_vertex() == Point(3.0, 4.0));
+
+	// properties are copied with value
+	ValueBase r(Real(1.0));
+	r.set_static(true);
+	r.set_interpolation(INTERPOLATION_CONSTANT);
+	ValueBase r_copy(r);
+	CHECK(r_copy.get_static());
+	CHECK(r_copy.get_interpolation() == INTERPOLATION_CONSTANT);
+
+	return failures;
+}
+
+static int value_test_move()
+{
+	int failures = 0;
+
+	ValueBase a(Vector(1.0, 2.0));
+	ValueBase b(std::move(a));
+	CHECK(b.get(Vector()) == Vector(1.0, 2.0));
+	CHECK(!a.is_valid());
+
+	ValueBase s(String("moved"));
+	ValueBase t(std::move(s));
+	CHECK(t.get(String()) == "moved");
+	CHECK(!s.is_valid());
+
+	ValueBase c(Real(3.0));
+	c = ValueBase(Angle::deg(90));
+	CHECK(c.get_type() == type_angle);
+	c = std::move(t);
+	CHECK(c.get_type() == type_string);
+	CHECK(c.get(String()) == "moved");
+	CHECK(!t.is_valid());
+
+	ValueBase d(String("large"));
+	ValueBase e(Real(4.0));
+	d = std::move(e);
+	CHECK(d.get_type() == type_real);
+	CHECK(d.get(Real()) == 4.0);
+	CHECK(!e.is_valid());
+
+	// self-assignment keeps the value
+	ValueBase &d_ref = d;
+	d = d_ref;
+	d = std::move(d_ref);
+	CHECK(d.get(Real()) == 4.0);
+
+	return failures;
+}
+
+// type changes between inline and heap-backed types
+static int value_test_assignment()
+{
+	int failures = 0;
+
+	ValueBase v;
+	CHECK(!v.is_valid());
+
+	v = Real(1.0);
+	CHECK(v.get_type() == type_real && v.get(Real()) == 1.0);
+	v = String("text");
+	CHECK(v.get_type() == type_string && v.get(String()) == "text");
+	v = Vector(5.0, 6.0);
+	CHECK(v.get_type() == type_vector && v.get(Vector()) == Vector(5.0, 6.0));
+	v = blinepoint(7.0, 8.0);
+	CHECK(v.get_type() == type_bline_point && v.get(BLinePoint()).get_vertex() == Point(7.0, 8.0));
+	v = Color(0.5, 0.5, 0.5, 1.0);
+	CHECK(v.get_type() == type_color && v.get(Color()) == Color(0.5, 0.5, 0.5, 1.0));
+	v = int(7);
+	CHECK(v.get_type() == type_integer && v.get(int()) == 7);
+	v = true;
+	CHECK(v.get_type() == type_bool && v.get(bool()));
+	v = ValueBase();
+	CHECK(!v.is_valid());
+
+	// real assigned to time keeps the type
+	ValueBase time(Time(1.0));
+	time = Real(2.0);
+	CHECK(time.get_type() == type_time && time.get(Time()) == Time(2.0));
+	time = ValueBase(Real(3.0));
+	CHECK(time.get_type() == type_time && time.get(Time()) == Time(3.0));
+
+	// assignment to a shared large value doesn't change other owners
+	ValueBase shared(String("shared"));
+	ValueBase owner(shared);
+	owner = Real(2.0);
+	CHECK(shared.get(String()) == "shared");
+	CHECK(owner.get(Real()) == 2.0);
+
+	// lists contain values of both kinds
+	vector<ValueBase> items;
+	items.push_back(Real(1.0));
+	items.push_back(String("two"));
+	items.push_back(Vector(3.0, 3.0));
+	items.push_back(blinepoint(4.0, 4.0));
+	ValueBase list(items);
+	ValueBase list_copy(list);
+	items.clear();
+	const vector<ValueBase> &copied = list_copy.get_list();
+	CHECK(copied.size() == 4);
+	if (copied.size() == 4)
+	{
+		CHECK(copied[0].get(Real()) == 1.0);
+		CHECK(copied[1].get(String()) == "two");
+		CHECK(copied[2].get(Vector()) == Vector(3.0, 3.0));
+		CHECK(copied[3].get(BLinePoint()).get_vertex() == Point(4.0, 4.0));
+	}
+
+	// reallocation of vector moves values
+	vector<ValueBase> values;
+	for(int i = 0; i < 100; ++i)
+		values.push_back(i % 2 ? ValueBase(Real(i)) : ValueBase(strprintf("%d", i)));
+	for(int i = 0; i < 100; ++i)
+		if (i % 2)
+			CHECK(values[i].get(Real()) == Real(i));
+		else
+			CHECK(values[i].get(String()) == strprintf("%d", i));
+
+	return failures;
+}
+
+/* === E N T R Y P O I N T ================================================= */
+
+int main()
+{
+	Type::subsys_init();
+
+	int failures = 0;
+
+	failures += value_test_copy();
+	failures += value_test_move();
+	failures += value_test_assignment();
+
+	Type::subsys_stop();
+
+	return failures;
+}
@@ -0,0 +1,254 @@
+/* === S Y N F I G ========================================================= */
+/*!	\file valuenode_program.cpp
+**	\brief ValueNodeProgram Test File
+**
+**	$Id$
+**
+**	\legal
+**	Copyright (c) 2019 Synfig Contributors
+**
+**	This package is free software; you can redistribute it and/or
+**	modify it under the terms of the GNU General Public License as
+**	published by the Free Software Foundation; either version 2 of
+**	the License, or (at your option) any later version.
+**
+**	This package is distributed in the hope that it will be useful,
+**	but WITHOUT ANY WARRANTY; without even the implied warranty of
+**	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+**	General Public License for more details.
+**	\endlegal
+*/
+/* ========================================================================= */
+
+/* === H E A D E R S ======================================================= */
+
+#ifdef USING_PCH
+#	include "pch.h"
+#else
+#ifdef HAVE_CONFIG_H
+#	include <config.h>
+#endif
+
+#include <cmath>
+#include <iostream>
+#include <vector>
+
+#include <ETL/stringf>
+
+#include <synfig/angle.h>
+#include <synfig/color.h>
+#include <synfig/time.h>
+#include <synfig/type.h>
+#include <synfig/value.h>
+#include <synfig/valuenode_program.h>
+#include <synfig/vector.h>
+#include <synfig/valuenodes/valuenode_add.h>
+#include <synfig/valuenodes/valuenode_atan2.h>
+#include <synfig/valuenodes/valuenode_composite.h>
+#include <synfig/valuenodes/valuenode_const.h>
+#include <synfig/valuenodes/valuenode_linear.h>
+#include <synfig/valuenodes/valuenode_reciprocal.h>
+#include <synfig/valuenodes/valuenode_scale.h>
+#include <synfig/valuenodes/valuenode_subtract.h>
+
+#endif
+
+/* === U S I N G =========================================================== */
+
+using namespace std;
+using namespace etl;
+using namespace synfig;
+
+/* === M A C R O S ========================================================= */
+
+/* === G L O B A L S ======================================================= */
+
+static const Real times[] = { 0.0, 0.5, 1.0, -2.25, 3.75 };
+
+/* === P R O C E D U R E S ================================================= */
+
+static bool equal(const ValueBase &a, const ValueBase &b)
+{
+	if (a.get_type() != b.get_type())
+		return false;
+	ValueNodeProgram::Kind kind = ValueNodeProgram::get_kind(a.get_type());
+	ValueNodeProgram::Register ra, rb;
+	if (!ValueNodeProgram::load(ra, kind, a) || !ValueNodeProgram::load(rb, kind, b))
+		return false;
+	for(int i = 0; i < 4; ++i)
+		if (fabs(ra.data[i] - rb.data[i]) > 1e-6*(1.0 + fabs(ra.data[i])))
+			return false;
+	return true;
+}
+
+// compares result of program with direct evaluation of nodes
+static int check(const String &name, const vector<ValueNode::Handle> &nodes, int expected_instructions = -1)
+{
+	ValueNodeProgram::Handle program = new ValueNodeProgram();
+	for(int i = 0; i < (int)nodes.size(); ++i)
+		program->add_output(strprintf("%s %d", name.c_str(), i), nodes[i]);
+
+	int failures = 0;
+	if (expected_instructions >= 0 && program->get_instruction_count() != expected_instructions)
+	{
+		cerr << name << ": " << program->get_instruction_count()
+			 << " instructions, expected " << expected_instructions << endl;
+		++failures;
+	}
+
+	vector<ValueBase> values;
+	for(int j = 0; j < (int)(sizeof(times)/sizeof(times[0])); ++j)
+	{
+		Time t(times[j]);
+		program->run(t, values);
+		if (values.size() != nodes.size())
+			{ cerr << name << ": wrong count of values" << endl; return failures + 1; }
+		for(int i = 0; i < (int)nodes.size(); ++i)
+			if (!equal(values[i], (*nodes[i])(t)))
+			{
+				cerr << program->get_output(i).name << ": wrong value at time " << times[j] << endl;
+				++failures;
+			}
+	}
+	return failures;
+}
+
+static ValueNode::Handle constant(const ValueBase &value)
+	{ return ValueNode_Const::create(value); }
+
+static ValueNode::Handle linear(const ValueBase &slope, const ValueBase &offset)
+{
+	LinkableValueNode::Handle node = ValueNode_Linear::create(offset);
+	node->set_link("slope", constant(slope));
+	node->set_link("offset", constant(offset));
+	return node;
+}
+
+static ValueNode::Handle reciprocal(const ValueNode::Handle &link)
+{
+	LinkableValueNode::Handle node = ValueNode_Reciprocal::create(Real(1.0));
+	node->set_link("link", link);
+	return node;
+}
+
+static ValueNode::Handle binary(LinkableValueNode::Handle node, const ValueNode::Handle &lhs, const ValueNode::Handle &rhs, const ValueNode::Handle &scalar)
+{
+	node->set_link("lhs", lhs);
+	node->set_link("rhs", rhs);
+	node->set_link("scalar", scalar);
+	return node;
+}
+
+static ValueNode::Handle scale(const ValueNode::Handle &link, const ValueNode::Handle &scalar)
+{
+	LinkableValueNode::Handle node = ValueNode_Scale::create((*link)(0));
+	node->set_link("link", link);
+	node->set_link("scalar", scalar);
+	return node;
+}
+
+// Add, Subtract, Scale and Linear for all supported types,
+// with sub-nodes linked several times
+static int program_test_arithmetic()
+{
+	vector< pair<ValueBase, ValueBase> > samples;
+	samples.push_back(make_pair(ValueBase(Real(1.5)), ValueBase(Real(-0.25))));
+	samples.push_back(make_pair(ValueBase(Angle::deg(30)), ValueBase(Angle::deg(-45))));
+	samples.push_back(make_pair(ValueBase(Time(2.0)), ValueBase(Time(0.5))));
+	samples.push_back(make_pair(ValueBase(int(3)), ValueBase(int(-7))));
+	samples.push_back(make_pair(ValueBase(Vector(1.0, -2.0)), ValueBase(Vector(0.25, 4.0))));
+	samples.push_back(make_pair(ValueBase(Color(0.1, 0.2, 0.3, 0.4)), ValueBase(Color(0.5, 0.25, 1.0, 1.0))));
+
+	int failures = 0;
+	for(int i = 0; i < (int)samples.size(); ++i)
+	{
+		const ValueBase &a = samples[i].first;
+		const ValueBase &b = samples[i].second;
+		String name = a.get_type().description.name;
+
+		ValueNode::Handle shared = linear(a, b);
+		ValueNode::Handle other = linear(b, a);
+		ValueNode::Handle scalar = linear(Real(0.75), Real(1.25));
+
+		vector<ValueNode::Handle> nodes;
+		nodes.push_back(shared);
+		nodes.push_back(binary(ValueNode_Add::create(a), shared, other, scalar));
+		nodes.push_back(binary(ValueNode_Subtract::create(a), shared, shared, scalar));
+		nodes.push_back(binary(ValueNode_Subtract::create(a), other, nodes[1], constant(Real(2.0))));
+		// ValueNode_Scale accepts only real scalar, but reads it as time for time values
+		if (a.get_type() != type_time)
+		{
+			nodes.push_back(scale(nodes[1], scalar));
+			nodes.push_back(scale(constant(a), reciprocal(scalar)));
+		}
+		failures += check(name, nodes);
+
+		// shared sub-node is compiled only once: Linear + Add
+		vector<ValueNode::Handle> single;
+		single.push_back(binary(ValueNode_Add::create(a), shared, shared, constant(Real(1.0))));
+		failures += check(name + " shared", single, 2);
+	}
+	return failures;
+}
+
+// Composite, Reciprocal and Atan2
+static int program_test_functions()
+{
+	ValueNode::Handle x = linear(Real(2.0), Real(-1.0));
+	ValueNode::Handle y = linear(Real(-0.5), Real(0.75));
+	ValueNode::Handle zero = linear(Real(0.0), Real(0.0));
+
+	vector<ValueNode::Handle> nodes;
+
+	LinkableValueNode::Handle vector_composite = ValueNode_Composite::create(Vector());
+	vector_composite->set_link("x", x);
+	vector_composite->set_link("y", reciprocal(y));
+	nodes.push_back(vector_composite);
+
+	LinkableValueNode::Handle color_composite = ValueNode_Composite::create(Color());
+	color_composite->set_link("r", x);
+	color_composite->set_link("g", y);
+	color_composite->set_link("b", x);
+	color_composite->set_link("a", constant(Real(0.5)));
+	nodes.push_back(color_composite);
+
+	// reciprocal of zero gives infinite value
+	nodes.push_back(reciprocal(x));
+	nodes.push_back(reciprocal(zero));
+
+	LinkableValueNode::Handle atan2 = ValueNode_Atan2::create(Angle::deg(0));
+	atan2->set_link("x", x);
+	atan2->set_link("y", y);
+	nodes.push_back(atan2);
+	nodes.push_back(scale(atan2, reciprocal(y)));
+
+	return check("functions", nodes);
+}
+
+// program with more registers than fits in stack
+static int program_test_large()
+{
+	ValueNode::Handle node = linear(Real(1.0), Real(0.0));
+	for(int i = 0; i < 2*ValueNodeProgram::STACK_REGISTERS; ++i)
+		node = binary(ValueNode_Add::create(Real()), node, linear(Real(0.125*i), Real(-0.5)), constant(Real(0.5)));
+
+	vector<ValueNode::Handle> nodes(1, node);
+	return check("large", nodes);
+}
+
+/* === E N T R Y P O I N T ================================================= */
+
+int main()
+{
+	Type::subsys_init();
+
+	int failures = 0;
+
+	failures += program_test_arithmetic();
+	failures += program_test_functions();
+	failures += program_test_large();
+
+	Type::subsys_stop();
+
+	return failures;
+}